@@ -0,0 +1,306 @@
+// PBenchmark.cpp - Implements the per-placement benchmark runs, kernels and statistics.
+//
+#include "pch.h"
+#include "PBenchmark.h"
+#include "PTelemetrySampler.h"
+#include <cerrno>
+#include <cmath>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+// Two-sided 95% Student's t quantiles for 1..30 degrees of freedom
+static const double tQuantile95[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+};
+
+// Mean, sample standard deviation, 95% confidence half-width and median
+PBenchStats PBenchStats::FromSamples(const std::vector<double>& samples)
+{
+    PBenchStats stats;
+    stats.count = samples.size();
+    if (samples.empty())
+        return stats;
+    stats.median = Percentile(samples, 50.0);
+    double sum = 0.0;
+    for (double value : samples)
+        sum += value;
+    stats.mean = sum / samples.size();
+    if (samples.size() < 2)
+        return stats;
+    double squares = 0.0;
+    for (double value : samples)
+        squares += (value - stats.mean) * (value - stats.mean);
+    stats.stddev = std::sqrt(squares / (samples.size() - 1));
+    size_t df = samples.size() - 1;
+    double t = df <= 30 ? tQuantile95[df - 1] : 1.960;
+    stats.ci95 = t * stats.stddev / std::sqrt(static_cast<double>(samples.size()));
+    return stats;
+}
+
+// Linear interpolation between the closest ranks (the "C = 1" definition: 0 is the minimum, 100 the maximum)
+double PBenchStats::Percentile(std::vector<double> samples, double p)
+{
+    if (samples.empty())
+        return 0.0;
+    std::sort(samples.begin(), samples.end());
+    double rank = std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(samples.size() - 1);
+    size_t lower = static_cast<size_t>(rank);
+    if (lower + 1 >= samples.size())
+        return samples.back();
+    return samples[lower] + (rank - static_cast<double>(lower)) * (samples[lower + 1] - samples[lower]);
+}
+
+// CPU time consumed by this process so far
+static double ProcessCpuSeconds()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0.0;
+    auto ticks = [](const FILETIME& ft) { return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime; };
+    return (ticks(kernel) + ticks(user)) / 1e7;
+#else
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#endif
+}
+
+// Package energy: top-level RAPL zones only, subzones are already included in them
+static double PackageJoules(const PTelemetrySampler& sampler, const PTelemetrySample& sample)
+{
+    uint64_t total = 0;
+    const auto& domains = sampler.EnergyDomains();
+    for (size_t i = 0; i < domains.size(); i++) {
+        if (std::count(domains[i].id.begin(), domains[i].id.end(), ':') == 1)
+            total += sample.energyUj[i];
+    }
+    return total / 1e6;
+}
+
+// Constructor
+PBenchmark::PBenchmark(const PCpuTopology& topology, const std::filesystem::path& root)
+    : topology(topology), root(root)
+{
+}
+
+// Run the workload `repeats` times under the placement
+bool PBenchmark::Run(PCorePlacement placement, const PBenchWorkload& workload, unsigned repeats, PBenchResult& result)
+{
+    result = {};
+    result.placement = placement;
+    PCpuMask cpus = PlacementMask(topology, placement);
+    result.cpuCount = cpus.Count();
+    if (cpus.Empty()) {
+        result.failed = true;
+        return false;
+    }
+
+    PTelemetrySampler sampler(root, 16);
+    result.haveEnergy = !sampler.EnergyDomains().empty();
+    PTelemetrySample sample;
+    for (unsigned run = 0; run < repeats; run++) {
+        // A slow sampling tick is enough to see every wraparound (ranges last minutes at package power)
+        bool sampling = result.haveEnergy && sampler.Start(std::chrono::milliseconds(500));
+        auto start = std::chrono::steady_clock::now();
+        double cpuSeconds = 0.0;
+        bool ok = RunOnce(cpus, workload, cpuSeconds);
+        auto end = std::chrono::steady_clock::now();
+        if (sampling) {
+            sampler.Stop();
+            sampler.Drain([](const PTelemetrySample&) {});
+            sampler.SampleOnce(sample);
+        }
+        if (!ok) {
+            result.failed = true;
+            return false;
+        }
+        result.wallSeconds.push_back(std::chrono::duration<double>(end - start).count());
+        result.cpuSeconds.push_back(cpuSeconds);
+        if (sampling)
+            result.joules.push_back(PackageJoules(sampler, sample));
+    }
+    return true;
+}
+
+// One timed run
+bool PBenchmark::RunOnce(const PCpuMask& cpus, const PBenchWorkload& workload, double& cpuSeconds)
+{
+    if (workload.external)
+        return RunCommand(cpus, workload.command, cpuSeconds);
+    double before = ProcessCpuSeconds();
+    if (!RunKernel(cpus, workload.kernel, workload.work))
+        return false;
+    cpuSeconds = ProcessCpuSeconds() - before;
+    return true;
+}
+
+// Built-in kernels: a fixed total amount of work split over one pinned thread per allowed CPU
+bool PBenchmark::RunKernel(const PCpuMask& cpus, PBenchKernel kernel, uint64_t work)
+{
+    // The calling thread is one of the workers; if the OS refuses the placement there is nothing to measure
+    PSavedAffinity saved;
+    if (!SaveCurrentThreadAffinity(saved) || !PinThread(CurrentThreadId(), cpus))
+        return false;
+    if (work == 0)
+        work = kernel == PBenchKernel::Compute ? 4000000000ull : 2000000000ull;
+    size_t threads = cpus.Count();
+    std::atomic<uint64_t> next{ 0 };
+    std::atomic<double> sink{ 0.0 };
+    const uint64_t chunk = 1 << 20;
+
+    auto worker = [&]() {
+        // Each worker pins itself: Windows threads do not inherit selected CPU sets
+        PinThread(CurrentThreadId(), cpus);
+        std::vector<double> a, b, c;
+        if (kernel == PBenchKernel::Memory) {
+            a.assign(chunk, 1.0);
+            b.assign(chunk, 2.0);
+            c.assign(chunk, 0.0);
+        }
+        double local = 0.0;
+        for (uint64_t begin = next.fetch_add(chunk); begin < work; begin = next.fetch_add(chunk)) {
+            uint64_t count = std::min(chunk, work - begin);
+            if (kernel == PBenchKernel::Compute) {
+                // Four independent dependency chains keep the FP pipes busy without vectorizing away the work
+                double x0 = 1.0, x1 = 1.1, x2 = 1.2, x3 = 1.3;
+                for (uint64_t i = 0; i < count; i += 4) {
+                    x0 = x0 * 0.999999 + 0.000001;
+                    x1 = x1 * 0.999999 + 0.000001;
+                    x2 = x2 * 0.999999 + 0.000001;
+                    x3 = x3 * 0.999999 + 0.000001;
+                }
+                local += x0 + x1 + x2 + x3;
+            } else {
+                for (uint64_t i = 0; i < count; i++)
+                    c[i] = a[i] + 3.0 * b[i];
+                local += c[count - 1];
+            }
+        }
+        sink.store(sink.load(std::memory_order_relaxed) + local, std::memory_order_relaxed);
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; t++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool)
+        thread.join();
+    RestoreCurrentThreadAffinity(saved);
+    return true;
+}
+
+#ifdef _WIN32
+
+// External command: created suspended, given the placement as default CPU sets, then resumed
+bool PBenchmark::RunCommand(const PCpuMask& cpus, const std::vector<std::wstring>& command, double& cpuSeconds)
+{
+    if (command.empty())
+        return false;
+    std::wstring commandLine;
+    for (const auto& arg : command) {
+        if (!commandLine.empty())
+            commandLine += L' ';
+        if (arg.find_first_of(L" \t\"") == std::wstring::npos && !arg.empty()) {
+            commandLine += arg;
+            continue;
+        }
+        commandLine += L'"';
+        for (wchar_t ch : arg) {
+            if (ch == L'"')
+                commandLine += L'\\';
+            commandLine += ch;
+        }
+        commandLine += L'"';
+    }
+
+    STARTUPINFOW startup = { sizeof(startup) };
+    PROCESS_INFORMATION process = {};
+    if (!CreateProcessW(nullptr, commandLine.data(), nullptr, nullptr, FALSE, CREATE_SUSPENDED, nullptr, nullptr, &startup, &process))
+        return false;
+    wil::unique_handle processHandle(process.hProcess);
+    wil::unique_handle threadHandle(process.hThread);
+    if (!PinProcess(process.hProcess, cpus)) {
+        TerminateProcess(process.hProcess, 1);
+        return false;
+    }
+    ResumeThread(process.hThread);
+    WaitForSingleObject(process.hProcess, INFINITE);
+
+    DWORD exitCode = 0;
+    GetExitCodeProcess(process.hProcess, &exitCode);
+    FILETIME creation, exit, kernel, user;
+    if (GetProcessTimes(process.hProcess, &creation, &exit, &kernel, &user)) {
+        auto ticks = [](const FILETIME& ft) { return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime; };
+        cpuSeconds = (ticks(kernel) + ticks(user)) / 1e7;
+    }
+    return exitCode == 0;
+}
+
+#else
+
+// External command: forked from a thread pinned to the placement, so the child inherits it
+bool PBenchmark::RunCommand(const PCpuMask& cpus, const std::vector<std::wstring>& command, double& cpuSeconds)
+{
+    if (command.empty())
+        return false;
+    // Narrow the arguments before fork; the child only calls execvp
+    std::vector<std::string> narrow;
+    for (const auto& arg : command) {
+        std::string text;
+        size_t length = std::wcstombs(nullptr, arg.c_str(), 0);
+        if (length != static_cast<size_t>(-1)) {
+            text.resize(length);
+            std::wcstombs(text.data(), arg.c_str(), length + 1);
+        }
+        narrow.push_back(std::move(text));
+    }
+    std::vector<char*> argv;
+    for (auto& arg : narrow)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    PSavedAffinity saved;
+    if (!SaveCurrentThreadAffinity(saved) || !PinThread(CurrentThreadId(), cpus))
+        return false;
+    pid_t child = fork();
+    if (child == 0) {
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    RestoreCurrentThreadAffinity(saved);
+    if (child < 0)
+        return false;
+
+    int status = 0;
+    rusage usage = {};
+    while (wait4(child, &status, 0, &usage) < 0) {
+        if (errno != EINTR)
+            return false;
+    }
+    cpuSeconds = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+#endif
+
+// Name used on the command line
+const wchar_t* PBenchmark::KernelName(PBenchKernel kernel)
+{
+    return kernel == PBenchKernel::Memory ? L"memory" : L"compute";
+}
+
+// Parse a kernel name
+bool PBenchmark::ParseKernel(std::wstring_view text, PBenchKernel& kernel)
+{
+    if (text == L"compute") kernel = PBenchKernel::Compute;
+    else if (text == L"memory") kernel = PBenchKernel::Memory;
+    else return false;
+    return true;
+}
@@ -0,0 +1,76 @@
+// PBenchmark.h - Declares the energy-to-solution benchmark harness.
+//
+// PBenchmark class:
+//   - Runs a workload repeatedly under a PCorePlacement and records wall time, CPU time and package energy.
+//   - Workloads are either a built-in kernel split across one thread per allowed CPU (a fixed total amount
+//     of work, so runs under different placements compute the same job) or an external command line.
+//   - Energy is the sum of the top-level RAPL zones (intel-rapl:N) read through PTelemetrySampler, which
+//     keeps sampling during the run so counter wraparound is caught; without powercap only times are reported.
+//
+// Types:
+//   - PBenchKernel: Built-in workloads (Compute: dependent FP multiply-adds, Memory: streaming triad).
+//   - PBenchStats: Mean, sample standard deviation, 95% confidence half-width (Student's t) and median;
+//     Percentile interpolates linearly between the closest ranks.
+//
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "PCpuTopology.h"
+#include "PThreadPlacement.h"
+
+enum class PBenchKernel {
+    Compute,
+    Memory,
+};
+
+struct PBenchStats {
+    double mean = 0.0;
+    double stddev = 0.0;
+    double ci95 = 0.0; // half-width of the 95% confidence interval
+    double median = 0.0;
+    size_t count = 0;
+
+    static PBenchStats FromSamples(const std::vector<double>& samples);
+    // p in [0, 100]; 0 for no samples
+    static double Percentile(std::vector<double> samples, double p);
+};
+
+struct PBenchWorkload {
+    bool external = false;
+    PBenchKernel kernel = PBenchKernel::Compute;
+    uint64_t work = 0;                   // kernel units in total (0 = kernel default)
+    std::vector<std::wstring> command;   // external: program and arguments
+};
+
+struct PBenchResult {
+    PCorePlacement placement = PCorePlacement::Any;
+    size_t cpuCount = 0;               // CPUs the placement allowed
+    bool haveEnergy = false;
+    bool failed = false;               // placement empty, pinning refused or command failed
+    std::vector<double> wallSeconds;
+    std::vector<double> cpuSeconds;
+    std::vector<double> joules;
+};
+
+class PBenchmark
+{
+public:
+    // root is the directory that contains "sys" ("/" on a live system)
+    PBenchmark(const PCpuTopology& topology, const std::filesystem::path& root = "/");
+
+    // Run the workload `repeats` times under the placement
+    bool Run(PCorePlacement placement, const PBenchWorkload& workload, unsigned repeats, PBenchResult& result);
+
+    static const wchar_t* KernelName(PBenchKernel kernel);
+    static bool ParseKernel(std::wstring_view text, PBenchKernel& kernel);
+
+private:
+    bool RunOnce(const PCpuMask& cpus, const PBenchWorkload& workload, double& cpuSeconds);
+    // Both pin the calling thread for the run and then put back the affinity it had before
+    bool RunKernel(const PCpuMask& cpus, PBenchKernel kernel, uint64_t work);
+    bool RunCommand(const PCpuMask& cpus, const std::vector<std::wstring>& command, double& cpuSeconds);
+
+    const PCpuTopology& topology;
+    std::filesystem::path root;
+};
@@ -0,0 +1,403 @@
+// PBinarySnapshot.cpp - Implements the binary snapshot writer and the memory-mapped reader.
+//
+#include "pch.h"
+#include "PBinarySnapshot.h"
+#include "PGuid.h"
+#include "PUtf8.h"
+#include <bit>
+#include <fstream>
+
+namespace {
+
+constexpr char SnapshotMagic[8] = { 'P', 'I', 'S', 'N', 'A', 'P', '\0', '\0' };
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t schemeCount;
+    uint32_t settingCount;
+    uint32_t cpuCount;
+    uint32_t siblingWords;
+    GUID activeScheme;
+    uint64_t schemesOffset;
+    uint64_t settingsOffset;
+    uint64_t cpusOffset;
+    uint64_t siblingsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+
+struct SchemeRecord {
+    GUID guid;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t firstSetting;
+    uint32_t settingCount;
+};
+
+struct SettingRecord {
+    GUID subgroup;
+    GUID setting;
+    uint32_t schemeIndex;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t descriptionOffset;
+    uint32_t descriptionLength;
+    uint32_t acValue;
+    uint32_t dcValue;
+    uint8_t acType;   // PValueType
+    uint8_t dcType;
+    uint8_t reserved[2];
+};
+
+struct CpuRecord {
+    uint8_t online;
+    uint8_t coreType;  // PCoreType
+    uint8_t reserved[2];
+    int32_t coreId;
+    int32_t packageId;
+    int32_t dieId;
+    int32_t numaNode;
+    uint32_t capacity;
+    uint32_t reserved2[2];
+};
+
+static_assert(std::endian::native == std::endian::little, "snapshot records are stored little-endian");
+static_assert(sizeof(GUID) == 16, "GUID must be 16 bytes");
+static_assert(sizeof(SnapshotHeader) % 8 == 0 && sizeof(SchemeRecord) == 32 && sizeof(SettingRecord) == 64 && sizeof(CpuRecord) == 32,
+              "record sizes are part of the file format");
+
+uint64_t Align8(uint64_t value)
+{
+    return (value + 7) & ~uint64_t(7);
+}
+
+// True if [offset, offset + count * size) lies inside the file
+bool InRange(uint64_t offset, uint64_t count, uint64_t size, uint64_t fileSize)
+{
+    return offset <= fileSize && offset % 8 == 0 && (size == 0 || count <= (fileSize - offset) / size);
+}
+
+} // namespace
+
+// Serialize a snapshot
+bool WriteBinarySnapshot(const PSystemSnapshot& snapshot, const std::filesystem::path& path)
+{
+    const PCompactSnapshot& settings = snapshot.settings;
+    const PStringTable& strings = settings.Strings();
+
+    // Each interned string is converted to UTF-8 once, on first use
+    std::string text;
+    std::vector<std::pair<uint32_t, uint32_t>> located(strings.Count(), { UINT32_MAX, 0 });
+    auto locate = [&](uint32_t id) {
+        if (located[id].first == UINT32_MAX) {
+            std::string utf8 = WideToUtf8(strings.Get(id));
+            located[id] = { static_cast<uint32_t>(text.size()), static_cast<uint32_t>(utf8.size()) };
+            text += utf8;
+        }
+        return located[id];
+    };
+
+    // Schemes sorted by GUID, their settings sorted by setting GUID
+    std::vector<uint32_t> schemeOrder(settings.SchemeCount());
+    for (uint32_t i = 0; i < schemeOrder.size(); i++)
+        schemeOrder[i] = i;
+    std::sort(schemeOrder.begin(), schemeOrder.end(), [&](uint32_t a, uint32_t b) {
+        return CompareGuid(settings.SchemeGuids()[a], settings.SchemeGuids()[b]) < 0;
+    });
+    std::vector<std::vector<uint32_t>> settingsOfScheme(settings.SchemeCount());
+    for (uint32_t i = 0; i < settings.SettingCount(); i++)
+        settingsOfScheme[settings.SettingSchemes()[i]].push_back(i);
+
+    std::vector<SchemeRecord> schemes;
+    std::vector<SettingRecord> records;
+    records.reserve(settings.SettingCount());
+    for (uint32_t source : schemeOrder) {
+        SchemeRecord scheme = {};
+        scheme.guid = settings.SchemeGuids()[source];
+        std::tie(scheme.nameOffset, scheme.nameLength) = locate(settings.SchemeNameIds()[source]);
+        scheme.firstSetting = static_cast<uint32_t>(records.size());
+        std::vector<uint32_t>& members = settingsOfScheme[source];
+        std::sort(members.begin(), members.end(), [&](uint32_t a, uint32_t b) {
+            return CompareGuid(settings.SettingGuids()[a], settings.SettingGuids()[b]) < 0;
+        });
+        for (uint32_t i : members) {
+            SettingRecord record = {};
+            record.subgroup = settings.SubgroupGuids()[i];
+            record.setting = settings.SettingGuids()[i];
+            record.schemeIndex = static_cast<uint32_t>(schemes.size());
+            std::tie(record.nameOffset, record.nameLength) = locate(settings.NameIds()[i]);
+            std::tie(record.descriptionOffset, record.descriptionLength) = locate(settings.DescriptionIds()[i]);
+            record.acValue = settings.AcValues()[i];
+            record.dcValue = settings.DcValues()[i];
+            record.acType = static_cast<uint8_t>(settings.AcTypes()[i]);
+            record.dcType = static_cast<uint8_t>(settings.DcTypes()[i]);
+            records.push_back(record);
+        }
+        scheme.settingCount = static_cast<uint32_t>(records.size()) - scheme.firstSetting;
+        schemes.push_back(scheme);
+    }
+
+    const PCpuTopology& topology = snapshot.topology;
+    size_t siblingWords = (topology.cpuCount + 63) / 64;
+    std::vector<CpuRecord> cpus(topology.cpuCount);
+    std::vector<uint64_t> siblings(topology.cpuCount * siblingWords);
+    for (size_t cpu = 0; cpu < topology.cpuCount; cpu++) {
+        CpuRecord& record = cpus[cpu];
+        record.online = topology.online.Test(cpu) ? 1 : 0;
+        record.coreType = static_cast<uint8_t>(topology.coreType[cpu]);
+        record.coreId = topology.coreId[cpu];
+        record.packageId = topology.packageId[cpu];
+        record.dieId = topology.dieId[cpu];
+        record.numaNode = topology.numaNode[cpu];
+        record.capacity = topology.capacity[cpu];
+        const auto& words = topology.smtSiblings[cpu].Words();
+        std::copy_n(words.begin(), std::min(words.size(), siblingWords), siblings.begin() + cpu * siblingWords);
+    }
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SnapshotMagic, sizeof(SnapshotMagic));
+    header.version = PBinarySnapshotReader::FormatVersion;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.schemeCount = static_cast<uint32_t>(schemes.size());
+    header.settingCount = static_cast<uint32_t>(records.size());
+    header.cpuCount = static_cast<uint32_t>(cpus.size());
+    header.siblingWords = static_cast<uint32_t>(siblingWords);
+    header.activeScheme = snapshot.activeScheme;
+    header.schemesOffset = sizeof(SnapshotHeader);
+    header.settingsOffset = header.schemesOffset + schemes.size() * sizeof(SchemeRecord);
+    header.cpusOffset = header.settingsOffset + records.size() * sizeof(SettingRecord);
+    header.siblingsOffset = header.cpusOffset + cpus.size() * sizeof(CpuRecord);
+    header.stringsOffset = Align8(header.siblingsOffset + siblings.size() * sizeof(uint64_t));
+    header.stringsSize = text.size();
+
+    std::filesystem::path temp = UniqueTempPath(path);
+    bool written;
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(schemes.data()), schemes.size() * sizeof(SchemeRecord));
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(SettingRecord));
+        out.write(reinterpret_cast<const char*>(cpus.data()), cpus.size() * sizeof(CpuRecord));
+        out.write(reinterpret_cast<const char*>(siblings.data()), siblings.size() * sizeof(uint64_t));
+        static const char padding[8] = {};
+        out.write(padding, header.stringsOffset - (header.siblingsOffset + siblings.size() * sizeof(uint64_t)));
+        out.write(text.data(), text.size());
+        out.close();
+        written = !out.fail();
+    }
+    std::error_code ec;
+    if (written)
+        std::filesystem::rename(temp, path, ec);
+    if (!written || ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+// Check the magic
+bool IsBinarySnapshot(const std::filesystem::path& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(SnapshotMagic)] = {};
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, SnapshotMagic, sizeof(magic)) == 0;
+}
+
+// Map the file and validate the header, every block and every string reference
+bool PBinarySnapshotReader::Open(const std::filesystem::path& path)
+{
+    if (!file.Open(path))
+        return false;
+    const uint8_t* data = file.Data();
+    uint64_t size = file.Size();
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(data);
+    // Records are read in place, so the mapping itself must be 8-byte aligned (it is page aligned in practice)
+    bool valid = reinterpret_cast<uintptr_t>(data) % 8 == 0 &&
+                 size >= sizeof(SnapshotHeader) &&
+                 std::memcmp(header->magic, SnapshotMagic, sizeof(SnapshotMagic)) == 0 &&
+                 header->version == FormatVersion &&
+                 header->headerSize >= sizeof(SnapshotHeader) &&
+                 header->schemesOffset >= header->headerSize &&
+                 header->siblingWords == (uint64_t(header->cpuCount) + 63) / 64 &&
+                 InRange(header->schemesOffset, header->schemeCount, sizeof(SchemeRecord), size) &&
+                 InRange(header->settingsOffset, header->settingCount, sizeof(SettingRecord), size) &&
+                 InRange(header->cpusOffset, header->cpuCount, sizeof(CpuRecord), size) &&
+                 InRange(header->siblingsOffset, uint64_t(header->cpuCount) * header->siblingWords, sizeof(uint64_t), size) &&
+                 header->stringsOffset <= size && header->stringsSize <= size - header->stringsOffset;
+
+    // Find() binary-searches, so the order is part of the format: schemes strictly ascending by GUID, their
+    // ranges tiling the setting array in scheme order, and each range ascending by setting GUID with every
+    // record pointing back at its scheme
+    auto stringOk = [&](uint32_t offset, uint32_t length) { return uint64_t(offset) + length <= header->stringsSize; };
+    const SchemeRecord* schemes = reinterpret_cast<const SchemeRecord*>(data + header->schemesOffset);
+    const SettingRecord* records = reinterpret_cast<const SettingRecord*>(data + header->settingsOffset);
+    uint64_t nextSetting = 0;
+    for (uint32_t i = 0; valid && i < header->schemeCount; i++) {
+        const SchemeRecord& scheme = schemes[i];
+        valid = stringOk(scheme.nameOffset, scheme.nameLength) &&
+                (i == 0 || CompareGuid(schemes[i - 1].guid, scheme.guid) < 0) &&
+                scheme.firstSetting == nextSetting &&
+                scheme.settingCount <= header->settingCount - nextSetting;
+        for (uint32_t j = scheme.firstSetting; valid && j < scheme.firstSetting + scheme.settingCount; j++) {
+            const SettingRecord& record = records[j];
+            valid = record.schemeIndex == i && stringOk(record.nameOffset, record.nameLength) &&
+                    stringOk(record.descriptionOffset, record.descriptionLength) &&
+                    (j == scheme.firstSetting || CompareGuid(records[j - 1].setting, record.setting) <= 0);
+        }
+        nextSetting += scheme.settingCount;
+    }
+    valid = valid && nextSetting == header->settingCount;
+    if (!valid)
+        file.Close();
+    return valid;
+}
+
+// Counts are 0 while no file is open
+const GUID& PBinarySnapshotReader::ActiveScheme() const
+{
+    static const GUID none = {};
+    if (!IsOpen())
+        return none;
+    return reinterpret_cast<const SnapshotHeader*>(file.Data())->activeScheme;
+}
+
+size_t PBinarySnapshotReader::SchemeCount() const
+{
+    if (!IsOpen())
+        return 0;
+    return reinterpret_cast<const SnapshotHeader*>(file.Data())->schemeCount;
+}
+
+size_t PBinarySnapshotReader::SettingCount() const
+{
+    if (!IsOpen())
+        return 0;
+    return reinterpret_cast<const SnapshotHeader*>(file.Data())->settingCount;
+}
+
+size_t PBinarySnapshotReader::CpuCount() const
+{
+    if (!IsOpen())
+        return 0;
+    return reinterpret_cast<const SnapshotHeader*>(file.Data())->cpuCount;
+}
+
+size_t PBinarySnapshotReader::SiblingWords() const
+{
+    if (!IsOpen())
+        return 0;
+    return reinterpret_cast<const SnapshotHeader*>(file.Data())->siblingWords;
+}
+
+// Scheme record as views into the mapping
+PBinarySnapshotReader::SchemeView PBinarySnapshotReader::Scheme(size_t index) const
+{
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(file.Data());
+    const SchemeRecord& record = reinterpret_cast<const SchemeRecord*>(file.Data() + header->schemesOffset)[index];
+    const char* strings = reinterpret_cast<const char*>(file.Data() + header->stringsOffset);
+    return { &record.guid, std::string_view(strings + record.nameOffset, record.nameLength), record.firstSetting, record.settingCount };
+}
+
+// Setting record as views into the mapping
+PBinarySnapshotReader::SettingView PBinarySnapshotReader::Setting(size_t index) const
+{
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(file.Data());
+    const SettingRecord& record = reinterpret_cast<const SettingRecord*>(file.Data() + header->settingsOffset)[index];
+    const SchemeRecord& scheme = reinterpret_cast<const SchemeRecord*>(file.Data() + header->schemesOffset)[record.schemeIndex];
+    const char* strings = reinterpret_cast<const char*>(file.Data() + header->stringsOffset);
+    SettingView view;
+    view.scheme = &scheme.guid;
+    view.subgroup = &record.subgroup;
+    view.setting = &record.setting;
+    view.name = std::string_view(strings + record.nameOffset, record.nameLength);
+    view.description = std::string_view(strings + record.descriptionOffset, record.descriptionLength);
+    view.schemeIndex = record.schemeIndex;
+    view.acOk = record.acType == static_cast<uint8_t>(PValueType::Dword);
+    view.dcOk = record.dcType == static_cast<uint8_t>(PValueType::Dword);
+    view.acValue = record.acValue;
+    view.dcValue = record.dcValue;
+    return view;
+}
+
+// CPU record as a view into the mapping
+PBinarySnapshotReader::CpuView PBinarySnapshotReader::Cpu(size_t index) const
+{
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(file.Data());
+    const CpuRecord& record = reinterpret_cast<const CpuRecord*>(file.Data() + header->cpusOffset)[index];
+    const uint64_t* siblings = reinterpret_cast<const uint64_t*>(file.Data() + header->siblingsOffset) + index * header->siblingWords;
+    return { record.online != 0, static_cast<PCoreType>(record.coreType), record.coreId, record.packageId, record.dieId,
+             record.numaNode, record.capacity, siblings };
+}
+
+// Binary search on scheme GUID, then on setting GUID within the scheme's range
+size_t PBinarySnapshotReader::Find(const GUID& scheme, const GUID& setting) const
+{
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(file.Data());
+    const SchemeRecord* schemes = reinterpret_cast<const SchemeRecord*>(file.Data() + header->schemesOffset);
+    const SchemeRecord* schemesEnd = schemes + header->schemeCount;
+    const SchemeRecord* s = std::lower_bound(schemes, schemesEnd, scheme, [](const SchemeRecord& record, const GUID& key) {
+        return CompareGuid(record.guid, key) < 0;
+    });
+    if (s == schemesEnd || s->guid != scheme)
+        return NotFound;
+    const SettingRecord* records = reinterpret_cast<const SettingRecord*>(file.Data() + header->settingsOffset);
+    const SettingRecord* begin = records + s->firstSetting;
+    const SettingRecord* end = begin + s->settingCount;
+    const SettingRecord* it = std::lower_bound(begin, end, setting, [](const SettingRecord& record, const GUID& key) {
+        return CompareGuid(record.setting, key) < 0;
+    });
+    if (it == end || it->setting != setting)
+        return NotFound;
+    return static_cast<size_t>(it - records);
+}
+
+// Expand into a PSystemSnapshot
+bool PBinarySnapshotReader::ToSystemSnapshot(PSystemSnapshot& out) const
+{
+    if (!IsOpen())
+        return false;
+    out = {};
+    out.activeScheme = ActiveScheme();
+    for (size_t i = 0; i < SchemeCount(); i++) {
+        SchemeView scheme = Scheme(i);
+        out.settings.AddScheme(*scheme.guid, Utf8ToWide(scheme.name));
+        for (size_t j = scheme.firstSetting; j < size_t(scheme.firstSetting) + scheme.settingCount; j++) {
+            SettingView record = Setting(j);
+            std::wstring name = Utf8ToWide(record.name);
+            std::wstring description = Utf8ToWide(record.description);
+            PSettingView view = {};
+            view.scheme = *record.scheme;
+            view.subgroup = *record.subgroup;
+            view.setting = *record.setting;
+            view.name = name;
+            view.description = description;
+            view.acValue = record.acValue;
+            view.dcValue = record.dcValue;
+            view.acOk = record.acOk;
+            view.dcOk = record.dcOk;
+            out.settings.AddSetting(view);
+        }
+    }
+
+    PCpuTopology& topology = out.topology;
+    topology.Reset(CpuCount());
+    for (size_t cpu = 0; cpu < CpuCount(); cpu++) {
+        CpuView view = Cpu(cpu);
+        if (view.online)
+            topology.online.Set(cpu);
+        topology.coreType[cpu] = view.coreType;
+        topology.coreId[cpu] = view.coreId;
+        topology.packageId[cpu] = view.packageId;
+        topology.dieId[cpu] = view.dieId;
+        topology.numaNode[cpu] = view.numaNode;
+        topology.capacity[cpu] = view.capacity;
+        for (size_t bit = 0; bit < CpuCount(); bit++) {
+            if ((view.siblings[bit / 64] >> (bit % 64)) & 1)
+                topology.smtSiblings[cpu].Set(bit);
+        }
+    }
+    topology.BuildMasks();
+    return true;
+}
@@ -0,0 +1,80 @@
+// PBinarySnapshot.h - Declares the versioned binary snapshot format and its zero-copy reader.
+//
+// File layout (little-endian, every block 8-byte aligned):
+//   - Header: magic "PISNAP", version, header size, counts, active scheme, block offsets.
+//   - Scheme records (32 bytes), sorted by GUID: guid, name, range of their setting records.
+//   - Setting records (64 bytes), sorted by (scheme, setting GUID): GUIDs, name/description, AC/DC values.
+//   - CPU records (32 bytes), one per logical CPU, followed by the SMT sibling masks (fixed words per CPU).
+//   - String table: UTF-8 bytes, each distinct string stored once; records hold (offset, length).
+//
+// PBinarySnapshotReader class:
+//   - Maps the file (PMappedFile) and validates every offset, the 8-byte alignment of every block and the
+//     record order Find() relies on once in Open(); accessors then return views into the mapping, so
+//     iterating records neither copies nor allocates.
+//   - Find() is a binary search on the (scheme, setting) key.
+//
+// Functions:
+//   - WriteBinarySnapshot: Serializes a PSystemSnapshot (unique temp file + rename).
+//   - IsBinarySnapshot: Checks the magic of a file.
+//
+#pragma once
+#include <filesystem>
+#include <string_view>
+#include "PMappedFile.h"
+#include "PSystemSnapshot.h"
+
+bool WriteBinarySnapshot(const PSystemSnapshot& snapshot, const std::filesystem::path& path);
+bool IsBinarySnapshot(const std::filesystem::path& path);
+
+class PBinarySnapshotReader
+{
+public:
+    static constexpr uint32_t FormatVersion = 1;
+    static constexpr size_t NotFound = SIZE_MAX;
+
+    struct SchemeView {
+        const GUID* guid;
+        std::string_view name;   // UTF-8
+        uint32_t firstSetting;
+        uint32_t settingCount;
+    };
+    struct SettingView {
+        const GUID* scheme;
+        const GUID* subgroup;
+        const GUID* setting;
+        std::string_view name;        // UTF-8
+        std::string_view description; // UTF-8
+        uint32_t schemeIndex;
+        uint32_t acValue, dcValue;
+        bool acOk, dcOk;
+    };
+    struct CpuView {
+        bool online;
+        PCoreType coreType;
+        int32_t coreId, packageId, dieId, numaNode;
+        uint32_t capacity;
+        const uint64_t* siblings; // SiblingWords() words
+    };
+
+    bool Open(const std::filesystem::path& path);
+    void Close() { file.Close(); }
+    bool IsOpen() const { return file.IsOpen(); }
+
+    const GUID& ActiveScheme() const;
+    size_t SchemeCount() const;
+    size_t SettingCount() const;
+    size_t CpuCount() const;
+    size_t SiblingWords() const;
+
+    SchemeView Scheme(size_t index) const;
+    SettingView Setting(size_t index) const;
+    CpuView Cpu(size_t index) const;
+    // Index of a setting record, or NotFound
+    size_t Find(const GUID& scheme, const GUID& setting) const;
+
+    // Expand into the in-memory form (allocates; for Diff and conversions)
+    bool ToSystemSnapshot(PSystemSnapshot& out) const;
+
+private:
+    PMappedFile file;
+};
@@ -0,0 +1,226 @@
+// PBytePattern.cpp - Implements pattern compilation, the SIMD prefilter and the streaming search.
+//
+#include "pch.h"
+#include "PBytePattern.h"
+#include "PSimd.h"
+#include <array>
+#include <bit>
+
+// How common a byte is in firmware images, executables and ACPI tables (higher is more common). The
+// prefilter anchors on uncommon bytes so that fewer candidates reach verification.
+static constexpr std::array<uint8_t, 256> MakeCommonness()
+{
+    std::array<uint8_t, 256> table{};
+    for (int c = '0'; c <= '9'; c++)
+        table[c] = 30;
+    for (int c = 'A'; c <= 'Z'; c++)
+        table[c] = 30;
+    for (int c = 'a'; c <= 'z'; c++)
+        table[c] = 40;
+    // x86 prefix, opcode and ModRM bytes that dominate code sections
+    for (uint8_t c : { 0x0F, 0x24, 0x41, 0x44, 0x45, 0x48, 0x49, 0x4C, 0x74, 0x75, 0x83, 0x85, 0x89, 0x8B, 0x8D, 0x90, 0xC3, 0xCC, 0xE8 })
+        table[c] = 80;
+    // Small integers, flags and padding
+    for (uint8_t c : { 0x01, 0x02, 0x03, 0x04, 0x08, 0x10, 0x20, 0x80, 0xFE })
+        table[c] = 120;
+    table[0xFF] = 200;
+    table[0x00] = 255;
+    return table;
+}
+static constexpr std::array<uint8_t, 256> CommonnessTable = MakeCommonness();
+
+// Commonness of a byte value
+int PBytePattern::Commonness(uint8_t value)
+{
+    return CommonnessTable[value];
+}
+
+// Compile a pattern
+bool PBytePattern::Parse(std::string_view text, PBytePattern& out)
+{
+    out = PBytePattern();
+    size_t nibbles = 0;
+    uint8_t value = 0, mask = 0;
+    for (char c : text) {
+        uint8_t nibble = 0, nibbleMask = 0xF;
+        if (c >= '0' && c <= '9')
+            nibble = static_cast<uint8_t>(c - '0');
+        else if (c >= 'a' && c <= 'f')
+            nibble = static_cast<uint8_t>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F')
+            nibble = static_cast<uint8_t>(c - 'A' + 10);
+        else if (c == '?')
+            nibbleMask = 0;
+        else if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+            continue;
+        else
+            return false;
+        value = static_cast<uint8_t>((value << 4) | nibble);
+        mask = static_cast<uint8_t>((mask << 4) | nibbleMask);
+        if (++nibbles % 2 == 0) {
+            out.values.push_back(value & mask);
+            out.masks.push_back(mask);
+        }
+    }
+    if (out.values.empty() || nibbles % 2 != 0)
+        return false;
+
+    out.exact = std::all_of(out.masks.begin(), out.masks.end(), [](uint8_t m) { return m == 0xFF; });
+
+    // Anchors: the most constrained bytes, the least common first
+    auto rank = [&](size_t i) { return std::popcount(out.masks[i]) * 256 - Commonness(out.values[i]); };
+    size_t first = 0;
+    for (size_t i = 1; i < out.Size(); i++) {
+        if (rank(i) > rank(first))
+            first = i;
+    }
+    size_t second = first;
+    for (size_t i = 0; i < out.Size(); i++) {
+        if (i != first && (second == first || rank(i) > rank(second)))
+            second = i;
+    }
+    const size_t anchors[2] = { first, second };
+    for (int a = 0; a < 2; a++) {
+        out.anchorOffset[a] = anchors[a];
+        out.anchorValue[a] = out.values[anchors[a]];
+        out.anchorMask[a] = out.masks[anchors[a]];
+    }
+    return true;
+}
+
+// Verify the whole pattern
+bool PBytePattern::Matches(const uint8_t* bytes) const
+{
+    if (exact)
+        return memcmp(bytes, values.data(), values.size()) == 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        if ((bytes[i] & masks[i]) != values[i])
+            return false;
+    }
+    return true;
+}
+
+// Prefilter a block at a time on both anchors, verify the candidates, finish the tail with scalar code
+template <typename Visitor>
+void PBytePattern::Search(std::span<const uint8_t> bytes, size_t start, Visitor&& visit) const
+{
+    const size_t size = Size();
+    if (size == 0 || bytes.size() < size)
+        return;
+    const uint8_t* data = bytes.data();
+    const size_t last = bytes.size() - size; // last possible match offset
+    const uint8_t* first = data + anchorOffset[0];
+    const uint8_t* second = data + anchorOffset[1];
+    size_t i = start;
+
+#if defined(PSIMD_AVX2)
+    constexpr size_t Width = 32;
+    const __m256i value0 = _mm256_set1_epi8(static_cast<char>(anchorValue[0])), mask0 = _mm256_set1_epi8(static_cast<char>(anchorMask[0]));
+    const __m256i value1 = _mm256_set1_epi8(static_cast<char>(anchorValue[1])), mask1 = _mm256_set1_epi8(static_cast<char>(anchorMask[1]));
+    for (; i + Width - 1 <= last; i += Width) {
+        __m256i a = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i)), mask0);
+        __m256i b = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(second + i)), mask1);
+        uint32_t hits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, value0), _mm256_cmpeq_epi8(b, value1))));
+        for (; hits; hits &= hits - 1) {
+            size_t candidate = i + std::countr_zero(hits);
+            if (Matches(data + candidate) && !visit(candidate))
+                return;
+        }
+    }
+#elif defined(PSIMD_SSE2)
+    constexpr size_t Width = 16;
+    const __m128i value0 = _mm_set1_epi8(static_cast<char>(anchorValue[0])), mask0 = _mm_set1_epi8(static_cast<char>(anchorMask[0]));
+    const __m128i value1 = _mm_set1_epi8(static_cast<char>(anchorValue[1])), mask1 = _mm_set1_epi8(static_cast<char>(anchorMask[1]));
+    for (; i + Width - 1 <= last; i += Width) {
+        __m128i a = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i)), mask0);
+        __m128i b = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(second + i)), mask1);
+        uint32_t hits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, value0), _mm_cmpeq_epi8(b, value1))));
+        for (; hits; hits &= hits - 1) {
+            size_t candidate = i + std::countr_zero(hits);
+            if (Matches(data + candidate) && !visit(candidate))
+                return;
+        }
+    }
+#elif defined(PSIMD_NEON)
+    constexpr size_t Width = 16;
+    const uint8x16_t value0 = vdupq_n_u8(anchorValue[0]), mask0 = vdupq_n_u8(anchorMask[0]);
+    const uint8x16_t value1 = vdupq_n_u8(anchorValue[1]), mask1 = vdupq_n_u8(anchorMask[1]);
+    for (; i + Width - 1 <= last; i += Width) {
+        uint8x16_t equal = vandq_u8(vceqq_u8(vandq_u8(vld1q_u8(first + i), mask0), value0),
+                                    vceqq_u8(vandq_u8(vld1q_u8(second + i), mask1), value1));
+        // Narrow to four bits per byte; bit 4k+3 is set when byte k matched
+        uint64_t hits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(equal), 4)), 0) & 0x8888888888888888ull;
+        for (; hits; hits &= hits - 1) {
+            size_t candidate = i + std::countr_zero(hits) / 4;
+            if (Matches(data + candidate) && !visit(candidate))
+                return;
+        }
+    }
+#endif
+
+    for (; i <= last; i++) {
+        if ((first[i] & anchorMask[0]) == anchorValue[0] && Matches(data + i) && !visit(i))
+            return;
+    }
+}
+
+// First match
+bool PBytePattern::Find(std::span<const uint8_t> bytes, size_t& offset, size_t start) const
+{
+    bool found = false;
+    Search(bytes, start, [&](size_t match) {
+        offset = match;
+        found = true;
+        return false;
+    });
+    return found;
+}
+
+// Every match
+void PBytePattern::FindAll(std::span<const uint8_t> bytes, std::vector<size_t>& offsets) const
+{
+    Search(bytes, 0, [&](size_t match) {
+        offsets.push_back(match);
+        return true;
+    });
+}
+
+// Search the next chunk
+void PBytePatternStream::Feed(std::span<const uint8_t> chunk, std::vector<uint64_t>& offsets)
+{
+    const size_t size = pattern.Size();
+    if (size == 0)
+        return;
+    if (!carry.empty()) {
+        // Matches that start in the carried tail: joined holds fewer than Size() bytes past the tail, so
+        // every match found in it starts in the tail
+        const uint64_t carryStart = consumed - carry.size();
+        joined.assign(carry.begin(), carry.end());
+        joined.insert(joined.end(), chunk.begin(), chunk.begin() + std::min(chunk.size(), size - 1));
+        found.clear();
+        pattern.FindAll(joined, found);
+        for (size_t offset : found)
+            offsets.push_back(carryStart + offset);
+    }
+    found.clear();
+    pattern.FindAll(chunk, found);
+    for (size_t offset : found)
+        offsets.push_back(consumed + offset);
+    consumed += chunk.size();
+
+    // Matches can still start in the last Size() - 1 bytes
+    size_t keep = std::min(size - 1, carry.size() + chunk.size());
+    if (chunk.size() >= keep) {
+        carry.assign(chunk.end() - keep, chunk.end());
+    } else {
+        carry.insert(carry.end(), chunk.begin(), chunk.end());
+        carry.erase(carry.begin(), carry.end() - keep);
+    }
+}
+
+// Start over
+void PBytePatternStream::Reset()
+{
+    carry.clear();
+    consumed = 0;
+}
@@ -0,0 +1,72 @@
+// PBytePattern.h - Declares PBytePattern, a masked byte pattern compiled once and searched many times.
+// It takes the place of StringUtil::BytePatternSearch (string_util.cpp, not built), which reparsed the
+// pattern on every call.
+//
+// PBytePattern class:
+//   - Parse() compiles text such as "48 8B 0D ?? ?? ?? ?? E8": two hex digits per byte, '?' is a
+//     wildcard nibble, whitespace is ignored. Each byte becomes a (value, mask) pair.
+//   - Search filters candidates with SIMD compares of two anchor bytes (the most constrained and least
+//     common ones) and only verifies the whole pattern where both anchors match.
+//   - Find returns the first match, FindAll every match (overlapping ones included).
+//
+// PBytePatternStream class:
+//   - Finds every match in data that arrives in chunks (file reads, pipes), including matches that span
+//     chunk boundaries, and reports absolute offsets. Only the last Size() - 1 bytes are kept between chunks.
+//
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+class PBytePattern
+{
+public:
+    // Compile a pattern; false if it is empty, has an odd number of nibbles or other characters
+    static bool Parse(std::string_view text, PBytePattern& out);
+
+    size_t Size() const { return values.size(); }
+    // Masked value and mask of byte i
+    uint8_t Value(size_t i) const { return values[i]; }
+    uint8_t Mask(size_t i) const { return masks[i]; }
+    // How common a byte value is in firmware and code (0-255, higher is more common)
+    static int Commonness(uint8_t value);
+    // True if the pattern matches at bytes (which holds at least Size() bytes)
+    bool Matches(const uint8_t* bytes) const;
+
+    // First match at or after start
+    bool Find(std::span<const uint8_t> bytes, size_t& offset, size_t start = 0) const;
+    // Every match, appended to offsets
+    void FindAll(std::span<const uint8_t> bytes, std::vector<size_t>& offsets) const;
+
+private:
+    // Visit candidate offsets in [start, bytes.size() - Size()] that match; stops when visit returns false
+    template <typename Visitor>
+    void Search(std::span<const uint8_t> bytes, size_t start, Visitor&& visit) const;
+
+    std::vector<uint8_t> values; // pattern bytes, already masked
+    std::vector<uint8_t> masks;  // 0xFF exact, 0xF0/0x0F nibble, 0x00 wildcard
+    bool exact = false;          // no wildcards: verify with memcmp
+    // Anchor bytes the prefilter compares (offset into the pattern, masked value, mask)
+    size_t anchorOffset[2] = {};
+    uint8_t anchorValue[2] = {};
+    uint8_t anchorMask[2] = {};
+};
+
+class PBytePatternStream
+{
+public:
+    explicit PBytePatternStream(const PBytePattern& pattern) : pattern(pattern) {}
+
+    // Search the next chunk; absolute offsets of matches are appended to offsets
+    void Feed(std::span<const uint8_t> chunk, std::vector<uint64_t>& offsets);
+    // Start over at offset 0
+    void Reset();
+
+private:
+    const PBytePattern& pattern;
+    std::vector<uint8_t> carry;   // tail of the data so far whose match starts are not decided yet
+    std::vector<uint8_t> joined;  // carry plus the head of the chunk, reused
+    std::vector<size_t> found;    // reused
+    uint64_t consumed = 0;        // bytes fed so far
+};
@@ -0,0 +1,221 @@
+// PBytePatternSet.cpp - Implements the anchor filter, the single-pass scan and patterns files.
+//
+#include "pch.h"
+#include "PBytePatternSet.h"
+#include "PSimd.h"
+#include "PFields.h"
+#include <bit>
+#include <fstream>
+
+// Add a compiled pattern
+uint32_t PBytePatternSet::Add(std::string name, const PBytePattern& pattern)
+{
+    names.push_back(std::move(name));
+    patterns.push_back(pattern);
+    compiled = false;
+    return static_cast<uint32_t>(patterns.size() - 1);
+}
+
+// Parse a patterns file
+bool PBytePatternSet::FromText(std::string_view text, PBytePatternSet& out, size_t& errorLine)
+{
+    out = {};
+    errorLine = 0;
+    size_t start = 0;
+    for (size_t lineNumber = 1; start < text.size(); lineNumber++) {
+        size_t end = text.find('\n', start);
+        if (end == std::string_view::npos)
+            end = text.size();
+        std::string_view line = text.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::vector<std::string_view> fields = SplitFields(line);
+        PBytePattern pattern;
+        if (fields.size() != 2 || fields[0].empty() || !PBytePattern::Parse(fields[1], pattern)) {
+            errorLine = lineNumber;
+            return false;
+        }
+        out.Add(UnescapeField(fields[0]), pattern);
+    }
+    out.Compile();
+    return true;
+}
+
+// Read a patterns file
+bool PBytePatternSet::Load(const std::filesystem::path& path, PBytePatternSet& out, size_t& errorLine)
+{
+    errorLine = 0;
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return FromText(text, out, errorLine);
+}
+
+// Number of byte values that pass a mask
+static uint32_t Expansions(uint8_t mask)
+{
+    return 1u << (8 - std::popcount(mask));
+}
+
+// Choose each pattern's anchor pair, bucket every 16-bit value it can take and fill the nibble tables
+void PBytePatternSet::Compile() const
+{
+    if (compiled)
+        return;
+    struct Anchor {
+        uint32_t offset;
+        uint8_t value[2];
+        uint8_t mask[2];
+    };
+    std::vector<Anchor> anchors;
+    anchors.reserve(patterns.size());
+    for (const PBytePattern& pattern : patterns) {
+        // A one-byte pattern pairs with a wildcard; the scan reads a zero past the end of the input
+        auto maskAt = [&](size_t i) -> uint8_t { return i < pattern.Size() ? pattern.Mask(i) : 0; };
+        auto valueAt = [&](size_t i) -> uint8_t { return i < pattern.Size() ? pattern.Value(i) : 0; };
+        size_t best = 0;
+        uint64_t bestCost = UINT64_MAX;
+        for (size_t i = 0; i + 1 < std::max<size_t>(pattern.Size(), 2); i++) {
+            // Fewest filter entries first, then the least common bytes
+            uint64_t cost = (static_cast<uint64_t>(Expansions(maskAt(i)) * Expansions(maskAt(i + 1))) << 16) +
+                            PBytePattern::Commonness(valueAt(i)) + PBytePattern::Commonness(valueAt(i + 1));
+            if (cost < bestCost) {
+                bestCost = cost;
+                best = i;
+            }
+        }
+        anchors.push_back({ static_cast<uint32_t>(best), { valueAt(best), valueAt(best + 1) }, { maskAt(best), maskAt(best + 1) } });
+    }
+
+    std::vector<std::pair<uint16_t, Candidate>> keyed;
+    for (uint32_t id = 0; id < patterns.size(); id++) {
+        const Anchor& anchor = anchors[id];
+        for (uint32_t high = 0; high < 256; high++) {
+            if ((high & anchor.mask[1]) != anchor.value[1])
+                continue;
+            for (uint32_t low = 0; low < 256; low++) {
+                if ((low & anchor.mask[0]) == anchor.value[0])
+                    keyed.push_back({ static_cast<uint16_t>(low | (high << 8)), { id, anchor.offset } });
+            }
+        }
+    }
+    std::stable_sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    filter.fill(0);
+    bucketStart.assign(65537, 0);
+    candidates.clear();
+    candidates.reserve(keyed.size());
+    for (const auto& [key, candidate] : keyed) {
+        filter[key >> 6] |= 1ull << (key & 63);
+        bucketStart[key + 1]++;
+        candidates.push_back(candidate);
+    }
+    for (size_t key = 0; key < 65536; key++)
+        bucketStart[key + 1] += bucketStart[key];
+
+    // Nibble tables: patterns with similar anchors share one of eight buckets, so each bucket's nibble
+    // sets stay narrow
+    std::vector<uint32_t> order(patterns.size());
+    for (uint32_t id = 0; id < order.size(); id++)
+        order[id] = id;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return std::make_pair(anchors[a].value[0], anchors[a].value[1]) < std::make_pair(anchors[b].value[0], anchors[b].value[1]);
+    });
+    for (auto& table : nibbles)
+        table.fill(0);
+    for (size_t rank = 0; rank < order.size(); rank++) {
+        const Anchor& anchor = anchors[order[rank]];
+        uint8_t bucket = static_cast<uint8_t>(1u << (rank * 8 / order.size()));
+        for (int position = 0; position < 2; position++) {
+            uint8_t value = anchor.value[position], mask = anchor.mask[position];
+            for (uint8_t n = 0; n < 16; n++) {
+                if ((n & mask & 0x0F) == (value & 0x0F))
+                    nibbles[2 * position][n] |= bucket;
+                if ((n & (mask >> 4)) == (value >> 4))
+                    nibbles[2 * position + 1][n] |= bucket;
+            }
+        }
+    }
+    compiled = true;
+}
+
+// Prefilter blocks with the nibble tables, test the windows that pass against the exact filter and verify
+// the patterns of their buckets
+void PBytePatternSet::Scan(std::span<const uint8_t> bytes, std::vector<PPatternHit>& hits) const
+{
+    Compile();
+    const uint8_t* data = bytes.data();
+    const size_t size = bytes.size();
+    const size_t first = hits.size();
+    if (size == 0 || candidates.empty())
+        return;
+    auto passes = [&](uint32_t key) { return (filter[key >> 6] >> (key & 63)) & 1; };
+    auto check = [&](size_t i, uint32_t key) {
+        if (!passes(key))
+            return;
+        for (uint32_t c = bucketStart[key]; c < bucketStart[key + 1]; c++) {
+            const Candidate& candidate = candidates[c];
+            const PBytePattern& pattern = patterns[candidate.pattern];
+            if (i < candidate.anchorOffset)
+                continue;
+            size_t offset = i - candidate.anchorOffset;
+            if (offset + pattern.Size() <= size && pattern.Matches(data + offset))
+                hits.push_back({ candidate.pattern, offset });
+        }
+    };
+    auto window = [&](size_t i) { return data[i] | (static_cast<uint32_t>(data[i + 1]) << 8); };
+    size_t i = 0;
+
+#if defined(PSIMD_AVX2)
+    // Look up the low and high nibble of both anchor bytes (vpshufb, per 128-bit lane); a window passes
+    // when all four lookups share a bucket bit
+    auto table = [&](int t) { return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(nibbles[t].data()))); };
+    const __m256i low0 = table(0), high0 = table(1), low1 = table(2), high1 = table(3);
+    const __m256i lowNibble = _mm256_set1_epi8(0x0F), zero = _mm256_setzero_si256();
+    for (; i + 33 <= size; i += 32) {
+        __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 1));
+        __m256i r0 = _mm256_and_si256(_mm256_shuffle_epi8(low0, _mm256_and_si256(x0, lowNibble)),
+                                      _mm256_shuffle_epi8(high0, _mm256_and_si256(_mm256_srli_epi16(x0, 4), lowNibble)));
+        __m256i r1 = _mm256_and_si256(_mm256_shuffle_epi8(low1, _mm256_and_si256(x1, lowNibble)),
+                                      _mm256_shuffle_epi8(high1, _mm256_and_si256(_mm256_srli_epi16(x1, 4), lowNibble)));
+        uint32_t passed = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(r0, r1), zero)));
+        for (; passed; passed &= passed - 1) {
+            size_t at = i + std::countr_zero(passed);
+            check(at, window(at));
+        }
+    }
+#elif defined(PSIMD_NEON)
+    // Same lookups with vqtbl1q
+    const uint8x16_t low0 = vld1q_u8(nibbles[0].data()), high0 = vld1q_u8(nibbles[1].data());
+    const uint8x16_t low1 = vld1q_u8(nibbles[2].data()), high1 = vld1q_u8(nibbles[3].data());
+    const uint8x16_t lowNibble = vdupq_n_u8(0x0F);
+    for (; i + 17 <= size; i += 16) {
+        uint8x16_t x0 = vld1q_u8(data + i), x1 = vld1q_u8(data + i + 1);
+        uint8x16_t r = vandq_u8(vandq_u8(vqtbl1q_u8(low0, vandq_u8(x0, lowNibble)), vqtbl1q_u8(high0, vshrq_n_u8(x0, 4))),
+                                vandq_u8(vqtbl1q_u8(low1, vandq_u8(x1, lowNibble)), vqtbl1q_u8(high1, vshrq_n_u8(x1, 4))));
+        // Four bits per byte; bit 4k+3 is set when window k passed
+        uint64_t passed = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(vtstq_u8(r, r)), 4)), 0) & 0x8888888888888888ull;
+        for (; passed; passed &= passed - 1) {
+            size_t at = i + std::countr_zero(passed) / 4;
+            check(at, window(at));
+        }
+    }
+#endif
+
+    // SSE2 has no byte shuffle: test every window against the exact filter directly
+    for (; i + 1 < size; i++)
+        check(i, window(i));
+    // Last byte: only one-byte patterns (anchored on a wildcard pair) can match here
+    check(size - 1, data[size - 1]);
+
+    // Hits come in anchor order; report them in offset order
+    std::sort(hits.begin() + first, hits.end(), [](const PPatternHit& a, const PPatternHit& b) {
+        return a.offset != b.offset ? a.offset < b.offset : a.pattern < b.pattern;
+    });
+}
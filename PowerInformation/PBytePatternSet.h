@@ -0,0 +1,61 @@
+// PBytePatternSet.h - Declares PBytePatternSet, many masked byte patterns searched in one pass.
+//
+// Types:
+//   - PPatternHit: pattern id (index in the set) and offset of one match.
+//
+// PBytePatternSet class:
+//   - Each pattern is anchored on two adjacent bytes, chosen to need the fewest expansions of wildcard
+//     nibbles and then to be uncommon. Every 16-bit value an anchor can take is set in a 64K-bit filter
+//     (8 KB, stays in L1), and listed in a bucket with the pattern and its anchor offset.
+//   - With AVX2 or NEON, a block of windows is prefiltered first: the patterns are split into eight buckets
+//     and four 16-entry tables map each nibble of the anchor pair to the buckets it can belong to
+//     (vpshufb/vqtbl, as in the Teddy matcher). Only windows where all four lookups share a bucket go on.
+//   - Scan tests each window (prefiltered, or every one on SSE2) against the filter and verifies only the
+//     patterns in its bucket, so the cost grows with the input size and the hit rate, not the pattern count.
+//   - Patterns file (UTF-8, one pattern per line): <name> <pattern>, tab-separated, '#' comments.
+//
+#pragma once
+#include "PBytePattern.h"
+#include <array>
+#include <filesystem>
+#include <string>
+
+struct PPatternHit {
+    uint32_t pattern;
+    size_t offset;
+};
+
+class PBytePatternSet
+{
+public:
+    // Add a compiled pattern; returns its id
+    uint32_t Add(std::string name, const PBytePattern& pattern);
+    // Parse a patterns file
+    static bool FromText(std::string_view text, PBytePatternSet& out, size_t& errorLine);
+    static bool Load(const std::filesystem::path& path, PBytePatternSet& out, size_t& errorLine);
+
+    size_t Size() const { return patterns.size(); }
+    const std::string& Name(uint32_t id) const { return names[id]; }
+    const PBytePattern& Pattern(uint32_t id) const { return patterns[id]; }
+
+    // Build the filter; Scan does it after a change, call it up front to share the set between threads
+    void Compile() const;
+    // Every hit in bytes, appended to hits in offset order (ties by pattern id)
+    void Scan(std::span<const uint8_t> bytes, std::vector<PPatternHit>& hits) const;
+
+private:
+    struct Candidate {
+        uint32_t pattern;
+        uint32_t anchorOffset; // offset of the anchor pair in the pattern
+    };
+
+    std::vector<std::string> names;
+    std::vector<PBytePattern> patterns;
+
+    // Built by Compile
+    mutable bool compiled = false;
+    mutable std::array<uint64_t, 1024> filter{};    // bit per 16-bit anchor value (first byte in the low bits)
+    mutable std::vector<uint32_t> bucketStart;      // anchor value -> first candidate; 65537 entries
+    mutable std::vector<Candidate> candidates;      // grouped by anchor value
+    mutable std::array<std::array<uint8_t, 16>, 4> nibbles{}; // bucket bits per nibble: low/high of anchor byte 0, then 1
+};
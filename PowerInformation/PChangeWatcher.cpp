@@ -0,0 +1,228 @@
+// PChangeWatcher.cpp - Implements change notification with inotify/poll (Linux) and power/registry notifications (Windows).
+//
+#include "pch.h"
+#include "PChangeWatcher.h"
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#endif
+
+// Destructor
+PChangeWatcher::~PChangeWatcher()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+// Power setting callback: runs on a system thread, only signals the waiting thread
+ULONG CALLBACK PChangeWatcher::OnPowerSetting(PVOID context, ULONG type, PVOID setting)
+{
+    auto watcher = static_cast<PChangeWatcher*>(context);
+    // Registration delivers the current value once; that is not a change
+    if (watcher->firstPowerCallback.exchange(false))
+        return ERROR_SUCCESS;
+    SetEvent(watcher->powerEvent);
+    return ERROR_SUCCESS;
+}
+
+// Start watching the active scheme and the power schemes registry subtree
+bool PChangeWatcher::Open(const std::vector<std::filesystem::path>&)
+{
+    Close();
+    powerEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    registryEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    wakeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!powerEvent || !registryEvent || !wakeEvent) {
+        Close();
+        return false;
+    }
+
+    powerParams = { OnPowerSetting, this };
+    firstPowerCallback = true;
+    PowerSettingRegisterNotification(&GUID_ACTIVE_POWERSCHEME, DEVICE_NOTIFY_CALLBACK, reinterpret_cast<HANDLE>(&powerParams), &powerNotify);
+
+    if (RegOpenKeyExW(HKEY_LOCAL_MACHINE, L"SYSTEM\\CurrentControlSet\\Control\\Power\\User\\PowerSchemes", 0,
+                      KEY_NOTIFY, &schemesKey) == ERROR_SUCCESS) {
+        RegNotifyChangeKeyValue(schemesKey, TRUE, REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET, registryEvent, TRUE);
+    }
+    if (!powerNotify && !schemesKey) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+// Stop watching
+void PChangeWatcher::Close()
+{
+    if (powerNotify)
+        PowerSettingUnregisterNotification(powerNotify);
+    if (schemesKey)
+        RegCloseKey(schemesKey);
+    for (HANDLE* handle : { &registryEvent, &powerEvent, &wakeEvent }) {
+        if (*handle)
+            CloseHandle(*handle);
+        *handle = nullptr;
+    }
+    powerNotify = nullptr;
+    schemesKey = nullptr;
+}
+
+bool PChangeWatcher::IsOpen() const
+{
+    return wakeEvent != nullptr;
+}
+
+// Wait for a notification, then let a burst of related writes settle
+bool PChangeWatcher::Wait(std::chrono::milliseconds timeout)
+{
+    if (!IsOpen())
+        return false;
+    HANDLE events[] = { wakeEvent, powerEvent, registryEvent };
+    DWORD milliseconds = timeout.count() >= INFINITE ? INFINITE : static_cast<DWORD>(timeout.count());
+    DWORD result = WaitForMultipleObjects(3, events, FALSE, milliseconds);
+    if (result == WAIT_TIMEOUT || result == WAIT_OBJECT_0 || result == WAIT_FAILED)
+        return false;
+    Sleep(static_cast<DWORD>(SettleTime.count()));
+    ResetEvent(powerEvent);
+    // Registry notifications are one-shot; re-arm after the settle so the burst is one wakeup
+    if (schemesKey) {
+        ResetEvent(registryEvent);
+        RegNotifyChangeKeyValue(schemesKey, TRUE, REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET, registryEvent, TRUE);
+    }
+    return true;
+}
+
+// Wake a blocked Wait
+void PChangeWatcher::Wake()
+{
+    if (wakeEvent)
+        SetEvent(wakeEvent);
+}
+
+#else
+
+// Start watching the attributes with inotify and POLLPRI
+bool PChangeWatcher::Open(const std::vector<std::filesystem::path>& attributes)
+{
+    Close();
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd < 0 || wakeFd < 0) {
+        Close();
+        return false;
+    }
+    size_t watched = 0;
+    for (const auto& path : attributes) {
+        if (inotify_add_watch(inotifyFd, path.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB) >= 0)
+            watched++;
+        // sysfs_notify wakes pollers with POLLPRI; regular files never report it, so this is free on fixtures
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            char buffer[256];
+            while (::pread(fd, buffer, sizeof(buffer), 0) < 0 && errno == EINTR) {}
+            attributeFds.push_back(fd);
+        }
+    }
+    if (watched == 0 && attributeFds.empty()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+// Stop watching
+void PChangeWatcher::Close()
+{
+    for (int fd : attributeFds)
+        ::close(fd);
+    attributeFds.clear();
+    if (inotifyFd >= 0)
+        ::close(inotifyFd);
+    if (wakeFd >= 0)
+        ::close(wakeFd);
+    inotifyFd = wakeFd = -1;
+}
+
+bool PChangeWatcher::IsOpen() const
+{
+    return inotifyFd >= 0;
+}
+
+// Consume pending events; true if any attribute changed
+bool PChangeWatcher::Drain()
+{
+    bool changed = false;
+    alignas(inotify_event) char buffer[4096];
+    while (::read(inotifyFd, buffer, sizeof(buffer)) > 0)
+        changed = true;
+
+    std::vector<pollfd> fds;
+    for (int fd : attributeFds)
+        fds.push_back({ fd, POLLPRI, 0 });
+    if (!fds.empty() && ::poll(fds.data(), fds.size(), 0) > 0) {
+        for (const auto& entry : fds) {
+            if (entry.revents & (POLLPRI | POLLERR)) {
+                // Reading the attribute re-arms sysfs_notify for this descriptor
+                char text[256];
+                while (::pread(entry.fd, text, sizeof(text), 0) < 0 && errno == EINTR) {}
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+// Wait for an event, then let a burst of related writes settle
+bool PChangeWatcher::Wait(std::chrono::milliseconds timeout)
+{
+    if (!IsOpen())
+        return false;
+    std::vector<pollfd> fds;
+    fds.push_back({ wakeFd, POLLIN, 0 });
+    fds.push_back({ inotifyFd, POLLIN, 0 });
+    for (int fd : attributeFds)
+        fds.push_back({ fd, POLLPRI, 0 });
+
+    bool forever = timeout == std::chrono::milliseconds::max();
+    auto deadline = forever ? std::chrono::steady_clock::time_point::max() : std::chrono::steady_clock::now() + timeout;
+    for (;;) {
+        int wait = -1;
+        if (!forever) {
+            // Round up: poll() would otherwise return just before the deadline
+            auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (remaining.count() < 0)
+                return false;
+            wait = static_cast<int>(std::min<int64_t>(remaining.count(), INT32_MAX));
+        }
+        int ready = ::poll(fds.data(), fds.size(), wait);
+        if (ready < 0 && errno == EINTR)
+            continue;
+        if (ready <= 0)
+            return false;
+        if (fds[0].revents & POLLIN) {
+            uint64_t count = 0;
+            while (::read(wakeFd, &count, sizeof(count)) < 0 && errno == EINTR) {}
+            return false;
+        }
+        std::this_thread::sleep_for(SettleTime);
+        if (Drain())
+            return true;
+    }
+}
+
+// Wake a blocked Wait
+void PChangeWatcher::Wake()
+{
+    if (wakeFd >= 0) {
+        uint64_t one = 1;
+        while (::write(wakeFd, &one, sizeof(one)) < 0 && errno == EINTR) {}
+    }
+}
+
+#endif
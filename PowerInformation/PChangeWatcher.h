@@ -0,0 +1,57 @@
+// PChangeWatcher.h - Declares PChangeWatcher, a blocking wait for power configuration changes.
+//
+// PChangeWatcher class:
+//   - Linux: inotify on each attribute (writes through the VFS, including fixture trees) plus poll(POLLPRI)
+//     on the attributes themselves (kernel-side sysfs_notify, e.g. platform_profile switched by firmware).
+//   - Windows: PowerSettingRegisterNotification for GUID_ACTIVE_POWERSCHEME plus RegNotifyChangeKeyValue on
+//     the power schemes registry subtree, which catches edits to inactive schemes as well.
+//   - Wait() sleeps in the kernel until an event, the timeout or Wake(); no polling, so idle cost is zero.
+//   - Events arriving within a short settle window are coalesced into one wakeup.
+//
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+class PChangeWatcher
+{
+public:
+    PChangeWatcher() = default;
+    ~PChangeWatcher();
+    PChangeWatcher(const PChangeWatcher&) = delete;
+    PChangeWatcher& operator=(const PChangeWatcher&) = delete;
+
+    // Start watching; on Linux `attributes` are the files to watch, on Windows they are ignored
+    bool Open(const std::vector<std::filesystem::path>& attributes);
+    void Close();
+    bool IsOpen() const;
+
+    // Block until something changed (true), the timeout passed or Wake() was called (false);
+    // milliseconds::max() waits without a timeout
+    bool Wait(std::chrono::milliseconds timeout);
+    // Wake a blocked Wait from another thread
+    void Wake();
+
+    // Window in which further events are folded into the current wakeup
+    static constexpr std::chrono::milliseconds SettleTime{ 20 };
+
+private:
+#ifdef _WIN32
+    static ULONG CALLBACK OnPowerSetting(PVOID context, ULONG type, PVOID setting);
+
+    DEVICE_NOTIFY_SUBSCRIBE_PARAMETERS powerParams = {};
+    HPOWERNOTIFY powerNotify = nullptr;
+    HKEY schemesKey = nullptr;
+    HANDLE registryEvent = nullptr;
+    HANDLE powerEvent = nullptr;
+    HANDLE wakeEvent = nullptr;
+    std::atomic<bool> firstPowerCallback{ true };
+#else
+    bool Drain();
+
+    int inotifyFd = -1;
+    int wakeFd = -1;
+    std::vector<int> attributeFds;
+#endif
+};
@@ -0,0 +1,184 @@
+// PCompactSnapshot.cpp - Implements the interned string table and the structure-of-arrays snapshot.
+//
+#include "pch.h"
+#include "PCompactSnapshot.h"
+
+// FNV-1a over the UTF-16/32 code units
+size_t PStringTable::Hash(std::wstring_view str)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (wchar_t ch : str) {
+        hash ^= static_cast<uint32_t>(ch);
+        hash *= 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+}
+
+// Returns the id of str, adding it if it is not interned yet
+uint32_t PStringTable::Intern(std::wstring_view str)
+{
+    uint32_t existing = Find(str);
+    if (existing != InvalidId)
+        return existing;
+
+    // Keep the load factor at or below 1/2
+    if ((Count() + 1) * 2 > slots.size())
+        Grow();
+
+    uint32_t id = static_cast<uint32_t>(Count());
+    chars.append(str);
+    offsets.push_back(static_cast<uint32_t>(chars.size()));
+
+    size_t mask = slots.size() - 1;
+    for (size_t slot = Hash(str) & mask;; slot = (slot + 1) & mask) {
+        if (slots[slot] == InvalidId) {
+            slots[slot] = id;
+            break;
+        }
+    }
+    return id;
+}
+
+// Returns the id of str, or InvalidId if it was never interned
+uint32_t PStringTable::Find(std::wstring_view str) const
+{
+    if (slots.empty())
+        return InvalidId;
+    size_t mask = slots.size() - 1;
+    for (size_t slot = Hash(str) & mask;; slot = (slot + 1) & mask) {
+        uint32_t id = slots[slot];
+        if (id == InvalidId)
+            return InvalidId;
+        if (Get(id) == str)
+            return id;
+    }
+}
+
+// String for an id
+std::wstring_view PStringTable::Get(uint32_t id) const
+{
+    if (id >= Count())
+        return {};
+    return std::wstring_view(chars).substr(offsets[id], offsets[id + 1] - offsets[id]);
+}
+
+// Bytes held by the table
+size_t PStringTable::MemoryUsage() const
+{
+    return chars.capacity() * sizeof(wchar_t) + offsets.capacity() * sizeof(uint32_t) + slots.capacity() * sizeof(uint32_t);
+}
+
+// Double the hash table and reinsert every id
+void PStringTable::Grow()
+{
+    size_t size = slots.empty() ? 64 : slots.size() * 2;
+    slots.assign(size, InvalidId);
+    size_t mask = size - 1;
+    for (uint32_t id = 0; id < Count(); id++) {
+        for (size_t slot = Hash(Get(id)) & mask;; slot = (slot + 1) & mask) {
+            if (slots[slot] == InvalidId) {
+                slots[slot] = id;
+                break;
+            }
+        }
+    }
+}
+
+// Capture every scheme and setting reachable through info
+PCompactSnapshot PCompactSnapshot::Capture(PInformation& info)
+{
+    class Collector : public PSettingVisitor
+    {
+    public:
+        explicit Collector(PCompactSnapshot& snapshot) : snapshot(snapshot) {}
+        bool OnScheme(const GUID& scheme, std::wstring_view profileName) override {
+            snapshot.AddScheme(scheme, profileName);
+            return true;
+        }
+        bool OnSetting(const PSettingView& setting) override {
+            snapshot.AddSetting(setting);
+            return true;
+        }
+    private:
+        PCompactSnapshot& snapshot;
+    };
+
+    PCompactSnapshot snapshot;
+    Collector collector(snapshot);
+    info.VisitSettings(collector);
+    return snapshot;
+}
+
+// Append a scheme
+uint32_t PCompactSnapshot::AddScheme(const GUID& guid, std::wstring_view name)
+{
+    schemeGuids.push_back(guid);
+    schemeNameIds.push_back(strings.Intern(name));
+    return static_cast<uint32_t>(schemeGuids.size() - 1);
+}
+
+// Append a setting to the scheme added last
+void PCompactSnapshot::AddSetting(const PSettingView& view)
+{
+    settingSchemes.push_back(static_cast<uint32_t>(schemeGuids.size() - 1));
+    subgroupGuids.push_back(view.subgroup);
+    settingGuids.push_back(view.setting);
+    nameIds.push_back(strings.Intern(view.name));
+    descriptionIds.push_back(strings.Intern(view.description));
+    acValues.push_back(view.acOk ? view.acValue : 0);
+    dcValues.push_back(view.dcOk ? view.dcValue : 0);
+    acTypes.push_back(view.acOk ? PValueType::Dword : PValueType::Error);
+    dcTypes.push_back(view.dcOk ? PValueType::Dword : PValueType::Error);
+}
+
+// Replace the AC or DC value of a setting record
+void PCompactSnapshot::SetValue(size_t setting, bool ac, PValueType type, DWORD value)
+{
+    (ac ? acValues : dcValues)[setting] = type == PValueType::Dword ? value : 0;
+    (ac ? acTypes : dcTypes)[setting] = type;
+}
+
+// Bytes held by the snapshot
+size_t PCompactSnapshot::MemoryUsage() const
+{
+    auto bytes = [](const auto& column) { return column.capacity() * sizeof(column[0]); };
+    return sizeof(*this) + strings.MemoryUsage() + bytes(schemeGuids) + bytes(schemeNameIds) + bytes(settingSchemes) +
+           bytes(subgroupGuids) + bytes(settingGuids) + bytes(nameIds) + bytes(descriptionIds) + bytes(acValues) +
+           bytes(dcValues) + bytes(acTypes) + bytes(dcTypes);
+}
+
+// Bytes the same data takes as a map of SettingInfo (heap blocks plus the objects themselves, ignoring allocator overhead)
+size_t PCompactSnapshot::MemoryUsage(const std::map<std::wstring, std::vector<SettingInfo>>& profiles)
+{
+    // Strings that fit the small-string buffer live inside the object; larger ones own a heap block
+    auto heap = [](const std::wstring& str) {
+        return str.capacity() > std::wstring().capacity() ? (str.capacity() + 1) * sizeof(wchar_t) : 0;
+    };
+    constexpr size_t mapNodeOverhead = 4 * sizeof(void*); // parent/left/right/color
+    size_t total = sizeof(profiles);
+    for (const auto& profile : profiles) {
+        total += mapNodeOverhead + sizeof(profile) + heap(profile.first);
+        total += profile.second.capacity() * sizeof(SettingInfo);
+        for (const auto& setting : profile.second)
+            total += heap(setting.name) + heap(setting.description) + heap(setting.acValue) + heap(setting.dcValue);
+    }
+    return total;
+}
+
+// Expand into the PowerEnumerateProfiles layout
+std::map<std::wstring, std::vector<SettingInfo>> PCompactSnapshot::ToProfileMap() const
+{
+    std::map<std::wstring, std::vector<SettingInfo>> profiles;
+    std::vector<std::vector<SettingInfo>> perScheme(SchemeCount());
+    for (size_t i = 0; i < SettingCount(); i++) {
+        SettingInfo info;
+        info.name = strings.Get(nameIds[i]);
+        info.description = strings.Get(descriptionIds[i]);
+        info.acValue = acTypes[i] == PValueType::Dword ? std::to_wstring(acValues[i]) : L"<error>";
+        info.dcValue = dcTypes[i] == PValueType::Dword ? std::to_wstring(dcValues[i]) : L"<error>";
+        perScheme[settingSchemes[i]].push_back(std::move(info));
+    }
+    for (size_t i = 0; i < SchemeCount(); i++)
+        profiles[std::wstring(strings.Get(schemeNameIds[i]))] = std::move(perScheme[i]);
+    return profiles;
+}
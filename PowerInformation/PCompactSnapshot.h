@@ -0,0 +1,107 @@
+// PCompactSnapshot.h - Declares a compact, interned, structure-of-arrays snapshot of all power settings.
+//
+// Types:
+//   - PStringTable: Interns wide strings into one buffer and hands out 32-bit ids.
+//   - PValueType: Whether a stored AC/DC value is a DWORD or a failed read.
+//
+// PCompactSnapshot class:
+//   - Captures every scheme and setting through PInformation::VisitSettings.
+//   - Names/descriptions are stored once in the string table, no matter how many schemes repeat them.
+//   - Values are stored as raw uint32_t plus a PValueType, not as text.
+//   - Setting records are laid out as parallel columns (structure-of-arrays).
+//
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "PInformation.h"
+
+// Interned wide strings addressed by 32-bit id
+class PStringTable
+{
+public:
+    static constexpr uint32_t InvalidId = UINT32_MAX;
+
+    // Returns the id of str, adding it if it is not interned yet
+    uint32_t Intern(std::wstring_view str);
+    // Returns the id of str, or InvalidId if it was never interned
+    uint32_t Find(std::wstring_view str) const;
+    // String for an id; valid until the next Intern()
+    std::wstring_view Get(uint32_t id) const;
+    // Number of distinct strings
+    size_t Count() const { return offsets.size() - 1; }
+    // Bytes held by the table
+    size_t MemoryUsage() const;
+
+private:
+    static size_t Hash(std::wstring_view str);
+    void Grow();
+
+    std::wstring chars;                       // all strings back to back
+    std::vector<uint32_t> offsets{ 0 };       // id -> start in chars; id + 1 -> end
+    std::vector<uint32_t> slots;              // open-addressing hash table of ids
+};
+
+// Type of a stored AC/DC value
+enum class PValueType : uint8_t {
+    Dword = 0,
+    Error = 1,
+};
+
+class PCompactSnapshot
+{
+public:
+    // Capture every scheme and setting reachable through info
+    static PCompactSnapshot Capture(PInformation& info);
+
+    // Append records; AddSetting belongs to the scheme added last
+    uint32_t AddScheme(const GUID& guid, std::wstring_view name);
+    void AddSetting(const PSettingView& view);
+    // Replace the AC or DC value of a setting record
+    void SetValue(size_t setting, bool ac, PValueType type, DWORD value);
+
+    const PStringTable& Strings() const { return strings; }
+
+    // Scheme columns
+    size_t SchemeCount() const { return schemeGuids.size(); }
+    const std::vector<GUID>& SchemeGuids() const { return schemeGuids; }
+    const std::vector<uint32_t>& SchemeNameIds() const { return schemeNameIds; }
+
+    // Setting columns, one entry per (scheme, setting)
+    size_t SettingCount() const { return settingGuids.size(); }
+    const std::vector<uint32_t>& SettingSchemes() const { return settingSchemes; }
+    const std::vector<GUID>& SubgroupGuids() const { return subgroupGuids; }
+    const std::vector<GUID>& SettingGuids() const { return settingGuids; }
+    const std::vector<uint32_t>& NameIds() const { return nameIds; }
+    const std::vector<uint32_t>& DescriptionIds() const { return descriptionIds; }
+    const std::vector<uint32_t>& AcValues() const { return acValues; }
+    const std::vector<uint32_t>& DcValues() const { return dcValues; }
+    const std::vector<PValueType>& AcTypes() const { return acTypes; }
+    const std::vector<PValueType>& DcTypes() const { return dcTypes; }
+
+    // Bytes held by the snapshot (string table plus columns)
+    size_t MemoryUsage() const;
+    // Bytes the same data takes as PowerEnumerateProfiles' map of SettingInfo (for comparison)
+    static size_t MemoryUsage(const std::map<std::wstring, std::vector<SettingInfo>>& profiles);
+
+    // Expand into the PowerEnumerateProfiles layout
+    std::map<std::wstring, std::vector<SettingInfo>> ToProfileMap() const;
+
+private:
+    PStringTable strings;
+
+    std::vector<GUID> schemeGuids;
+    std::vector<uint32_t> schemeNameIds;
+
+    std::vector<uint32_t> settingSchemes;
+    std::vector<GUID> subgroupGuids;
+    std::vector<GUID> settingGuids;
+    std::vector<uint32_t> nameIds;
+    std::vector<uint32_t> descriptionIds;
+    std::vector<uint32_t> acValues;
+    std::vector<uint32_t> dcValues;
+    std::vector<PValueType> acTypes;
+    std::vector<PValueType> dcTypes;
+};
@@ -0,0 +1,430 @@
+// PCpuTopology.cpp - Implements CPU masks and topology discovery for Linux sysfs and Windows.
+//
+#include "pch.h"
+#include "PCpuTopology.h"
+#include "PProcText.h"
+#include <bit>
+#include <charconv>
+
+// Resize to cpuCount bits, dropping bits past the end
+void PCpuMask::Resize(size_t cpuCount)
+{
+    bits = cpuCount;
+    words.resize((cpuCount + 63) / 64);
+    if (bits % 64)
+        words.back() &= (uint64_t(1) << (bits % 64)) - 1;
+}
+
+// Set a CPU, growing the mask as needed
+void PCpuMask::Set(size_t cpu)
+{
+    if (cpu >= bits)
+        Resize(cpu + 1);
+    words[cpu / 64] |= uint64_t(1) << (cpu % 64);
+}
+
+// Set CPUs first..last (inclusive) a word at a time
+void PCpuMask::SetRange(size_t first, size_t last)
+{
+    if (last >= bits)
+        Resize(last + 1);
+    auto span = [](size_t from, size_t to) { // bits from..to of one word
+        return (to - from == 63 ? ~uint64_t(0) : ((uint64_t(1) << (to - from + 1)) - 1)) << from;
+    };
+    size_t firstWord = first / 64, lastWord = last / 64;
+    if (firstWord == lastWord) {
+        words[firstWord] |= span(first % 64, last % 64);
+        return;
+    }
+    words[firstWord] |= span(first % 64, 63);
+    std::fill(words.begin() + firstWord + 1, words.begin() + lastWord, ~uint64_t(0));
+    words[lastWord] |= span(0, last % 64);
+}
+
+// Clear a CPU
+void PCpuMask::Reset(size_t cpu)
+{
+    if (cpu < bits)
+        words[cpu / 64] &= ~(uint64_t(1) << (cpu % 64));
+}
+
+// Clear every CPU, keeping the size
+void PCpuMask::Clear()
+{
+    std::fill(words.begin(), words.end(), 0);
+}
+
+// Number of set CPUs
+size_t PCpuMask::Count() const
+{
+    size_t count = 0;
+    for (uint64_t word : words)
+        count += std::popcount(word);
+    return count;
+}
+
+// Lowest set CPU, or Size() if none
+size_t PCpuMask::First() const
+{
+    for (size_t i = 0; i < words.size(); i++) {
+        if (words[i])
+            return i * 64 + std::countr_zero(words[i]);
+    }
+    return bits;
+}
+
+// Union
+PCpuMask& PCpuMask::operator|=(const PCpuMask& other)
+{
+    if (other.bits > bits)
+        Resize(other.bits);
+    for (size_t i = 0; i < other.words.size(); i++)
+        words[i] |= other.words[i];
+    return *this;
+}
+
+// Intersection
+PCpuMask& PCpuMask::operator&=(const PCpuMask& other)
+{
+    for (size_t i = 0; i < words.size(); i++)
+        words[i] &= i < other.words.size() ? other.words[i] : 0;
+    return *this;
+}
+
+// Difference
+PCpuMask& PCpuMask::AndNot(const PCpuMask& other)
+{
+    for (size_t i = 0; i < words.size() && i < other.words.size(); i++)
+        words[i] &= ~other.words[i];
+    return *this;
+}
+
+// Equality of set bits, regardless of size
+bool PCpuMask::operator==(const PCpuMask& other) const
+{
+    size_t n = std::max(words.size(), other.words.size());
+    for (size_t i = 0; i < n; i++) {
+        uint64_t a = i < words.size() ? words[i] : 0;
+        uint64_t b = i < other.words.size() ? other.words[i] : 0;
+        if (a != b)
+            return false;
+    }
+    return true;
+}
+
+// Parse a kernel CPU list such as "0-7,16-23": ranges are split with PTokenRange and set a word at a time
+bool PCpuMask::ParseList(std::string_view text, PCpuMask& mask)
+{
+    auto number = [](std::string_view token, size_t& value) {
+        auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+        return ec == std::errc() && end == token.data() + token.size();
+    };
+    // Trailing newline and spaces around the commas are allowed; empty items are not
+    text = text.substr(0, text.find_last_not_of(" \t\n") + 1);
+    for (std::string_view item : PTokenRange(text, ",", true)) {
+        item = item.substr(std::min(item.size(), item.find_first_not_of(" \t\n")));
+        item = item.substr(0, item.find_last_not_of(" \t\n") + 1);
+        size_t dash = item.find('-');
+        size_t first = 0, last = 0;
+        if (!number(item.substr(0, dash), first))
+            return false;
+        last = first;
+        if (dash != std::string_view::npos && (!number(item.substr(dash + 1), last) || last < first))
+            return false;
+        mask.SetRange(first, last);
+    }
+    return true;
+}
+
+// Format as a kernel CPU list
+std::string PCpuMask::ToList() const
+{
+    std::string out;
+    for (size_t cpu = 0; cpu < bits;) {
+        if (!Test(cpu)) {
+            cpu++;
+            continue;
+        }
+        size_t last = cpu;
+        while (last + 1 < bits && Test(last + 1))
+            last++;
+        if (!out.empty())
+            out += ',';
+        out += std::to_string(cpu);
+        if (last != cpu)
+            out += '-' + std::to_string(last);
+        cpu = last + 1;
+    }
+    return out;
+}
+
+// Number of physical cores of a type
+size_t PCpuTopology::CoreCount(PCoreType type) const
+{
+    size_t count = 0;
+    for (size_t cpu = 0; cpu < cpuCount; cpu++) {
+        if (firstThreadPerCore.Test(cpu) && coreType[cpu] == type)
+            count++;
+    }
+    return count;
+}
+
+// Size the per-CPU arrays and reset them to "unknown"
+void PCpuTopology::Reset(size_t count)
+{
+    cpuCount = count;
+    coreType.assign(count, PCoreType::Unknown);
+    coreId.assign(count, -1);
+    packageId.assign(count, -1);
+    dieId.assign(count, -1);
+    numaNode.assign(count, -1);
+    capacity.assign(count, 0);
+    smtSiblings.assign(count, PCpuMask(count));
+    online = PCpuMask(count);
+    performance = PCpuMask(count);
+    efficiency = PCpuMask(count);
+    firstThreadPerCore = PCpuMask(count);
+    numaNodes.clear();
+}
+
+// Derive the precomputed masks from the per-CPU arrays
+void PCpuTopology::BuildMasks()
+{
+    for (size_t cpu = 0; cpu < cpuCount; cpu++) {
+        if (!online.Test(cpu))
+            continue;
+        if (coreType[cpu] == PCoreType::Performance)
+            performance.Set(cpu);
+        else if (coreType[cpu] == PCoreType::Efficiency)
+            efficiency.Set(cpu);
+        if (smtSiblings[cpu].Empty())
+            smtSiblings[cpu].Set(cpu);
+        if (smtSiblings[cpu].First() == cpu)
+            firstThreadPerCore.Set(cpu);
+        if (numaNode[cpu] >= 0) {
+            if (static_cast<size_t>(numaNode[cpu]) >= numaNodes.size())
+                numaNodes.resize(numaNode[cpu] + 1, PCpuMask(cpuCount));
+            numaNodes[numaNode[cpu]].Set(cpu);
+        }
+    }
+}
+
+// Highest NUMA node count the kernel supports (MAX_NUMNODES with NODES_SHIFT=10)
+static constexpr int32_t MaxNumaNodes = 1024;
+
+// Read a small sysfs file as a signed integer; file's buffer is reused across reads
+static bool ReadSysfsInt(PProcFile& file, const std::filesystem::path& path, int64_t& value)
+{
+    if (!file.Read(path))
+        return false;
+    std::string_view text = file.Text();
+    bool negative = !text.empty() && text[0] == '-';
+    uint64_t magnitude = 0;
+    if (!ParseUInt(text.substr(negative ? 1 : 0), magnitude))
+        return false;
+    value = negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+// Read a sysfs CPU list file into a mask
+static bool ReadSysfsCpuList(PProcFile& file, const std::filesystem::path& path, PCpuMask& mask)
+{
+    return file.Read(path) && PCpuMask::ParseList(file.Text(), mask);
+}
+
+// Fill core and package ids that sysfs did not provide from /proc/cpuinfo, and group hardware threads
+// with the same (package, core) into SMT siblings where no sibling list was found
+static void FillFromCpuInfo(PProcFile& file, const std::filesystem::path& path, PCpuTopology& out)
+{
+    std::vector<PCpuInfoEntry> entries;
+    if (!file.Read(path) || !ParseCpuInfo(file.Text(), entries))
+        return;
+    for (const PCpuInfoEntry& entry : entries) {
+        if (entry.processor >= out.cpuCount)
+            continue;
+        if (out.coreId[entry.processor] < 0) out.coreId[entry.processor] = entry.coreId;
+        if (out.packageId[entry.processor] < 0) out.packageId[entry.processor] = entry.physicalId;
+    }
+    for (const PCpuInfoEntry& entry : entries) {
+        if (entry.processor >= out.cpuCount || entry.coreId < 0 || !out.smtSiblings[entry.processor].Empty())
+            continue;
+        for (const PCpuInfoEntry& other : entries) {
+            if (other.processor < out.cpuCount && other.coreId == entry.coreId && other.physicalId == entry.physicalId)
+                out.smtSiblings[entry.processor].Set(other.processor);
+        }
+    }
+}
+
+// Load from sysfs under root
+bool PCpuTopology::LoadFromSysfs(const std::filesystem::path& root, PCpuTopology& out)
+{
+    const std::filesystem::path cpuDir = root / "sys/devices/system/cpu";
+    PProcFile file;
+    PCpuMask present;
+    if (!ReadSysfsCpuList(file, cpuDir / "present", present) && !ReadSysfsCpuList(file, cpuDir / "possible", present))
+        return false;
+    size_t count = 0;
+    for (size_t cpu = 0; cpu < present.Size(); cpu++)
+        if (present.Test(cpu)) count = cpu + 1;
+    if (count == 0)
+        return false;
+
+    out.Reset(count);
+    if (!ReadSysfsCpuList(file, cpuDir / "online", out.online))
+        out.online = present;
+    out.online.Resize(count);
+
+    // Intel hybrid PMUs list their CPUs directly
+    PCpuMask coreCpus, atomCpus;
+    bool haveHybridPmu = ReadSysfsCpuList(file, root / "sys/devices/cpu_core/cpus", coreCpus) &&
+                         ReadSysfsCpuList(file, root / "sys/devices/cpu_atom/cpus", atomCpus);
+
+    uint32_t maxCapacity = 0;
+    for (size_t cpu = 0; cpu < count; cpu++) {
+        if (!present.Test(cpu))
+            continue;
+        const std::filesystem::path dir = cpuDir / ("cpu" + std::to_string(cpu));
+        const std::filesystem::path topology = dir / "topology";
+        int64_t value = 0;
+        if (ReadSysfsInt(file, topology / "core_id", value)) out.coreId[cpu] = static_cast<int32_t>(value);
+        if (ReadSysfsInt(file, topology / "physical_package_id", value)) out.packageId[cpu] = static_cast<int32_t>(value);
+        if (ReadSysfsInt(file, topology / "die_id", value)) out.dieId[cpu] = static_cast<int32_t>(value);
+        if (ReadSysfsInt(file, dir / "cpu_capacity", value) && value > 0) {
+            out.capacity[cpu] = static_cast<uint32_t>(value);
+            maxCapacity = std::max(maxCapacity, out.capacity[cpu]);
+        }
+        PCpuMask siblings(count);
+        if (ReadSysfsCpuList(file, topology / "core_cpus_list", siblings) || ReadSysfsCpuList(file, topology / "thread_siblings_list", siblings)) {
+            siblings.Resize(count);
+            out.smtSiblings[cpu] = siblings;
+        }
+        if (haveHybridPmu)
+            out.coreType[cpu] = coreCpus.Test(cpu) ? PCoreType::Performance : atomCpus.Test(cpu) ? PCoreType::Efficiency : PCoreType::Unknown;
+    }
+
+    // Containers and some VMs hide cpuN/topology; /proc/cpuinfo still lists core and package ids
+    bool missingIds = false;
+    for (size_t cpu = 0; cpu < count; cpu++)
+        missingIds |= present.Test(cpu) && (out.coreId[cpu] < 0 || out.packageId[cpu] < 0);
+    if (missingIds)
+        FillFromCpuInfo(file, root / "proc/cpuinfo", out);
+
+    // Without hybrid PMUs, asymmetric capacities (e.g. big.LITTLE) still tell the core types apart
+    bool asymmetric = false;
+    for (size_t cpu = 0; cpu < count; cpu++)
+        asymmetric |= out.capacity[cpu] != 0 && out.capacity[cpu] != maxCapacity;
+    if (!haveHybridPmu && asymmetric) {
+        for (size_t cpu = 0; cpu < count; cpu++) {
+            if (out.capacity[cpu] != 0)
+                out.coreType[cpu] = out.capacity[cpu] == maxCapacity ? PCoreType::Performance : PCoreType::Efficiency;
+        }
+    }
+    // Normalize capacity so the largest core is 1024
+    if (maxCapacity != 0 && maxCapacity != 1024) {
+        for (auto& c : out.capacity)
+            c = static_cast<uint32_t>(uint64_t(c) * 1024 / maxCapacity);
+    }
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(root / "sys/devices/system/node", ec)) {
+        // "node" and a decimal id; ids that overflow or exceed the kernel's node limit are skipped
+        std::string name = entry.path().filename().string();
+        if (name.size() <= 4 || name.compare(0, 4, "node") != 0)
+            continue;
+        int32_t node = -1;
+        auto [end, error] = std::from_chars(name.data() + 4, name.data() + name.size(), node);
+        if (error != std::errc() || end != name.data() + name.size() || node < 0 || node >= MaxNumaNodes)
+            continue;
+        PCpuMask cpus;
+        if (!ReadSysfsCpuList(file, entry.path() / "cpulist", cpus))
+            continue;
+        for (size_t cpu = 0; cpu < count; cpu++)
+            if (cpus.Test(cpu)) out.numaNode[cpu] = node;
+    }
+
+    out.BuildMasks();
+    return true;
+}
+
+#ifdef _WIN32
+// Load from GetLogicalProcessorInformationEx
+bool PCpuTopology::LoadFromWindows(PCpuTopology& out)
+{
+    DWORD len = 0;
+    GetLogicalProcessorInformationEx(RelationAll, nullptr, &len);
+    std::vector<BYTE> buffer(len);
+    if (!GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &len))
+        return false;
+
+    // Logical CPU number = group * 64 + bit
+    auto forEachCpu = [](const GROUP_AFFINITY& affinity, auto&& fn) {
+        for (KAFFINITY bits = affinity.Mask; bits; bits &= bits - 1)
+            fn(static_cast<size_t>(affinity.Group) * 64 + std::countr_zero(static_cast<uint64_t>(bits)));
+    };
+    auto forEachRecord = [&](auto&& fn) {
+        for (BYTE* ptr = buffer.data(); ptr < buffer.data() + len;) {
+            auto info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(ptr);
+            fn(*info);
+            ptr += info->Size;
+        }
+    };
+
+    // First pass: CPU count and the range of efficiency classes
+    size_t count = 0;
+    BYTE minClass = 0xff, maxClass = 0;
+    forEachRecord([&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& info) {
+        if (info.Relationship != RelationProcessorCore)
+            return;
+        minClass = std::min(minClass, info.Processor.EfficiencyClass);
+        maxClass = std::max(maxClass, info.Processor.EfficiencyClass);
+        for (WORD g = 0; g < info.Processor.GroupCount; g++)
+            forEachCpu(info.Processor.GroupMask[g], [&](size_t cpu) { count = std::max(count, cpu + 1); });
+    });
+    if (count == 0)
+        return false;
+    out.Reset(count);
+
+    // Second pass: per-CPU fields. Higher EfficiencyClass means a faster core.
+    int32_t core = 0, package = 0, die = 0;
+    forEachRecord([&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& info) {
+        switch (info.Relationship) {
+        case RelationProcessorCore: {
+            PCpuMask siblings(count);
+            for (WORD g = 0; g < info.Processor.GroupCount; g++)
+                forEachCpu(info.Processor.GroupMask[g], [&](size_t cpu) { siblings.Set(cpu); });
+            BYTE efficiencyClass = info.Processor.EfficiencyClass;
+            for (size_t cpu = 0; cpu < count; cpu++) {
+                if (!siblings.Test(cpu))
+                    continue;
+                out.online.Set(cpu);
+                out.coreId[cpu] = core;
+                out.smtSiblings[cpu] = siblings;
+                out.capacity[cpu] = static_cast<uint32_t>((efficiencyClass + 1u) * 1024u / (maxClass + 1u));
+                if (minClass != maxClass)
+                    out.coreType[cpu] = efficiencyClass == maxClass ? PCoreType::Performance : PCoreType::Efficiency;
+            }
+            core++;
+            break;
+        }
+        case RelationProcessorPackage:
+            for (WORD g = 0; g < info.Processor.GroupCount; g++)
+                forEachCpu(info.Processor.GroupMask[g], [&](size_t cpu) { if (cpu < count) out.packageId[cpu] = package; });
+            package++;
+            break;
+        case RelationProcessorDie:
+            for (WORD g = 0; g < info.Processor.GroupCount; g++)
+                forEachCpu(info.Processor.GroupMask[g], [&](size_t cpu) { if (cpu < count) out.dieId[cpu] = die; });
+            die++;
+            break;
+        case RelationNumaNode:
+            forEachCpu(info.NumaNode.GroupMask, [&](size_t cpu) { if (cpu < count) out.numaNode[cpu] = static_cast<int32_t>(info.NumaNode.NodeNumber); });
+            break;
+        default:
+            break;
+        }
+    });
+
+    out.BuildMasks();
+    return true;
+}
+#endif
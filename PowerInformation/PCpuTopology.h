@@ -0,0 +1,102 @@
+// PCpuTopology.h - Declares the per-logical-CPU hybrid topology model.
+//
+// Types:
+//   - PCoreType: Performance / Efficiency / Unknown core type.
+//   - PCpuMask: Growable bitmask of logical CPU numbers.
+//   - PCpuTopology: Dense per-CPU arrays (core type, SMT siblings, package, die, NUMA node, capacity)
+//     plus precomputed masks, so placement questions are a lookup instead of a scan.
+//
+// Sources:
+//   - Linux: /sys/devices/system/cpu/{present,online}, /sys/devices/cpu_core/cpus, /sys/devices/cpu_atom/cpus,
+//     cpuN/topology/*, cpuN/cpu_capacity and /sys/devices/system/node/nodeN/cpulist, under an injectable root;
+//     core/package ids and SMT siblings missing there come from /proc/cpuinfo. Files are read through one
+//     reused PProcFile buffer.
+//   - Windows: GetLogicalProcessorInformationEx (cores with EfficiencyClass, packages, dies, NUMA nodes).
+//
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class PCoreType : uint8_t {
+    Unknown = 0,
+    Performance = 1,
+    Efficiency = 2,
+};
+
+// Growable bitmask of logical CPU numbers
+class PCpuMask
+{
+public:
+    PCpuMask() = default;
+    explicit PCpuMask(size_t cpuCount) { Resize(cpuCount); }
+
+    void Resize(size_t cpuCount);
+    size_t Size() const { return bits; }
+
+    // Set grows the mask as needed; Test is false past the end
+    void Set(size_t cpu);
+    // Set CPUs first..last inclusive, growing as needed
+    void SetRange(size_t first, size_t last);
+    void Reset(size_t cpu);
+    bool Test(size_t cpu) const { return cpu < bits && (words[cpu / 64] >> (cpu % 64)) & 1; }
+    void Clear();
+
+    size_t Count() const;
+    bool Empty() const { return Count() == 0; }
+    // Lowest set CPU, or Size() if none
+    size_t First() const;
+
+    PCpuMask& operator|=(const PCpuMask& other);
+    PCpuMask& operator&=(const PCpuMask& other);
+    PCpuMask& AndNot(const PCpuMask& other);
+    bool operator==(const PCpuMask& other) const;
+
+    const std::vector<uint64_t>& Words() const { return words; }
+
+    // Parse a kernel CPU list such as "0-7,16-23" into the mask (added to existing bits)
+    static bool ParseList(std::string_view text, PCpuMask& mask);
+    // Format as a kernel CPU list
+    std::string ToList() const;
+
+private:
+    std::vector<uint64_t> words;
+    size_t bits = 0;
+};
+
+struct PCpuTopology {
+    // Logical CPU slots (highest present CPU + 1); arrays below are indexed by logical CPU number
+    size_t cpuCount = 0;
+    std::vector<PCoreType> coreType;
+    std::vector<int32_t> coreId;        // -1 if unknown
+    std::vector<int32_t> packageId;     // -1 if unknown
+    std::vector<int32_t> dieId;         // -1 if unknown
+    std::vector<int32_t> numaNode;      // -1 if unknown
+    std::vector<uint32_t> capacity;     // relative capacity, largest core = 1024; 0 if unknown
+    std::vector<PCpuMask> smtSiblings;  // hardware threads sharing the CPU's core, including itself
+
+    // Precomputed masks
+    PCpuMask online;
+    PCpuMask performance;
+    PCpuMask efficiency;
+    PCpuMask firstThreadPerCore;        // one hardware thread per physical core
+    std::vector<PCpuMask> numaNodes;    // NUMA node -> CPUs
+
+    bool IsHybrid() const { return !performance.Empty() && !efficiency.Empty(); }
+    // Number of physical cores of a type
+    size_t CoreCount(PCoreType type) const;
+
+    // Load from sysfs under root ("/" on a live system); returns false if no CPU list is found
+    static bool LoadFromSysfs(const std::filesystem::path& root, PCpuTopology& out);
+#ifdef _WIN32
+    // Load from GetLogicalProcessorInformationEx
+    static bool LoadFromWindows(PCpuTopology& out);
+#endif
+
+    // Loader steps, also used to rebuild a topology from a saved snapshot:
+    // size the per-CPU arrays and reset them to "unknown", fill arrays and online, then derive the masks
+    void Reset(size_t count);
+    void BuildMasks();
+};
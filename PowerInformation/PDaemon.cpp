@@ -0,0 +1,384 @@
+// PDaemon.cpp - Implements the cached-state daemon, its line protocol and the client.
+//
+#include "pch.h"
+#include "PDaemon.h"
+#include "PGuid.h"
+#include "PFields.h"
+#include "PUtf8.h"
+#include <charconv>
+
+// Constructor
+PDaemon::PDaemon(PInformation& info, PPowerBackend& backend)
+    : info(info), backend(backend), tracker(info, backend)
+{
+}
+
+// Destructor
+PDaemon::~PDaemon()
+{
+    Stop();
+}
+
+// Capture the state and start the watcher thread
+void PDaemon::Start()
+{
+    {
+        std::unique_lock lock(stateMutex);
+        tracker.Capture();
+        RebuildIndex();
+    }
+    stopping = false;
+    watcher.Open(backend.ChangeSources());
+    watchThread = std::thread(&PDaemon::WatchLoop, this);
+}
+
+// Disconnect every client and stop the watcher thread
+void PDaemon::Stop()
+{
+    {
+        std::lock_guard lock(stopMutex);
+        stopping = true;
+    }
+    stopSignal.notify_all();
+    watcher.Wake();
+    if (watchThread.joinable())
+        watchThread.join();
+    {
+        std::lock_guard lock(connectionsMutex);
+        for (auto& connection : connections)
+            connection.channel->Shutdown();
+    }
+    JoinFinished(true);
+    watcher.Close();
+}
+
+// Re-read values; the indexes only change when settings or schemes came or went
+void PDaemon::Refresh()
+{
+    changes.clear();
+    tracker.Refresh(changes);
+    for (const auto& change : changes) {
+        if (change.kind != PSettingChange::Kind::Value) {
+            RebuildIndex();
+            break;
+        }
+    }
+}
+
+// Refresh on every change notification, or once a second without notifications
+void PDaemon::WatchLoop()
+{
+    while (!stopping) {
+        if (watcher.IsOpen()) {
+            if (!watcher.Wait(std::chrono::milliseconds::max()))
+                continue;
+        } else {
+            std::unique_lock lock(stopMutex);
+            if (stopSignal.wait_for(lock, std::chrono::seconds(1), [this] { return stopping.load(); }))
+                break;
+        }
+        std::unique_lock lock(stateMutex);
+        Refresh();
+    }
+}
+
+// Index the snapshot by UTF-8 names; settings of one scheme are contiguous in capture order
+void PDaemon::RebuildIndex()
+{
+    const PCompactSnapshot& snapshot = tracker.Snapshot();
+    settings.clear();
+    schemes.clear();
+    settings.reserve(snapshot.SettingCount());
+    std::vector<std::string> schemeNames;
+    for (uint32_t id : snapshot.SchemeNameIds())
+        schemeNames.push_back(WideToUtf8(snapshot.Strings().Get(id)));
+    for (uint32_t i = 0; i < snapshot.SettingCount(); i++) {
+        uint32_t scheme = snapshot.SettingSchemes()[i];
+        const std::string& profile = schemeNames[scheme];
+        // First name wins, like PSettingCatalog
+        settings.emplace(profile + '\t' + WideToUtf8(snapshot.Strings().Get(snapshot.NameIds()[i])), i);
+        auto range = schemes.try_emplace(profile, i, i).first;
+        if (range->second.second == i)
+            range->second.second = i + 1;
+    }
+    for (size_t i = 0; i < schemeNames.size(); i++)
+        schemes.try_emplace(schemeNames[i], 0, 0);
+    searchIndex.reset();
+}
+
+size_t PDaemon::SettingCount()
+{
+    std::shared_lock lock(stateMutex);
+    return tracker.Snapshot().SettingCount();
+}
+
+size_t PDaemon::SchemeCount()
+{
+    std::shared_lock lock(stateMutex);
+    return tracker.Snapshot().SchemeCount();
+}
+
+// Append a cached value: decimal or "error"
+static void AppendValue(std::string& out, PValueType type, uint32_t value)
+{
+    if (type != PValueType::Dword) {
+        out += "error";
+        return;
+    }
+    char digits[16];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// Parse a SET value column: decimal, or "-" to leave the value unchanged
+static bool ParseRequestValue(std::string_view text, bool& managed, DWORD& value)
+{
+    managed = text != "-";
+    if (!managed)
+        return true;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Answer one request line
+void PDaemon::Handle(std::string_view request, std::string& response, bool maySet)
+{
+    std::vector<std::string_view> fields = SplitFields(request);
+    std::string_view verb = fields[0];
+
+    if (verb == "GET" && fields.size() == 3) {
+        std::string key = UnescapeField(fields[1]) + '\t' + UnescapeField(fields[2]);
+        std::shared_lock lock(stateMutex);
+        auto it = settings.find(key);
+        if (it == settings.end()) {
+            response += "ERR\tsetting not found\n";
+            return;
+        }
+        const PCompactSnapshot& snapshot = tracker.Snapshot();
+        response += "OK\t";
+        AppendValue(response, snapshot.AcTypes()[it->second], snapshot.AcValues()[it->second]);
+        response += '\t';
+        AppendValue(response, snapshot.DcTypes()[it->second], snapshot.DcValues()[it->second]);
+        response += '\n';
+    } else if (verb == "SET" && fields.size() == 5) {
+        if (!maySet) {
+            response += "ERR\tpermission denied\n";
+            return;
+        }
+        bool acManaged = false, dcManaged = false;
+        DWORD ac = 0, dc = 0;
+        if (!ParseRequestValue(fields[3], acManaged, ac) || !ParseRequestValue(fields[4], dcManaged, dc)) {
+            response += "ERR\tinvalid value\n";
+            return;
+        }
+        std::wstring profile = Utf8ToWide(UnescapeField(fields[1]));
+        std::wstring setting = Utf8ToWide(UnescapeField(fields[2]));
+        std::vector<PSettingWrite> writes;
+        if (acManaged)
+            writes.push_back({ profile, setting, true, ac });
+        if (dcManaged)
+            writes.push_back({ profile, setting, false, dc });
+        std::unique_lock lock(stateMutex);
+        PSetResult result = info.SetPowerSettingValues(writes);
+        // Don't wait for the notification: the next GET on any connection must see the write
+        Refresh();
+        if (result == PSetResult::Applied)
+            response += "OK\n";
+        else if (result == PSetResult::NotActivated)
+            response += "ERR\tvalue set but the profile could not be activated\n";
+        else if (result == PSetResult::PartlyApplied)
+            response += "ERR\tfailed to set value; some values could not be restored\n";
+        else
+            response += "ERR\tfailed to set value\n";
+    } else if (verb == "DUMP" && fields.size() == 2) {
+        std::shared_lock lock(stateMutex);
+        auto it = schemes.find(UnescapeField(fields[1]));
+        if (it == schemes.end()) {
+            response += "ERR\tprofile not found\n";
+            return;
+        }
+        const PCompactSnapshot& snapshot = tracker.Snapshot();
+        auto [first, last] = it->second;
+        response += "OK\t" + std::to_string(last - first) + "\n";
+        for (uint32_t i = first; i < last; i++) {
+            response += EscapeField(WideToUtf8(snapshot.Strings().Get(snapshot.NameIds()[i])));
+            response += '\t';
+            response += EscapeField(WideToUtf8(snapshot.Strings().Get(snapshot.DescriptionIds()[i])));
+            response += '\t';
+            AppendValue(response, snapshot.AcTypes()[i], snapshot.AcValues()[i]);
+            response += '\t';
+            AppendValue(response, snapshot.DcTypes()[i], snapshot.DcValues()[i]);
+            response += '\n';
+        }
+    } else if (verb == "SEARCH" && fields.size() == 2) {
+        std::shared_lock lock(stateMutex);
+        {
+            std::lock_guard build(searchMutex);
+            if (!searchIndex)
+                searchIndex = std::make_unique<PSearchIndex>(PSearchIndex::Build(tracker.Snapshot()));
+        }
+        std::vector<PSearchHit> hits;
+        if (!searchIndex->Search(Utf8ToWide(UnescapeField(fields[1])), hits)) {
+            response += "ERR\tempty search\n";
+            return;
+        }
+        response += "OK\t" + std::to_string(hits.size()) + "\n";
+        for (const PSearchHit& hit : hits) {
+            response += WideToUtf8(GuidToString(searchIndex->Setting(hit.document)));
+            response += '\t';
+            response += EscapeField(WideToUtf8(searchIndex->Name(hit.document)));
+            response += '\t';
+            response += EscapeField(WideToUtf8(searchIndex->Description(hit.document)));
+            response += '\t';
+            response += std::to_string(hit.score);
+            response += '\n';
+        }
+    } else if (verb == "PING" && fields.size() == 1) {
+        response += "OK\n";
+    } else {
+        response += "ERR\tunknown request\n";
+    }
+}
+
+// Serve one client: answer every complete line of a read with one write
+void PDaemon::ServeConnection(PIpcConnection& channel)
+{
+    static constexpr size_t MaxPending = 1 << 20;
+    const bool maySet = channel.PeerIsOwner();
+    std::string pending, response;
+    char buffer[16 * 1024];
+    while (size_t read = channel.Read(buffer, sizeof(buffer))) {
+        pending.append(buffer, read);
+        size_t start = 0;
+        response.clear();
+        for (size_t end; (end = pending.find('\n', start)) != std::string::npos; start = end + 1) {
+            std::string_view line(pending.data() + start, end - start);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            if (!line.empty())
+                Handle(line, response, maySet);
+        }
+        pending.erase(0, start);
+        if (pending.size() > MaxPending || (!response.empty() && !channel.Write(response)))
+            break;
+    }
+}
+
+// Join connection threads that ended (or all of them)
+void PDaemon::JoinFinished(bool all)
+{
+    std::list<Connection> finished;
+    {
+        std::lock_guard lock(connectionsMutex);
+        for (auto it = connections.begin(); it != connections.end();) {
+            auto next = std::next(it);
+            if (all || *it->done)
+                finished.splice(finished.end(), connections, it);
+            it = next;
+        }
+    }
+    for (auto& connection : finished)
+        connection.thread.join();
+}
+
+// Accept loop
+void PDaemon::Serve(PIpcListener& listener, std::chrono::steady_clock::time_point deadline)
+{
+    while (!stopping) {
+        auto timeout = std::chrono::milliseconds(500);
+        if (deadline != std::chrono::steady_clock::time_point::max()) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline)
+                break;
+            timeout = std::min(timeout, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now) + std::chrono::milliseconds(1));
+        }
+        JoinFinished(false);
+        std::unique_ptr<PIpcConnection> accepted = listener.Accept(timeout);
+        if (!accepted)
+            continue;
+        Connection connection;
+        connection.channel = std::move(accepted);
+        connection.done = std::make_shared<std::atomic<bool>>(false);
+        connection.thread = std::thread([this, channel = connection.channel, done = connection.done] {
+            ServeConnection(*channel);
+            *done = true;
+        });
+        std::lock_guard lock(connectionsMutex);
+        connections.push_back(std::move(connection));
+    }
+}
+
+// Connect to a running daemon
+bool PDaemonClient::Connect(const std::wstring& endpoint)
+{
+    channel = ConnectIpc(endpoint);
+    buffer.clear();
+    position = 0;
+    return channel != nullptr;
+}
+
+// Next response line, reading more as needed
+bool PDaemonClient::ReadLine(std::string& line)
+{
+    for (;;) {
+        size_t end = buffer.find('\n', position);
+        if (end != std::string::npos) {
+            line.assign(buffer, position, end - position);
+            position = end + 1;
+            return true;
+        }
+        buffer.erase(0, position);
+        position = 0;
+        char chunk[16 * 1024];
+        size_t read = channel->Read(chunk, sizeof(chunk));
+        if (read == 0)
+            return false;
+        buffer.append(chunk, read);
+    }
+}
+
+// One response: the status line, and for DUMP and SEARCH the "OK <count>" body lines
+bool PDaemonClient::ReadResponse(const std::string& request, std::vector<std::string>& response)
+{
+    response.assign(1, std::string());
+    if (!ReadLine(response[0]))
+        return false;
+    bool listing = request.compare(0, 5, "DUMP\t") == 0 || request.compare(0, 7, "SEARCH\t") == 0;
+    if (listing && response[0].compare(0, 3, "OK\t") == 0) {
+        size_t count = std::strtoul(response[0].c_str() + 3, nullptr, 10);
+        response.resize(count + 1);
+        for (size_t i = 1; i <= count; i++) {
+            if (!ReadLine(response[i]))
+                return false;
+        }
+    }
+    return true;
+}
+
+// Pipelined exchange in windows: a window fits in the socket buffer, so its write completes even while the
+// daemon is blocked writing responses, and the responses are read before the next window goes out
+bool PDaemonClient::Exchange(const std::vector<std::string>& requests, std::vector<std::vector<std::string>>& responses)
+{
+    static constexpr size_t WindowBytes = 16 * 1024;
+    if (!channel)
+        return false;
+    responses.clear();
+    std::string batch;
+    for (size_t next = 0; next < requests.size();) {
+        size_t first = next;
+        batch.clear();
+        while (next < requests.size() && (next == first || batch.size() + requests[next].size() < WindowBytes)) {
+            batch += requests[next++];
+            batch += '\n';
+        }
+        if (!channel->Write(batch))
+            return false;
+        for (size_t i = first; i < next; i++) {
+            std::vector<std::string> response;
+            if (!ReadResponse(requests[i], response))
+                return false;
+            responses.push_back(std::move(response));
+        }
+    }
+    return true;
+}
@@ -0,0 +1,116 @@
+// PDaemon.h - Declares the resident daemon that answers Get/Set/Dump from cached state, and its client.
+//
+// PDaemon class:
+//   - Captures every scheme and setting once (PSettingTracker) and indexes them by UTF-8 (profile, setting)
+//     name, so a Get is one hash lookup with no power API call.
+//   - The first SEARCH builds a PSearchIndex over the captured names and descriptions; later searches reuse
+//     it until settings or schemes come or go.
+//   - A watcher thread re-reads values when PChangeWatcher reports a change (once a second if the backend
+//     has no change notifications); Set writes through PInformation and refreshes the cache right away.
+//   - One thread per connection; requests are pipelined: every complete line in a read is answered and
+//     the responses go out in one write, in request order.
+//   - On a shared endpoint (a root daemon on /run/PowerInformation.sock), clients of other users may read
+//     but SET answers "ERR permission denied".
+//
+// Protocol (UTF-8, one request per line, tab-separated, fields escaped like snapshots):
+//   GET  <profile> <setting>            -> OK <ac> <dc>            (values decimal or "error")
+//   SET  <profile> <setting> <ac> <dc>  -> OK                      ("-" leaves a value unchanged)
+//   DUMP <profile>                      -> OK <count>, then <count> lines: <setting> <description> <ac> <dc>
+//   SEARCH <text>                       -> OK <count>, then <count> lines: <guid> <setting> <description> <score>
+//   PING                                -> OK
+//   Any failure                         -> ERR <message>
+//
+// PDaemonClient class:
+//   - Sends requests in windows of about 16 KB and reads each window's responses before sending the next,
+//     so a large batch cannot fill both socket buffers while client and daemon are both writing.
+//
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "PChangeWatcher.h"
+#include "PIpcChannel.h"
+#include "PSearchIndex.h"
+#include "PSettingTracker.h"
+
+class PDaemon
+{
+public:
+    PDaemon(PInformation& info, PPowerBackend& backend);
+    ~PDaemon();
+    PDaemon(const PDaemon&) = delete;
+    PDaemon& operator=(const PDaemon&) = delete;
+
+    // Capture the state and start the watcher thread
+    void Start();
+    // Accept and serve clients until the deadline (steady_clock::time_point::max() serves until the process ends)
+    void Serve(PIpcListener& listener, std::chrono::steady_clock::time_point deadline);
+    // Disconnect every client and stop the watcher thread
+    void Stop();
+
+    // Answer one request line, appending the response lines; without maySet, SET is refused
+    void Handle(std::string_view request, std::string& response, bool maySet = true);
+
+    size_t SettingCount();
+    size_t SchemeCount();
+
+private:
+    struct Connection {
+        std::shared_ptr<PIpcConnection> channel;
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+
+    void WatchLoop();
+    void Refresh();
+    void RebuildIndex();
+    void ServeConnection(PIpcConnection& channel);
+    void JoinFinished(bool all);
+
+    PInformation& info;
+    PPowerBackend& backend;
+    PSettingTracker tracker;
+    PChangeWatcher watcher;
+
+    std::shared_mutex stateMutex;                       // tracker and indexes
+    std::unordered_map<std::string, uint32_t> settings; // "<profile>\t<setting>" (UTF-8) -> snapshot index
+    std::unordered_map<std::string, std::pair<uint32_t, uint32_t>> schemes; // profile -> [first, last) setting
+    std::vector<PSettingChange> changes;
+    std::mutex searchMutex;                             // builds searchIndex under a shared stateMutex
+    std::unique_ptr<PSearchIndex> searchIndex;          // built by the first SEARCH; reset with the indexes
+
+    std::thread watchThread;
+    std::atomic<bool> stopping{ false };
+    std::mutex stopMutex;
+    std::condition_variable stopSignal;
+
+    std::mutex connectionsMutex;
+    std::list<Connection> connections;
+};
+
+class PDaemonClient
+{
+public:
+    // Connect to a running daemon
+    bool Connect(const std::wstring& endpoint);
+    // Send the requests (one line each, no newline) in pipelined windows and collect the responses; each
+    // response is its status line followed by its body lines (DUMP, SEARCH)
+    bool Exchange(const std::vector<std::string>& requests, std::vector<std::vector<std::string>>& responses);
+
+private:
+    bool ReadLine(std::string& line);
+    bool ReadResponse(const std::string& request, std::vector<std::string>& response);
+
+    std::unique_ptr<PIpcConnection> channel;
+    std::string buffer;
+    size_t position = 0;
+};
@@ -0,0 +1,138 @@
+// PDesiredState.cpp - Implements manifest parsing and the desired-state reconcile.
+//
+#include "pch.h"
+#include "PDesiredState.h"
+#include "PFields.h"
+#include "PUtf8.h"
+#include <charconv>
+#include <fstream>
+#include <unordered_map>
+
+// Parse one value column: decimal, or "-" for unmanaged
+static bool ParseDesiredValue(std::string_view text, bool& managed, DWORD& value)
+{
+    managed = text != "-";
+    if (!managed)
+        return true;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Parse a manifest
+bool PDesiredState::FromText(std::string_view text, PDesiredState& out, size_t& errorLine)
+{
+    out = {};
+    errorLine = 0;
+    size_t start = 0;
+    for (size_t lineNumber = 1; start < text.size(); lineNumber++) {
+        size_t end = text.find('\n', start);
+        if (end == std::string_view::npos)
+            end = text.size();
+        std::string_view line = text.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::vector<std::string_view> fields = SplitFields(line);
+        bool acManaged = false, dcManaged = false;
+        DWORD ac = 0, dc = 0;
+        if (fields.size() != 4 || fields[0].empty() || fields[1].empty() ||
+            !ParseDesiredValue(fields[2], acManaged, ac) || !ParseDesiredValue(fields[3], dcManaged, dc)) {
+            errorLine = lineNumber;
+            return false;
+        }
+        std::wstring profile = Utf8ToWide(UnescapeField(fields[0]));
+        std::wstring setting = Utf8ToWide(UnescapeField(fields[1]));
+        if (acManaged)
+            out.values.push_back({ profile, setting, true, ac, lineNumber });
+        if (dcManaged)
+            out.values.push_back({ std::move(profile), std::move(setting), false, dc, lineNumber });
+    }
+    return true;
+}
+
+// Read a manifest file
+bool PDesiredState::Load(const std::filesystem::path& path, PDesiredState& out, size_t& errorLine)
+{
+    errorLine = 0;
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return FromText(text, out, errorLine);
+}
+
+// Number of distinct profiles the plan writes to
+size_t PReconcilePlan::ProfileCount() const
+{
+    std::vector<const std::wstring*> profiles;
+    for (const auto& planned : writes) {
+        auto same = [&](const std::wstring* name) { return *name == planned.write.profileName; };
+        if (std::find_if(profiles.begin(), profiles.end(), same) == profiles.end())
+            profiles.push_back(&planned.write.profileName);
+    }
+    return profiles.size();
+}
+
+// Compute the minimal write set
+PReconcilePlan PlanReconcile(PInformation& info, const PDesiredState& desired)
+{
+    PReconcilePlan plan;
+
+    // Keep only the last entry per (profile, setting, AC/DC), in manifest order
+    std::unordered_map<std::wstring, size_t> last;
+    for (size_t i = 0; i < desired.values.size(); i++) {
+        const PDesiredValue& value = desired.values[i];
+        last[value.profileName + L'\t' + value.settingName + (value.ac ? L"\tac" : L"\tdc")] = i;
+    }
+    std::vector<const PDesiredValue*> managed;
+    for (size_t i = 0; i < desired.values.size(); i++) {
+        const PDesiredValue& value = desired.values[i];
+        if (last[value.profileName + L'\t' + value.settingName + (value.ac ? L"\tac" : L"\tdc")] == i)
+            managed.push_back(&value);
+    }
+
+    // One batch read of the current values; names resolve through the catalog built once per backend generation
+    std::vector<PSettingRead> reads;
+    reads.reserve(managed.size());
+    for (const PDesiredValue* value : managed)
+        reads.push_back({ value->profileName, value->settingName, value->ac });
+    info.GetPowerSettingValues(reads);
+
+    for (size_t i = 0; i < managed.size(); i++) {
+        const PDesiredValue& value = *managed[i];
+        const PSettingRead& read = reads[i];
+        if (!read.found) {
+            // Report a manifest line once, not once per AC/DC value
+            if (plan.unresolved.empty() || plan.unresolved.back()->line != value.line)
+                plan.unresolved.push_back(&value);
+            continue;
+        }
+        if (!read.ok) {
+            plan.unreadable.push_back(&value);
+            continue;
+        }
+        if (read.value == value.value) {
+            plan.unchanged++;
+            continue;
+        }
+        plan.writes.push_back({ { value.profileName, value.settingName, value.ac, value.value }, read.value, value.line });
+    }
+    return plan;
+}
+
+// Apply a plan as one batch
+PSetResult ApplyReconcile(PInformation& info, const PReconcilePlan& plan)
+{
+    if (!plan.unresolved.empty())
+        return PSetResult::NotApplied;
+    if (plan.writes.empty())
+        return PSetResult::Applied;
+    std::vector<PSettingWrite> writes;
+    writes.reserve(plan.writes.size());
+    for (const auto& planned : plan.writes)
+        writes.push_back(planned.write);
+    return info.SetPowerSettingValues(writes);
+}
@@ -0,0 +1,63 @@
+// PDesiredState.h - Declares the desired-state manifest and its reconcile plan (the Apply command).
+//
+// PDesiredState:
+//   - Loads a tab-separated UTF-8 manifest, one setting per line:
+//       <profile name> <setting name> <ac> <dc>
+//     Values are decimal; "-" leaves that value unmanaged. Empty lines and lines starting with '#' are
+//     ignored; fields are escaped like snapshots (\t \n \r \\, PFields.h). A later line for the same setting wins.
+//
+// Functions:
+//   - PlanReconcile: Resolves every entry and reads the current values in one batch, and keeps only the
+//     values that differ. A converged machine yields an empty plan, so nothing is written or activated.
+//     A value whose current state cannot be read is reported as unreadable and left alone: without the
+//     old value there is no telling whether it drifted, and a failed batch could not restore it.
+//   - ApplyReconcile: Writes the plan through PInformation::SetPowerSettingValues, which activates each
+//     affected scheme once at the end and rolls back on failure, and returns its PSetResult.
+//
+#pragma once
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "PInformation.h"
+
+// One managed AC or DC value
+struct PDesiredValue {
+    std::wstring profileName;
+    std::wstring settingName;
+    bool ac;
+    DWORD value;
+    size_t line; // 1-based manifest line, for messages
+};
+
+struct PDesiredState {
+    std::vector<PDesiredValue> values;
+
+    // Parse a manifest; on failure errorLine is the 1-based line that could not be parsed
+    static bool FromText(std::string_view text, PDesiredState& out, size_t& errorLine);
+    static bool Load(const std::filesystem::path& path, PDesiredState& out, size_t& errorLine);
+};
+
+// One write of a reconcile plan and the value it replaces
+struct PPlannedWrite {
+    PSettingWrite write;
+    DWORD current;
+    size_t line;
+};
+
+struct PReconcilePlan {
+    std::vector<PPlannedWrite> writes;
+    std::vector<const PDesiredValue*> unresolved; // profile/setting names that were not found
+    std::vector<const PDesiredValue*> unreadable; // resolved, but the current value could not be read; not written
+    size_t unchanged = 0;                         // managed values already as desired
+
+    bool Converged() const { return writes.empty() && unresolved.empty() && unreadable.empty(); }
+    // Number of distinct profiles the plan writes to (each is activated once)
+    size_t ProfileCount() const;
+};
+
+// Compute the minimal write set that brings the live values to the desired state
+PReconcilePlan PlanReconcile(PInformation& info, const PDesiredState& desired);
+// Apply a plan with no unresolved entries as one batch; an empty plan writes nothing (Applied), a plan with
+// unresolved entries is refused (NotApplied). Unreadable values are not part of the batch.
+PSetResult ApplyReconcile(PInformation& info, const PReconcilePlan& plan);
@@ -0,0 +1,307 @@
+// PFakePowerBackend.cpp - Implements the in-memory PPowerBackend.
+//
+#include "pch.h"
+#include "PFakePowerBackend.h"
+#include <thread>
+#include <utility>
+
+// Build a deterministic GUID from a kind tag and up to three indices
+static GUID MakeSyntheticGuid(uint16_t kind, uint32_t a, uint32_t b, uint32_t c)
+{
+    GUID guid = {};
+    guid.Data1 = a;
+    guid.Data2 = kind;
+    guid.Data3 = static_cast<uint16_t>(b);
+    std::memcpy(guid.Data4, &c, sizeof(c));
+    guid.Data4[7] = 0x5a;
+    return guid;
+}
+
+// Constructor
+PFakePowerBackend::PFakePowerBackend() {}
+
+// Add a scheme; the first scheme added becomes active
+void PFakePowerBackend::AddScheme(const GUID& scheme, const std::wstring& name, const std::wstring& description)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (schemes.empty())
+        activeScheme = scheme;
+    schemes.push_back({ scheme, name, description, {} });
+    generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+// Add a subgroup to a scheme
+bool PFakePowerBackend::AddSubgroup(const GUID& scheme, const GUID& subgroup, const std::wstring& name, const std::wstring& description)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    FakeScheme* s = FindScheme(scheme);
+    if (!s) return false;
+    s->subgroups.push_back({ subgroup, name, description, {} });
+    generation.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+}
+
+// Add a setting to a subgroup
+bool PFakePowerBackend::AddSetting(const GUID& scheme, const GUID& subgroup, const GUID& setting, const std::wstring& name,
+                                   const std::wstring& description, DWORD acValue, DWORD dcValue)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    FakeSubgroup* g = FindSubgroup(scheme, subgroup);
+    if (!g) return false;
+    g->settings.push_back({ setting, name, description, acValue, dcValue });
+    generation.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+}
+
+// Rename a scheme
+bool PFakePowerBackend::RenameScheme(const GUID& scheme, const std::wstring& name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    FakeScheme* s = FindScheme(scheme);
+    if (!s) return false;
+    s->name = name;
+    generation.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+}
+
+// Rename a setting
+bool PFakePowerBackend::RenameSetting(const GUID& scheme, const GUID& subgroup, const GUID& setting, const std::wstring& name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    FakeSetting* i = FindSetting(scheme, subgroup, setting);
+    if (!i) return false;
+    i->name = name;
+    generation.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+}
+
+// Remove a scheme
+bool PFakePowerBackend::RemoveScheme(const GUID& scheme)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find_if(schemes.begin(), schemes.end(), [&](const FakeScheme& s) { return s.guid == scheme; });
+    if (it == schemes.end()) return false;
+    schemes.erase(it);
+    generation.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+}
+
+// Fail reads and/or writes of a setting name
+void PFakePowerBackend::FailSetting(const std::wstring& settingName, bool reads, bool writes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (reads)
+        failingReads.push_back(settingName);
+    if (writes)
+        failingWrites.push_back(settingName);
+}
+
+// Stop failing anything
+void PFakePowerBackend::ClearFailures()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    failingReads.clear();
+    failingWrites.clear();
+    activationFails = false;
+}
+
+// Hand over the journal and start a new one
+std::vector<std::wstring> PFakePowerBackend::TakeJournal()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::exchange(journal, {});
+}
+
+// Fill the store with a deterministic synthetic layout
+void PFakePowerBackend::Populate(size_t schemeCount, size_t subgroupsPerScheme, size_t settingsPerSubgroup)
+{
+    for (size_t s = 0; s < schemeCount; s++) {
+        GUID schemeGuid = MakeSyntheticGuid(1, static_cast<uint32_t>(s), 0, 0);
+        AddScheme(schemeGuid, L"Scheme " + std::to_wstring(s), L"Synthetic scheme " + std::to_wstring(s));
+        for (size_t g = 0; g < subgroupsPerScheme; g++) {
+            GUID subgroupGuid = MakeSyntheticGuid(2, static_cast<uint32_t>(g), 0, 0);
+            AddSubgroup(schemeGuid, subgroupGuid, L"Subgroup " + std::to_wstring(g));
+            for (size_t i = 0; i < settingsPerSubgroup; i++) {
+                GUID settingGuid = MakeSyntheticGuid(3, static_cast<uint32_t>(g), static_cast<uint32_t>(i), 0);
+                std::wstring id = std::to_wstring(g) + L"." + std::to_wstring(i);
+                AddSetting(schemeGuid, subgroupGuid, settingGuid, L"Setting " + id, L"Synthetic setting " + id,
+                           static_cast<DWORD>(i), static_cast<DWORD>(s));
+            }
+        }
+    }
+}
+
+// Enumerate schemes
+DWORD PFakePowerBackend::EnumerateScheme(DWORD index, GUID& scheme)
+{
+    CountCall();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (index >= schemes.size()) return ERROR_NO_MORE_ITEMS;
+    scheme = schemes[index].guid;
+    return ERROR_SUCCESS;
+}
+
+// Enumerate subgroups of a scheme
+DWORD PFakePowerBackend::EnumerateSubgroup(const GUID& scheme, DWORD index, GUID& subgroup)
+{
+    CountCall();
+    std::lock_guard<std::mutex> lock(mutex);
+    FakeScheme* s = FindScheme(scheme);
+    if (!s) return ERROR_FILE_NOT_FOUND;
+    if (index >= s->subgroups.size()) return ERROR_NO_MORE_ITEMS;
+    subgroup = s->subgroups[index].guid;
+    return ERROR_SUCCESS;
+}
+
+// Enumerate settings of a subgroup
+DWORD PFakePowerBackend::EnumerateSetting(const GUID& scheme, const GUID& subgroup, DWORD index, GUID& setting)
+{
+    CountCall();
+    std::lock_guard<std::mutex> lock(mutex);
+    FakeSubgroup* g = FindSubgroup(scheme, subgroup);
+    if (!g) return ERROR_FILE_NOT_FOUND;
+    if (index >= g->settings.size()) return ERROR_NO_MORE_ITEMS;
+    setting = g->settings[index].guid;
+    return ERROR_SUCCESS;
+}
+
+// Read friendly name of a scheme, subgroup or setting
+DWORD PFakePowerBackend::ReadFriendlyName(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& name)
+{
+    CountCall();
+    std::lock_guard<std::mutex> lock(mutex);
+    name.clear();
+    if (!scheme) return ERROR_INVALID_PARAMETER;
+    if (setting && subgroup) {
+        FakeSetting* i = FindSetting(*scheme, *subgroup, *setting);
+        if (!i) return ERROR_FILE_NOT_FOUND;
+        name.assign(i->name);
+    } else if (subgroup) {
+        FakeSubgroup* g = FindSubgroup(*scheme, *subgroup);
+        if (!g) return ERROR_FILE_NOT_FOUND;
+        name.assign(g->name);
+    } else {
+        FakeScheme* s = FindScheme(*scheme);
+        if (!s) return ERROR_FILE_NOT_FOUND;
+        name.assign(s->name);
+    }
+    return ERROR_SUCCESS;
+}
+
+// Read description of a scheme, subgroup or setting
+DWORD PFakePowerBackend::ReadDescription(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& description)
+{
+    CountCall();
+    std::lock_guard<std::mutex> lock(mutex);
+    description.clear();
+    if (!scheme) return ERROR_INVALID_PARAMETER;
+    if (setting && subgroup) {
+        FakeSetting* i = FindSetting(*scheme, *subgroup, *setting);
+        if (!i) return ERROR_FILE_NOT_FOUND;
+        description.assign(i->description);
+    } else if (subgroup) {
+        FakeSubgroup* g = FindSubgroup(*scheme, *subgroup);
+        if (!g) return ERROR_FILE_NOT_FOUND;
+        description.assign(g->description);
+    } else {
+        FakeScheme* s = FindScheme(*scheme);
+        if (!s) return ERROR_FILE_NOT_FOUND;
+        description.assign(s->description);
+    }
+    return ERROR_SUCCESS;
+}
+
+// Read AC or DC value
+DWORD PFakePowerBackend::ReadValue(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD& type, DWORD& value)
+{
+    CountCall();
+    std::lock_guard<std::mutex> lock(mutex);
+    FakeSetting* i = FindSetting(scheme, subgroup, setting);
+    if (!i) return ERROR_FILE_NOT_FOUND;
+    if (std::find(failingReads.begin(), failingReads.end(), i->name) != failingReads.end()) return ERROR_ACCESS_DENIED;
+    type = REG_DWORD;
+    value = ac ? i->acValue : i->dcValue;
+    return ERROR_SUCCESS;
+}
+
+// Write AC or DC value
+DWORD PFakePowerBackend::WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD value)
+{
+    CountCall();
+    std::lock_guard<std::mutex> lock(mutex);
+    FakeSetting* i = FindSetting(scheme, subgroup, setting);
+    if (!i) return ERROR_FILE_NOT_FOUND;
+    if (std::find(failingWrites.begin(), failingWrites.end(), i->name) != failingWrites.end()) return ERROR_ACCESS_DENIED;
+    (ac ? i->acValue : i->dcValue) = value;
+    journal.push_back(L"write " + FindScheme(scheme)->name + L"/" + i->name + (ac ? L" AC " : L" DC ") + std::to_wstring(value));
+    return ERROR_SUCCESS;
+}
+
+// Get the active scheme
+DWORD PFakePowerBackend::GetActiveScheme(GUID& scheme)
+{
+    CountCall();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (schemes.empty()) return ERROR_NOT_FOUND;
+    scheme = activeScheme;
+    return ERROR_SUCCESS;
+}
+
+// Activate a scheme
+DWORD PFakePowerBackend::SetActiveScheme(const GUID& scheme)
+{
+    CountCall();
+    std::lock_guard<std::mutex> lock(mutex);
+    FakeScheme* s = FindScheme(scheme);
+    if (!s) return ERROR_FILE_NOT_FOUND;
+    if (activationFails) return ERROR_ACCESS_DENIED;
+    activeScheme = scheme;
+    journal.push_back(L"activate " + s->name);
+    return ERROR_SUCCESS;
+}
+
+// Current generation
+uint64_t PFakePowerBackend::GetGeneration()
+{
+    return generation.load(std::memory_order_acquire);
+}
+
+// Version of the names and descriptions
+uint64_t PFakePowerBackend::MetadataFingerprint()
+{
+    return generation.load(std::memory_order_acquire);
+}
+
+// Count a call and apply the simulated latency
+void PFakePowerBackend::CountCall()
+{
+    calls.fetch_add(1, std::memory_order_relaxed);
+    if (callLatency.count() > 0)
+        std::this_thread::sleep_for(callLatency);
+}
+
+// Lookup helpers (caller holds the mutex)
+PFakePowerBackend::FakeScheme* PFakePowerBackend::FindScheme(const GUID& scheme)
+{
+    for (auto& s : schemes)
+        if (s.guid == scheme) return &s;
+    return nullptr;
+}
+
+PFakePowerBackend::FakeSubgroup* PFakePowerBackend::FindSubgroup(const GUID& scheme, const GUID& subgroup)
+{
+    FakeScheme* s = FindScheme(scheme);
+    if (!s) return nullptr;
+    for (auto& g : s->subgroups)
+        if (g.guid == subgroup) return &g;
+    return nullptr;
+}
+
+PFakePowerBackend::FakeSetting* PFakePowerBackend::FindSetting(const GUID& scheme, const GUID& subgroup, const GUID& setting)
+{
+    FakeSubgroup* g = FindSubgroup(scheme, subgroup);
+    if (!g) return nullptr;
+    for (auto& i : g->settings)
+        if (i.guid == setting) return &i;
+    return nullptr;
+}
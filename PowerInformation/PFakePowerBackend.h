@@ -0,0 +1,102 @@
+// PFakePowerBackend.h - Declares an in-memory PPowerBackend for tests and benchmarks.
+//
+// PFakePowerBackend class:
+//   - Holds schemes -> subgroups -> settings with names, descriptions and AC/DC values.
+//   - Counts backend calls so callers can measure how many round trips an operation costs.
+//   - Can add a fixed per-call latency to model slow stores when measuring parallel enumeration.
+//   - Bumps its generation on every structural or name change, like a real store would.
+//   - Can fail reads or writes of a named setting, or every activation, and journals the value writes and
+//     activations that landed so tests can check their order.
+//
+#pragma once
+#include "PPowerBackend.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class PFakePowerBackend : public PPowerBackend
+{
+public:
+    PFakePowerBackend();
+
+    // Structural edits; each returns false if the parent does not exist
+    void AddScheme(const GUID& scheme, const std::wstring& name, const std::wstring& description = L"");
+    bool AddSubgroup(const GUID& scheme, const GUID& subgroup, const std::wstring& name, const std::wstring& description = L"");
+    bool AddSetting(const GUID& scheme, const GUID& subgroup, const GUID& setting, const std::wstring& name,
+                    const std::wstring& description = L"", DWORD acValue = 0, DWORD dcValue = 0);
+    bool RenameScheme(const GUID& scheme, const std::wstring& name);
+    bool RenameSetting(const GUID& scheme, const GUID& subgroup, const GUID& setting, const std::wstring& name);
+    bool RemoveScheme(const GUID& scheme);
+
+    // Fill the store with a deterministic synthetic layout (same setting GUIDs/names in every scheme)
+    void Populate(size_t schemeCount, size_t subgroupsPerScheme, size_t settingsPerSubgroup);
+
+    // Simulated latency added to every backend call (outside the store lock, like a blocking syscall)
+    void SetCallLatency(std::chrono::microseconds latency) { callLatency = latency; }
+
+    // Make reads and/or writes of every setting with this name fail until ClearFailures()
+    void FailSetting(const std::wstring& settingName, bool reads, bool writes);
+    // Make every SetActiveScheme fail until ClearFailures()
+    void FailActivation() { activationFails = true; }
+    void ClearFailures();
+
+    // Value writes ("write <scheme>/<setting> AC|DC <value>") and activations ("activate <scheme>") that
+    // succeeded since the last call, oldest first
+    std::vector<std::wstring> TakeJournal();
+
+    // Number of backend calls made since construction or the last ResetCallCount()
+    uint64_t CallCount() const { return calls.load(std::memory_order_relaxed); }
+    void ResetCallCount() { calls.store(0, std::memory_order_relaxed); }
+
+    DWORD EnumerateScheme(DWORD index, GUID& scheme) override;
+    DWORD EnumerateSubgroup(const GUID& scheme, DWORD index, GUID& subgroup) override;
+    DWORD EnumerateSetting(const GUID& scheme, const GUID& subgroup, DWORD index, GUID& setting) override;
+    DWORD ReadFriendlyName(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& name) override;
+    DWORD ReadDescription(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& description) override;
+    DWORD ReadValue(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD& type, DWORD& value) override;
+    DWORD WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD value) override;
+    DWORD GetActiveScheme(GUID& scheme) override;
+    DWORD SetActiveScheme(const GUID& scheme) override;
+    uint64_t GetGeneration() override;
+    // The generation: every name change is a new version of the metadata
+    uint64_t MetadataFingerprint() override;
+
+private:
+    struct FakeSetting {
+        GUID guid;
+        std::wstring name;
+        std::wstring description;
+        DWORD acValue;
+        DWORD dcValue;
+    };
+    struct FakeSubgroup {
+        GUID guid;
+        std::wstring name;
+        std::wstring description;
+        std::vector<FakeSetting> settings;
+    };
+    struct FakeScheme {
+        GUID guid;
+        std::wstring name;
+        std::wstring description;
+        std::vector<FakeSubgroup> subgroups;
+    };
+
+    FakeScheme* FindScheme(const GUID& scheme);
+    FakeSubgroup* FindSubgroup(const GUID& scheme, const GUID& subgroup);
+    FakeSetting* FindSetting(const GUID& scheme, const GUID& subgroup, const GUID& setting);
+    void CountCall();
+
+    std::mutex mutex;
+    std::vector<FakeScheme> schemes;
+    std::vector<std::wstring> failingReads;
+    std::vector<std::wstring> failingWrites;
+    bool activationFails = false;
+    std::vector<std::wstring> journal;
+    GUID activeScheme = {};
+    std::atomic<uint64_t> generation{ 1 };
+    std::atomic<uint64_t> calls{ 0 };
+    std::chrono::microseconds callLatency{ 0 };
+};
@@ -0,0 +1,16 @@
+// PFields.h - Field helpers shared by the tab-separated UTF-8 formats (snapshots, manifests, patterns
+// files and the daemon protocol).
+//
+// Functions:
+//   - EscapeField: Escapes tabs, line breaks and backslashes as \t \n \r \\ so a value fits in one field.
+//   - UnescapeField: Undoes EscapeField; an unknown escape keeps the escaped character.
+//   - SplitFields: Splits one line on tabs into (still escaped) views of the line.
+//
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+std::string EscapeField(std::string_view text);
+std::string UnescapeField(std::string_view text);
+std::vector<std::string_view> SplitFields(std::string_view line);
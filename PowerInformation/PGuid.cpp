@@ -0,0 +1,74 @@
+// PGuid.cpp - Implements portable GUID formatting, parsing, ordering and hashing.
+//
+#include "pch.h"
+#include "PGuid.h"
+
+// Format a GUID the way StringFromGUID2 does
+std::wstring GuidToString(const GUID& guid)
+{
+    wchar_t buffer[64] = {};
+    swprintf(buffer, 64, L"{%08X-%04X-%04X-%02X%02X-%02X%02X%02X%02X%02X%02X}",
+             static_cast<unsigned>(guid.Data1), static_cast<unsigned>(guid.Data2), static_cast<unsigned>(guid.Data3),
+             guid.Data4[0], guid.Data4[1], guid.Data4[2], guid.Data4[3],
+             guid.Data4[4], guid.Data4[5], guid.Data4[6], guid.Data4[7]);
+    return buffer;
+}
+
+// Parse a GUID string, with or without braces; returns false on malformed input
+bool GuidFromString(std::wstring_view text, GUID& out)
+{
+    if (text.size() == 38 && text.front() == L'{' && text.back() == L'}')
+        text = text.substr(1, 36);
+    if (text.size() != 36)
+        return false;
+
+    // Hex digit positions in "XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX"
+    unsigned char bytes[16] = {};
+    size_t byteIndex = 0;
+    for (size_t i = 0; i < text.size();) {
+        if (i == 8 || i == 13 || i == 18 || i == 23) {
+            if (text[i] != L'-')
+                return false;
+            i++;
+            continue;
+        }
+        int value = 0;
+        for (int n = 0; n < 2; n++, i++) {
+            wchar_t ch = text[i];
+            value <<= 4;
+            if (ch >= L'0' && ch <= L'9') value |= ch - L'0';
+            else if (ch >= L'a' && ch <= L'f') value |= ch - L'a' + 10;
+            else if (ch >= L'A' && ch <= L'F') value |= ch - L'A' + 10;
+            else return false;
+        }
+        bytes[byteIndex++] = static_cast<unsigned char>(value);
+    }
+
+    out.Data1 = (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+                (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+    out.Data2 = static_cast<uint16_t>((bytes[4] << 8) | bytes[5]);
+    out.Data3 = static_cast<uint16_t>((bytes[6] << 8) | bytes[7]);
+    std::memcpy(out.Data4, bytes + 8, 8);
+    return true;
+}
+
+// Lexicographic comparison of the raw GUID fields: <0, 0, >0
+int CompareGuid(const GUID& a, const GUID& b)
+{
+    if (a.Data1 != b.Data1) return a.Data1 < b.Data1 ? -1 : 1;
+    if (a.Data2 != b.Data2) return a.Data2 < b.Data2 ? -1 : 1;
+    if (a.Data3 != b.Data3) return a.Data3 < b.Data3 ? -1 : 1;
+    return std::memcmp(a.Data4, b.Data4, sizeof(a.Data4));
+}
+
+// FNV-1a over the 16 GUID bytes
+size_t PGuidHash::operator()(const GUID& guid) const noexcept
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&guid);
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < sizeof(GUID); i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+}
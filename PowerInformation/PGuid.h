@@ -0,0 +1,30 @@
+// PGuid.h - Portable GUID helpers shared by the power backends, catalog and caches.
+//
+// Functions:
+//   - GuidToString: Formats a GUID as "{XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX}" (same as StringFromGUID2).
+//   - GuidFromString: Parses the same format, braces optional.
+//   - CompareGuid: Total order over GUIDs, used for sorted merges and on-disk tables.
+//
+// Types:
+//   - PGuidHash: Hash functor so GUIDs can key unordered containers.
+//
+#pragma once
+#include <string>
+#include <string_view>
+
+// Format a GUID the way StringFromGUID2 does
+std::wstring GuidToString(const GUID& guid);
+// Parse a GUID string, with or without braces; returns false on malformed input
+bool GuidFromString(std::wstring_view text, GUID& out);
+// Lexicographic comparison of the raw GUID fields: <0, 0, >0
+int CompareGuid(const GUID& a, const GUID& b);
+
+// Hash functor for GUID keys
+struct PGuidHash {
+    size_t operator()(const GUID& guid) const noexcept;
+};
+
+// Ordering functor for GUID keys
+struct PGuidLess {
+    bool operator()(const GUID& a, const GUID& b) const noexcept { return CompareGuid(a, b) < 0; }
+};
@@ -0,0 +1,674 @@
+// PHexBase64.cpp - Implements the hex and Base64 block codecs and the incremental encoder and decoders.
+//
+#include "pch.h"
+#include "PHexBase64.h"
+#include "PSimd.h"
+#include <array>
+
+static constexpr char HexDigits[] = "0123456789abcdef";
+static constexpr char Base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static constexpr uint8_t Invalid = 0xFF;
+
+// Lookup tables: the two hex digits of a byte, the value of a hex digit or Base64 character (Invalid for
+// others), the two Base64 characters of 12 bits, and each Base64 character's value placed at one of the
+// four positions of a group (bits above 24 set for invalid characters, so one test covers a whole group)
+static constexpr std::array<std::array<char, 2>, 256> MakeHexPairs()
+{
+    std::array<std::array<char, 2>, 256> table{};
+    for (int b = 0; b < 256; b++)
+        table[b] = { HexDigits[b >> 4], HexDigits[b & 15] };
+    return table;
+}
+
+static constexpr std::array<uint8_t, 256> MakeHexValues()
+{
+    std::array<uint8_t, 256> table{};
+    table.fill(Invalid);
+    for (int d = 0; d < 10; d++)
+        table['0' + d] = static_cast<uint8_t>(d);
+    for (int d = 0; d < 6; d++) {
+        table['a' + d] = static_cast<uint8_t>(10 + d);
+        table['A' + d] = static_cast<uint8_t>(10 + d);
+    }
+    return table;
+}
+
+static constexpr std::array<uint8_t, 256> MakeBase64Values()
+{
+    std::array<uint8_t, 256> table{};
+    table.fill(Invalid);
+    for (int v = 0; v < 64; v++)
+        table[static_cast<uint8_t>(Base64Alphabet[v])] = static_cast<uint8_t>(v);
+    return table;
+}
+
+static constexpr std::array<std::array<char, 2>, 4096> MakeBase64Pairs()
+{
+    std::array<std::array<char, 2>, 4096> table{};
+    for (int v = 0; v < 4096; v++)
+        table[v] = { Base64Alphabet[v >> 6], Base64Alphabet[v & 63] };
+    return table;
+}
+
+static constexpr std::array<uint32_t, 256> MakeBase64Placed(int position)
+{
+    std::array<uint32_t, 256> table{};
+    const std::array<uint8_t, 256> values = MakeBase64Values();
+    for (int c = 0; c < 256; c++)
+        table[c] = values[c] == Invalid ? 0x01000000u : static_cast<uint32_t>(values[c]) << (18 - 6 * position);
+    return table;
+}
+
+static constexpr std::array<std::array<char, 2>, 256> HexPairs = MakeHexPairs();
+static constexpr std::array<uint8_t, 256> HexValues = MakeHexValues();
+static constexpr std::array<uint8_t, 256> Base64Values = MakeBase64Values();
+static constexpr std::array<std::array<char, 2>, 4096> Base64Pairs = MakeBase64Pairs();
+static constexpr std::array<std::array<uint32_t, 256>, 4> Base64Placed = {
+    MakeBase64Placed(0), MakeBase64Placed(1), MakeBase64Placed(2), MakeBase64Placed(3)
+};
+
+static uint8_t HexValue(char c)
+{
+    return HexValues[static_cast<uint8_t>(c)];
+}
+
+// Hex blocks: encode bytes, or decode pairs of digits until a block holds an invalid one; both return the
+// bytes done and leave the rest to the scalar loops
+#if defined(PSIMD_SSE2)
+
+#if defined(PSIMD_AVX2)
+
+// Nibbles (0-15) to digits: '0' + n, plus 39 more past 9
+static __m256i HexChars(__m256i nibbles)
+{
+    __m256i letters = _mm256_and_si256(_mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9)), _mm256_set1_epi8(39));
+    return _mm256_add_epi8(nibbles, _mm256_add_epi8(letters, _mm256_set1_epi8('0')));
+}
+
+// Digits to nibbles; valid is all ones where the character is a hex digit
+static __m256i HexNibbles(__m256i chars, __m256i& valid)
+{
+    __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    __m256i letter = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+    valid = _mm256_or_si256(isDigit, isLetter);
+    return _mm256_or_si256(_mm256_and_si256(isDigit, digit), _mm256_and_si256(isLetter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+}
+
+// Pairs of nibbles (high first) in 16-bit lanes to bytes in the low half of each lane
+static __m256i JoinNibbles(__m256i nibbles)
+{
+    return _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(nibbles, 4), _mm256_set1_epi16(0x00F0)), _mm256_srli_epi16(nibbles, 8));
+}
+
+static size_t EncodeHexBlocks(const uint8_t* s, size_t size, char* d)
+{
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F));
+        __m256i low = _mm256_and_si256(bytes, _mm256_set1_epi8(0x0F));
+        // Interleaving works per 128-bit lane: bytes 0-7 and 16-23, then 8-15 and 24-31
+        __m256i first = _mm256_unpacklo_epi8(high, low), second = _mm256_unpackhi_epi8(high, low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 2 * i), HexChars(_mm256_permute2x128_si256(first, second, 0x20)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 2 * i + 32), HexChars(_mm256_permute2x128_si256(first, second, 0x31)));
+    }
+    return i;
+}
+
+static size_t DecodeHexBlocks(const char* s, size_t size, uint8_t* d)
+{
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i valid0, valid1;
+        __m256i nibbles0 = HexNibbles(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 2 * i)), valid0);
+        __m256i nibbles1 = HexNibbles(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 2 * i + 32)), valid1);
+        if (_mm256_movemask_epi8(_mm256_and_si256(valid0, valid1)) != -1)
+            break;
+        // packus works per lane; restore the order of the 64-bit halves
+        __m256i bytes = _mm256_packus_epi16(JoinNibbles(nibbles0), JoinNibbles(nibbles1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), _mm256_permute4x64_epi64(bytes, 0xD8));
+    }
+    return i;
+}
+
+#else
+
+// Nibbles (0-15) to digits: '0' + n, plus 39 more past 9
+static __m128i HexChars(__m128i nibbles)
+{
+    __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8(39));
+    return _mm_add_epi8(nibbles, _mm_add_epi8(letters, _mm_set1_epi8('0')));
+}
+
+// Digits to nibbles; valid is all ones where the character is a hex digit
+static __m128i HexNibbles(__m128i chars, __m128i& valid)
+{
+    __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    valid = _mm_or_si128(isDigit, isLetter);
+    return _mm_or_si128(_mm_and_si128(isDigit, digit), _mm_and_si128(isLetter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+// Pairs of nibbles (high first) in 16-bit lanes to bytes in the low half of each lane
+static __m128i JoinNibbles(__m128i nibbles)
+{
+    return _mm_or_si128(_mm_and_si128(_mm_slli_epi16(nibbles, 4), _mm_set1_epi16(0x00F0)), _mm_srli_epi16(nibbles, 8));
+}
+
+static size_t EncodeHexBlocks(const uint8_t* s, size_t size, char* d)
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F));
+        __m128i low = _mm_and_si128(bytes, _mm_set1_epi8(0x0F));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 2 * i), HexChars(_mm_unpacklo_epi8(high, low)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 2 * i + 16), HexChars(_mm_unpackhi_epi8(high, low)));
+    }
+    return i;
+}
+
+static size_t DecodeHexBlocks(const char* s, size_t size, uint8_t* d)
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i valid0, valid1;
+        __m128i nibbles0 = HexNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 2 * i)), valid0);
+        __m128i nibbles1 = HexNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 2 * i + 16)), valid1);
+        if (_mm_movemask_epi8(_mm_and_si128(valid0, valid1)) != 0xFFFF)
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packus_epi16(JoinNibbles(nibbles0), JoinNibbles(nibbles1)));
+    }
+    return i;
+}
+
+#endif
+
+#elif defined(PSIMD_NEON)
+
+static uint8x16_t HexNibbles(uint8x16_t chars, uint8x16_t& valid)
+{
+    uint8x16_t digit = vsubq_u8(chars, vdupq_n_u8('0'));
+    uint8x16_t letter = vsubq_u8(vorrq_u8(chars, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    uint8x16_t isDigit = vcleq_u8(digit, vdupq_n_u8(9)), isLetter = vcleq_u8(letter, vdupq_n_u8(5));
+    valid = vorrq_u8(isDigit, isLetter);
+    return vbslq_u8(isDigit, digit, vaddq_u8(letter, vdupq_n_u8(10)));
+}
+
+// vld2/vst2 split and interleave the digit pairs directly
+static size_t EncodeHexBlocks(const uint8_t* s, size_t size, char* d)
+{
+    const uint8x16_t digits = vld1q_u8(reinterpret_cast<const uint8_t*>(HexDigits));
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t bytes = vld1q_u8(s + i);
+        uint8x16x2_t chars = { { vqtbl1q_u8(digits, vshrq_n_u8(bytes, 4)), vqtbl1q_u8(digits, vandq_u8(bytes, vdupq_n_u8(0x0F))) } };
+        vst2q_u8(reinterpret_cast<uint8_t*>(d + 2 * i), chars);
+    }
+    return i;
+}
+
+static size_t DecodeHexBlocks(const char* s, size_t size, uint8_t* d)
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        uint8x16x2_t chars = vld2q_u8(reinterpret_cast<const uint8_t*>(s + 2 * i));
+        uint8x16_t validHigh, validLow;
+        uint8x16_t high = HexNibbles(chars.val[0], validHigh), low = HexNibbles(chars.val[1], validLow);
+        if (vminvq_u8(vandq_u8(validHigh, validLow)) != 0xFF)
+            break;
+        vst1q_u8(d + i, vorrq_u8(vshlq_n_u8(high, 4), low));
+    }
+    return i;
+}
+
+#else
+
+static size_t EncodeHexBlocks(const uint8_t*, size_t, char*)
+{
+    return 0;
+}
+
+static size_t DecodeHexBlocks(const char*, size_t, uint8_t*)
+{
+    return 0;
+}
+
+#endif
+
+// Base64 blocks: encode whole 3-byte groups, or decode whole 4-character groups until a block holds a
+// character outside the alphabet (padding included); both return the groups done
+#if defined(PSIMD_AVX2)
+
+// 24 bytes to 32 characters (Muła and Lemire's method); reads 28 bytes
+static size_t EncodeBase64Blocks(const uint8_t* s, size_t groups, char* d)
+{
+    size_t g = 0;
+    for (; g + 10 <= groups; g += 8) {
+        // Each lane gets 12 bytes; spread every 3 to a 32-bit lane as bytes 1 0 2 1
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 3 * g))),
+                                             _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 3 * g + 12)), 1);
+        in = _mm256_shuffle_epi8(in, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                                      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+        // Move the four 6-bit fields to the low bits of their bytes
+        __m256i ac = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+        __m256i bd = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+        __m256i indices = _mm256_or_si256(ac, bd);
+        // Index to character: pick the offset of its range (A-Z, a-z, 0-9, +, /) with a shuffle
+        __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        range = _mm256_or_si256(range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+        const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                 '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                                 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                 '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+        __m256i chars = _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, range));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 4 * g), chars);
+    }
+    return g;
+}
+
+// 32 characters to 24 bytes: validate with nibble lookups, map to 6-bit values by adding the offset of the
+// character's range, then pack
+static size_t DecodeBase64Blocks(const char* s, size_t groups, uint8_t* d)
+{
+    // A character is valid when the bits for its low and high nibble share nothing
+    const __m256i validLow = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                                              0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i validHigh = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                               0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    // By high nibble; index 1 is '/', whose nibble is 2 like '+'
+    const __m256i offsets = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                             0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    // Only bits 0-3 and 7 select a shuffle entry, so 0x2F works as the nibble mask and as '/'
+    const __m256i nibbleMask = _mm256_set1_epi8(0x2F);
+    size_t g = 0;
+    for (; g + 8 <= groups; g += 8) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 4 * g));
+        __m256i high = _mm256_and_si256(_mm256_srli_epi32(chars, 4), nibbleMask);
+        __m256i low = _mm256_and_si256(chars, nibbleMask);
+        if (!_mm256_testz_si256(_mm256_shuffle_epi8(validLow, low), _mm256_shuffle_epi8(validHigh, high)))
+            break;
+        __m256i slash = _mm256_cmpeq_epi8(chars, nibbleMask);
+        __m256i values = _mm256_add_epi8(chars, _mm256_shuffle_epi8(offsets, _mm256_add_epi8(high, slash)));
+        // Join 6-bit fields into 12, then 24 bits per 32-bit lane, and drop every fourth byte
+        __m256i joined = _mm256_madd_epi16(_mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140)), _mm256_set1_epi32(0x00011000));
+        joined = _mm256_shuffle_epi8(joined, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                              2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        joined = _mm256_permutevar8x32_epi32(joined, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 3 * g), _mm256_castsi256_si128(joined));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(d + 3 * g + 16), _mm256_extracti128_si256(joined, 1));
+    }
+    return g;
+}
+
+#elif defined(PSIMD_NEON)
+
+// 48 bytes to 64 characters: vld3 splits the groups' bytes, vst4 interleaves the characters
+static size_t EncodeBase64Blocks(const uint8_t* s, size_t groups, char* d)
+{
+    const uint8x16x4_t alphabet = vld1q_u8_x4(reinterpret_cast<const uint8_t*>(Base64Alphabet));
+    const uint8x16_t six = vdupq_n_u8(0x3F);
+    size_t g = 0;
+    for (; g + 16 <= groups; g += 16) {
+        uint8x16x3_t in = vld3q_u8(s + 3 * g);
+        uint8x16x4_t out;
+        out.val[0] = vqtbl4q_u8(alphabet, vshrq_n_u8(in.val[0], 2));
+        out.val[1] = vqtbl4q_u8(alphabet, vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), six));
+        out.val[2] = vqtbl4q_u8(alphabet, vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), six));
+        out.val[3] = vqtbl4q_u8(alphabet, vandq_u8(in.val[2], six));
+        vst4q_u8(reinterpret_cast<uint8_t*>(d + 4 * g), out);
+    }
+    return g;
+}
+
+// 64 characters to 48 bytes; the 128-entry value table takes two 64-byte lookups
+static size_t DecodeBase64Blocks(const char* s, size_t groups, uint8_t* d)
+{
+    const uint8x16x4_t low = vld1q_u8_x4(Base64Values.data()), high = vld1q_u8_x4(Base64Values.data() + 64);
+    size_t g = 0;
+    for (; g + 16 <= groups; g += 16) {
+        uint8x16x4_t chars = vld4q_u8(reinterpret_cast<const uint8_t*>(s + 4 * g));
+        uint8x16_t values[4], bad = vdupq_n_u8(0);
+        for (int k = 0; k < 4; k++) {
+            // Out-of-range indices give 0 (vqtbl) or keep the previous lookup (vqtbx); Invalid and
+            // characters from 0x80 up both have the top bit set
+            values[k] = vqtbx4q_u8(vqtbl4q_u8(low, chars.val[k]), high, vsubq_u8(chars.val[k], vdupq_n_u8(64)));
+            bad = vorrq_u8(bad, vorrq_u8(values[k], chars.val[k]));
+        }
+        if (vmaxvq_u8(bad) >= 0x80)
+            break;
+        uint8x16x3_t out;
+        out.val[0] = vorrq_u8(vshlq_n_u8(values[0], 2), vshrq_n_u8(values[1], 4));
+        out.val[1] = vorrq_u8(vshlq_n_u8(values[1], 4), vshrq_n_u8(values[2], 2));
+        out.val[2] = vorrq_u8(vshlq_n_u8(values[2], 6), values[3]);
+        vst3q_u8(d + 3 * g, out);
+    }
+    return g;
+}
+
+#else
+
+// SSE2 has no byte shuffle; the 12-bit tables in the scalar loops do better than emulating one
+static size_t EncodeBase64Blocks(const uint8_t*, size_t, char*)
+{
+    return 0;
+}
+
+static size_t DecodeBase64Blocks(const char*, size_t, uint8_t*)
+{
+    return 0;
+}
+
+#endif
+
+// Encode whole 3-byte groups
+static void EncodeBase64Groups(const uint8_t* s, size_t groups, char* d)
+{
+    for (size_t g = EncodeBase64Blocks(s, groups, d); g < groups; g++) {
+        uint32_t bits = (static_cast<uint32_t>(s[3 * g]) << 16) | (static_cast<uint32_t>(s[3 * g + 1]) << 8) | s[3 * g + 2];
+        memcpy(d + 4 * g, Base64Pairs[bits >> 12].data(), 2);
+        memcpy(d + 4 * g + 2, Base64Pairs[bits & 0xFFF].data(), 2);
+    }
+}
+
+// Encode the last 1 or 2 bytes with padding
+static void EncodeBase64Tail(const uint8_t* s, size_t size, char* d)
+{
+    uint32_t bits = (static_cast<uint32_t>(s[0]) << 16) | (size > 1 ? static_cast<uint32_t>(s[1]) << 8 : 0);
+    d[0] = Base64Alphabet[bits >> 18];
+    d[1] = Base64Alphabet[(bits >> 12) & 63];
+    d[2] = size > 1 ? Base64Alphabet[(bits >> 6) & 63] : '=';
+    d[3] = '=';
+}
+
+// Decode whole 4-character groups up to the first one with a character outside the alphabet; returns the
+// groups decoded
+static size_t DecodeBase64Groups(const char* s, size_t groups, uint8_t* d)
+{
+    size_t g = DecodeBase64Blocks(s, groups, d);
+    for (; g < groups; g++) {
+        const uint8_t* c = reinterpret_cast<const uint8_t*>(s + 4 * g);
+        uint32_t bits = Base64Placed[0][c[0]] | Base64Placed[1][c[1]] | Base64Placed[2][c[2]] | Base64Placed[3][c[3]];
+        if (bits >> 24)
+            break;
+        d[3 * g] = static_cast<uint8_t>(bits >> 16);
+        d[3 * g + 1] = static_cast<uint8_t>(bits >> 8);
+        d[3 * g + 2] = static_cast<uint8_t>(bits);
+    }
+    return g;
+}
+
+// Decode one group that may end in padding ("xx==" or "xxx="); returns the bytes written, or 0 with the
+// index of the first bad character in bad
+static size_t DecodeBase64Group(const char* group, uint8_t* d, size_t& bad)
+{
+    size_t length = group[3] != '=' ? 4 : group[2] == '=' ? 2 : 3;
+    uint32_t bits = 0;
+    for (size_t k = 0; k < length; k++) {
+        uint8_t value = Base64Values[static_cast<uint8_t>(group[k])];
+        if (value == Invalid) {
+            bad = k;
+            return 0;
+        }
+        bits |= static_cast<uint32_t>(value) << (18 - 6 * k);
+    }
+    for (size_t k = 0; k + 1 < length; k++)
+        d[k] = static_cast<uint8_t>(bits >> (16 - 8 * k));
+    return length - 1;
+}
+
+// Decode pairs of digits; returns the bytes decoded, fewer than size at an invalid digit
+static size_t DecodeHexPairs(const char* s, size_t size, uint8_t* d)
+{
+    size_t i = DecodeHexBlocks(s, size, d);
+    for (; i < size; i++) {
+        uint8_t high = HexValue(s[2 * i]), low = HexValue(s[2 * i + 1]);
+        if ((high | low) == Invalid)
+            break;
+        d[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+    return i;
+}
+
+// Bytes to hex digits
+size_t EncodeHex(std::span<const uint8_t> data, char* out)
+{
+    for (size_t i = EncodeHexBlocks(data.data(), data.size(), out); i < data.size(); i++)
+        memcpy(out + 2 * i, HexPairs[data[i]].data(), 2);
+    return HexEncodedSize(data.size());
+}
+
+// Bytes to hex digits, appended to out
+void EncodeHex(std::span<const uint8_t> data, std::string& out)
+{
+    size_t base = out.size();
+    out.resize(base + HexEncodedSize(data.size()));
+    EncodeHex(data, out.data() + base);
+}
+
+// Hex digits to bytes
+bool DecodeHex(std::string_view text, uint8_t* out, size_t* errorPosition)
+{
+    size_t done = DecodeHexPairs(text.data(), text.size() / 2, out);
+    size_t error = std::string_view::npos;
+    if (done < text.size() / 2)
+        error = 2 * done + (HexValue(text[2 * done]) == Invalid ? 0 : 1);
+    else if (text.size() % 2 != 0)
+        error = text.size() - 1;
+    if (error == std::string_view::npos)
+        return true;
+    if (errorPosition)
+        *errorPosition = error;
+    return false;
+}
+
+// Bytes to Base64
+size_t EncodeBase64(std::span<const uint8_t> data, char* out)
+{
+    const size_t groups = data.size() / 3;
+    EncodeBase64Groups(data.data(), groups, out);
+    if (data.size() % 3 != 0)
+        EncodeBase64Tail(data.data() + 3 * groups, data.size() % 3, out + 4 * groups);
+    return Base64EncodedSize(data.size());
+}
+
+// Bytes to Base64, appended to out
+void EncodeBase64(std::span<const uint8_t> data, std::string& out)
+{
+    size_t base = out.size();
+    out.resize(base + Base64EncodedSize(data.size()));
+    EncodeBase64(data, out.data() + base);
+}
+
+// Base64 to bytes
+bool DecodeBase64(std::string_view text, uint8_t* out, size_t& written, size_t* errorPosition)
+{
+    PBase64Decoder decoder;
+    size_t tail = 0;
+    bool decoded = decoder.Feed(text, out, written) && decoder.Finish(out + written, tail);
+    written += tail;
+    if (!decoded && errorPosition)
+        *errorPosition = static_cast<size_t>(decoder.ErrorPosition());
+    return decoded;
+}
+
+// Encode the next chunk
+size_t PBase64Encoder::Feed(std::span<const uint8_t> chunk, char* out)
+{
+    size_t i = 0, written = 0;
+    if (carried > 0) {
+        uint8_t group[3] = { carry[0], carry[1] };
+        while (carried < 3 && i < chunk.size())
+            group[carried++] = chunk[i++];
+        if (carried < 3) {
+            memcpy(carry, group, carried);
+            return 0;
+        }
+        EncodeBase64Groups(group, 1, out);
+        written = 4;
+        carried = 0;
+    }
+    const size_t groups = (chunk.size() - i) / 3;
+    EncodeBase64Groups(chunk.data() + i, groups, out + written);
+    i += 3 * groups;
+    written += 4 * groups;
+    carried = chunk.size() - i;
+    memcpy(carry, chunk.data() + i, carried);
+    return written;
+}
+
+// Pad the carried bytes
+size_t PBase64Encoder::Finish(char* out)
+{
+    if (carried == 0)
+        return 0;
+    EncodeBase64Tail(carry, carried, out);
+    carried = 0;
+    return 4;
+}
+
+// Decode the next chunk
+bool PHexDecoder::Feed(std::string_view chunk, uint8_t* out, size_t& written)
+{
+    written = 0;
+    if (failed)
+        return false;
+    const uint64_t base = consumed;
+    consumed += chunk.size();
+    size_t i = 0;
+    if (carried && !chunk.empty()) {
+        uint8_t low = HexValue(chunk[0]);
+        if (low == Invalid) {
+            failed = true;
+            errorPosition = base;
+            return false;
+        }
+        out[written++] = static_cast<uint8_t>((high << 4) | low);
+        carried = false;
+        i = 1;
+    }
+    const size_t pairs = (chunk.size() - i) / 2;
+    size_t done = DecodeHexPairs(chunk.data() + i, pairs, out + written);
+    written += done;
+    i += 2 * done;
+    if (done < pairs) {
+        failed = true;
+        errorPosition = base + i + (HexValue(chunk[i]) == Invalid ? 0 : 1);
+        return false;
+    }
+    if (i < chunk.size()) {
+        high = HexValue(chunk[i]);
+        if (high == Invalid) {
+            failed = true;
+            errorPosition = base + i;
+            return false;
+        }
+        carried = true;
+    }
+    return true;
+}
+
+// Check for a leftover digit and start over
+bool PHexDecoder::Finish()
+{
+    bool finished = !failed;
+    if (finished && carried) {
+        errorPosition = consumed - 1;
+        finished = false;
+    }
+    carried = false;
+    failed = false;
+    consumed = 0;
+    return finished;
+}
+
+// Record the first error
+bool PBase64Decoder::Fail(uint64_t position)
+{
+    failed = true;
+    errorPosition = position;
+    return false;
+}
+
+// Decode the next chunk
+bool PBase64Decoder::Feed(std::string_view chunk, uint8_t* out, size_t& written)
+{
+    written = 0;
+    if (failed)
+        return false;
+    const char* s = chunk.data();
+    const size_t size = chunk.size();
+    const uint64_t base = consumed;
+    consumed += size;
+    if (padded && size > 0)
+        return Fail(base);
+    size_t i = 0, bad = 0;
+
+    // Complete the carried group
+    if (carried > 0) {
+        const uint64_t groupStart = base - carried;
+        while (carried < 4 && i < size)
+            carry[carried++] = s[i++];
+        if (carried < 4)
+            return true;
+        carried = 0;
+        size_t bytes = DecodeBase64Group(carry, out, bad);
+        if (bytes == 0)
+            return Fail(groupStart + bad);
+        written = bytes;
+        if (bytes < 3) {
+            padded = true;
+            return i < size ? Fail(base + i) : true;
+        }
+    }
+
+    // Whole groups; the first one they stop at is padded or invalid
+    const size_t groups = (size - i) / 4;
+    size_t done = DecodeBase64Groups(s + i, groups, out + written);
+    i += 4 * done;
+    written += 3 * done;
+    if (done < groups) {
+        size_t bytes = DecodeBase64Group(s + i, out + written, bad);
+        if (bytes == 0)
+            return Fail(base + i + bad);
+        written += bytes;
+        i += 4;
+        padded = true;
+        return i < size ? Fail(base + i) : true;
+    }
+
+    carried = size - i;
+    memcpy(carry, s + i, carried);
+    return true;
+}
+
+// Decode an unpadded final group and start over
+bool PBase64Decoder::Finish(uint8_t* out, size_t& written)
+{
+    written = 0;
+    bool finished = !failed;
+    if (finished && carried == 1)
+        finished = Fail(consumed - 1);
+    if (finished && carried > 1) {
+        for (size_t k = 0; k < carried && finished; k++) {
+            if (Base64Values[static_cast<uint8_t>(carry[k])] == Invalid)
+                finished = Fail(consumed - carried + k);
+        }
+        if (finished) {
+            char group[4] = { carry[0], carry[1], carry[2], '=' };
+            if (carried == 2)
+                group[2] = '=';
+            size_t bad = 0;
+            written = DecodeBase64Group(group, out, bad);
+        }
+    }
+    carried = 0;
+    padded = false;
+    failed = false;
+    consumed = 0;
+    return finished;
+}
@@ -0,0 +1,99 @@
+// PHexBase64.h - Hex and Base64 (RFC 4648, standard alphabet, '=' padding) codecs for binary setting
+// values and snapshot blobs embedded in text output. Use these, not StringUtil::EncodeHex/DecodeBase64 and
+// friends in the unbuilt string_util.cpp.
+//
+// Functions:
+//   - EncodeHex, EncodeBase64: write into a caller buffer of HexEncodedSize/Base64EncodedSize characters
+//     and return the count; the appending overloads grow a string once and encode in place.
+//   - DecodeHex, DecodeBase64: strict; they stop at the first invalid character and return false with its
+//     offset in errorPosition. Hex digits may be either case; Base64 accepts padding only at the end and
+//     no whitespace.
+//
+// PBase64Encoder, PHexDecoder, PBase64Decoder classes:
+//   - Incremental codecs for data that arrives in chunks: each carries the unfinished group (at most two
+//     bytes or three characters) to the next Feed and writes into caller buffers without allocating.
+//     Hex encoding has no state, so EncodeHex on each chunk is its incremental encoder.
+//
+// Whole blocks go through SSE2/AVX2/NEON code chosen at compile time (PSimd.h): hex in 16 or 32 bytes,
+// Base64 in 24 (AVX2) or 48 (NEON) bytes. Without a byte shuffle (SSE2 only, portable builds) Base64
+// uses 12-bit lookup tables, two characters or one and a half bytes per load.
+//
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+constexpr size_t HexEncodedSize(size_t bytes) { return bytes * 2; }
+constexpr size_t Base64EncodedSize(size_t bytes) { return (bytes + 2) / 3 * 4; }
+// Upper bound of the decoded size of Base64 text (exact for unpadded input)
+constexpr size_t Base64DecodedMaxSize(size_t characters) { return characters / 4 * 3 + (characters % 4) * 3 / 4; }
+
+size_t EncodeHex(std::span<const uint8_t> data, char* out);
+void EncodeHex(std::span<const uint8_t> data, std::string& out);
+// text must have an even length; out receives text.size() / 2 bytes
+bool DecodeHex(std::string_view text, uint8_t* out, size_t* errorPosition = nullptr);
+
+size_t EncodeBase64(std::span<const uint8_t> data, char* out);
+void EncodeBase64(std::span<const uint8_t> data, std::string& out);
+// out needs Base64DecodedMaxSize(text.size()) bytes; written is the decoded size (on failure, the bytes of
+// the complete groups before the error)
+bool DecodeBase64(std::string_view text, uint8_t* out, size_t& written, size_t* errorPosition = nullptr);
+
+class PBase64Encoder
+{
+public:
+    // Room Feed needs for a chunk
+    static constexpr size_t MaxOutput(size_t chunkSize) { return (chunkSize + 2) / 3 * 4; }
+
+    // Encode the next chunk; returns the characters written to out
+    size_t Feed(std::span<const uint8_t> chunk, char* out);
+    // Encode the carried bytes with padding (at most 4 characters) and start over
+    size_t Finish(char* out);
+
+private:
+    uint8_t carry[2] = {};
+    size_t carried = 0;
+};
+
+class PHexDecoder
+{
+public:
+    static constexpr size_t MaxOutput(size_t chunkSize) { return chunkSize / 2 + 1; }
+
+    // Decode the next chunk; false at the first invalid digit (ErrorPosition), after writing the bytes before it
+    bool Feed(std::string_view chunk, uint8_t* out, size_t& written);
+    // False if an odd digit is left over; starts over either way
+    bool Finish();
+    // Offset of the invalid character in all the text fed so far
+    uint64_t ErrorPosition() const { return errorPosition; }
+
+private:
+    uint8_t high = 0;        // carried digit
+    bool carried = false;
+    bool failed = false;
+    uint64_t consumed = 0;   // characters fed so far
+    uint64_t errorPosition = 0;
+};
+
+class PBase64Decoder
+{
+public:
+    static constexpr size_t MaxOutput(size_t chunkSize) { return (chunkSize + 3) / 4 * 3; }
+
+    // Decode the next chunk; false at the first invalid character (ErrorPosition)
+    bool Feed(std::string_view chunk, uint8_t* out, size_t& written);
+    // Decode an unpadded final group (at most 2 bytes); false if one character is left over. Starts over.
+    bool Finish(uint8_t* out, size_t& written);
+    uint64_t ErrorPosition() const { return errorPosition; }
+
+private:
+    bool Fail(uint64_t position);
+
+    char carry[4] = {};
+    size_t carried = 0;
+    bool padded = false;     // a group with '=' ended the data
+    bool failed = false;
+    uint64_t consumed = 0;
+    uint64_t errorPosition = 0;
+};
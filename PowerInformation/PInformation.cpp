@@ -1,9 +1,9 @@
 // PInformation.cpp - Implements power profile and setting enumeration, retrieval, and modification.
 //
 // This file provides:
-// - Helper functions for string conversion and power setting name/description retrieval.
-// - PInformation class methods for enumerating power profiles and settings.
+// - PInformation class methods for enumerating power profiles and settings via PPowerBackend.
 // - Methods to get and set power setting values for specific profiles/settings.
+// - Name resolution through PSettingCatalog, so Get/Set no longer walk the whole store.
 //
 // Usage:
 //   - Enumerate all profiles and their settings.
@@ -11,278 +11,400 @@
 //
 #include "pch.h"
 #include "PInformation.h"
+#include "PGuid.h"
+#include "PParallel.h"
 
-// Helper function to read friendly name for a power setting
-static std::wstring ReadFriendlyName(const GUID* scheme, const GUID* subgroup, const GUID* setting)
+// Constructor: uses the platform default backend
+PInformation::PInformation()
+    : ownedBackend(CreateDefaultPowerBackend()), backend(ownedBackend.get())
 {
-    wchar_t buffer[512] = {};
-    DWORD bufSize = sizeof(buffer);
-    DWORD ret = PowerReadFriendlyName(NULL, scheme, subgroup, setting, (PUCHAR)buffer, &bufSize);
-    if (ret == ERROR_SUCCESS) return buffer;
-    return L"";
+    if (backend)
+        catalog = std::make_unique<PSettingCatalog>(*backend);
 }
 
-// Helper function to read description for a power setting
-static std::wstring ReadDescription(const GUID* scheme, const GUID* subgroup, const GUID* setting)
+// Constructor: uses a caller-owned backend
+PInformation::PInformation(PPowerBackend& backend)
+    : backend(&backend), catalog(std::make_unique<PSettingCatalog>(backend))
 {
-    wchar_t buffer[512] = {};
-    DWORD bufSize = sizeof(buffer);
-    DWORD ret = PowerReadDescription(NULL, scheme, subgroup, setting, (PUCHAR)buffer, &bufSize);
-    if (ret == ERROR_SUCCESS) return buffer;
-    return L"";
 }
 
-// Constructor
-PInformation::PInformation() {}
-
 // Destructor
 PInformation::~PInformation() {}
 
+// Friendly name of a scheme, falling back to its GUID string
+std::wstring PInformation::ReadSchemeName(const GUID& schemeGuid)
+{
+    std::wstring name;
+    backend->ReadFriendlyName(&schemeGuid, nullptr, nullptr, name);
+    if (name.empty())
+        name = GuidToString(schemeGuid);
+    return name;
+}
+
 // Get the friendly name of the currently active power profile
 std::wstring PInformation::GetDefaultPowerProfileName()
 {
-    USES_CONVERSION;
-    wil::unique_any<GUID*, decltype(&::LocalFree), ::LocalFree> pPwrGUID;
-    DWORD ret = PowerGetActiveScheme(NULL, pPwrGUID.put());
-    if (ret != ERROR_SUCCESS)
+    if (!backend) return std::wstring();
+    GUID active = {};
+    if (backend->GetActiveScheme(active) != ERROR_SUCCESS)
         return std::wstring();
 
-    UCHAR aBuffer[2048];
-    DWORD aBufferSize = sizeof(aBuffer);
-    ret = PowerReadFriendlyName(NULL, pPwrGUID.get(), &NO_SUBGROUP_GUID, NULL, aBuffer, &aBufferSize);
-    std::wstring friendlyName = (wchar_t*)aBuffer;
-    if (ret != ERROR_SUCCESS)
+    std::wstring friendlyName;
+    if (backend->ReadFriendlyName(&active, nullptr, nullptr, friendlyName) != ERROR_SUCCESS)
         return std::wstring();
     return friendlyName;
 }
 
-// Enumerate all settings and their AC/DC values for a given power scheme
-std::vector<SettingInfo> PInformation::EnumerateAllSettingsValues(const GUID* schemeGuid)
+// GUID of the active scheme
+bool PInformation::GetActiveSchemeGuid(GUID& outGuid)
 {
-    std::vector<SettingInfo> settingsList;
-    if (!schemeGuid) return settingsList;
-    DWORD subgroup_idx = 0;
+    return backend && backend->GetActiveScheme(outGuid) == ERROR_SUCCESS;
+}
+
+// Subgroup GUIDs of a scheme, in enumeration order
+std::vector<GUID> PInformation::EnumerateSubgroups(const GUID& schemeGuid)
+{
+    std::vector<GUID> subgroups;
     GUID subgroup_guid = {};
-    DWORD guid_size = sizeof(GUID);
-    while (ERROR_SUCCESS == PowerEnumerate(NULL, schemeGuid, NULL, ACCESS_SUBGROUP, subgroup_idx++, (UCHAR*)&subgroup_guid, &guid_size)) {
-        DWORD setting_idx = 0;
-        GUID setting_guid = {};
-        DWORD setting_guid_size = sizeof(GUID);
-        while (ERROR_SUCCESS == PowerEnumerate(NULL, schemeGuid, &subgroup_guid, ACCESS_INDIVIDUAL_SETTING, setting_idx++, (UCHAR*)&setting_guid, &setting_guid_size)) {
-            SettingInfo info;
-            info.name = ReadFriendlyName(schemeGuid, &subgroup_guid, &setting_guid);
-            info.description = ReadDescription(schemeGuid, &subgroup_guid, &setting_guid);
-            if (info.name.empty()) {
-                wchar_t setting_guid_str[64] = {};
-                if (StringFromGUID2(setting_guid, setting_guid_str, 64) > 0) {
-                    info.name = setting_guid_str;
-                } else {
-                    // Handle the error case if needed
-                    info.name = L"<invalid GUID>";
-                }
-            }
-            DWORD type = 0;
-            BYTE buffer[256] = {};
-            DWORD bufferSize = sizeof(buffer);
-            DWORD ret = PowerReadACValue(NULL, schemeGuid, &subgroup_guid, &setting_guid, &type, buffer, &bufferSize);
-            info.acValue = (ret == ERROR_SUCCESS) ? std::to_wstring(*(DWORD*)buffer) : L"<error>";
-            bufferSize = sizeof(buffer);
-            ret = PowerReadDCValue(NULL, schemeGuid, &subgroup_guid, &setting_guid, &type, buffer, &bufferSize);
-            info.dcValue = (ret == ERROR_SUCCESS) ? std::to_wstring(*(DWORD*)buffer) : L"<error>";
-            settingsList.push_back(info);
-        }
+    for (DWORD subgroup_idx = 0; backend->EnumerateSubgroup(schemeGuid, subgroup_idx, subgroup_guid) == ERROR_SUCCESS; subgroup_idx++)
+        subgroups.push_back(subgroup_guid);
+    return subgroups;
+}
+
+// Append the settings of one subgroup to settingsList
+void PInformation::EnumerateSubgroupSettings(const GUID& schemeGuid, const GUID& subgroupGuid, std::vector<SettingInfo>& settingsList)
+{
+    GUID setting_guid = {};
+    for (DWORD setting_idx = 0; backend->EnumerateSetting(schemeGuid, subgroupGuid, setting_idx, setting_guid) == ERROR_SUCCESS; setting_idx++) {
+        SettingInfo info;
+        backend->ReadFriendlyName(&schemeGuid, &subgroupGuid, &setting_guid, info.name);
+        backend->ReadDescription(&schemeGuid, &subgroupGuid, &setting_guid, info.description);
+        if (info.name.empty())
+            info.name = GuidToString(setting_guid);
+        DWORD type = 0;
+        DWORD value = 0;
+        DWORD ret = backend->ReadValue(schemeGuid, subgroupGuid, setting_guid, true, type, value);
+        info.acValue = (ret == ERROR_SUCCESS) ? std::to_wstring(value) : L"<error>";
+        ret = backend->ReadValue(schemeGuid, subgroupGuid, setting_guid, false, type, value);
+        info.dcValue = (ret == ERROR_SUCCESS) ? std::to_wstring(value) : L"<error>";
+        settingsList.push_back(std::move(info));
     }
+}
+
+// Enumerate all settings and their AC/DC values for a given power scheme
+std::vector<SettingInfo> PInformation::EnumerateAllSettingsValues(const GUID* schemeGuid, unsigned threadCount)
+{
+    std::vector<SettingInfo> settingsList;
+    if (!schemeGuid || !backend) return settingsList;
+    std::vector<GUID> subgroups = EnumerateSubgroups(*schemeGuid);
+
+    // One slot per subgroup, concatenated in enumeration order afterwards
+    std::vector<std::vector<SettingInfo>> perSubgroup(subgroups.size());
+    ParallelFor(subgroups.size(), threadCount, [&](size_t i) {
+        EnumerateSubgroupSettings(*schemeGuid, subgroups[i], perSubgroup[i]);
+    });
+    for (auto& part : perSubgroup)
+        std::move(part.begin(), part.end(), std::back_inserter(settingsList));
     return settingsList;
 }
 
 // Enumerate all power profiles and their settings
-std::map<std::wstring, std::vector<SettingInfo>> PInformation::PowerEnumerateProfiles()
+std::map<std::wstring, std::vector<SettingInfo>> PInformation::PowerEnumerateProfiles(unsigned threadCount)
 {
     std::map<std::wstring, std::vector<SettingInfo>> profileSettingsMap;
+    if (!backend) return profileSettingsMap;
+
+    std::vector<GUID> schemes;
     DWORD scheme_idx = 0;
     while (true)
     {
         GUID scheme_guid = {};
-        DWORD guid_size = sizeof(GUID);
-        DWORD status = PowerEnumerate(nullptr, nullptr, nullptr, ACCESS_SCHEME, scheme_idx, (UCHAR*)&scheme_guid, &guid_size);
+        DWORD status = backend->EnumerateScheme(scheme_idx, scheme_guid);
         if (status == ERROR_NO_MORE_ITEMS)
             break;
-        if (status != ERROR_SUCCESS)
-        {
-            scheme_idx++;
-            continue;
-        }
-        wchar_t wszName[512] = {};
-        DWORD dwLen = 511;
-        DWORD dwRet = PowerReadFriendlyName(nullptr, &scheme_guid, nullptr, nullptr, (PUCHAR)wszName, &dwLen);
-        std::wstring profileName = (dwRet == ERROR_SUCCESS) ? wszName : L"";
-        if (profileName.empty()) {
-            wchar_t scheme_guid_str[64] = {};
-            if (StringFromGUID2(scheme_guid, scheme_guid_str, 64) > 0) {
-                profileName = scheme_guid_str;
-            } else {
-                profileName = L"<invalid GUID>";
-            }
-        }
-        std::vector<SettingInfo> settings = EnumerateAllSettingsValues(&scheme_guid);
-        profileSettingsMap[profileName] = settings;
+        if (status == ERROR_SUCCESS)
+            schemes.push_back(scheme_guid);
         scheme_idx++;
     }
+
+    // First fan-out: scheme names and subgroup lists
+    std::vector<std::wstring> schemeNames(schemes.size());
+    std::vector<std::vector<GUID>> schemeSubgroups(schemes.size());
+    ParallelFor(schemes.size(), threadCount, [&](size_t i) {
+        schemeNames[i] = ReadSchemeName(schemes[i]);
+        schemeSubgroups[i] = EnumerateSubgroups(schemes[i]);
+    });
+
+    // Second fan-out: one task per (scheme, subgroup)
+    struct SubgroupTask {
+        size_t scheme;
+        GUID subgroup;
+    };
+    std::vector<SubgroupTask> tasks;
+    for (size_t i = 0; i < schemes.size(); i++)
+        for (const GUID& subgroup : schemeSubgroups[i])
+            tasks.push_back({ i, subgroup });
+    std::vector<std::vector<SettingInfo>> results(tasks.size());
+    ParallelFor(tasks.size(), threadCount, [&](size_t i) {
+        EnumerateSubgroupSettings(schemes[tasks[i].scheme], tasks[i].subgroup, results[i]);
+    });
+
+    // Merge in enumeration order; a later scheme with the same name replaces an earlier one, as before
+    size_t task = 0;
+    for (size_t i = 0; i < schemes.size(); i++) {
+        std::vector<SettingInfo> settings;
+        for (size_t n = 0; n < schemeSubgroups[i].size(); n++, task++)
+            std::move(results[task].begin(), results[task].end(), std::back_inserter(settings));
+        profileSettingsMap[schemeNames[i]] = std::move(settings);
+    }
     return profileSettingsMap;
 }
 
-// Helper to resolve name and description for a power scheme
-void PInformation::resolveNameAndDescForPowerScheme(power_scheme_s& scheme, std::map<std::wstring, SettingInfo>& powerProfiles)
+// Stream settings one at a time; name, description and profile buffers are reused across settings
+bool PInformation::VisitSettings(PSettingVisitor& visitor, const GUID* schemeGuid, unsigned threadCount)
 {
-    DWORD dwLen = 511;
-    wchar_t wszName[512] = {};
-    DWORD dwRet = PowerReadFriendlyName(nullptr,
-                                        &scheme.uid,
-                                        nullptr, nullptr,
-                                        (PUCHAR)wszName,
-                                        &dwLen);
-    if (dwRet == ERROR_MORE_DATA)
-    {
-        return;
-    }
-    else if (dwRet == ERROR_SUCCESS)
-    {
-        wchar_t wszDesc[512] = {};
-        dwLen = 511;
-        dwRet = PowerReadDescription(nullptr,
-                                     &scheme.uid,
-                                     nullptr, nullptr,
-                                     (PUCHAR)wszDesc,
-                                     &dwLen);
-        if (dwRet == ERROR_MORE_DATA)
-        {
-            return;
-        }
-        else if (dwRet == ERROR_SUCCESS)
-        {
-            SettingInfo info;
-            info.name = wszName;
-            info.description = wszDesc;
-            powerProfiles[wszName] = info;
+    if (!backend) return true;
+    if (threadCount > 1)
+        return VisitSettingsParallel(visitor, schemeGuid, threadCount);
+    std::wstring profileName;
+    std::wstring name;
+    std::wstring description;
+    PSettingView view = {};
+    const bool values = visitor.WantsValues();
+
+    GUID scheme_guid = {};
+    for (DWORD scheme_idx = 0;; scheme_idx++) {
+        DWORD status = backend->EnumerateScheme(scheme_idx, scheme_guid);
+        if (status == ERROR_NO_MORE_ITEMS)
+            break;
+        if (status != ERROR_SUCCESS || (schemeGuid && !(scheme_guid == *schemeGuid)))
+            continue;
+
+        backend->ReadFriendlyName(&scheme_guid, nullptr, nullptr, profileName);
+        if (profileName.empty())
+            profileName = GuidToString(scheme_guid);
+        if (!visitor.OnScheme(scheme_guid, profileName))
+            continue;
+
+        GUID subgroup_guid = {};
+        for (DWORD subgroup_idx = 0; backend->EnumerateSubgroup(scheme_guid, subgroup_idx, subgroup_guid) == ERROR_SUCCESS; subgroup_idx++) {
+            GUID setting_guid = {};
+            for (DWORD setting_idx = 0; backend->EnumerateSetting(scheme_guid, subgroup_guid, setting_idx, setting_guid) == ERROR_SUCCESS; setting_idx++) {
+                backend->ReadFriendlyName(&scheme_guid, &subgroup_guid, &setting_guid, name);
+                if (name.empty())
+                    name = GuidToString(setting_guid);
+                if (!visitor.Accept(setting_guid, name))
+                    continue;
+
+                backend->ReadDescription(&scheme_guid, &subgroup_guid, &setting_guid, description);
+                DWORD type = 0;
+                view.scheme = scheme_guid;
+                view.subgroup = subgroup_guid;
+                view.setting = setting_guid;
+                view.profileName = profileName;
+                view.name = name;
+                view.description = description;
+                view.acOk = values && backend->ReadValue(scheme_guid, subgroup_guid, setting_guid, true, type, view.acValue) == ERROR_SUCCESS;
+                view.dcOk = values && backend->ReadValue(scheme_guid, subgroup_guid, setting_guid, false, type, view.dcValue) == ERROR_SUCCESS;
+                if (!visitor.OnSetting(view))
+                    return false;
+            }
         }
     }
+    return true;
 }
 
-// Set a power setting value for a specific profile and setting
-bool PInformation::SetPowerSettingValue(const std::wstring& profileName, const std::wstring& settingName, DWORD value, bool ac)
+// Per scheme: fan out the setting names by subgroup, filter serially, fan out the description and value
+// reads of the accepted settings, then report them in enumeration order
+bool PInformation::VisitSettingsParallel(PSettingVisitor& visitor, const GUID* schemeGuid, unsigned threadCount)
 {
-    // Find profile GUID
-    int scheme_idx = 0;
+    struct Item {
+        GUID subgroup;
+        GUID setting;
+        std::wstring name;
+        std::wstring description;
+        DWORD acValue;
+        DWORD dcValue;
+        bool acOk;
+        bool dcOk;
+    };
+    std::vector<std::vector<Item>> perSubgroup;
+    std::vector<Item*> accepted;
+    const bool values = visitor.WantsValues();
+
     GUID scheme_guid = {};
-    DWORD guid_size = sizeof(GUID);
-    while (ERROR_SUCCESS == PowerEnumerate(nullptr, nullptr, nullptr, ACCESS_SCHEME, scheme_idx++, (UCHAR*)&scheme_guid, &guid_size)) {
-        wchar_t wszName[512] = {};
-        DWORD dwLen = 511;
-        DWORD dwRet = PowerReadFriendlyName(nullptr, &scheme_guid, nullptr, nullptr, (PUCHAR)wszName, &dwLen);
-        std::wstring foundProfile = (dwRet == ERROR_SUCCESS) ? wszName : L"";
-        if (foundProfile.empty()) {
-            wchar_t scheme_guid_str[64] = {};
-            if (StringFromGUID2(scheme_guid, scheme_guid_str, 64) > 0) {
-                foundProfile = scheme_guid_str;
-            } else {
-                foundProfile = L"<invalid GUID>";
+    for (DWORD scheme_idx = 0;; scheme_idx++) {
+        DWORD status = backend->EnumerateScheme(scheme_idx, scheme_guid);
+        if (status == ERROR_NO_MORE_ITEMS)
+            break;
+        if (status != ERROR_SUCCESS || (schemeGuid && !(scheme_guid == *schemeGuid)))
+            continue;
+
+        std::wstring profileName = ReadSchemeName(scheme_guid);
+        if (!visitor.OnScheme(scheme_guid, profileName))
+            continue;
+
+        std::vector<GUID> subgroups = EnumerateSubgroups(scheme_guid);
+        perSubgroup.assign(subgroups.size(), {});
+        ParallelFor(subgroups.size(), threadCount, [&](size_t i) {
+            Item item = {};
+            item.subgroup = subgroups[i];
+            for (DWORD setting_idx = 0; backend->EnumerateSetting(scheme_guid, item.subgroup, setting_idx, item.setting) == ERROR_SUCCESS; setting_idx++) {
+                backend->ReadFriendlyName(&scheme_guid, &item.subgroup, &item.setting, item.name);
+                if (item.name.empty())
+                    item.name = GuidToString(item.setting);
+                perSubgroup[i].push_back(item);
             }
-        }
-        if (foundProfile == profileName) {
-            // Find setting GUID
-            DWORD subgroup_idx = 0;
-            GUID subgroup_guid = {};
-            DWORD subgroup_guid_size = sizeof(GUID);
-            while (ERROR_SUCCESS == PowerEnumerate(nullptr, &scheme_guid, nullptr, ACCESS_SUBGROUP, subgroup_idx++, (UCHAR*)&subgroup_guid, &subgroup_guid_size)) {
-                DWORD setting_idx = 0;
-                GUID setting_guid = {};
-                DWORD setting_guid_size = sizeof(GUID);
-                while (ERROR_SUCCESS == PowerEnumerate(nullptr, &scheme_guid, &subgroup_guid, ACCESS_INDIVIDUAL_SETTING, setting_idx++, (UCHAR*)&setting_guid, &setting_guid_size)) {
-                    std::wstring foundSetting = ReadFriendlyName(&scheme_guid, &subgroup_guid, &setting_guid);
-                    if (foundSetting.empty()) {
-                        wchar_t setting_guid_str[64] = {};
-                        if (StringFromGUID2(setting_guid, setting_guid_str, 64) > 0) {
-                            foundSetting = setting_guid_str;
-                        } else {
-                            foundSetting = L"<invalid GUID>";
-                        }
-                    }
-                    if (foundSetting == settingName) {
-                        // Set value for AC or DC
-                        DWORD ret;
-                        if (ac)
-                            ret = PowerWriteACValueIndex(nullptr, &scheme_guid, &subgroup_guid, &setting_guid, value);
-                        else
-                            ret = PowerWriteDCValueIndex(nullptr, &scheme_guid, &subgroup_guid, &setting_guid, value);
-                        PowerSetActiveScheme(nullptr, &scheme_guid);
-                        return ret == ERROR_SUCCESS;
-                    }
-                }
+        });
+
+        accepted.clear();
+        for (auto& items : perSubgroup) {
+            for (Item& item : items) {
+                if (visitor.Accept(item.setting, item.name))
+                    accepted.push_back(&item);
             }
         }
-        scheme_guid = {};
-        guid_size = sizeof(GUID);
+
+        ParallelFor(accepted.size(), threadCount, [&](size_t i) {
+            Item& item = *accepted[i];
+            DWORD type = 0;
+            backend->ReadDescription(&scheme_guid, &item.subgroup, &item.setting, item.description);
+            item.acOk = values && backend->ReadValue(scheme_guid, item.subgroup, item.setting, true, type, item.acValue) == ERROR_SUCCESS;
+            item.dcOk = values && backend->ReadValue(scheme_guid, item.subgroup, item.setting, false, type, item.dcValue) == ERROR_SUCCESS;
+        });
+
+        for (const Item* item : accepted) {
+            PSettingView view = { scheme_guid, item->subgroup, item->setting, profileName, item->name, item->description,
+                                  item->acValue, item->dcValue, item->acOk, item->dcOk };
+            if (!visitor.OnSetting(view))
+                return false;
+        }
     }
-    return false;
+    return true;
+}
+
+// Helper to resolve name and description for a power scheme
+void PInformation::resolveNameAndDescForPowerScheme(power_scheme_s& scheme, std::map<std::wstring, SettingInfo>& powerProfiles)
+{
+    if (!backend) return;
+    std::wstring name;
+    if (backend->ReadFriendlyName(&scheme.uid, nullptr, nullptr, name) != ERROR_SUCCESS)
+        return;
+    std::wstring description;
+    if (backend->ReadDescription(&scheme.uid, nullptr, nullptr, description) != ERROR_SUCCESS)
+        return;
+    SettingInfo info;
+    info.name = name;
+    info.description = description;
+    powerProfiles[name] = info;
+}
+
+// Set a power setting value for a specific profile and setting
+bool PInformation::SetPowerSettingValue(const std::wstring& profileName, const std::wstring& settingName, DWORD value, bool ac)
+{
+    PSettingLocation location;
+    if (!catalog || !catalog->Find(profileName, settingName, location))
+        return false;
+    DWORD ret = backend->WriteValueIndex(location.scheme, location.subgroup, location.setting, ac, value);
+    backend->SetActiveScheme(location.scheme);
+    return ret == ERROR_SUCCESS;
 }
 
 // Get a power setting value for a specific profile and setting
 bool PInformation::GetPowerSettingValue(const std::wstring& profileName, const std::wstring& settingName, bool ac, DWORD& outValue)
 {
-    int scheme_idx = 0;
-    GUID scheme_guid = {};
-    DWORD guid_size = sizeof(GUID);
-    while (ERROR_SUCCESS == PowerEnumerate(nullptr, nullptr, nullptr, ACCESS_SCHEME, scheme_idx++, (UCHAR*)&scheme_guid, &guid_size)) {
-        wchar_t wszName[512] = {};
-        DWORD dwLen = 511;
-        DWORD dwRet = PowerReadFriendlyName(nullptr, &scheme_guid, nullptr, nullptr, (PUCHAR)wszName, &dwLen);
-        std::wstring foundProfile = (dwRet == ERROR_SUCCESS) ? wszName : L"";
-        if (foundProfile.empty()) {
-            wchar_t scheme_guid_str[64] = {};
-            if (StringFromGUID2(scheme_guid, scheme_guid_str, 64) > 0) {
-                foundProfile = scheme_guid_str;
-            } else {
-                foundProfile = L"<invalid GUID>";
-            }
+    PSettingLocation location;
+    if (!catalog || !catalog->Find(profileName, settingName, location))
+        return false;
+    DWORD type = 0;
+    DWORD value = 0;
+    if (backend->ReadValue(location.scheme, location.subgroup, location.setting, ac, type, value) != ERROR_SUCCESS)
+        return false;
+    outValue = value;
+    return true;
+}
+
+// Apply a batch of writes as one transaction with a single activation per scheme
+PSetResult PInformation::SetPowerSettingValues(const std::vector<PSettingWrite>& writes)
+{
+    if (!catalog) return PSetResult::NotApplied;
+
+    // Resolve every name before anything is written
+    struct PendingWrite {
+        PSettingLocation location;
+        bool ac;
+        DWORD value;
+        DWORD previous;
+        bool restorable;
+    };
+    std::vector<PendingWrite> pending;
+    pending.reserve(writes.size());
+    for (const auto& write : writes) {
+        PendingWrite entry = { {}, write.ac, write.value, 0, false };
+        if (!catalog->Find(write.profileName, write.settingName, entry.location))
+            return PSetResult::NotApplied;
+        pending.push_back(entry);
+    }
+
+    for (size_t i = 0; i < pending.size(); i++) {
+        PendingWrite& entry = pending[i];
+        // Only a write that a later failure would undo needs its old value; the last one never does
+        if (i + 1 < pending.size()) {
+            DWORD type = 0;
+            entry.restorable = backend->ReadValue(entry.location.scheme, entry.location.subgroup, entry.location.setting,
+                                                  entry.ac, type, entry.previous) == ERROR_SUCCESS;
         }
-        if (foundProfile == profileName) {
-            DWORD subgroup_idx = 0;
-            GUID subgroup_guid = {};
-            DWORD subgroup_guid_size = sizeof(GUID);
-            while (ERROR_SUCCESS == PowerEnumerate(nullptr, &scheme_guid, nullptr, ACCESS_SUBGROUP, subgroup_idx++, (UCHAR*)&subgroup_guid, &subgroup_guid_size)) {
-                DWORD setting_idx = 0;
-                GUID setting_guid = {};
-                DWORD setting_guid_size = sizeof(GUID);
-                while (ERROR_SUCCESS == PowerEnumerate(nullptr, &scheme_guid, &subgroup_guid, ACCESS_INDIVIDUAL_SETTING, setting_idx++, (UCHAR*)&setting_guid, &setting_guid_size)) {
-                    std::wstring foundSetting = ReadFriendlyName(&scheme_guid, &subgroup_guid, &setting_guid);
-                    if (foundSetting.empty()) {
-                        wchar_t setting_guid_str[64] = {};
-                        if (StringFromGUID2(setting_guid, setting_guid_str, 64) > 0) {
-                            foundSetting = setting_guid_str;
-                        } else {
-                            foundSetting = L"<invalid GUID>";
-                        }
-                    }
-                    if (foundSetting == settingName) {
-                        DWORD type = 0;
-                        BYTE buffer[256] = {};
-                        DWORD bufferSize = sizeof(buffer);
-                        DWORD ret;
-                        if (ac)
-                            ret = PowerReadACValue(nullptr, &scheme_guid, &subgroup_guid, &setting_guid, &type, buffer, &bufferSize);
-                        else
-                            ret = PowerReadDCValue(nullptr, &scheme_guid, &subgroup_guid, &setting_guid, &type, buffer, &bufferSize);
-                        if (ret == ERROR_SUCCESS) {
-                            outValue = *(DWORD*)buffer;
-                            return true;
-                        }
-                        return false;
-                    }
-                }
+        if (backend->WriteValueIndex(entry.location.scheme, entry.location.subgroup, entry.location.setting, entry.ac, entry.value) != ERROR_SUCCESS) {
+            // Roll back in reverse so repeated writes to one setting end at the original value
+            bool restored = true;
+            while (i-- > 0) {
+                const PendingWrite& undo = pending[i];
+                if (!undo.restorable ||
+                    backend->WriteValueIndex(undo.location.scheme, undo.location.subgroup, undo.location.setting, undo.ac, undo.previous) != ERROR_SUCCESS)
+                    restored = false;
             }
+            return restored ? PSetResult::NotApplied : PSetResult::PartlyApplied;
         }
-        scheme_guid = {};
-        guid_size = sizeof(GUID);
     }
-    return false;
-}
\ No newline at end of file
+
+    // Activate each affected scheme once, ordered by its last write so the same scheme ends up
+    // active as when the writes were made one by one
+    std::vector<GUID> schemesToActivate;
+    for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+        if (std::find(schemesToActivate.begin(), schemesToActivate.end(), it->location.scheme) == schemesToActivate.end())
+            schemesToActivate.push_back(it->location.scheme);
+    }
+    PSetResult result = PSetResult::Applied;
+    for (auto it = schemesToActivate.rbegin(); it != schemesToActivate.rend(); ++it) {
+        if (backend->SetActiveScheme(*it) != ERROR_SUCCESS)
+            result = PSetResult::NotActivated;
+    }
+    return result;
+}
+
+// Read a batch of values; each entry reports its own success
+void PInformation::GetPowerSettingValues(std::vector<PSettingRead>& reads)
+{
+    for (auto& read : reads) {
+        read.ok = false;
+        PSettingLocation location;
+        read.found = catalog && catalog->Find(read.profileName, read.settingName, location);
+        if (!read.found)
+            continue;
+        DWORD type = 0;
+        read.ok = backend->ReadValue(location.scheme, location.subgroup, location.setting, read.ac, type, read.value) == ERROR_SUCCESS;
+    }
+}
+
+// Find the scheme GUID for a profile name
+bool PInformation::FindProfileGuid(const std::wstring& profileName, GUID& outGuid)
+{
+    return catalog && catalog->FindScheme(profileName, outGuid);
+}
+
+// Force the name -> GUID catalog to be rebuilt on next use
+void PInformation::InvalidateCatalog()
+{
+    if (catalog)
+        catalog->Invalidate();
+}
@@ -3,15 +3,22 @@
 // Types:
 //   - power_scheme_s: Holds GUID and name/description for a power scheme.
 //   - SettingInfo: Holds name, description, AC/DC values for a power setting.
+//   - PSettingView/PSettingVisitor: Streaming access to settings without materialized copies.
 //
 // PInformation class:
-//   - Enumerates power profiles and settings.
-//   - Gets/sets power setting values for specific profiles/settings.
+//   - Enumerates power profiles and settings through a PPowerBackend, serially or in parallel.
+//   - Streams settings to a PSettingVisitor with early filtering/termination.
+//   - Gets/sets power setting values for specific profiles/settings, singly or in batches.
+//   - Resolves profile/setting names through a PSettingCatalog built once and reused.
 //
 #pragma once
 #include <vector>
 #include <map>
+#include <memory>
 #include <string>
+#include <string_view>
+#include "PPowerBackend.h"
+#include "PSettingCatalog.h"
 
 // Structure for power scheme information
 struct power_scheme_s {
@@ -28,22 +35,114 @@ struct SettingInfo {
     std::wstring dcValue;
 };
 
+// One write in a batch: profile/setting by name, AC or DC, new value index
+struct PSettingWrite {
+    std::wstring profileName;
+    std::wstring settingName;
+    bool ac;
+    DWORD value;
+};
+
+// Outcome of a batch of writes
+enum class PSetResult {
+    Applied,       // every value written and each affected scheme activated
+    NotActivated,  // every value written, but activating a scheme failed
+    NotApplied,    // nothing changed: a name did not resolve, or a write failed and the earlier ones were restored
+    PartlyApplied, // a write failed and some earlier writes could not be restored
+};
+
+// One read in a batch: filled in with the value, whether the names resolved and whether the read succeeded
+struct PSettingRead {
+    std::wstring profileName;
+    std::wstring settingName;
+    bool ac;
+    DWORD value = 0;
+    bool ok = false;
+    bool found = false;
+};
+
+// One setting as seen by a PSettingVisitor; views are only valid during the callback
+struct PSettingView {
+    GUID scheme;
+    GUID subgroup;
+    GUID setting;
+    std::wstring_view profileName;
+    std::wstring_view name;
+    std::wstring_view description;
+    DWORD acValue;
+    DWORD dcValue;
+    bool acOk;
+    bool dcOk;
+};
+
+// Streaming consumer for PInformation::VisitSettings
+class PSettingVisitor
+{
+public:
+    virtual ~PSettingVisitor() = default;
+    // Called when a scheme starts; return false to skip the whole scheme
+    virtual bool OnScheme(const GUID& /*scheme*/, std::wstring_view /*profileName*/) { return true; }
+    // Called with only the setting name; return false to skip it before its description and values are read
+    virtual bool Accept(const GUID& /*setting*/, std::wstring_view /*name*/) { return true; }
+    // Called for every accepted setting; return false to stop the enumeration
+    virtual bool OnSetting(const PSettingView& setting) = 0;
+    // Return false if OnSetting only uses names and descriptions: values are then not read (acOk/dcOk false)
+    virtual bool WantsValues() const { return true; }
+};
+
 // Main class for power profile/setting management
 class PInformation
 {
 public:
-    PInformation();
+    PInformation();                                 // uses the platform default backend
+    explicit PInformation(PPowerBackend& backend);  // uses a caller-owned backend (e.g. PFakePowerBackend)
     ~PInformation();
 
     std::wstring GetDefaultPowerProfileName();
-    std::map<std::wstring, std::vector<SettingInfo>> PowerEnumerateProfiles(); // profile name -> settings
-    std::vector<SettingInfo> EnumerateAllSettingsValues(const GUID* schemeGuid); // settings for a given profile
+    // GUID of the active scheme
+    bool GetActiveSchemeGuid(GUID& outGuid);
+    // threadCount > 1 splits the reads by scheme and subgroup across a bounded pool;
+    // results are merged in enumeration order, so the output is identical to the serial walk
+    std::map<std::wstring, std::vector<SettingInfo>> PowerEnumerateProfiles(unsigned threadCount = 1); // profile name -> settings
+    std::vector<SettingInfo> EnumerateAllSettingsValues(const GUID* schemeGuid, unsigned threadCount = 1); // settings for a given profile
+    // Stream settings one at a time in enumeration order without materializing them.
+    // Restrict to one scheme with schemeGuid. Returns false if the visitor stopped early.
+    // threadCount > 1 reads each scheme's names, then the accepted settings' descriptions and values,
+    // across a bounded pool; callbacks still run on the calling thread in enumeration order, but all
+    // Accept calls of a scheme come before its OnSetting calls.
+    bool VisitSettings(PSettingVisitor& visitor, const GUID* schemeGuid = nullptr, unsigned threadCount = 1);
     void resolveNameAndDescForPowerScheme(power_scheme_s& scheme, std::map<std::wstring, SettingInfo>& powerProfiles);
 
     // Set a power setting value for a specific profile/setting
     bool SetPowerSettingValue(const std::wstring& profileName, const std::wstring& settingName, DWORD value, bool ac); // ac=true for AC, false for DC
     // Get a power setting value for a specific profile/setting
     bool GetPowerSettingValue(const std::wstring& profileName, const std::wstring& settingName, bool ac, DWORD& outValue);
-};
 
+    // Apply a batch of writes as one transaction:
+    //   - every name is resolved first; if any fails nothing is written,
+    //   - if a write fails the writes already made are restored, in reverse order; a write whose old
+    //     value could not be read is still made but cannot be restored,
+    //   - each affected scheme is activated once at the end.
+    PSetResult SetPowerSettingValues(const std::vector<PSettingWrite>& writes);
+    // Read a batch of values; each entry reports its own success
+    void GetPowerSettingValues(std::vector<PSettingRead>& reads);
+
+    // Find the scheme GUID for a profile name
+    bool FindProfileGuid(const std::wstring& profileName, GUID& outGuid);
+    // Force the name -> GUID catalog to be rebuilt on next use
+    void InvalidateCatalog();
 
+private:
+    // Friendly name of a scheme, falling back to its GUID string
+    std::wstring ReadSchemeName(const GUID& schemeGuid);
+    // Subgroup GUIDs of a scheme, in enumeration order
+    std::vector<GUID> EnumerateSubgroups(const GUID& schemeGuid);
+    // Append the settings of one subgroup to settingsList
+    void EnumerateSubgroupSettings(const GUID& schemeGuid, const GUID& subgroupGuid, std::vector<SettingInfo>& settingsList);
+    // VisitSettings with threadCount > 1
+    bool VisitSettingsParallel(PSettingVisitor& visitor, const GUID* schemeGuid, unsigned threadCount);
+
+    std::unique_ptr<PPowerBackend> ownedBackend;
+    PPowerBackend* backend = nullptr;
+    std::unique_ptr<PSettingCatalog> catalog;
+};
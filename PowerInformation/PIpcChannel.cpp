@@ -0,0 +1,400 @@
+// PIpcChannel.cpp - Implements the Unix domain socket (Linux) and named pipe (Windows) transport.
+//
+#include "pch.h"
+#include "PIpcChannel.h"
+#include "PUtf8.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <climits>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+#ifdef _WIN32
+
+// Default endpoint
+std::wstring DefaultIpcEndpoint()
+{
+    return L"\\\\.\\pipe\\PowerInformation";
+}
+
+// Pipes are machine-wide: one name for every user
+std::vector<std::wstring> DefaultClientIpcEndpoints()
+{
+    return { DefaultIpcEndpoint() };
+}
+
+bool IsSystemIpcEndpoint(const std::wstring& endpoint)
+{
+    return endpoint == DefaultIpcEndpoint();
+}
+
+// Pipe names have no directory
+bool IsPrivateIpcDirectory(const std::wstring& /*directory*/)
+{
+    return false;
+}
+
+// User of a process token, as a TOKEN_USER in buffer
+static bool ProcessUser(HANDLE process, std::vector<BYTE>& buffer)
+{
+    HANDLE token = nullptr;
+    if (!OpenProcessToken(process, TOKEN_QUERY, &token))
+        return false;
+    DWORD size = 0;
+    GetTokenInformation(token, TokenUser, nullptr, 0, &size);
+    buffer.resize(size);
+    bool ok = size != 0 && GetTokenInformation(token, TokenUser, buffer.data(), size, &size);
+    CloseHandle(token);
+    return ok;
+}
+
+// Destructor
+PIpcConnection::~PIpcConnection()
+{
+    if (pipe != INVALID_HANDLE_VALUE)
+        CloseHandle(pipe);
+    if (readEvent)
+        CloseHandle(readEvent);
+}
+
+// Read; server pipes are overlapped, so every call goes through an OVERLAPPED and waits for it
+size_t PIpcConnection::Read(char* buffer, size_t size)
+{
+    if (!readEvent && !(readEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr)))
+        return 0;
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = readEvent;
+    DWORD read = 0;
+    if (!ReadFile(pipe, buffer, static_cast<DWORD>(size), &read, &overlapped)) {
+        if (GetLastError() != ERROR_IO_PENDING || !GetOverlappedResult(pipe, &overlapped, &read, TRUE))
+            return 0;
+    }
+    return read;
+}
+
+// Write everything
+bool PIpcConnection::Write(std::string_view data)
+{
+    HANDLE event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!event)
+        return false;
+    bool ok = true;
+    while (ok && !data.empty()) {
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = event;
+        DWORD written = 0;
+        if (!WriteFile(pipe, data.data(), static_cast<DWORD>(data.size()), &written, &overlapped) &&
+            (GetLastError() != ERROR_IO_PENDING || !GetOverlappedResult(pipe, &overlapped, &written, TRUE)))
+            ok = false;
+        data.remove_prefix(written);
+    }
+    CloseHandle(event);
+    return ok;
+}
+
+// Cancel pending I/O on the pipe
+void PIpcConnection::Shutdown()
+{
+    CancelIoEx(pipe, nullptr);
+    DisconnectNamedPipe(pipe);
+}
+
+// Compare the user SID of the client process with ours; any failure counts as another user
+bool PIpcConnection::PeerIsOwner() const
+{
+    ULONG clientId = 0;
+    if (!GetNamedPipeClientProcessId(pipe, &clientId))
+        return false;
+    HANDLE client = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, clientId);
+    if (!client)
+        return false;
+    std::vector<BYTE> peer, own;
+    bool same = ProcessUser(client, peer) && ProcessUser(GetCurrentProcess(), own) &&
+                EqualSid(reinterpret_cast<TOKEN_USER*>(peer.data())->User.Sid, reinterpret_cast<TOKEN_USER*>(own.data())->User.Sid);
+    CloseHandle(client);
+    return same;
+}
+
+// Destructor
+PIpcListener::~PIpcListener()
+{
+    Close();
+}
+
+// One overlapped, byte-mode, local-only pipe instance
+HANDLE PIpcListener::CreateInstance(bool first)
+{
+    DWORD openMode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | (first ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0);
+    return CreateNamedPipeW(endpoint.c_str(), openMode, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                            PIPE_UNLIMITED_INSTANCES, 64 * 1024, 64 * 1024, 0, nullptr);
+}
+
+// Create the first pipe instance; FILE_FLAG_FIRST_PIPE_INSTANCE fails if another server owns the name
+bool PIpcListener::Open(const std::wstring& name, bool /*shared*/)
+{
+    Close();
+    endpoint = name;
+    connectEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    pending = CreateInstance(true);
+    if (!connectEvent || pending == INVALID_HANDLE_VALUE) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+// Stop listening
+void PIpcListener::Close()
+{
+    if (pending != INVALID_HANDLE_VALUE) {
+        if (connecting)
+            CancelIoEx(pending, &connect);
+        CloseHandle(pending);
+    }
+    if (connectEvent)
+        CloseHandle(connectEvent);
+    pending = INVALID_HANDLE_VALUE;
+    connectEvent = nullptr;
+    connecting = false;
+}
+
+// Wait for a client on the pending instance, then hand it out and create the next instance
+std::unique_ptr<PIpcConnection> PIpcListener::Accept(std::chrono::milliseconds timeout)
+{
+    if (pending == INVALID_HANDLE_VALUE)
+        return nullptr;
+    if (!connecting) {
+        connect = {};
+        connect.hEvent = connectEvent;
+        ResetEvent(connectEvent);
+        if (ConnectNamedPipe(pending, &connect) || GetLastError() == ERROR_PIPE_CONNECTED) {
+            SetEvent(connectEvent);
+        } else if (GetLastError() != ERROR_IO_PENDING) {
+            return nullptr;
+        }
+        connecting = true;
+    }
+    if (WaitForSingleObject(connectEvent, static_cast<DWORD>(std::min<long long>(timeout.count(), INFINITE - 1))) != WAIT_OBJECT_0)
+        return nullptr;
+    connecting = false;
+    DWORD unused = 0;
+    HANDLE client = pending;
+    pending = CreateInstance(false);
+    if (!GetOverlappedResult(client, &connect, &unused, FALSE) && GetLastError() != ERROR_PIPE_CONNECTED) {
+        CloseHandle(client);
+        return nullptr;
+    }
+    return std::make_unique<PIpcConnection>(client);
+}
+
+// Open the pipe, waiting briefly if every instance is busy
+std::unique_ptr<PIpcConnection> ConnectIpc(const std::wstring& endpoint)
+{
+    for (int attempt = 0; attempt < 2; attempt++) {
+        HANDLE pipe = CreateFileW(endpoint.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+        if (pipe != INVALID_HANDLE_VALUE)
+            return std::make_unique<PIpcConnection>(pipe);
+        if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeW(endpoint.c_str(), 1000))
+            break;
+    }
+    return nullptr;
+}
+
+#else
+
+static const wchar_t* SystemEndpoint = L"/run/PowerInformation.sock";
+
+// Directory in /tmp for users without XDG_RUNTIME_DIR
+static std::string FallbackIpcDirectory()
+{
+    return "/tmp/PowerInformation-" + std::to_string(geteuid());
+}
+
+// Per-user runtime directory; XDG_RUNTIME_DIR is owner-only by specification
+static std::wstring UserIpcEndpoint()
+{
+    const char* runtime = getenv("XDG_RUNTIME_DIR");
+    std::string path = runtime && *runtime ? std::string(runtime) + "/PowerInformation.sock"
+                                           : FallbackIpcDirectory() + "/PowerInformation.sock";
+    return Utf8ToWide(path);
+}
+
+// lstat, so a symlink planted in place of the directory is refused rather than followed
+bool IsPrivateIpcDirectory(const std::wstring& directory)
+{
+    struct stat info = {};
+    return lstat(WideToUtf8(directory).c_str(), &info) == 0 && S_ISDIR(info.st_mode) && info.st_uid == geteuid() &&
+           (info.st_mode & 0077) == 0;
+}
+
+// Endpoints in the fallback directory are only used while it is private; a server creates it first
+static bool EndpointDirectoryIsSafe(const std::string& path, bool create)
+{
+    std::string directory = FallbackIpcDirectory();
+    if (path.size() <= directory.size() || path.compare(0, directory.size(), directory) != 0 || path[directory.size()] != '/')
+        return true;
+    if (create && mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST)
+        return false;
+    return IsPrivateIpcDirectory(Utf8ToWide(directory));
+}
+
+// Default endpoint: a root daemon serves every user from /run, others their own runtime directory
+std::wstring DefaultIpcEndpoint()
+{
+    return geteuid() == 0 ? SystemEndpoint : UserIpcEndpoint();
+}
+
+// A user's own daemon first, then the system daemon
+std::vector<std::wstring> DefaultClientIpcEndpoints()
+{
+    if (geteuid() == 0)
+        return { SystemEndpoint };
+    return { UserIpcEndpoint(), SystemEndpoint };
+}
+
+bool IsSystemIpcEndpoint(const std::wstring& endpoint)
+{
+    return endpoint == SystemEndpoint;
+}
+
+// Socket address for a path; false if it does not fit
+static bool SocketAddress(const std::wstring& endpoint, sockaddr_un& address)
+{
+    std::string path = WideToUtf8(endpoint);
+    address = {};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+        return false;
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Destructor
+PIpcConnection::~PIpcConnection()
+{
+    if (fd >= 0)
+        close(fd);
+}
+
+// Read
+size_t PIpcConnection::Read(char* buffer, size_t size)
+{
+    for (;;) {
+        ssize_t result = recv(fd, buffer, size, 0);
+        if (result >= 0)
+            return static_cast<size_t>(result);
+        if (errno != EINTR)
+            return 0;
+    }
+}
+
+// Write everything
+bool PIpcConnection::Write(std::string_view data)
+{
+    while (!data.empty()) {
+        ssize_t result = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(result));
+    }
+    return true;
+}
+
+// Wake a blocked recv with end of stream
+void PIpcConnection::Shutdown()
+{
+    shutdown(fd, SHUT_RDWR);
+}
+
+// Credentials the kernel recorded when the peer connected
+bool PIpcConnection::PeerIsOwner() const
+{
+    ucred credentials = {};
+    socklen_t size = sizeof(credentials);
+    return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &size) == 0 && credentials.uid == geteuid();
+}
+
+// Destructor
+PIpcListener::~PIpcListener()
+{
+    Close();
+}
+
+// Bind and listen; a socket file nobody answers on is stale and replaced
+bool PIpcListener::Open(const std::wstring& name, bool shared)
+{
+    Close();
+    sockaddr_un address;
+    if (!SocketAddress(name, address) || !EndpointDirectoryIsSafe(address.sun_path, true))
+        return false;
+    if (ConnectIpc(name))
+        return false;
+    unlink(address.sun_path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+    // Owner only: Set changes system configuration. A shared socket lets every user connect; the daemon
+    // answers their reads and refuses their writes (PeerIsOwner).
+    mode_t previous = umask(shared ? 0111 : 0077);
+    bool bound = bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    umask(previous);
+    if (!bound || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    endpoint = name;
+    return true;
+}
+
+// Stop listening and remove the socket file
+void PIpcListener::Close()
+{
+    if (fd < 0)
+        return;
+    close(fd);
+    fd = -1;
+    sockaddr_un address;
+    if (SocketAddress(endpoint, address))
+        unlink(address.sun_path);
+}
+
+// Wait for a client
+std::unique_ptr<PIpcConnection> PIpcListener::Accept(std::chrono::milliseconds timeout)
+{
+    if (fd < 0)
+        return nullptr;
+    pollfd entry = { fd, POLLIN, 0 };
+    if (poll(&entry, 1, static_cast<int>(std::min<long long>(timeout.count(), INT_MAX))) <= 0)
+        return nullptr;
+    int client = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (client < 0)
+        return nullptr;
+    return std::make_unique<PIpcConnection>(client);
+}
+
+// Connect to a listening socket
+std::unique_ptr<PIpcConnection> ConnectIpc(const std::wstring& endpoint)
+{
+    sockaddr_un address;
+    if (!SocketAddress(endpoint, address) || !EndpointDirectoryIsSafe(address.sun_path, false))
+        return nullptr;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return nullptr;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    return std::make_unique<PIpcConnection>(fd);
+}
+
+#endif
@@ -0,0 +1,96 @@
+// PIpcChannel.h - Declares the local IPC transport of the daemon: a Unix domain socket or a named pipe.
+//
+// PIpcConnection class:
+//   - One connected byte stream; Read blocks until data arrives, Shutdown unblocks it from another thread.
+//   - PeerIsOwner: whether the client runs as the same user as the server (SO_PEERCRED on Linux, the user
+//     SID of the client process token on Windows).
+//
+// PIpcListener class:
+//   - Linux: SOCK_STREAM Unix domain socket at a file system path, created owner-only, or readable and
+//     writable by everyone for a shared endpoint (the server then checks PeerIsOwner before changing anything).
+//   - Windows: byte-mode named pipe (\\.\pipe\<name>) that rejects remote clients; a new instance is
+//     created for every accepted connection.
+//   - Accept waits up to a timeout so the caller can stop listening.
+//
+// Functions:
+//   - DefaultIpcEndpoint: Where a daemon listens. \\.\pipe\PowerInformation on Windows. On Linux, root
+//     uses the system endpoint /run/PowerInformation.sock; other users $XDG_RUNTIME_DIR/PowerInformation.sock,
+//     or /tmp/PowerInformation-<uid>/PowerInformation.sock without XDG_RUNTIME_DIR. /tmp is shared, so that
+//     directory is created 0700 and both Open and ConnectIpc refuse it unless it is private
+//     (IsPrivateIpcDirectory); otherwise another user could create it first and serve or intercept the socket.
+//   - DefaultClientIpcEndpoints: Where a client looks, in order: the user's own endpoint, then the system one.
+//   - ConnectIpc: Client side of an endpoint.
+//
+#pragma once
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class PIpcConnection
+{
+public:
+#ifdef _WIN32
+    explicit PIpcConnection(HANDLE pipe) : pipe(pipe) {}
+#else
+    explicit PIpcConnection(int fd) : fd(fd) {}
+#endif
+    ~PIpcConnection();
+    PIpcConnection(const PIpcConnection&) = delete;
+    PIpcConnection& operator=(const PIpcConnection&) = delete;
+
+    // Bytes read, 0 at end of stream or on error
+    size_t Read(char* buffer, size_t size);
+    // Write everything; false if the peer went away
+    bool Write(std::string_view data);
+    // Unblock a pending Read (from another thread) and refuse further I/O
+    void Shutdown();
+    // True if the peer runs as the user of this process
+    bool PeerIsOwner() const;
+
+private:
+#ifdef _WIN32
+    HANDLE pipe;
+    HANDLE readEvent = nullptr;
+#else
+    int fd;
+#endif
+};
+
+class PIpcListener
+{
+public:
+    PIpcListener() = default;
+    ~PIpcListener();
+    PIpcListener(const PIpcListener&) = delete;
+    PIpcListener& operator=(const PIpcListener&) = delete;
+
+    // Start listening; fails if another server already answers on the endpoint. Any local user may connect
+    // to a shared endpoint (Linux only; pipes keep their default security).
+    bool Open(const std::wstring& endpoint, bool shared = false);
+    void Close();
+    // Next client, or nullptr when the timeout passed
+    std::unique_ptr<PIpcConnection> Accept(std::chrono::milliseconds timeout);
+
+private:
+    std::wstring endpoint;
+#ifdef _WIN32
+    HANDLE CreateInstance(bool first);
+
+    HANDLE pending = INVALID_HANDLE_VALUE;
+    HANDLE connectEvent = nullptr;
+    OVERLAPPED connect = {};
+    bool connecting = false;
+#else
+    int fd = -1;
+#endif
+};
+
+std::wstring DefaultIpcEndpoint();
+std::vector<std::wstring> DefaultClientIpcEndpoints();
+// True for the endpoint a root daemon serves to every user
+bool IsSystemIpcEndpoint(const std::wstring& endpoint);
+// True if a directory (not a symlink) belongs to this user and grants nobody else any access
+bool IsPrivateIpcDirectory(const std::wstring& directory);
+std::unique_ptr<PIpcConnection> ConnectIpc(const std::wstring& endpoint);
@@ -0,0 +1,314 @@
+// PLinuxPowerBackend.cpp - Implements PPowerBackend over ACPI platform_profile and cpufreq sysfs attributes.
+//
+#include "pch.h"
+#include "PLinuxPowerBackend.h"
+#include "PGuid.h"
+#include <charconv>
+
+#ifndef _WIN32
+
+// GUID_PROCESSOR_SETTINGS_SUBGROUP and GUID_PROCESSOR_PERF_ENERGY_PREFERENCE, so names line up with Windows
+const GUID PLinuxPowerBackend::ProcessorSubgroup = { 0x54533251, 0x82be, 0x4824, { 0x96, 0xc1, 0x47, 0xb6, 0x0b, 0x74, 0x0d, 0x00 } };
+const GUID PLinuxPowerBackend::EnergyPreferenceSetting = { 0x36687f9e, 0xe3a5, 0x4dbf, { 0xb1, 0xdc, 0x15, 0xeb, 0x38, 0x1c, 0x68, 0x63 } };
+// No Windows equivalent; fixed GUID owned by this tool
+const GUID PLinuxPowerBackend::ScalingGovernorSetting = { 0x9f2a6c10, 0x4b1e, 0x4c55, { 0x8d, 0x3a, 0x2e, 0x71, 0x5c, 0x90, 0x1b, 0x01 } };
+// Scheme used when the platform exposes no platform_profile
+static const GUID DefaultSchemeGuid = { 0x9f2a6c10, 0x4b1e, 0x4c55, { 0x8d, 0x3a, 0x2e, 0x71, 0x5c, 0x90, 0x1b, 0x00 } };
+
+// Stable GUID derived from a platform profile name
+static GUID SchemeGuidFromName(const std::string& name)
+{
+    uint64_t h1 = 14695981039346656037ull, h2 = 0x9e3779b97f4a7c15ull;
+    for (unsigned char ch : name) {
+        h1 = (h1 ^ ch) * 1099511628211ull;
+        h2 = (h2 ^ ch) * 0x100000001b3ull + 0x7f4a7c15;
+    }
+    GUID guid = {};
+    guid.Data1 = static_cast<uint32_t>(h1 >> 32);
+    guid.Data2 = static_cast<uint16_t>(h1 >> 16);
+    guid.Data3 = static_cast<uint16_t>((h1 & 0x0fff) | 0x5000); // name-based version nibble
+    std::memcpy(guid.Data4, &h2, sizeof(guid.Data4));
+    guid.Data4[0] = static_cast<uint8_t>((guid.Data4[0] & 0x3f) | 0x80);
+    return guid;
+}
+
+// Split a space-separated sysfs list
+static std::vector<std::string> SplitWords(const std::string& text)
+{
+    std::vector<std::string> words;
+    std::istringstream stream(text);
+    for (std::string word; stream >> word;)
+        words.push_back(word);
+    return words;
+}
+
+// Widen an ASCII sysfs keyword
+static std::wstring Widen(const std::string& text)
+{
+    return std::wstring(text.begin(), text.end());
+}
+
+// Open every attribute once and build the scheme/setting tables
+PLinuxPowerBackend::PLinuxPowerBackend(const std::filesystem::path& root) : root(root)
+{
+    std::filesystem::path acpi = root / "sys/firmware/acpi";
+    PSysfsAttribute choices;
+    std::string choiceText;
+    if (platformProfile.Open(acpi / "platform_profile", true) && choices.Open(acpi / "platform_profile_choices") && choices.ReadText(choiceText)) {
+        for (const std::string& name : SplitWords(choiceText))
+            schemes.push_back({ SchemeGuidFromName(name), name });
+    }
+    if (schemes.empty())
+        schemes.push_back({ DefaultSchemeGuid, "Default" });
+
+    // cpufreq policies in numeric order; entries that are not "policy<N>" are skipped
+    std::vector<std::pair<unsigned, std::filesystem::path>> numbered;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(root / "sys/devices/system/cpu/cpufreq", ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("policy", 0) != 0)
+            continue;
+        const char* last = name.data() + name.size();
+        unsigned number = 0;
+        auto result = std::from_chars(name.data() + 6, last, number);
+        if (result.ec == std::errc() && result.ptr == last)
+            numbered.emplace_back(number, entry.path());
+    }
+    std::sort(numbered.begin(), numbered.end());
+    std::vector<std::filesystem::path> policies;
+    for (auto& [number, path] : numbered)
+        policies.push_back(std::move(path));
+
+    AddSetting(ScalingGovernorSetting, L"Scaling governor", "scaling_governor", "scaling_available_governors", policies);
+    AddSetting(EnergyPreferenceSetting, L"Energy performance preference", "energy_performance_preference",
+               "energy_performance_available_preferences", policies);
+    if (platformProfile.IsOpen())
+        platformProfile.ReadText(lastProfile);
+
+    // Everything the names and descriptions are built from: another root or another choice list is another cache
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* bytes, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            hash ^= static_cast<const uint8_t*>(bytes)[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    std::string rootText = root.string();
+    mix(rootText.data(), rootText.size() + 1);
+    for (const auto& setting : settings) {
+        size_t policyCount = setting.attributes.size();
+        mix(&setting.guid, sizeof(setting.guid));
+        mix(setting.description.data(), setting.description.size() * sizeof(wchar_t));
+        mix(&policyCount, sizeof(policyCount));
+    }
+    metadataFingerprint = hash;
+}
+
+// Expose one per-policy attribute as a setting if the first policy has it
+void PLinuxPowerBackend::AddSetting(const GUID& guid, const std::wstring& name, const char* attribute, const char* choicesAttribute,
+                                    const std::vector<std::filesystem::path>& policies)
+{
+    if (policies.empty())
+        return;
+    PSysfsAttribute choices;
+    std::string choiceText;
+    if (!choices.Open(policies.front() / choicesAttribute) || !choices.ReadText(choiceText))
+        return;
+
+    Setting setting;
+    setting.guid = guid;
+    setting.name = name;
+    setting.choices = SplitWords(choiceText);
+    setting.description = L"cpufreq " + Widen(attribute) + L" for all policies. Values:";
+    for (size_t i = 0; i < setting.choices.size(); i++)
+        setting.description += L" " + std::to_wstring(i) + L"=" + Widen(setting.choices[i]);
+    for (const auto& policy : policies) {
+        PSysfsAttribute attr;
+        if (attr.Open(policy / attribute, true))
+            setting.attributes.push_back(std::move(attr));
+    }
+    if (!setting.attributes.empty() && !setting.choices.empty())
+        settings.push_back(std::move(setting));
+}
+
+// Enumerate schemes
+DWORD PLinuxPowerBackend::EnumerateScheme(DWORD index, GUID& scheme)
+{
+    if (index >= schemes.size()) return ERROR_NO_MORE_ITEMS;
+    scheme = schemes[index].guid;
+    return ERROR_SUCCESS;
+}
+
+// Enumerate subgroups: only the processor subgroup of the live scheme, when any setting exists
+DWORD PLinuxPowerBackend::EnumerateSubgroup(const GUID& scheme, DWORD index, GUID& subgroup)
+{
+    if (!FindScheme(scheme)) return ERROR_FILE_NOT_FOUND;
+    if (index > 0 || settings.empty() || !IsLive(scheme)) return ERROR_NO_MORE_ITEMS;
+    subgroup = ProcessorSubgroup;
+    return ERROR_SUCCESS;
+}
+
+// Enumerate settings of the live scheme's processor subgroup
+DWORD PLinuxPowerBackend::EnumerateSetting(const GUID& scheme, const GUID& subgroup, DWORD index, GUID& setting)
+{
+    if (!(subgroup == ProcessorSubgroup) || !IsLive(scheme)) return ERROR_FILE_NOT_FOUND;
+    if (index >= settings.size()) return ERROR_NO_MORE_ITEMS;
+    setting = settings[index].guid;
+    return ERROR_SUCCESS;
+}
+
+// Read friendly name of a scheme, subgroup or setting
+DWORD PLinuxPowerBackend::ReadFriendlyName(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& name)
+{
+    name.clear();
+    const Scheme* s = scheme ? FindScheme(*scheme) : nullptr;
+    if (!s) return ERROR_FILE_NOT_FOUND;
+    if (setting && subgroup) {
+        Setting* i = FindSetting(*scheme, *subgroup, *setting);
+        if (!i) return ERROR_FILE_NOT_FOUND;
+        name = i->name;
+    } else if (subgroup) {
+        if (!(*subgroup == ProcessorSubgroup) || !IsLive(*scheme)) return ERROR_FILE_NOT_FOUND;
+        name = L"Processor power management";
+    } else {
+        name = Widen(s->name);
+    }
+    return ERROR_SUCCESS;
+}
+
+// Read description of a scheme, subgroup or setting
+DWORD PLinuxPowerBackend::ReadDescription(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& description)
+{
+    description.clear();
+    const Scheme* s = scheme ? FindScheme(*scheme) : nullptr;
+    if (!s) return ERROR_FILE_NOT_FOUND;
+    if (setting && subgroup) {
+        Setting* i = FindSetting(*scheme, *subgroup, *setting);
+        if (!i) return ERROR_FILE_NOT_FOUND;
+        description = i->description;
+    } else if (subgroup) {
+        if (!(*subgroup == ProcessorSubgroup) || !IsLive(*scheme)) return ERROR_FILE_NOT_FOUND;
+        description = L"cpufreq policy settings";
+    } else {
+        description = platformProfile.IsOpen() ? L"ACPI platform profile" : L"No ACPI platform profile available";
+    }
+    return ERROR_SUCCESS;
+}
+
+// Read the live value from the first policy as an index into the choice list (AC and DC alike)
+DWORD PLinuxPowerBackend::ReadValue(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool /*ac*/, DWORD& type, DWORD& value)
+{
+    Setting* i = FindSetting(scheme, subgroup, setting);
+    if (!i) return ERROR_FILE_NOT_FOUND;
+    std::string text;
+    if (!i->attributes.front().ReadText(text)) return ERROR_ACCESS_DENIED;
+    auto it = std::find(i->choices.begin(), i->choices.end(), text);
+    if (it == i->choices.end()) return ERROR_INVALID_DATA;
+    type = REG_DWORD;
+    value = static_cast<DWORD>(it - i->choices.begin());
+    return ERROR_SUCCESS;
+}
+
+// Write the choice for a value index to every policy; only the live scheme has settings to write
+DWORD PLinuxPowerBackend::WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool /*ac*/, DWORD value)
+{
+    Setting* i = FindSetting(scheme, subgroup, setting);
+    if (!i) return ERROR_FILE_NOT_FOUND;
+    if (value >= i->choices.size()) return ERROR_INVALID_PARAMETER;
+    for (const auto& attribute : i->attributes) {
+        if (!attribute.Write(i->choices[value]))
+            return ERROR_ACCESS_DENIED;
+    }
+    return ERROR_SUCCESS;
+}
+
+// Active scheme from platform_profile
+DWORD PLinuxPowerBackend::GetActiveScheme(GUID& scheme)
+{
+    if (!platformProfile.IsOpen()) {
+        scheme = schemes.front().guid;
+        return ERROR_SUCCESS;
+    }
+    std::string text;
+    if (!platformProfile.ReadText(text)) return ERROR_ACCESS_DENIED;
+    for (const auto& s : schemes) {
+        if (s.name == text) {
+            scheme = s.guid;
+            return ERROR_SUCCESS;
+        }
+    }
+    return ERROR_NOT_FOUND;
+}
+
+// Activate a scheme by writing its name to platform_profile
+DWORD PLinuxPowerBackend::SetActiveScheme(const GUID& scheme)
+{
+    const Scheme* s = FindScheme(scheme);
+    if (!s) return ERROR_FILE_NOT_FOUND;
+    if (!platformProfile.IsOpen())
+        return ERROR_SUCCESS; // the single default scheme is always active
+    return platformProfile.Write(s->name) ? ERROR_SUCCESS : ERROR_ACCESS_DENIED;
+}
+
+// Bump the generation when platform_profile moved the settings to another scheme
+uint64_t PLinuxPowerBackend::GetGeneration()
+{
+    std::string profile;
+    if (platformProfile.IsOpen() && !platformProfile.ReadText(profile))
+        profile.clear();
+    std::lock_guard<std::mutex> lock(generationMutex);
+    if (profile != lastProfile) {
+        lastProfile = std::move(profile);
+        generation++;
+    }
+    return generation;
+}
+
+// Attributes whose modification changes what the backend reports
+std::vector<std::filesystem::path> PLinuxPowerBackend::ChangeSources()
+{
+    std::vector<std::filesystem::path> sources;
+    if (platformProfile.IsOpen())
+        sources.push_back(platformProfile.Path());
+    for (const auto& setting : settings) {
+        for (const auto& attribute : setting.attributes)
+            sources.push_back(attribute.Path());
+    }
+    return sources;
+}
+
+// Lookup helpers
+const PLinuxPowerBackend::Scheme* PLinuxPowerBackend::FindScheme(const GUID& scheme) const
+{
+    for (const auto& s : schemes)
+        if (s.guid == scheme) return &s;
+    return nullptr;
+}
+
+const PLinuxPowerBackend::Scheme* PLinuxPowerBackend::LiveScheme() const
+{
+    if (!platformProfile.IsOpen())
+        return &schemes.front();
+    std::string text;
+    if (!platformProfile.ReadText(text))
+        return nullptr;
+    for (const auto& s : schemes)
+        if (s.name == text) return &s;
+    return nullptr;
+}
+
+bool PLinuxPowerBackend::IsLive(const GUID& scheme) const
+{
+    const Scheme* live = LiveScheme();
+    return live && live->guid == scheme;
+}
+
+PLinuxPowerBackend::Setting* PLinuxPowerBackend::FindSetting(const GUID& scheme, const GUID& subgroup, const GUID& setting)
+{
+    if (!(subgroup == ProcessorSubgroup) || !IsLive(scheme)) return nullptr;
+    for (auto& s : settings)
+        if (s.guid == setting) return &s;
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,87 @@
+// PLinuxPowerBackend.h - Declares the sysfs implementation of PPowerBackend.
+//
+// Mapping onto the PInformation model:
+//   - Schemes: one per ACPI platform profile choice (/sys/firmware/acpi/platform_profile_choices);
+//     a single "Default" scheme when the platform has no platform_profile.
+//   - Active scheme: /sys/firmware/acpi/platform_profile.
+//   - Settings (processor subgroup): cpufreq scaling_governor and energy_performance_preference,
+//     valued as an index into the matching scaling_available_* list and applied to every policy.
+//   - Linux keeps one live value per attribute, not one per profile, so the processor subgroup exists
+//     only under the active scheme. Other schemes enumerate no subgroups, and reads or writes addressed
+//     to them fail with ERROR_FILE_NOT_FOUND instead of silently changing the live system.
+//   - AC and DC are the same live value: both read it and a write to either replaces it.
+//   - The generation moves when platform_profile names another scheme, because the settings move with it.
+//
+// Every attribute is opened once at construction and read with pread; the sysfs root is injectable
+// so a fixture tree can stand in for /sys. Policies and choice lists are fixed at construction; a new
+// backend picks up hot-plugged policies or firmware changes.
+//
+#pragma once
+#include "PPowerBackend.h"
+#include "PSysfsAttribute.h"
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+class PLinuxPowerBackend : public PPowerBackend
+{
+public:
+    // root is the directory that contains "sys" ("/" on a live system)
+    explicit PLinuxPowerBackend(const std::filesystem::path& root = "/");
+
+    DWORD EnumerateScheme(DWORD index, GUID& scheme) override;
+    DWORD EnumerateSubgroup(const GUID& scheme, DWORD index, GUID& subgroup) override;
+    DWORD EnumerateSetting(const GUID& scheme, const GUID& subgroup, DWORD index, GUID& setting) override;
+    DWORD ReadFriendlyName(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& name) override;
+    DWORD ReadDescription(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& description) override;
+    DWORD ReadValue(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD& type, DWORD& value) override;
+    DWORD WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD value) override;
+    DWORD GetActiveScheme(GUID& scheme) override;
+    DWORD SetActiveScheme(const GUID& scheme) override;
+    uint64_t GetGeneration() override;
+    // Root, settings, their choice lists and policy counts (fixed at construction)
+    uint64_t MetadataFingerprint() override { return metadataFingerprint; }
+    // platform_profile and every policy attribute behind a setting
+    std::vector<std::filesystem::path> ChangeSources() override;
+
+    // Root the backend reads from
+    const std::filesystem::path& Root() const { return root; }
+
+    // Processor subgroup and the settings exposed under it
+    static const GUID ProcessorSubgroup;
+    static const GUID ScalingGovernorSetting;
+    static const GUID EnergyPreferenceSetting;
+
+private:
+    struct Scheme {
+        GUID guid;
+        std::string name;
+    };
+    struct Setting {
+        GUID guid;
+        std::wstring name;
+        std::wstring description;
+        std::vector<std::string> choices;          // value index -> sysfs keyword
+        std::vector<PSysfsAttribute> attributes;   // one per cpufreq policy
+    };
+
+    const Scheme* FindScheme(const GUID& scheme) const;
+    // Scheme named by platform_profile (the single scheme without one); nullptr if unreadable or unknown
+    const Scheme* LiveScheme() const;
+    bool IsLive(const GUID& scheme) const;
+    Setting* FindSetting(const GUID& scheme, const GUID& subgroup, const GUID& setting);
+    void AddSetting(const GUID& guid, const std::wstring& name, const char* attribute, const char* choicesAttribute,
+                    const std::vector<std::filesystem::path>& policies);
+
+    std::filesystem::path root;
+    PSysfsAttribute platformProfile;
+    std::vector<Scheme> schemes;
+    std::vector<Setting> settings;
+    std::mutex generationMutex;
+    std::string lastProfile;      // platform_profile at the last GetGeneration()
+    uint64_t generation = 1;
+    uint64_t metadataFingerprint = 0;
+};
+#endif
@@ -0,0 +1,110 @@
+// PMappedFile.cpp - Implements read-only file mappings for Windows and POSIX.
+//
+#include "pch.h"
+#include "PMappedFile.h"
+
+#include <atomic>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Temp name next to target, unique per process and call
+std::filesystem::path UniqueTempPath(const std::filesystem::path& target)
+{
+    static std::atomic<uint32_t> counter{ 0 };
+#ifdef _WIN32
+    unsigned long pid = GetCurrentProcessId();
+#else
+    unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+    char suffix[48];
+    std::snprintf(suffix, sizeof(suffix), ".%lu.%u.tmp", pid, counter.fetch_add(1));
+    std::filesystem::path temp = target;
+    temp += suffix;
+    return temp;
+}
+
+// Destructor
+PMappedFile::~PMappedFile()
+{
+    Close();
+}
+
+// Move constructor
+PMappedFile::PMappedFile(PMappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+// Move assignment
+PMappedFile& PMappedFile::operator=(PMappedFile&& other) noexcept
+{
+    if (this != &other) {
+        Close();
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+#ifdef _WIN32
+        std::swap(mapping, other.mapping);
+#endif
+    }
+    return *this;
+}
+
+// Map the file read-only
+bool PMappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+#ifdef _WIN32
+    wil::unique_hfile file(CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+    if (!file)
+        return false;
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file.get(), &fileSize) || fileSize.QuadPart == 0)
+        return false;
+    HANDLE map = CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!map)
+        return false;
+    void* view = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(map);
+        return false;
+    }
+    mapping = map;
+    data = static_cast<const uint8_t*>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (view == MAP_FAILED)
+        return false;
+    data = static_cast<const uint8_t*>(view);
+    size = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+// Release the mapping
+void PMappedFile::Close()
+{
+    if (!data)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
@@ -0,0 +1,43 @@
+// PMappedFile.h - Declares PMappedFile, a read-only memory mapping of a whole file.
+//
+// PMappedFile class:
+//   - Maps a file read-only (MapViewOfFile on Windows, mmap elsewhere) for zero-copy readers.
+//   - Move-only; the mapping is released on Close() or destruction.
+//
+// Functions:
+//   - UniqueTempPath: sibling of a file for write-then-rename, unique per process and call, so two
+//     processes (or threads) saving the same file never write into one temp file.
+//
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+class PMappedFile
+{
+public:
+    PMappedFile() = default;
+    ~PMappedFile();
+    PMappedFile(PMappedFile&& other) noexcept;
+    PMappedFile& operator=(PMappedFile&& other) noexcept;
+    PMappedFile(const PMappedFile&) = delete;
+    PMappedFile& operator=(const PMappedFile&) = delete;
+
+    // Map the file; returns false if it cannot be opened or is empty
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    bool IsOpen() const { return data != nullptr; }
+    const uint8_t* Data() const { return data; }
+    size_t Size() const { return size; }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* mapping = nullptr;
+#endif
+};
+
+// "<target>.<pid>.<n>.tmp" next to target
+std::filesystem::path UniqueTempPath(const std::filesystem::path& target);
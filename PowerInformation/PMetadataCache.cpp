@@ -0,0 +1,302 @@
+// PMetadataCache.cpp - Implements the memory-mapped name/description cache and its backend decorator.
+//
+#include "pch.h"
+#include "PMetadataCache.h"
+#include <fstream>
+
+namespace {
+
+constexpr char CacheMagic[8] = { 'P', 'I', 'M', 'E', 'T', 'A', '\0', '\0' };
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t wcharSize;
+    uint64_t fingerprint;
+    uint64_t entryCount;
+    uint64_t entriesOffset;
+    uint64_t charsOffset;
+    uint64_t charCount;
+};
+
+struct CacheEntry {
+    uint32_t kind;
+    GUID guid;
+    uint32_t nameOffset;   // in wchar_t units from charsOffset
+    uint32_t nameLength;
+    uint32_t descriptionOffset;
+    uint32_t descriptionLength;
+};
+
+static_assert(sizeof(GUID) == 16, "GUID must be 16 bytes");
+
+} // namespace
+
+// Constructor
+PMetadataCache::PMetadataCache(std::filesystem::path path) : path(std::move(path)) {}
+
+// Map the cache file and validate its header
+bool PMetadataCache::Open(uint64_t expectedFingerprint)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    fingerprint = expectedFingerprint;
+    pending.clear();
+    if (!file.Open(path))
+        return false;
+
+    const uint8_t* data = file.Data();
+    size_t size = file.Size();
+    bool valid = size >= sizeof(CacheHeader);
+    const CacheHeader* header = reinterpret_cast<const CacheHeader*>(data);
+    if (valid) {
+        valid = std::memcmp(header->magic, CacheMagic, sizeof(CacheMagic)) == 0 &&
+                header->version == FormatVersion &&
+                header->wcharSize == sizeof(wchar_t) &&
+                header->fingerprint == expectedFingerprint &&
+                header->entriesOffset % alignof(CacheEntry) == 0 &&
+                header->charsOffset % alignof(wchar_t) == 0 &&
+                header->entriesOffset <= size &&
+                header->entryCount <= (size - header->entriesOffset) / sizeof(CacheEntry) &&
+                header->charsOffset <= size &&
+                header->charCount <= (size - header->charsOffset) / sizeof(wchar_t);
+    }
+    if (!valid)
+        file.Close();
+    return valid;
+}
+
+// Binary search of the mapped entries
+bool PMetadataCache::LookupMapped(Kind kind, const GUID& guid, std::wstring_view& name, std::wstring_view& description) const
+{
+    if (!file.IsOpen())
+        return false;
+    const CacheHeader* header = reinterpret_cast<const CacheHeader*>(file.Data());
+    const CacheEntry* begin = reinterpret_cast<const CacheEntry*>(file.Data() + header->entriesOffset);
+    const CacheEntry* end = begin + header->entryCount;
+    const Key key = { kind, guid };
+    const CacheEntry* it = std::lower_bound(begin, end, key, [](const CacheEntry& entry, const Key& k) {
+        return Key{ static_cast<Kind>(entry.kind), entry.guid } < k;
+    });
+    if (it == end || it->kind != static_cast<uint32_t>(kind) || !(it->guid == guid))
+        return false;
+
+    const wchar_t* chars = reinterpret_cast<const wchar_t*>(file.Data() + header->charsOffset);
+    if (uint64_t(it->nameOffset) + it->nameLength > header->charCount ||
+        uint64_t(it->descriptionOffset) + it->descriptionLength > header->charCount)
+        return false;
+    name = std::wstring_view(chars + it->nameOffset, it->nameLength);
+    description = std::wstring_view(chars + it->descriptionOffset, it->descriptionLength);
+    return true;
+}
+
+// Look up a name/description in the mapping, then in the entries recorded this run
+bool PMetadataCache::Lookup(Kind kind, const GUID& guid, std::wstring_view& name, std::wstring_view& description)
+{
+    if (LookupMapped(kind, guid, name, description))
+        return true;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pending.find(Key{ kind, guid });
+    if (it == pending.end())
+        return false;
+    // std::map nodes are stable, so the views outlive the lock
+    name = it->second.name;
+    description = it->second.description;
+    return true;
+}
+
+// Remember a value read from the backend
+void PMetadataCache::Record(Kind kind, const GUID& guid, std::wstring_view name, std::wstring_view description)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.try_emplace(Key{ kind, guid }, Text{ std::wstring(name), std::wstring(description) });
+}
+
+// True if Record() added anything since Open()
+bool PMetadataCache::IsDirty()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return !pending.empty();
+}
+
+// Rewrite the file: mapped entries plus recorded ones, written to a temp file and renamed over the old one
+bool PMetadataCache::Save()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Gather everything into one ordered set; recorded entries win over mapped ones
+    std::map<Key, Text> all = pending;
+    if (file.IsOpen()) {
+        const CacheHeader* header = reinterpret_cast<const CacheHeader*>(file.Data());
+        const CacheEntry* entries = reinterpret_cast<const CacheEntry*>(file.Data() + header->entriesOffset);
+        const wchar_t* chars = reinterpret_cast<const wchar_t*>(file.Data() + header->charsOffset);
+        for (uint64_t i = 0; i < header->entryCount; i++) {
+            const CacheEntry& e = entries[i];
+            if (uint64_t(e.nameOffset) + e.nameLength > header->charCount ||
+                uint64_t(e.descriptionOffset) + e.descriptionLength > header->charCount)
+                continue;
+            all.try_emplace(Key{ static_cast<Kind>(e.kind), e.guid },
+                            Text{ std::wstring(chars + e.nameOffset, e.nameLength),
+                                  std::wstring(chars + e.descriptionOffset, e.descriptionLength) });
+        }
+    }
+
+    std::vector<CacheEntry> entries;
+    entries.reserve(all.size());
+    std::wstring chars;
+    for (const auto& [key, text] : all) {
+        CacheEntry e = {};
+        e.kind = static_cast<uint32_t>(key.kind);
+        e.guid = key.guid;
+        e.nameOffset = static_cast<uint32_t>(chars.size());
+        e.nameLength = static_cast<uint32_t>(text.name.size());
+        chars += text.name;
+        e.descriptionOffset = static_cast<uint32_t>(chars.size());
+        e.descriptionLength = static_cast<uint32_t>(text.description.size());
+        chars += text.description;
+        entries.push_back(e);
+    }
+
+    CacheHeader header = {};
+    std::memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.version = FormatVersion;
+    header.wcharSize = sizeof(wchar_t);
+    header.fingerprint = fingerprint;
+    header.entryCount = entries.size();
+    header.entriesOffset = sizeof(CacheHeader);
+    header.charsOffset = header.entriesOffset + entries.size() * sizeof(CacheEntry);
+    header.charCount = chars.size();
+
+    // Unmap before replacing the file (Windows cannot rename over a mapped file)
+    file.Close();
+    // A per-process temp name: concurrent savers each rename a complete file, and the last one wins
+    std::filesystem::path temp = UniqueTempPath(path);
+    bool written;
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(CacheEntry));
+        out.write(reinterpret_cast<const char*>(chars.data()), chars.size() * sizeof(wchar_t));
+        out.close();
+        written = !out.fail();
+    }
+    std::error_code ec;
+    if (written)
+        std::filesystem::rename(temp, path, ec);
+    if (!written || ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+
+    pending.clear();
+    file.Open(path);
+    return true;
+}
+
+// Fingerprint of the inputs that change cached names: UI language and the backend's store
+uint64_t PMetadataCache::CurrentFingerprint(PPowerBackend& backend)
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&](const void* bytes, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            hash ^= static_cast<const uint8_t*>(bytes)[i];
+            hash *= 1099511628211ull;
+        }
+    };
+#ifdef _WIN32
+    LANGID language = GetUserDefaultUILanguage();
+    mix(&language, sizeof(language));
+#else
+    for (const char* variable : { "LC_ALL", "LC_MESSAGES", "LANG" }) {
+        const char* value = std::getenv(variable);
+        if (value && *value) {
+            mix(value, std::strlen(value));
+            break;
+        }
+    }
+#endif
+    uint64_t store = backend.MetadataFingerprint();
+    mix(&store, sizeof(store));
+    return hash;
+}
+
+// Constructor: open the cache for the current fingerprint
+PCachedPowerBackend::PCachedPowerBackend(PPowerBackend& inner, std::filesystem::path path)
+    : inner(inner), cache(std::move(path))
+{
+    fingerprint = PMetadataCache::CurrentFingerprint(inner);
+    warm = cache.Open(fingerprint);
+    nextRecheck = std::chrono::steady_clock::now() + recheckInterval;
+}
+
+// Destructor: persist anything read from the inner backend this run
+PCachedPowerBackend::~PCachedPowerBackend()
+{
+    if (cache.IsDirty())
+        cache.Save();
+}
+
+// Read friendly name
+DWORD PCachedPowerBackend::ReadFriendlyName(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& name)
+{
+    return ReadText(scheme, subgroup, setting, true, name);
+}
+
+// Read description
+DWORD PCachedPowerBackend::ReadDescription(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& description)
+{
+    return ReadText(scheme, subgroup, setting, false, description);
+}
+
+// Serve from the cache, filling it from the inner backend on a miss
+DWORD PCachedPowerBackend::ReadText(const GUID* scheme, const GUID* subgroup, const GUID* setting, bool wantName, std::wstring& out)
+{
+    if (!subgroup) {
+        // Scheme names can be renamed by the user; never cache them
+        return wantName ? inner.ReadFriendlyName(scheme, subgroup, setting, out)
+                        : inner.ReadDescription(scheme, subgroup, setting, out);
+    }
+
+    Revalidate();
+    std::shared_lock lock(cacheMutex);
+    PMetadataCache::Kind kind = setting ? PMetadataCache::Kind::Setting : PMetadataCache::Kind::Subgroup;
+    const GUID& key = setting ? *setting : *subgroup;
+    std::wstring_view name, description;
+    if (cache.Lookup(kind, key, name, description)) {
+        out.assign(wantName ? name : description);
+        return ERROR_SUCCESS;
+    }
+
+    // Miss: read both strings so the entry is complete, and only cache successful reads
+    std::wstring readName, readDescription;
+    DWORD nameStatus = inner.ReadFriendlyName(scheme, subgroup, setting, readName);
+    DWORD descriptionStatus = inner.ReadDescription(scheme, subgroup, setting, readDescription);
+    if (nameStatus == ERROR_SUCCESS && descriptionStatus == ERROR_SUCCESS)
+        cache.Record(kind, key, readName, readDescription);
+    out = wantName ? std::move(readName) : std::move(readDescription);
+    return wantName ? nameStatus : descriptionStatus;
+}
+
+// Change the recheck interval; the next read checks
+void PCachedPowerBackend::SetRecheckInterval(std::chrono::steady_clock::duration interval)
+{
+    std::lock_guard<std::mutex> recheck(recheckMutex);
+    recheckInterval = interval;
+    nextRecheck = {};
+}
+
+// Re-check the fingerprint once the interval has passed; reopening for a new fingerprint starts empty
+// (the file on disk still carries the old one) and the next Save() rewrites it
+void PCachedPowerBackend::Revalidate()
+{
+    std::lock_guard<std::mutex> recheck(recheckMutex);
+    auto now = std::chrono::steady_clock::now();
+    if (now < nextRecheck)
+        return;
+    nextRecheck = now + recheckInterval;
+    uint64_t current = PMetadataCache::CurrentFingerprint(inner);
+    if (current == fingerprint)
+        return;
+    std::unique_lock lock(cacheMutex);
+    fingerprint = current;
+    cache.Open(current);
+}
@@ -0,0 +1,121 @@
+// PMetadataCache.h - Declares the persistent, memory-mapped cache of power setting names/descriptions.
+//
+// File format (native endianness, version PMetadataCache::FormatVersion):
+//   - Header: magic, version, sizeof(wchar_t), fingerprint, entry count, offsets.
+//   - Entries: fixed-size records sorted by (kind, GUID) for binary search.
+//   - Characters: every name/description back to back as wchar_t, referenced by offset/length.
+//
+// PMetadataCache class:
+//   - Maps the file zero-copy; lookups return views straight into the mapping.
+//   - Rejects the file when the version, wchar_t size or fingerprint differ. The fingerprint covers the UI
+//     language and PPowerBackend::MetadataFingerprint() (which store, and its definitions' version).
+//   - Collects misses and rewrites the file atomically on Save() (unique temp file, then rename).
+//
+// PCachedPowerBackend class:
+//   - PPowerBackend decorator that serves subgroup/setting names and descriptions from the cache.
+//   - Scheme names are user-editable, so they always go to the inner backend.
+//   - Re-checks the fingerprint while reading, at most once per recheck interval, and discards the cache
+//     when it moved, so a long-running process stops serving names from before a store or language change.
+//
+#pragma once
+#include "PPowerBackend.h"
+#include "PMappedFile.h"
+#include "PGuid.h"
+#include <filesystem>
+#include <map>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+
+class PMetadataCache
+{
+public:
+    static constexpr uint32_t FormatVersion = 1;
+
+    enum class Kind : uint32_t {
+        Subgroup = 1,
+        Setting = 2,
+    };
+
+    explicit PMetadataCache(std::filesystem::path path);
+
+    // Map the cache file; returns false (and starts empty) if it is missing or stale
+    bool Open(uint64_t fingerprint);
+    // Look up a name/description; views stay valid until Save() or destruction
+    bool Lookup(Kind kind, const GUID& guid, std::wstring_view& name, std::wstring_view& description);
+    // Remember a value read from the backend so the next Save() persists it
+    void Record(Kind kind, const GUID& guid, std::wstring_view name, std::wstring_view description);
+    // True if Record() added anything since Open()
+    bool IsDirty();
+    // Rewrite the file with the mapped entries plus the recorded ones
+    bool Save();
+
+    // Fingerprint of the inputs that change cached names: UI language and the backend's store
+    static uint64_t CurrentFingerprint(PPowerBackend& backend);
+
+private:
+    struct Key {
+        Kind kind;
+        GUID guid;
+        bool operator<(const Key& other) const {
+            if (kind != other.kind) return kind < other.kind;
+            return CompareGuid(guid, other.guid) < 0;
+        }
+    };
+    struct Text {
+        std::wstring name;
+        std::wstring description;
+    };
+
+    bool LookupMapped(Kind kind, const GUID& guid, std::wstring_view& name, std::wstring_view& description) const;
+
+    std::filesystem::path path;
+    uint64_t fingerprint = 0;
+    PMappedFile file;
+    std::mutex mutex;
+    std::map<Key, Text> pending;
+};
+
+class PCachedPowerBackend : public PPowerBackend
+{
+public:
+    // Opens (or starts) the cache at path; saves it on destruction if new entries were read
+    PCachedPowerBackend(PPowerBackend& inner, std::filesystem::path path);
+    ~PCachedPowerBackend() override;
+
+    DWORD EnumerateScheme(DWORD index, GUID& scheme) override { return inner.EnumerateScheme(index, scheme); }
+    DWORD EnumerateSubgroup(const GUID& scheme, DWORD index, GUID& subgroup) override { return inner.EnumerateSubgroup(scheme, index, subgroup); }
+    DWORD EnumerateSetting(const GUID& scheme, const GUID& subgroup, DWORD index, GUID& setting) override { return inner.EnumerateSetting(scheme, subgroup, index, setting); }
+    DWORD ReadFriendlyName(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& name) override;
+    DWORD ReadDescription(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& description) override;
+    DWORD ReadValue(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD& type, DWORD& value) override { return inner.ReadValue(scheme, subgroup, setting, ac, type, value); }
+    DWORD WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD value) override { return inner.WriteValueIndex(scheme, subgroup, setting, ac, value); }
+    DWORD GetActiveScheme(GUID& scheme) override { return inner.GetActiveScheme(scheme); }
+    DWORD SetActiveScheme(const GUID& scheme) override { return inner.SetActiveScheme(scheme); }
+    uint64_t GetGeneration() override { return inner.GetGeneration(); }
+    std::vector<std::filesystem::path> ChangeSources() override { return inner.ChangeSources(); }
+    uint64_t MetadataFingerprint() override { return inner.MetadataFingerprint(); }
+
+    // True if the cache file was valid when opened
+    bool WasWarm() const { return warm; }
+    // Minimum time between fingerprint checks (1 s by default; zero checks on every read); the next read checks
+    void SetRecheckInterval(std::chrono::steady_clock::duration interval);
+
+private:
+    // Discard the cache if the fingerprint moved since it was opened
+    void Revalidate();
+    // Serve name (wantName) or description from the cache, filling it from the inner backend on a miss
+    DWORD ReadText(const GUID* scheme, const GUID* subgroup, const GUID* setting, bool wantName, std::wstring& out);
+
+    PPowerBackend& inner;
+    PMetadataCache cache;
+    bool warm = false;
+    // Shared while a view into the cache is in use, exclusive to discard it
+    std::shared_mutex cacheMutex;
+    std::mutex recheckMutex;
+    uint64_t fingerprint = 0;
+    std::chrono::steady_clock::time_point nextRecheck;
+    std::chrono::steady_clock::duration recheckInterval = std::chrono::seconds(1);
+};
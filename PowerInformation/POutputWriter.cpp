@@ -0,0 +1,252 @@
+// POutputWriter.cpp - Implements the buffered UTF-8 writer and its record formats.
+//
+#include "pch.h"
+#include "POutputWriter.h"
+#include "PUtf8.h"
+#include <cmath>
+
+// Parse an output format name
+bool ParseOutputFormat(std::wstring_view text, POutputFormat& format)
+{
+    if (text == L"text") format = POutputFormat::Text;
+    else if (text == L"json") format = POutputFormat::Json;
+    else if (text == L"csv") format = POutputFormat::Csv;
+    else if (text == L"ndjson") format = POutputFormat::Ndjson;
+    else return false;
+    return true;
+}
+
+// Constructor
+POutputWriter::POutputWriter(FILE* stream, POutputFormat format, size_t capacity)
+    : stream(stream), format(format), capacity(capacity)
+{
+    buffer.reserve(capacity + capacity / 4);
+}
+
+// Destructor: closes a started JSON array; a command with an empty result set calls Finish itself
+POutputWriter::~POutputWriter()
+{
+    if (recordCount)
+        Finish();
+    else
+        Flush();
+}
+
+// Free text: encode to UTF-8 straight into the buffer
+POutputWriter& POutputWriter::operator<<(std::wstring_view text)
+{
+    WideToUtf8(text, buffer);
+    return Written();
+}
+
+POutputWriter& POutputWriter::operator<<(std::string_view utf8)
+{
+    buffer.append(utf8);
+    return Written();
+}
+
+POutputWriter& POutputWriter::operator<<(double value)
+{
+    char digits[64];
+    auto result = precision < 0 ? std::to_chars(digits, digits + sizeof(digits), value)
+                                : std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, precision);
+    buffer.append(digits, static_cast<size_t>(result.ptr - digits));
+    return Written();
+}
+
+// Start a record
+void POutputWriter::BeginRecord()
+{
+    inRecord = true;
+    fieldCount = 0;
+    switch (format) {
+    case POutputFormat::Json:
+        buffer += recordCount == 0 ? "[\n{" : ",\n{";
+        break;
+    case POutputFormat::Ndjson:
+        buffer += '{';
+        break;
+    case POutputFormat::Csv:
+        recordStart = buffer.size();
+        break;
+    case POutputFormat::Text:
+        break;
+    }
+}
+
+// Separator and key of the next field
+void POutputWriter::BeginField(std::string_view name)
+{
+    switch (format) {
+    case POutputFormat::Json:
+    case POutputFormat::Ndjson:
+        if (fieldCount)
+            buffer += ',';
+        AppendString(name);
+        buffer += ':';
+        break;
+    case POutputFormat::Csv:
+        if (fieldCount)
+            buffer += ',';
+        if (recordCount == 0) {
+            if (fieldCount)
+                csvHeader += ',';
+            csvHeader.append(name);
+        }
+        break;
+    case POutputFormat::Text:
+        if (fieldCount)
+            buffer += '\t';
+        break;
+    }
+    fieldCount++;
+}
+
+// String value in the current format's quoting
+void POutputWriter::AppendString(std::string_view utf8)
+{
+    switch (format) {
+    case POutputFormat::Json:
+    case POutputFormat::Ndjson:
+        buffer += '"';
+        // Copy runs that need no escaping in one append
+        for (size_t start = 0, i = 0; i <= utf8.size(); i++) {
+            unsigned char byte = i < utf8.size() ? static_cast<unsigned char>(utf8[i]) : 0;
+            if (i < utf8.size() && byte >= 0x20 && byte != '"' && byte != '\\')
+                continue;
+            buffer.append(utf8.data() + start, i - start);
+            start = i + 1;
+            if (i == utf8.size())
+                break;
+            static const char hex[] = "0123456789abcdef";
+            if (byte == '"' || byte == '\\') {
+                buffer += '\\';
+                buffer += static_cast<char>(byte);
+            } else if (byte == '\n') buffer += "\\n";
+            else if (byte == '\r') buffer += "\\r";
+            else if (byte == '\t') buffer += "\\t";
+            else {
+                buffer += "\\u00";
+                buffer += hex[byte >> 4];
+                buffer += hex[byte & 15];
+            }
+        }
+        buffer += '"';
+        break;
+    case POutputFormat::Csv:
+        if (utf8.find_first_of(",\"\r\n") == std::string_view::npos) {
+            buffer.append(utf8);
+            break;
+        }
+        buffer += '"';
+        for (char ch : utf8) {
+            if (ch == '"')
+                buffer += '"';
+            buffer += ch;
+        }
+        buffer += '"';
+        break;
+    case POutputFormat::Text:
+        if (utf8.empty()) {
+            buffer += '-';
+            break;
+        }
+        for (size_t start = 0;;) {
+            size_t i = utf8.find_first_of("\t\n\r\\", start);
+            buffer.append(utf8.substr(start, i - start));
+            if (i == std::string_view::npos)
+                break;
+            char ch = utf8[i];
+            buffer += '\\';
+            buffer += ch == '\t' ? 't' : ch == '\n' ? 'n' : ch == '\r' ? 'r' : '\\';
+            start = i + 1;
+        }
+        break;
+    }
+}
+
+// Wide string value: encoded once into a reused scratch buffer, then quoted
+void POutputWriter::AppendEncoded(std::wstring_view value)
+{
+    scratch.clear();
+    WideToUtf8(value, scratch);
+    AppendString(scratch);
+}
+
+void POutputWriter::Field(std::string_view name, std::wstring_view value)
+{
+    BeginField(name);
+    AppendEncoded(value);
+}
+
+void POutputWriter::Field(std::string_view name, std::string_view utf8)
+{
+    BeginField(name);
+    AppendString(utf8);
+}
+
+// NaN and infinities have no JSON form: written as a missing value in every format
+void POutputWriter::Field(std::string_view name, double value)
+{
+    if (!std::isfinite(value)) {
+        NullField(name);
+        return;
+    }
+    BeginField(name);
+    *this << value;
+}
+
+// Missing value: null in JSON, empty in CSV, "-" in text
+void POutputWriter::NullField(std::string_view name)
+{
+    BeginField(name);
+    if (format == POutputFormat::Json || format == POutputFormat::Ndjson)
+        buffer += "null";
+    else if (format == POutputFormat::Text)
+        buffer += '-';
+}
+
+// End a record
+void POutputWriter::EndRecord()
+{
+    switch (format) {
+    case POutputFormat::Json:
+        buffer += '}';
+        break;
+    case POutputFormat::Ndjson:
+        buffer += "}\n";
+        break;
+    case POutputFormat::Csv:
+        if (recordCount == 0) {
+            csvHeader += '\n';
+            buffer.insert(recordStart, csvHeader);
+        }
+        buffer += '\n';
+        break;
+    case POutputFormat::Text:
+        buffer += '\n';
+        break;
+    }
+    recordCount++;
+    inRecord = false;
+    Written();
+}
+
+// Write the buffer out
+void POutputWriter::Flush()
+{
+    if (!buffer.empty()) {
+        fwrite(buffer.data(), 1, buffer.size(), stream);
+        buffer.clear();
+    }
+    fflush(stream);
+}
+
+// Close the JSON array and flush
+void POutputWriter::Finish()
+{
+    if (!finished && format == POutputFormat::Json)
+        buffer += recordCount == 0 ? "[]\n" : "\n]\n";
+    finished = true;
+    Flush();
+}
@@ -0,0 +1,111 @@
+// POutputWriter.h - Declares POutputWriter, the buffered UTF-8 output layer of the command line tool.
+//
+// POutputWriter class:
+//   - Appends into one reusable buffer and writes it out when it fills up or on an explicit Flush(),
+//     instead of a flushing stream write per line. Wide text is encoded to UTF-8 once, in place.
+//   - Free text via operator<< (any format), records via BeginRecord/Field/EndRecord:
+//       Text:   values separated by tabs ("-" for empty/null; tab, newline, backslash escaped)
+//       CSV:    header row from the first record's field names, RFC 4180 quoting
+//       JSON:   one array of objects, closed by Finish()
+//       NDJSON: one object per line
+//   - A non-finite double field (NaN, infinity) is written like NullField, so JSON output stays valid.
+//   - Finish() closes the JSON array ("[]" if no record was written) and flushes; the destructor
+//     finishes an array that was started and otherwise only flushes.
+//
+#pragma once
+#include <charconv>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+enum class POutputFormat {
+    Text,
+    Json,
+    Csv,
+    Ndjson,
+};
+
+// Parse "text", "json", "csv" or "ndjson"
+bool ParseOutputFormat(std::wstring_view text, POutputFormat& format);
+
+class POutputWriter
+{
+public:
+    static constexpr size_t DefaultCapacity = 64 * 1024;
+
+    explicit POutputWriter(FILE* stream, POutputFormat format = POutputFormat::Text, size_t capacity = DefaultCapacity);
+    ~POutputWriter();
+    POutputWriter(const POutputWriter&) = delete;
+    POutputWriter& operator=(const POutputWriter&) = delete;
+
+    POutputFormat Format() const { return format; }
+    bool IsStructured() const { return format != POutputFormat::Text; }
+    // Digits after the decimal point for floating point values (-1: shortest form)
+    void SetPrecision(int digits) { precision = digits; }
+
+    // Free text
+    POutputWriter& operator<<(std::wstring_view text);
+    POutputWriter& operator<<(const wchar_t* text) { return *this << std::wstring_view(text); }
+    POutputWriter& operator<<(const std::wstring& text) { return *this << std::wstring_view(text); }
+    POutputWriter& operator<<(std::string_view utf8);
+    POutputWriter& operator<<(const char* utf8) { return *this << std::string_view(utf8); }
+    POutputWriter& operator<<(const std::string& utf8) { return *this << std::string_view(utf8); }
+    POutputWriter& operator<<(double value);
+    template <typename T>
+        requires std::is_integral_v<T> && (!std::is_same_v<T, bool>) && (!std::is_same_v<T, char>) && (!std::is_same_v<T, wchar_t>)
+    POutputWriter& operator<<(T value)
+    {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, static_cast<size_t>(result.ptr - digits));
+        return Written();
+    }
+
+    // Records
+    void BeginRecord();
+    void Field(std::string_view name, std::wstring_view value);
+    void Field(std::string_view name, std::string_view utf8);
+    void Field(std::string_view name, const wchar_t* value) { Field(name, std::wstring_view(value)); }
+    void Field(std::string_view name, const char* utf8) { Field(name, std::string_view(utf8)); }
+    void Field(std::string_view name, double value);
+    template <typename T>
+        requires std::is_integral_v<T> && (!std::is_same_v<T, bool>) && (!std::is_same_v<T, char>) && (!std::is_same_v<T, wchar_t>)
+    void Field(std::string_view name, T value)
+    {
+        BeginField(name);
+        *this << value;
+    }
+    void NullField(std::string_view name);
+    void EndRecord();
+
+    // Write the buffer out; Finish also closes a JSON array
+    void Flush();
+    void Finish();
+
+private:
+    void BeginField(std::string_view name);
+    void AppendString(std::string_view utf8);
+    // Quoted/escaped string value for the current format; wide values are encoded first into scratch
+    void AppendEncoded(std::wstring_view value);
+    // Flush once the buffer is full, but never in the middle of a record
+    POutputWriter& Written()
+    {
+        if (!inRecord && buffer.size() >= capacity)
+            Flush();
+        return *this;
+    }
+
+    FILE* stream;
+    POutputFormat format;
+    size_t capacity;
+    int precision = -1;
+    std::string buffer;
+    std::string scratch;
+    size_t recordCount = 0;
+    size_t fieldCount = 0;
+    size_t recordStart = 0;   // CSV: where the first record starts, for inserting the header
+    std::string csvHeader;
+    bool inRecord = false;
+    bool finished = false;
+};
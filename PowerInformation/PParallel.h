@@ -0,0 +1,44 @@
+// PParallel.h - Minimal bounded worker pool for fan-out enumeration.
+//
+// Functions:
+//   - ParallelFor: Runs fn(i) for i in [0, count) on at most threadCount threads.
+//     Work is handed out through an atomic counter, so slow items do not stall a fixed partition.
+//     The calling thread is one of the workers; threadCount <= 1 runs everything inline.
+//
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+template <typename Fn>
+void ParallelFor(size_t count, unsigned threadCount, Fn&& fn)
+{
+    size_t workers = std::min<size_t>(threadCount, count);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; i++)
+            fn(i);
+        return;
+    }
+
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed))
+            fn(i);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t t = 1; t < workers; t++)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+}
+
+// Default worker count for enumeration: the backend calls block, so more threads than cores is not useful
+inline unsigned DefaultEnumerationThreads()
+{
+    unsigned hardware = std::thread::hardware_concurrency();
+    return std::clamp(hardware, 1u, 8u);
+}
@@ -0,0 +1,18 @@
+// PPowerBackend.cpp - Selects the PPowerBackend implementation for the current platform.
+//
+#include "pch.h"
+#include "PPowerBackend.h"
+#include "PWinPowerBackend.h"
+#include "PLinuxPowerBackend.h"
+
+// Creates the backend for the current platform (nullptr when none is available)
+std::unique_ptr<PPowerBackend> CreateDefaultPowerBackend(const std::filesystem::path& sysfsRoot)
+{
+#ifdef _WIN32
+    return std::make_unique<PWinPowerBackend>();
+#elif defined(__linux__)
+    return std::make_unique<PLinuxPowerBackend>(sysfsRoot.empty() ? std::filesystem::path("/") : sysfsRoot);
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,56 @@
+// PPowerBackend.h - Declares the PPowerBackend interface that PInformation uses to reach the power store.
+//
+// PPowerBackend class:
+//   - Mirrors the powrprof calls PInformation needs (enumerate, read names, read/write values, activate).
+//   - Returns Win32 error codes (ERROR_SUCCESS, ERROR_NO_MORE_ITEMS, ...) like the powrprof API.
+//   - Exposes a generation counter so caches built on top of it can invalidate cheaply.
+//   - Lists the files whose modification signals a change (PChangeWatcher), when the store is file based.
+//
+// Implementations:
+//   - PWinPowerBackend: powrprof (Windows).
+//   - PLinuxPowerBackend: ACPI platform_profile and cpufreq sysfs attributes (Linux).
+//   - PFakePowerBackend: in-memory store for tests and benchmarks on any platform.
+//
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+class PPowerBackend
+{
+public:
+    virtual ~PPowerBackend() = default;
+
+    // Enumerate schemes, subgroups of a scheme and settings of a subgroup by index
+    virtual DWORD EnumerateScheme(DWORD index, GUID& scheme) = 0;
+    virtual DWORD EnumerateSubgroup(const GUID& scheme, DWORD index, GUID& subgroup) = 0;
+    virtual DWORD EnumerateSetting(const GUID& scheme, const GUID& subgroup, DWORD index, GUID& setting) = 0;
+
+    // Read friendly name/description; pass nullptr subgroup and setting to address the scheme itself
+    virtual DWORD ReadFriendlyName(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& name) = 0;
+    virtual DWORD ReadDescription(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& description) = 0;
+
+    // Read/write the AC (ac=true) or DC (ac=false) value of a setting
+    virtual DWORD ReadValue(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD& type, DWORD& value) = 0;
+    virtual DWORD WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD value) = 0;
+
+    // Active scheme
+    virtual DWORD GetActiveScheme(GUID& scheme) = 0;
+    virtual DWORD SetActiveScheme(const GUID& scheme) = 0;
+
+    // Counter that moves whenever schemes, settings or their names may have changed. Implementations derive
+    // it from the store itself (registry timestamps, their own edits) so it is cheap to poll before each use
+    virtual uint64_t GetGeneration() = 0;
+
+    // Identity of the store plus a version of its subgroup/setting names and descriptions; persistent
+    // caches of those strings (PMetadataCache) are discarded when it changes. 0 when not tracked
+    virtual uint64_t MetadataFingerprint() { return 0; }
+
+    // Files to watch for external changes (sysfs attributes); empty when the platform has its own notifications
+    virtual std::vector<std::filesystem::path> ChangeSources() { return {}; }
+};
+
+// Creates the backend for the current platform (nullptr when none is available).
+// sysfsRoot replaces "/" for the Linux backend (fixture trees); it is ignored on Windows.
+std::unique_ptr<PPowerBackend> CreateDefaultPowerBackend(const std::filesystem::path& sysfsRoot = {});
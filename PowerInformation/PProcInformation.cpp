@@ -1,12 +1,11 @@
 // PProcInformation.cpp - Implements processor core type detection for Intel Hybrid architecture.
 //
 // This file provides:
-// - Detection of P-core and E-core counts using Windows API.
-// - Console output of detected core types.
+// - Detection of P-core and E-core counts from the PCpuTopology (Windows API or Linux sysfs).
+// - Output of detected core types through a POutputWriter.
 //
 #include "pch.h"
 #include "PProcInformation.h"
-#include <iostream>
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -16,6 +15,11 @@ PProcInformation::PProcInformation() {
     DetectCoreTypes();
 }
 
+// Constructor: Detects core types from sysfs under sysfsRoot
+PProcInformation::PProcInformation(const std::filesystem::path& sysfsRoot) : sysfsRoot(sysfsRoot) {
+    DetectCoreTypes();
+}
+
 // Destructor
 PProcInformation::~PProcInformation() {}
 
@@ -24,34 +28,22 @@ bool PProcInformation::IsIntelHybridArchDetected() {
     return intelHybridArchDetected;
 }
 
-// Dumps P-core and E-core counts to console
-void PProcInformation::DumpCoreTypes() {
-    std::wcout << L"Intel Hybrid Architecture Detected: " << (intelHybridArchDetected ? L"Yes" : L"No") << std::endl;
-    std::wcout << L"P-Cores: " << pCoreCount << std::endl;
-    std::wcout << L"E-Cores: " << eCoreCount << std::endl;
+// Dumps P-core and E-core counts to the output
+void PProcInformation::DumpCoreTypes(POutputWriter& out) {
+    out << L"Intel Hybrid Architecture Detected: " << (intelHybridArchDetected ? L"Yes" : L"No") << L"\n";
+    out << L"P-Cores: " << pCoreCount << L"\n";
+    out << L"E-Cores: " << eCoreCount << L"\n";
+    out << L"Logical CPUs: " << topology.online.Count() << L"\n";
 }
 
-// Detects core types using Windows API (Windows 11+)
+// Detects core types from the topology (Windows API on Windows 11+, sysfs on Linux)
 void PProcInformation::DetectCoreTypes() {
 #ifdef _WIN32
-    DWORD len = 0;
-    GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &len);
-    std::vector<BYTE> buffer(len);
-    if (!GetLogicalProcessorInformationEx(RelationProcessorCore, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &len)) return;
-
-    BYTE* ptr = buffer.data();
-    BYTE* end = buffer.data() + len;
-    while (ptr < end) {
-        PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX coreInfo = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(ptr);
-        if (coreInfo->Relationship == RelationProcessorCore) {
-            // EfficiencyClass: 0 = P-core, 1 = E-core (Windows 11+)
-            if (coreInfo->Processor.EfficiencyClass == 0)
-                pCoreCount++;
-            else if (coreInfo->Processor.EfficiencyClass == 1)
-                eCoreCount++;
-        }
-        ptr += coreInfo->Size;
-    }
-    intelHybridArchDetected = (pCoreCount > 0 && eCoreCount > 0);
+    if (!PCpuTopology::LoadFromWindows(topology)) return;
+#else
+    if (!PCpuTopology::LoadFromSysfs(sysfsRoot, topology)) return;
 #endif
+    pCoreCount = static_cast<int>(topology.CoreCount(PCoreType::Performance));
+    eCoreCount = static_cast<int>(topology.CoreCount(PCoreType::Efficiency));
+    intelHybridArchDetected = (pCoreCount > 0 && eCoreCount > 0);
 }
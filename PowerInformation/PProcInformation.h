@@ -2,24 +2,34 @@
 //
 // PProcInformation class:
 //   - Detects Intel Hybrid architecture (P-core/E-core).
+//   - Keeps the full per-CPU topology (PCpuTopology) for placement decisions.
  //   - Dumps core type counts.
 //
 #pragma once
+#include <filesystem>
 #include <string>
+#include "PCpuTopology.h"
+#include "POutputWriter.h"
 
 class PProcInformation {
 public:
     PProcInformation();
+    // Linux: read topology from sysfs under root instead of "/" (fixture trees)
+    explicit PProcInformation(const std::filesystem::path& sysfsRoot);
     ~PProcInformation();
 
     // Returns true if Intel Hybrid architecture is detected
     bool IsIntelHybridArchDetected();
-    // Dumps P-core and E-core counts to console
-    void DumpCoreTypes();
+    // Dumps P-core and E-core counts to the output
+    void DumpCoreTypes(POutputWriter& out);
+    // Per-CPU topology
+    const PCpuTopology& Topology() const { return topology; }
 
 private:
     // Detects core types and sets member variables
     void DetectCoreTypes();
+    std::filesystem::path sysfsRoot = "/";
+    PCpuTopology topology;
     bool intelHybridArchDetected = false;
     int pCoreCount = 0;
     int eCoreCount = 0;
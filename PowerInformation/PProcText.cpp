@@ -0,0 +1,177 @@
+// PProcText.cpp - Implements the key/value scanner, the reusable file buffer and the cpuinfo/stat parsers.
+//
+#include "pch.h"
+#include "PProcText.h"
+#include <charconv>
+
+// Trim spaces and tabs on both sides
+static std::string_view Trim(std::string_view text)
+{
+    size_t first = text.find_first_not_of(" \t");
+    if (first == std::string_view::npos)
+        return {};
+    size_t last = text.find_last_not_of(" \t");
+    return text.substr(first, last - first + 1);
+}
+
+// Next key/value line
+bool PKeyValueScanner::Next(std::string_view& key, std::string_view& value)
+{
+    if (position >= text.size())
+        return false;
+    size_t end = text.find('\n', position);
+    if (end == std::string_view::npos)
+        end = text.size();
+    std::string_view line = text.substr(position, end - position);
+    position = end + 1;
+
+    size_t split = line.find(separator);
+    if (split == std::string_view::npos) {
+        key = Trim(line);
+        value = {};
+    } else {
+        key = Trim(line.substr(0, split));
+        value = Trim(line.substr(split + 1));
+    }
+    return true;
+}
+
+// Open a file for unbuffered reads straight into our buffer
+static std::FILE* OpenFile(const std::filesystem::path& path)
+{
+#ifdef _WIN32
+    std::FILE* file = _wfopen(path.c_str(), L"rb");
+#else
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+#endif
+    if (file)
+        std::setvbuf(file, nullptr, _IONBF, 0);
+    return file;
+}
+
+// Read a whole file once
+bool PProcFile::Read(const std::filesystem::path& path)
+{
+    std::FILE* once = OpenFile(path);
+    if (!once)
+        return false;
+    bool read = ReadAll(once);
+    std::fclose(once);
+    return read;
+}
+
+// Keep a file open for ReadAgain
+bool PProcFile::Open(const std::filesystem::path& path)
+{
+    Close();
+    file = OpenFile(path);
+    return file != nullptr;
+}
+
+// Re-read the open file from the start
+bool PProcFile::ReadAgain()
+{
+    return file && ReadAll(file);
+}
+
+// Close the kept file
+void PProcFile::Close()
+{
+    if (file)
+        std::fclose(file);
+    file = nullptr;
+}
+
+// Fill the buffer from the start of the file; it only grows when the file outgrows it
+bool PProcFile::ReadAll(std::FILE* from)
+{
+    size = 0;
+    if (std::fseek(from, 0, SEEK_SET) != 0)
+        return false;
+    for (;;) {
+        size += std::fread(buffer.data() + size, 1, buffer.size() - size, from);
+        if (size < buffer.size())
+            break;
+        buffer.resize(buffer.size() * 2);
+    }
+    return !std::ferror(from);
+}
+
+// Unsigned decimal prefix
+bool ParseUInt(std::string_view text, uint64_t& value)
+{
+    return std::from_chars(text.data(), text.data() + text.size(), value).ec == std::errc();
+}
+
+// "2400.000" (MHz) to kHz without floating point
+static uint32_t ParseMhzAsKHz(std::string_view text)
+{
+    uint64_t mhz = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), mhz);
+    if (ec != std::errc())
+        return 0;
+    uint64_t khz = mhz * 1000;
+    const char* last = text.data() + text.size();
+    if (end < last && *end == '.') {
+        uint64_t scale = 100;
+        for (const char* p = end + 1; p < last && *p >= '0' && *p <= '9' && scale > 0; p++, scale /= 10)
+            khz += static_cast<uint64_t>(*p - '0') * scale;
+    }
+    return static_cast<uint32_t>(khz);
+}
+
+// Records of /proc/cpuinfo: one "key : value" block per processor, blocks separated by blank lines
+bool ParseCpuInfo(std::string_view text, std::vector<PCpuInfoEntry>& out)
+{
+    out.clear();
+    PKeyValueScanner scanner(text, ':');
+    std::string_view key, value;
+    bool inRecord = false;
+    while (scanner.Next(key, value)) {
+        if (key.empty()) {
+            inRecord = false;
+            continue;
+        }
+        uint64_t number = 0;
+        if (key == "processor") {
+            if (!ParseUInt(value, number))
+                continue;
+            out.push_back({});
+            out.back().processor = static_cast<uint32_t>(number);
+            inRecord = true;
+        } else if (!inRecord) {
+            continue;
+        } else if (key == "physical id" && ParseUInt(value, number)) {
+            out.back().physicalId = static_cast<int32_t>(number);
+        } else if (key == "core id" && ParseUInt(value, number)) {
+            out.back().coreId = static_cast<int32_t>(number);
+        } else if (key == "cpu MHz") {
+            out.back().frequencyKHz = ParseMhzAsKHz(value);
+        }
+    }
+    return !out.empty();
+}
+
+// cpuN lines of /proc/stat: "cpu3 user nice system idle iowait irq softirq steal guest guest_nice"
+bool ParseProcStat(std::string_view text, std::vector<PCpuTimes>& out)
+{
+    out.clear();
+    PKeyValueScanner scanner(text, ' ');
+    std::string_view key, value;
+    while (scanner.Next(key, value)) {
+        uint64_t cpu = 0;
+        if (key.size() < 4 || key.compare(0, 3, "cpu") != 0 || !ParseUInt(key.substr(3), cpu))
+            continue;
+        PCpuTimes times;
+        times.cpu = static_cast<uint32_t>(cpu);
+        uint64_t* fields[] = { &times.user, &times.nice, &times.system, &times.idle, &times.iowait, &times.irq, &times.softirq, &times.steal };
+        size_t field = 0;
+        for (std::string_view token : PTokenRange(value, " ")) {
+            if (field == std::size(fields))
+                break;
+            ParseUInt(token, *fields[field++]);
+        }
+        out.push_back(times);
+    }
+    return !out.empty();
+}
@@ -0,0 +1,152 @@
+// PProcText.h - Allocation-free parsing of procfs/sysfs text (/proc/cpuinfo, /proc/stat, CPU lists).
+//
+// Types:
+//   - PTokenRange: Lazy range of the tokens of a string_view split at any of a set of delimiter characters;
+//     iterating yields string_views into the text, nothing is copied. Empty tokens are skipped unless asked.
+//   - PKeyValueScanner: Walks "key<separator>value" lines ("cpu MHz\t\t: 2400.000", "cpu0 123 0 45 ...")
+//     with both sides trimmed; a blank line comes back as an empty key (the record break in /proc/cpuinfo).
+//   - PProcFile: Reads a whole procfs/sysfs file with large unbuffered reads into a buffer that is kept
+//     between reads, so re-reading the same file (a sampler tick) does not allocate.
+//   - PCpuInfoEntry, PCpuTimes: Per-CPU records of /proc/cpuinfo and the cpuN lines of /proc/stat.
+//
+// Functions:
+//   - ParseUInt: Unsigned decimal prefix of a token (std::from_chars; no locale, no terminator needed).
+//   - ParseCpuInfo, ParseProcStat: Fill caller vectors (cleared, capacity kept) from the file text.
+//   CPU lists ("0-7,16-23") are decoded by PCpuMask::ParseList, which fills whole 64-bit words per range.
+//
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+class PTokenRange
+{
+public:
+    PTokenRange(std::string_view text, std::string_view delimiters, bool keepEmpty = false)
+        : text(text), delimiters(delimiters), keepEmpty(keepEmpty) {}
+
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+
+        Iterator() = default;
+        Iterator(const PTokenRange* range, size_t start) : range(range), start(start) { Settle(); }
+
+        reference operator*() const { return token; }
+        pointer operator->() const { return &token; }
+        Iterator& operator++()
+        {
+            start = end + 1;
+            Settle();
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const Iterator& other) const { return start == other.start; }
+
+    private:
+        // Find the token at start, skipping empty ones unless they are kept; past the text, start is npos
+        void Settle()
+        {
+            const std::string_view text = range->text;
+            while (start <= text.size()) {
+                end = text.find_first_of(range->delimiters, start);
+                if (end == std::string_view::npos)
+                    end = text.size();
+                if (end > start || (range->keepEmpty && end < text.size())) {
+                    token = text.substr(start, end - start);
+                    return;
+                }
+                start = end + 1;
+            }
+            start = std::string_view::npos;
+        }
+
+        const PTokenRange* range = nullptr;
+        size_t start = std::string_view::npos;
+        size_t end = 0;
+        std::string_view token;
+    };
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(); }
+
+private:
+    std::string_view text;
+    std::string_view delimiters;
+    bool keepEmpty;
+};
+
+class PKeyValueScanner
+{
+public:
+    PKeyValueScanner(std::string_view text, char separator) : text(text), separator(separator) {}
+
+    // Next line; false at the end of the text. A line without the separator is all key.
+    bool Next(std::string_view& key, std::string_view& value);
+
+private:
+    std::string_view text;
+    char separator;
+    size_t position = 0;
+};
+
+class PProcFile
+{
+public:
+    PProcFile() = default;
+    ~PProcFile() { Close(); }
+    PProcFile(const PProcFile&) = delete;
+    PProcFile& operator=(const PProcFile&) = delete;
+
+    // Read the whole file (procfs reports size 0, so read to the end); Text() views it until the next Read
+    bool Read(const std::filesystem::path& path);
+    // Keep the file open and re-read it from the start (for files read every sample)
+    bool Open(const std::filesystem::path& path);
+    bool ReadAgain();
+    void Close();
+
+    std::string_view Text() const { return std::string_view(buffer.data(), size); }
+
+private:
+    bool ReadAll(std::FILE* file);
+
+    std::FILE* file = nullptr;
+    std::vector<char> buffer = std::vector<char>(64 * 1024);
+    size_t size = 0;
+};
+
+struct PCpuInfoEntry {
+    uint32_t processor = 0;
+    int32_t physicalId = -1;  // package; -1 if not listed
+    int32_t coreId = -1;
+    uint32_t frequencyKHz = 0; // "cpu MHz"; 0 if not listed
+};
+
+struct PCpuTimes {
+    uint32_t cpu = 0;
+    // USER_HZ ticks: user, nice, system, idle, iowait, irq, softirq, steal
+    uint64_t user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+
+    uint64_t Busy() const { return user + nice + system + irq + softirq + steal; }
+    uint64_t Total() const { return Busy() + idle + iowait; }
+};
+
+// Unsigned decimal prefix of text; false if it does not start with a digit
+bool ParseUInt(std::string_view text, uint64_t& value);
+// Records of /proc/cpuinfo, in file order
+bool ParseCpuInfo(std::string_view text, std::vector<PCpuInfoEntry>& out);
+// cpuN lines of /proc/stat (the aggregate "cpu" line is skipped), in file order
+bool ParseProcStat(std::string_view text, std::vector<PCpuTimes>& out);
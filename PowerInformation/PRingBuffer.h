@@ -0,0 +1,72 @@
+// PRingBuffer.h - Lock-free single-producer/single-consumer ring of preallocated slots.
+//
+// PSpscRing class:
+//   - Capacity is rounded up to a power of two; slots are constructed once and reused, so a producer
+//     that fills a slot in place (e.g. vectors sized up front) never allocates.
+//   - Producer: BeginWrite() returns the next free slot or nullptr when full, EndWrite() publishes it.
+//   - Consumer: BeginRead() returns the oldest published slot or nullptr when empty, EndRead() frees it.
+//   - head/tail sit on separate cache lines; each side only writes its own index.
+//
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+template <typename T>
+class PSpscRing
+{
+public:
+    explicit PSpscRing(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    size_t Capacity() const { return slots.size(); }
+
+    // Slots are handed out by reference so the owner can preallocate their contents
+    T& Slot(size_t index) { return slots[index]; }
+
+    // Producer side
+    T* BeginWrite()
+    {
+        size_t head = writeIndex.load(std::memory_order_relaxed);
+        if (head - cachedRead == slots.size()) {
+            cachedRead = readIndex.load(std::memory_order_acquire);
+            if (head - cachedRead == slots.size())
+                return nullptr;
+        }
+        return &slots[head & mask];
+    }
+    void EndWrite()
+    {
+        writeIndex.store(writeIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer side
+    T* BeginRead()
+    {
+        size_t tail = readIndex.load(std::memory_order_relaxed);
+        if (tail == cachedWrite) {
+            cachedWrite = writeIndex.load(std::memory_order_acquire);
+            if (tail == cachedWrite)
+                return nullptr;
+        }
+        return &slots[tail & mask];
+    }
+    void EndRead()
+    {
+        readIndex.store(readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> writeIndex{ 0 };
+    size_t cachedRead = 0;  // producer's last view of readIndex
+    alignas(64) std::atomic<size_t> readIndex{ 0 };
+    size_t cachedWrite = 0; // consumer's last view of writeIndex
+};
@@ -0,0 +1,227 @@
+// PSearchIndex.cpp - Implements trigram index construction, posting list intersection and hit ranking.
+//
+#include "pch.h"
+#include "PSearchIndex.h"
+#include "PGuid.h"
+#include "PSettingFilter.h"
+#include <algorithm>
+#include <cwctype>
+#include <set>
+#include <numeric>
+
+// Rank of a word by where it occurs; name positions outrank any description position
+enum : uint32_t {
+    ScoreWholeName = 1000,
+    ScoreNamePrefix = 500,
+    ScoreNameWord = 300,
+    ScoreName = 200,
+    ScoreDescriptionWord = 30,
+    ScoreDescription = 20,
+};
+
+// Three folded characters packed into one key (21 bits each)
+uint64_t PSearchIndex::Trigram(const wchar_t* text)
+{
+    auto bits = [](wchar_t ch) { return static_cast<uint64_t>(static_cast<uint32_t>(ch) & 0x1FFFFF); };
+    return bits(text[0]) << 42 | bits(text[1]) << 21 | bits(text[2]);
+}
+
+// Fold a whole string
+static std::wstring Folded(std::wstring_view text)
+{
+    std::wstring folded(text);
+    std::transform(folded.begin(), folded.end(), folded.begin(), FoldCase);
+    return folded;
+}
+
+// Append a document and its trigrams
+void PSearchIndex::AddDocument(const GUID& setting, std::wstring_view name, std::wstring_view description, TrigramEntries& entries)
+{
+    uint32_t document = static_cast<uint32_t>(settings.size());
+    std::wstring foldedName = Folded(name), foldedDescription = Folded(description);
+    settings.push_back(setting);
+    nameIds.push_back(strings.Intern(name));
+    descriptionIds.push_back(strings.Intern(description));
+    foldedNameIds.push_back(strings.Intern(foldedName));
+    foldedDescriptionIds.push_back(strings.Intern(foldedDescription));
+    for (std::wstring_view text : { std::wstring_view(foldedName), std::wstring_view(foldedDescription) }) {
+        for (size_t i = 0; i + 3 <= text.size(); i++)
+            entries.emplace_back(Trigram(text.data() + i), document);
+    }
+}
+
+// Sorting groups each trigram's documents in ascending order; unique drops repeats within a document
+void PSearchIndex::Finish(TrigramEntries& entries)
+{
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+    postings.reserve(entries.size());
+    for (const auto& [trigram, document] : entries) {
+        if (trigrams.empty() || trigrams.back() != trigram) {
+            trigrams.push_back(trigram);
+            offsets.push_back(static_cast<uint32_t>(postings.size()));
+        }
+        postings.push_back(document);
+    }
+    offsets.push_back(static_cast<uint32_t>(postings.size()));
+}
+
+// Index the distinct settings of a snapshot
+PSearchIndex PSearchIndex::Build(const PCompactSnapshot& snapshot)
+{
+    PSearchIndex index;
+    std::set<GUID, PGuidLess> seen;
+    TrigramEntries entries;
+    for (size_t i = 0; i < snapshot.SettingCount(); i++) {
+        if (!seen.insert(snapshot.SettingGuids()[i]).second)
+            continue; // the same setting in another profile
+        index.AddDocument(snapshot.SettingGuids()[i], snapshot.Strings().Get(snapshot.NameIds()[i]),
+                          snapshot.Strings().Get(snapshot.DescriptionIds()[i]), entries);
+    }
+    index.Finish(entries);
+    return index;
+}
+
+// Index the distinct settings of the live store; names decide, so repeats cost one name read each
+PSearchIndex PSearchIndex::Build(PInformation& info, unsigned threadCount)
+{
+    struct Visitor : PSettingVisitor {
+        PSearchIndex& index;
+        TrigramEntries& entries;
+        std::set<GUID, PGuidLess> seen;
+
+        Visitor(PSearchIndex& index, TrigramEntries& entries) : index(index), entries(entries) {}
+        bool Accept(const GUID& setting, std::wstring_view /*name*/) override { return seen.insert(setting).second; }
+        bool OnSetting(const PSettingView& setting) override
+        {
+            index.AddDocument(setting.setting, setting.name, setting.description, entries);
+            return true;
+        }
+        bool WantsValues() const override { return false; }
+    };
+    PSearchIndex index;
+    TrigramEntries entries;
+    Visitor visitor(index, entries);
+    info.VisitSettings(visitor, nullptr, threadCount);
+    index.Finish(entries);
+    return index;
+}
+
+// Documents containing a trigram
+std::span<const uint32_t> PSearchIndex::Postings(uint64_t trigram) const
+{
+    auto it = std::lower_bound(trigrams.begin(), trigrams.end(), trigram);
+    if (it == trigrams.end() || *it != trigram)
+        return {};
+    size_t i = it - trigrams.begin();
+    return std::span<const uint32_t>(postings.data() + offsets[i], offsets[i + 1] - offsets[i]);
+}
+
+// True if word occurs in text at the start of a word
+static bool AtWordStart(std::wstring_view text, std::wstring_view word)
+{
+    for (size_t pos = text.find(word); pos != std::wstring_view::npos; pos = text.find(word, pos + 1)) {
+        if (pos == 0 || !std::iswalnum(text[pos - 1]))
+            return true;
+    }
+    return false;
+}
+
+// Rank of one folded word in one document
+uint32_t PSearchIndex::Score(uint32_t document, std::wstring_view word) const
+{
+    std::wstring_view name = strings.Get(foldedNameIds[document]);
+    size_t pos = name.find(word);
+    if (pos != std::wstring_view::npos) {
+        if (name.size() == word.size())
+            return ScoreWholeName;
+        if (pos == 0)
+            return ScoreNamePrefix;
+        return AtWordStart(name, word) ? ScoreNameWord : ScoreName;
+    }
+    std::wstring_view description = strings.Get(foldedDescriptionIds[document]);
+    if (description.find(word) == std::wstring_view::npos)
+        return 0;
+    return AtWordStart(description, word) ? ScoreDescriptionWord : ScoreDescription;
+}
+
+// Candidates from the posting lists of the long words, then a text check and a score for each
+bool PSearchIndex::Search(std::wstring_view query, std::vector<PSearchHit>& hits, size_t limit) const
+{
+    hits.clear();
+    const std::wstring folded = Folded(query);
+    std::vector<std::wstring_view> words;
+    for (size_t pos = 0; pos < folded.size();) {
+        size_t end = folded.find_first_of(L" \t", pos);
+        if (end == std::wstring::npos)
+            end = folded.size();
+        if (end > pos)
+            words.push_back(std::wstring_view(folded).substr(pos, end - pos));
+        pos = end + 1;
+    }
+    if (words.empty())
+        return false;
+
+    // Intersect shortest list first; a trigram no document has ends the search
+    std::vector<std::span<const uint32_t>> lists;
+    for (std::wstring_view word : words) {
+        for (size_t i = 0; i + 3 <= word.size(); i++) {
+            std::span<const uint32_t> list = Postings(Trigram(word.data() + i));
+            if (list.empty())
+                return true;
+            lists.push_back(list);
+        }
+    }
+    std::vector<uint32_t> candidates, next;
+    if (lists.empty()) {
+        candidates.resize(settings.size());
+        std::iota(candidates.begin(), candidates.end(), 0u);
+    } else {
+        std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b) { return a.size() < b.size(); });
+        candidates.assign(lists[0].begin(), lists[0].end());
+        for (size_t i = 1; i < lists.size() && !candidates.empty(); i++) {
+            next.clear();
+            std::set_intersection(candidates.begin(), candidates.end(), lists[i].begin(), lists[i].end(), std::back_inserter(next));
+            candidates.swap(next);
+        }
+    }
+
+    // Trigrams only say the characters are there; the text check confirms each word in one field
+    for (uint32_t document : candidates) {
+        uint32_t score = 0;
+        for (std::wstring_view word : words) {
+            uint32_t wordScore = Score(document, word);
+            if (wordScore == 0) {
+                score = 0;
+                break;
+            }
+            score += wordScore;
+        }
+        if (score)
+            hits.push_back({ document, score });
+    }
+
+    auto better = [this](const PSearchHit& a, const PSearchHit& b) {
+        if (a.score != b.score)
+            return a.score > b.score;
+        size_t aLength = Name(a.document).size(), bLength = Name(b.document).size();
+        if (aLength != bLength)
+            return aLength < bLength;
+        return a.document < b.document;
+    };
+    if (limit < hits.size()) {
+        std::partial_sort(hits.begin(), hits.begin() + limit, hits.end(), better);
+        hits.resize(limit);
+    } else {
+        std::sort(hits.begin(), hits.end(), better);
+    }
+    return true;
+}
+
+// Bytes held by the index
+size_t PSearchIndex::MemoryUsage() const
+{
+    auto bytes = [](const auto& column) { return column.capacity() * sizeof(column[0]); };
+    return sizeof(*this) + strings.MemoryUsage() + bytes(settings) + bytes(nameIds) + bytes(descriptionIds) +
+           bytes(foldedNameIds) + bytes(foldedDescriptionIds) + bytes(trigrams) + bytes(offsets) + bytes(postings);
+}
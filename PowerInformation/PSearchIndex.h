@@ -0,0 +1,79 @@
+// PSearchIndex.h - Declares PSearchIndex, a trigram index over setting names and descriptions.
+//
+// Types:
+//   - PSearchHit: One matching setting and its rank score.
+//
+// PSearchIndex class:
+//   - Build() takes the distinct settings (by GUID, first name/description wins) of a PCompactSnapshot, so a
+//     setting shared by every profile is one document. Text is folded once (FoldCase) when building.
+//     The PInformation overload visits the live store instead: Accept drops a setting already indexed, so
+//     only its first profile's description is read, and no values are read at all.
+//   - Every distinct trigram of a folded name or description maps to the sorted list of documents that
+//     contain it. A query word of three or more characters intersects the lists of its trigrams; only those
+//     candidates are compared against the text, so a query touches a handful of documents instead of all.
+//   - Search() splits the query at whitespace; every word must occur in the name or the description.
+//     Hits are ranked by where the words occur: whole name, name prefix, start of a word in the name,
+//     anywhere in the name, then the same in the description. Ties go to the shorter name.
+//   - The index is read-only after Build(); Search() may run on several threads at once.
+//
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "PCompactSnapshot.h"
+#include "PInformation.h"
+
+// One search result
+struct PSearchHit {
+    uint32_t document;  // PSearchIndex document id
+    uint32_t score;     // higher ranks first
+};
+
+class PSearchIndex
+{
+public:
+    // Index the distinct settings of a snapshot, or of the live store
+    static PSearchIndex Build(const PCompactSnapshot& snapshot);
+    static PSearchIndex Build(PInformation& info, unsigned threadCount = 1);
+
+    // Ranked hits for every document that contains all words of query (at most limit of them);
+    // false if the query has no words
+    bool Search(std::wstring_view query, std::vector<PSearchHit>& hits, size_t limit = SIZE_MAX) const;
+
+    // Documents
+    size_t DocumentCount() const { return settings.size(); }
+    const GUID& Setting(uint32_t document) const { return settings[document]; }
+    std::wstring_view Name(uint32_t document) const { return strings.Get(nameIds[document]); }
+    std::wstring_view Description(uint32_t document) const { return strings.Get(descriptionIds[document]); }
+
+    // Distinct trigrams and bytes held by the index
+    size_t TrigramCount() const { return trigrams.size(); }
+    size_t MemoryUsage() const;
+
+private:
+    using TrigramEntries = std::vector<std::pair<uint64_t, uint32_t>>; // (trigram, document)
+
+    // Append a document; its trigrams go to entries
+    void AddDocument(const GUID& setting, std::wstring_view name, std::wstring_view description, TrigramEntries& entries);
+    // Build the trigram table and posting lists from every document's entries
+    void Finish(TrigramEntries& entries);
+    // Three folded characters packed into one key (21 bits each)
+    static uint64_t Trigram(const wchar_t* text);
+    // Documents containing a trigram; empty if none
+    std::span<const uint32_t> Postings(uint64_t trigram) const;
+    // Rank of one folded word in one document; 0 if the document does not contain it
+    uint32_t Score(uint32_t document, std::wstring_view word) const;
+
+    std::vector<GUID> settings;               // document -> setting GUID
+    std::vector<uint32_t> nameIds;            // document -> name in strings
+    std::vector<uint32_t> descriptionIds;     // document -> description in strings
+    std::vector<uint32_t> foldedNameIds;      // document -> folded name in strings
+    std::vector<uint32_t> foldedDescriptionIds;
+    PStringTable strings;
+
+    std::vector<uint64_t> trigrams;           // sorted distinct trigrams
+    std::vector<uint32_t> offsets;            // trigram i -> postings[offsets[i], offsets[i + 1])
+    std::vector<uint32_t> postings;           // document ids, ascending within each trigram
+};
@@ -0,0 +1,93 @@
+// PSettingCatalog.cpp - Implements the name -> GUID index used by PInformation Get/Set.
+//
+#include "pch.h"
+#include "PSettingCatalog.h"
+
+// Constructor
+PSettingCatalog::PSettingCatalog(PPowerBackend& backend) : backend(backend) {}
+
+// Resolve (profile, setting) names to GUIDs
+bool PSettingCatalog::Find(const std::wstring& profileName, const std::wstring& settingName, PSettingLocation& out)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    RebuildIfStale();
+    auto scheme = schemes.find(profileName);
+    if (scheme == schemes.end()) return false;
+    auto setting = scheme->second.settings.find(settingName);
+    if (setting == scheme->second.settings.end()) return false;
+    out = setting->second;
+    return true;
+}
+
+// Resolve a profile name to its scheme GUID
+bool PSettingCatalog::FindScheme(const std::wstring& profileName, GUID& out)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    RebuildIfStale();
+    auto scheme = schemes.find(profileName);
+    if (scheme == schemes.end()) return false;
+    out = scheme->second.guid;
+    return true;
+}
+
+// Drop the index; the next lookup rebuilds it
+void PSettingCatalog::Invalidate()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    valid = false;
+}
+
+// Number of profiles currently indexed
+size_t PSettingCatalog::SchemeCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    RebuildIfStale();
+    return schemes.size();
+}
+
+// Rebuild when never built, invalidated, or the backend reports a new generation
+void PSettingCatalog::RebuildIfStale()
+{
+    if (valid && builtGeneration == backend.GetGeneration())
+        return;
+    Rebuild();
+}
+
+// Walk every scheme/subgroup/setting once and index them by name
+void PSettingCatalog::Rebuild()
+{
+    // Read the generation first so a change during the walk triggers another rebuild
+    builtGeneration = backend.GetGeneration();
+    schemes.clear();
+
+    std::wstring name;
+    GUID scheme_guid = {};
+    for (DWORD scheme_idx = 0;; scheme_idx++) {
+        DWORD status = backend.EnumerateScheme(scheme_idx, scheme_guid);
+        if (status == ERROR_NO_MORE_ITEMS)
+            break;
+        if (status != ERROR_SUCCESS)
+            continue;
+
+        backend.ReadFriendlyName(&scheme_guid, nullptr, nullptr, name);
+        if (name.empty())
+            name = GuidToString(scheme_guid);
+        auto inserted = schemes.try_emplace(name);
+        if (!inserted.second)
+            continue; // duplicate profile name: first one wins
+        SchemeEntry& entry = inserted.first->second;
+        entry.guid = scheme_guid;
+
+        GUID subgroup_guid = {};
+        for (DWORD subgroup_idx = 0; backend.EnumerateSubgroup(scheme_guid, subgroup_idx, subgroup_guid) == ERROR_SUCCESS; subgroup_idx++) {
+            GUID setting_guid = {};
+            for (DWORD setting_idx = 0; backend.EnumerateSetting(scheme_guid, subgroup_guid, setting_idx, setting_guid) == ERROR_SUCCESS; setting_idx++) {
+                backend.ReadFriendlyName(&scheme_guid, &subgroup_guid, &setting_guid, name);
+                if (name.empty())
+                    name = GuidToString(setting_guid);
+                entry.settings.try_emplace(name, PSettingLocation{ scheme_guid, subgroup_guid, setting_guid });
+            }
+        }
+    }
+    valid = true;
+}
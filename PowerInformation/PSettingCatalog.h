@@ -0,0 +1,55 @@
+// PSettingCatalog.h - Declares PSettingCatalog, a name -> GUID index over the power store.
+//
+// Types:
+//   - PSettingLocation: Scheme, subgroup and setting GUIDs that address one setting.
+//
+// PSettingCatalog class:
+//   - Walks the backend once and indexes (profile name, setting name) -> PSettingLocation.
+//   - Lookups are hash lookups; the index is rebuilt lazily when the backend generation
+//     changes or Invalidate() is called.
+//   - Names that read back empty are indexed by their GUID string, like the enumeration output.
+//   - When names repeat, the first one in enumeration order wins (same as the old linear scan).
+//
+#pragma once
+#include "PPowerBackend.h"
+#include "PGuid.h"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// GUIDs that address one setting
+struct PSettingLocation {
+    GUID scheme;
+    GUID subgroup;
+    GUID setting;
+};
+
+class PSettingCatalog
+{
+public:
+    explicit PSettingCatalog(PPowerBackend& backend);
+
+    // Resolve (profile, setting) names to GUIDs
+    bool Find(const std::wstring& profileName, const std::wstring& settingName, PSettingLocation& out);
+    // Resolve a profile name to its scheme GUID
+    bool FindScheme(const std::wstring& profileName, GUID& out);
+    // Drop the index; the next lookup rebuilds it
+    void Invalidate();
+    // Number of profiles currently indexed (rebuilds if stale)
+    size_t SchemeCount();
+
+private:
+    struct SchemeEntry {
+        GUID guid;
+        std::unordered_map<std::wstring, PSettingLocation> settings; // setting name -> location
+    };
+
+    void RebuildIfStale();
+    void Rebuild();
+
+    PPowerBackend& backend;
+    std::mutex mutex;
+    std::unordered_map<std::wstring, SchemeEntry> schemes; // profile name -> scheme entry
+    uint64_t builtGeneration = 0;
+    bool valid = false;
+};
@@ -0,0 +1,160 @@
+// PSettingFilter.cpp - Implements predicate compilation, allocation-free case-insensitive matching and
+// the per-name cache.
+//
+#include "pch.h"
+#include "PSettingFilter.h"
+#include "PGuid.h"
+#include <algorithm>
+#include <array>
+#include <cwctype>
+
+static constexpr std::array<wchar_t, 128> MakeAsciiLower()
+{
+    std::array<wchar_t, 128> table{};
+    for (int c = 0; c < 128; c++)
+        table[c] = static_cast<wchar_t>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+    return table;
+}
+static constexpr std::array<wchar_t, 128> AsciiLower = MakeAsciiLower();
+
+// Simple lowercase of the Latin, Greek, Cyrillic and Armenian letters setting names are localized into.
+// towlower only maps these under a matching locale, and the CLI usually runs in the "C" locale.
+static wchar_t LowerLetter(wchar_t ch)
+{
+    const uint32_t c = static_cast<uint32_t>(ch);
+    // Blocks where each capital is followed by its small letter, starting with a capital at first
+    auto alternating = [c](uint32_t first, uint32_t last) { return c >= first && c <= last && (c - first) % 2 == 0; };
+    if ((c >= 0xC0 && c <= 0xDE && c != 0xD7) || (c >= 0x391 && c <= 0x3AB && c != 0x3A2) || (c >= 0x410 && c <= 0x42F) ||
+        (c >= 0xFF21 && c <= 0xFF3A))
+        return static_cast<wchar_t>(c + 0x20);
+    if (c >= 0x400 && c <= 0x40F)
+        return static_cast<wchar_t>(c + 0x50);
+    if (c >= 0x531 && c <= 0x556)
+        return static_cast<wchar_t>(c + 0x30);
+    if (alternating(0x100, 0x12F) || alternating(0x132, 0x137) || alternating(0x139, 0x148) || alternating(0x14A, 0x177) ||
+        alternating(0x179, 0x17E) || alternating(0x460, 0x481) || alternating(0x48A, 0x4BF) || alternating(0x4C1, 0x4CE) ||
+        alternating(0x4D0, 0x52F) || alternating(0x1E00, 0x1E95) || alternating(0x1EA0, 0x1EFF))
+        return static_cast<wchar_t>(c + 1);
+    switch (c) {
+    case 0x130: return L'i';
+    case 0x178: return static_cast<wchar_t>(0xFF);
+    case 0x386: return static_cast<wchar_t>(0x3AC);
+    case 0x388: case 0x389: case 0x38A: return static_cast<wchar_t>(c + 0x25);
+    case 0x38C: return static_cast<wchar_t>(0x3CC);
+    case 0x38E: case 0x38F: return static_cast<wchar_t>(c + 0x3F);
+    case 0x4C0: return static_cast<wchar_t>(0x4CF);
+    }
+    return static_cast<wchar_t>(::towlower(ch));
+}
+
+// Case-fold one character
+wchar_t FoldCase(wchar_t ch)
+{
+    return static_cast<uint32_t>(ch) < 128 ? AsciiLower[ch] : LowerLetter(ch);
+}
+
+// Case-insensitive substring search; needle is already folded
+static bool ContainsFolded(std::wstring_view text, std::wstring_view needle)
+{
+    if (needle.size() > text.size())
+        return false;
+    const wchar_t first = needle[0];
+    for (size_t i = 0; i + needle.size() <= text.size(); i++) {
+        if (FoldCase(text[i]) != first)
+            continue;
+        size_t k = 1;
+        while (k < needle.size() && FoldCase(text[i + k]) == needle[k])
+            k++;
+        if (k == needle.size())
+            return true;
+    }
+    return false;
+}
+
+// Case-insensitive glob over the whole text ('*' any run, '?' any character); mask is already folded.
+// Backtracks only to the last '*', as StringUtil::WildcardMatch does.
+static bool GlobFolded(std::wstring_view text, std::wstring_view mask)
+{
+    size_t t = 0, m = 0;
+    size_t starMask = std::wstring_view::npos, starText = 0;
+    while (t < text.size()) {
+        if (m < mask.size() && mask[m] == L'*') {
+            starMask = ++m;
+            starText = t;
+        } else if (m < mask.size() && (mask[m] == L'?' || mask[m] == FoldCase(text[t]))) {
+            m++;
+            t++;
+        } else if (starMask != std::wstring_view::npos) {
+            m = starMask;
+            t = ++starText;
+        } else {
+            return false;
+        }
+    }
+    while (m < mask.size() && mask[m] == L'*')
+        m++;
+    return m == mask.size();
+}
+
+// Compile predicates
+bool PSettingFilter::Compile(const std::vector<std::wstring>& predicates, PSettingFilter& out, size_t& errorIndex)
+{
+    out = PSettingFilter();
+    errorIndex = 0;
+    for (size_t i = 0; i < predicates.size(); i++) {
+        const std::wstring& predicate = predicates[i];
+        if (predicate.empty()) {
+            errorIndex = i;
+            return false;
+        }
+        GUID guid = {};
+        if (GuidFromString(predicate, guid)) {
+            out.guids.push_back(guid);
+            continue;
+        }
+        std::wstring folded = predicate;
+        std::transform(folded.begin(), folded.end(), folded.begin(), FoldCase);
+        if (folded.find_first_of(L"*?") != std::wstring::npos)
+            out.globs.push_back(std::move(folded));
+        else
+            out.substrings.push_back(std::move(folded));
+    }
+    std::sort(out.guids.begin(), out.guids.end(), PGuidLess());
+    return true;
+}
+
+// The default listing's filter
+PSettingFilter PSettingFilter::ThreadScheduling()
+{
+    PSettingFilter filter;
+    size_t errorIndex = 0;
+    Compile({ L"heterogeneous thread scheduling policy", L"heterogeneous short running thread scheduling policy" }, filter, errorIndex);
+    return filter;
+}
+
+// GUID predicates first, then the remembered (or newly computed) name result
+bool PSettingFilter::Matches(const GUID& setting, std::wstring_view name)
+{
+    if (!guids.empty() && std::binary_search(guids.begin(), guids.end(), setting, PGuidLess()))
+        return true;
+    if (substrings.empty() && globs.empty())
+        return false;
+    uint32_t id = names.Intern(name);
+    if (id == results.size())
+        results.push_back(MatchesName(name));
+    return results[id];
+}
+
+// Evaluate the name predicates
+bool PSettingFilter::MatchesName(std::wstring_view name) const
+{
+    for (const std::wstring& needle : substrings) {
+        if (ContainsFolded(name, needle))
+            return true;
+    }
+    for (const std::wstring& mask : globs) {
+        if (GlobFolded(name, mask))
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,48 @@
+// PSettingFilter.h - Declares PSettingFilter, setting predicates compiled once and evaluated once per name.
+//
+// PSettingFilter class:
+//   - Compile() turns a list of predicates into one matcher; a setting matches if any predicate does:
+//       - a GUID ("{...}" or bare): that setting, whatever its name;
+//       - text with '*' or '?': glob over the whole name (StringUtil::WildcardMatch rules);
+//       - other text: substring of the name.
+//     Name predicates ignore case. Needles are folded once at compile time; names are folded one
+//     character at a time while matching, so nothing is copied. Folding does not depend on the C locale:
+//     ASCII by table, Latin, Greek, Cyrillic and Armenian by their case pairs, anything else with towlower.
+//   - Matches() interns each name and remembers its result, so a name shared by every profile is only
+//     evaluated once.
+//   - ThreadScheduling() is the default listing's filter.
+//
+#pragma once
+#include "PCompactSnapshot.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Case-fold one character as name predicates compare it
+wchar_t FoldCase(wchar_t ch);
+
+class PSettingFilter
+{
+public:
+    // Compile predicates; false with the index of the first empty one
+    static bool Compile(const std::vector<std::wstring>& predicates, PSettingFilter& out, size_t& errorIndex);
+    // The heterogeneous thread scheduling policies
+    static PSettingFilter ThreadScheduling();
+
+    // True if any predicate matches; the name's result is remembered
+    bool Matches(const GUID& setting, std::wstring_view name);
+    // Evaluate the name predicates without the cache
+    bool MatchesName(std::wstring_view name) const;
+
+    size_t PredicateCount() const { return substrings.size() + globs.size() + guids.size(); }
+    // Distinct names evaluated so far
+    size_t CachedNames() const { return names.Count(); }
+
+private:
+    std::vector<std::wstring> substrings; // folded
+    std::vector<std::wstring> globs;      // folded
+    std::vector<GUID> guids;              // sorted
+
+    PStringTable names;                   // names seen by Matches
+    std::vector<bool> results;            // name id -> result
+};
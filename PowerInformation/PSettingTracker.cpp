@@ -0,0 +1,161 @@
+// PSettingTracker.cpp - Implements value-only refresh and delta reporting for Watch.
+//
+#include "pch.h"
+#include "PSettingTracker.h"
+#include "PGuid.h"
+
+// Constructor
+PSettingTracker::PSettingTracker(PInformation& info, PPowerBackend& backend)
+    : info(info), backend(backend)
+{
+}
+
+// Full capture
+void PSettingTracker::Capture()
+{
+    generation = backend.GetGeneration();
+    info.InvalidateCatalog();
+    snapshot = PCompactSnapshot::Capture(info);
+    if (backend.GetActiveScheme(activeScheme) != ERROR_SUCCESS)
+        activeScheme = {};
+}
+
+// Name of a scheme in a snapshot (GUID string if unknown)
+std::wstring PSettingTracker::SchemeName(const PCompactSnapshot& source, const GUID& scheme) const
+{
+    const auto& guids = source.SchemeGuids();
+    for (size_t i = 0; i < guids.size(); i++) {
+        if (guids[i] == scheme)
+            return std::wstring(source.Strings().Get(source.SchemeNameIds()[i]));
+    }
+    return GuidToString(scheme);
+}
+
+// True if the backend layout moved since the capture
+bool PSettingTracker::SchemesChanged()
+{
+    if (backend.GetGeneration() != generation)
+        return true;
+    const auto& guids = snapshot.SchemeGuids();
+    GUID scheme;
+    DWORD index = 0;
+    for (; backend.EnumerateScheme(index, scheme) == ERROR_SUCCESS; index++) {
+        if (index >= guids.size() || guids[index] != scheme)
+            return true;
+    }
+    return index != guids.size();
+}
+
+// Re-read and report differences
+void PSettingTracker::Refresh(std::vector<PSettingChange>& changes)
+{
+    GUID active = {};
+    if (backend.GetActiveScheme(active) == ERROR_SUCCESS && active != activeScheme) {
+        PSettingChange change;
+        change.kind = PSettingChange::Kind::ActiveScheme;
+        change.previousProfile = SchemeName(snapshot, activeScheme);
+        activeScheme = active;
+        if (SchemesChanged()) {
+            Recapture(changes);
+            change.profileName = SchemeName(snapshot, active);
+            changes.insert(changes.begin(), change);
+            return;
+        }
+        change.profileName = SchemeName(snapshot, active);
+        changes.push_back(change);
+    }
+    if (SchemesChanged()) {
+        Recapture(changes);
+        return;
+    }
+
+    // Same layout: only the values need reading
+    const auto& schemes = snapshot.SchemeGuids();
+    for (size_t i = 0; i < snapshot.SettingCount(); i++) {
+        const GUID& scheme = schemes[snapshot.SettingSchemes()[i]];
+        DWORD type = 0, ac = 0, dc = 0;
+        bool acOk = backend.ReadValue(scheme, snapshot.SubgroupGuids()[i], snapshot.SettingGuids()[i], true, type, ac) == ERROR_SUCCESS;
+        bool dcOk = backend.ReadValue(scheme, snapshot.SubgroupGuids()[i], snapshot.SettingGuids()[i], false, type, dc) == ERROR_SUCCESS;
+        bool oldAcOk = snapshot.AcTypes()[i] == PValueType::Dword;
+        bool oldDcOk = snapshot.DcTypes()[i] == PValueType::Dword;
+        bool acChanged = acOk != oldAcOk || (acOk && ac != snapshot.AcValues()[i]);
+        bool dcChanged = dcOk != oldDcOk || (dcOk && dc != snapshot.DcValues()[i]);
+        if (!acChanged && !dcChanged)
+            continue;
+        PSettingChange change;
+        change.kind = PSettingChange::Kind::Value;
+        change.profileName = snapshot.Strings().Get(snapshot.SchemeNameIds()[snapshot.SettingSchemes()[i]]);
+        change.settingName = snapshot.Strings().Get(snapshot.NameIds()[i]);
+        change.acChanged = acChanged;
+        change.dcChanged = dcChanged;
+        change.oldAcOk = oldAcOk;
+        change.oldDcOk = oldDcOk;
+        change.oldAc = snapshot.AcValues()[i];
+        change.oldDc = snapshot.DcValues()[i];
+        change.newAcOk = acOk;
+        change.newDcOk = dcOk;
+        change.newAc = acOk ? ac : 0;
+        change.newDc = dcOk ? dc : 0;
+        changes.push_back(change);
+        snapshot.SetValue(i, true, acOk ? PValueType::Dword : PValueType::Error, ac);
+        snapshot.SetValue(i, false, dcOk ? PValueType::Dword : PValueType::Error, dc);
+    }
+}
+
+// Layout changed: capture again and diff the two snapshots by (scheme, setting) GUID
+void PSettingTracker::Recapture(std::vector<PSettingChange>& changes)
+{
+    PCompactSnapshot previous = std::move(snapshot);
+    Capture();
+
+    auto key = [](const PCompactSnapshot& source, size_t i) {
+        return GuidToString(source.SchemeGuids()[source.SettingSchemes()[i]]) + GuidToString(source.SettingGuids()[i]);
+    };
+    std::unordered_map<std::wstring, size_t> before;
+    for (size_t i = 0; i < previous.SettingCount(); i++)
+        before.emplace(key(previous, i), i);
+
+    auto describe = [](const PCompactSnapshot& source, size_t i, PSettingChange::Kind kind) {
+        PSettingChange change;
+        change.kind = kind;
+        change.profileName = source.Strings().Get(source.SchemeNameIds()[source.SettingSchemes()[i]]);
+        change.settingName = source.Strings().Get(source.NameIds()[i]);
+        change.newAcOk = source.AcTypes()[i] == PValueType::Dword;
+        change.newDcOk = source.DcTypes()[i] == PValueType::Dword;
+        change.newAc = source.AcValues()[i];
+        change.newDc = source.DcValues()[i];
+        return change;
+    };
+
+    for (size_t i = 0; i < snapshot.SettingCount(); i++) {
+        auto it = before.find(key(snapshot, i));
+        if (it == before.end()) {
+            changes.push_back(describe(snapshot, i, PSettingChange::Kind::Added));
+            continue;
+        }
+        size_t j = it->second;
+        before.erase(it);
+        PSettingChange change = describe(snapshot, i, PSettingChange::Kind::Value);
+        change.oldAcOk = previous.AcTypes()[j] == PValueType::Dword;
+        change.oldDcOk = previous.DcTypes()[j] == PValueType::Dword;
+        change.oldAc = previous.AcValues()[j];
+        change.oldDc = previous.DcValues()[j];
+        change.acChanged = change.oldAcOk != change.newAcOk || change.oldAc != change.newAc;
+        change.dcChanged = change.oldDcOk != change.newDcOk || change.oldDc != change.newDc;
+        if (change.acChanged || change.dcChanged)
+            changes.push_back(change);
+    }
+    // Whatever is left in the index disappeared; report it in capture order
+    std::vector<size_t> removed;
+    for (const auto& entry : before)
+        removed.push_back(entry.second);
+    std::sort(removed.begin(), removed.end());
+    for (size_t j : removed) {
+        PSettingChange change = describe(previous, j, PSettingChange::Kind::Removed);
+        std::swap(change.oldAcOk, change.newAcOk);
+        std::swap(change.oldDcOk, change.newDcOk);
+        std::swap(change.oldAc, change.newAc);
+        std::swap(change.oldDc, change.newDc);
+        changes.push_back(change);
+    }
+}
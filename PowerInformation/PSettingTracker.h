@@ -0,0 +1,53 @@
+// PSettingTracker.h - Declares PSettingTracker, which turns change notifications into a list of deltas.
+//
+// PSettingTracker class:
+//   - Capture() takes one full PCompactSnapshot (names, descriptions, values) and the active scheme.
+//   - Refresh() re-reads only the values of the captured settings and the active scheme, and reports what
+//     differs. A full re-capture happens only when the backend generation or the scheme list changed.
+//
+#pragma once
+#include <string>
+#include <vector>
+#include "PCompactSnapshot.h"
+#include "PInformation.h"
+#include "PPowerBackend.h"
+
+struct PSettingChange {
+    enum class Kind {
+        ActiveScheme, // profileName is the new active scheme, previousProfile the old one
+        Value,        // AC and/or DC value of a setting changed
+        Added,        // setting (or whole scheme) appeared
+        Removed,      // setting (or whole scheme) disappeared
+    };
+    Kind kind = Kind::Value;
+    std::wstring profileName;
+    std::wstring previousProfile;
+    std::wstring settingName;
+    bool acChanged = false, dcChanged = false;
+    bool oldAcOk = false, oldDcOk = false, newAcOk = false, newDcOk = false;
+    DWORD oldAc = 0, oldDc = 0, newAc = 0, newDc = 0;
+};
+
+class PSettingTracker
+{
+public:
+    PSettingTracker(PInformation& info, PPowerBackend& backend);
+
+    // Full capture; the baseline for later Refresh calls
+    void Capture();
+    // Re-read and append the differences from the last state to changes
+    void Refresh(std::vector<PSettingChange>& changes);
+
+    const PCompactSnapshot& Snapshot() const { return snapshot; }
+
+private:
+    bool SchemesChanged();
+    void Recapture(std::vector<PSettingChange>& changes);
+    std::wstring SchemeName(const PCompactSnapshot& source, const GUID& scheme) const;
+
+    PInformation& info;
+    PPowerBackend& backend;
+    PCompactSnapshot snapshot;
+    GUID activeScheme = {};
+    uint64_t generation = 0;
+};
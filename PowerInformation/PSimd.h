@@ -0,0 +1,24 @@
+// PSimd.h - Compile-time selection of the vector instruction set used by the scanning and transcoding code.
+//
+// Exactly one of these is defined; PSIMD_AVX2 also defines PSIMD_SSE2:
+//   - PSIMD_AVX2: the compiler targets AVX2 (/arch:AVX2, -mavx2, -march=x86-64-v3).
+//   - PSIMD_SSE2: any x64 build.
+//   - PSIMD_NEON: ARM64.
+//   - PSIMD_NONE: portable scalar code, usually on 64-bit words.
+// There is no runtime dispatch: a binary uses what it was compiled for.
+//
+#pragma once
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PSIMD_AVX2
+#define PSIMD_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PSIMD_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define PSIMD_NEON
+#else
+#define PSIMD_NONE
+#endif
@@ -0,0 +1,224 @@
+// PSnapshotDiff.cpp - Implements the GUID-keyed snapshot diff.
+//
+#include "pch.h"
+#include "PSnapshotDiff.h"
+#include "PGuid.h"
+
+namespace {
+
+// (scheme, subgroup, setting) triple used as the join key; a setting GUID may appear under two subgroups
+struct SettingKey {
+    GUID scheme;
+    GUID subgroup;
+    GUID setting;
+    bool operator==(const SettingKey& other) const
+    {
+        return scheme == other.scheme && subgroup == other.subgroup && setting == other.setting;
+    }
+};
+
+struct SettingKeyHash {
+    size_t operator()(const SettingKey& key) const noexcept
+    {
+        PGuidHash hash;
+        return (hash(key.scheme) * 31 + hash(key.subgroup)) * 31 + hash(key.setting);
+    }
+};
+
+SettingKey KeyOf(const PCompactSnapshot& snapshot, size_t i)
+{
+    return { snapshot.SchemeGuids()[snapshot.SettingSchemes()[i]], snapshot.SubgroupGuids()[i], snapshot.SettingGuids()[i] };
+}
+
+std::wstring ValueText(PValueType type, uint32_t value)
+{
+    return type == PValueType::Dword ? std::to_wstring(value) : std::wstring(L"error");
+}
+
+std::wstring SchemeName(const PCompactSnapshot& snapshot, size_t scheme)
+{
+    return std::wstring(snapshot.Strings().Get(snapshot.SchemeNameIds()[scheme]));
+}
+
+// Record for one side of a setting (added/removed)
+PDiffRecord SettingRecord(const PCompactSnapshot& snapshot, size_t i, PDiffRecord::Kind kind)
+{
+    PDiffRecord record;
+    record.kind = kind;
+    size_t scheme = snapshot.SettingSchemes()[i];
+    record.scheme = snapshot.SchemeGuids()[scheme];
+    record.subgroup = snapshot.SubgroupGuids()[i];
+    record.setting = snapshot.SettingGuids()[i];
+    record.profileName = SchemeName(snapshot, scheme);
+    record.settingName = snapshot.Strings().Get(snapshot.NameIds()[i]);
+    std::wstring values = L"ac=" + ValueText(snapshot.AcTypes()[i], snapshot.AcValues()[i]) +
+                          L",dc=" + ValueText(snapshot.DcTypes()[i], snapshot.DcValues()[i]);
+    (kind == PDiffRecord::Kind::SettingAdded ? record.newValue : record.oldValue) = values;
+    return record;
+}
+
+// Topology differences, per CPU and attribute
+void DiffTopology(const PCpuTopology& baseline, const PCpuTopology& current, std::vector<PDiffRecord>& records)
+{
+    auto add = [&](const std::wstring& field, const std::wstring& oldValue, const std::wstring& newValue) {
+        if (oldValue == newValue)
+            return;
+        PDiffRecord record;
+        record.kind = PDiffRecord::Kind::TopologyChanged;
+        record.field = field;
+        record.oldValue = oldValue;
+        record.newValue = newValue;
+        records.push_back(record);
+    };
+    auto typeText = [](PCoreType type) {
+        return std::wstring(type == PCoreType::Performance ? L"P" : type == PCoreType::Efficiency ? L"E" : L"U");
+    };
+    auto listText = [](const PCpuMask& mask) {
+        std::string list = mask.ToList();
+        return std::wstring(list.begin(), list.end());
+    };
+
+    // Every attribute of a CPU in one line, for CPUs present on one side only
+    auto cpuText = [&](const PCpuTopology& topology, size_t cpu) {
+        return L"online=" + std::wstring(topology.online.Test(cpu) ? L"1" : L"0") + L",type=" + typeText(topology.coreType[cpu]) +
+               L",core=" + std::to_wstring(topology.coreId[cpu]) + L",package=" + std::to_wstring(topology.packageId[cpu]) +
+               L",die=" + std::to_wstring(topology.dieId[cpu]) + L",node=" + std::to_wstring(topology.numaNode[cpu]) +
+               L",capacity=" + std::to_wstring(topology.capacity[cpu]) + L",siblings=" + listText(topology.smtSiblings[cpu]);
+    };
+
+    add(L"cpuCount", std::to_wstring(baseline.cpuCount), std::to_wstring(current.cpuCount));
+    size_t common = std::min(baseline.cpuCount, current.cpuCount);
+    for (size_t cpu = common; cpu < std::max(baseline.cpuCount, current.cpuCount); cpu++) {
+        PDiffRecord record;
+        record.field = L"cpu" + std::to_wstring(cpu);
+        if (cpu < current.cpuCount) {
+            record.kind = PDiffRecord::Kind::CpuAdded;
+            record.newValue = cpuText(current, cpu);
+        } else {
+            record.kind = PDiffRecord::Kind::CpuRemoved;
+            record.oldValue = cpuText(baseline, cpu);
+        }
+        records.push_back(record);
+    }
+    for (size_t cpu = 0; cpu < common; cpu++) {
+        std::wstring prefix = L"cpu" + std::to_wstring(cpu) + L".";
+        add(prefix + L"online", baseline.online.Test(cpu) ? L"1" : L"0", current.online.Test(cpu) ? L"1" : L"0");
+        add(prefix + L"type", typeText(baseline.coreType[cpu]), typeText(current.coreType[cpu]));
+        add(prefix + L"core", std::to_wstring(baseline.coreId[cpu]), std::to_wstring(current.coreId[cpu]));
+        add(prefix + L"package", std::to_wstring(baseline.packageId[cpu]), std::to_wstring(current.packageId[cpu]));
+        add(prefix + L"die", std::to_wstring(baseline.dieId[cpu]), std::to_wstring(current.dieId[cpu]));
+        add(prefix + L"node", std::to_wstring(baseline.numaNode[cpu]), std::to_wstring(current.numaNode[cpu]));
+        add(prefix + L"capacity", std::to_wstring(baseline.capacity[cpu]), std::to_wstring(current.capacity[cpu]));
+        add(prefix + L"siblings", listText(baseline.smtSiblings[cpu]), listText(current.smtSiblings[cpu]));
+    }
+}
+
+} // namespace
+
+// Diff two snapshots
+std::vector<PDiffRecord> DiffSnapshots(const PSystemSnapshot& baseline, const PSystemSnapshot& current)
+{
+    std::vector<PDiffRecord> records;
+    const PCompactSnapshot& before = baseline.settings;
+    const PCompactSnapshot& after = current.settings;
+
+    if (baseline.activeScheme != current.activeScheme) {
+        PDiffRecord record;
+        record.kind = PDiffRecord::Kind::ActiveScheme;
+        record.scheme = current.activeScheme;
+        record.field = L"active";
+        record.oldValue = GuidToString(baseline.activeScheme);
+        record.newValue = GuidToString(current.activeScheme);
+        records.push_back(record);
+    }
+
+    // Schemes
+    std::unordered_map<GUID, size_t, PGuidHash> beforeSchemes;
+    for (size_t i = 0; i < before.SchemeCount(); i++)
+        beforeSchemes.emplace(before.SchemeGuids()[i], i);
+    std::vector<bool> schemeMatched(before.SchemeCount());
+    std::vector<bool> schemeAdded(after.SchemeCount());
+    for (size_t i = 0; i < after.SchemeCount(); i++) {
+        auto it = beforeSchemes.find(after.SchemeGuids()[i]);
+        if (it != beforeSchemes.end()) {
+            schemeMatched[it->second] = true;
+            continue;
+        }
+        schemeAdded[i] = true;
+        PDiffRecord record;
+        record.kind = PDiffRecord::Kind::SchemeAdded;
+        record.scheme = after.SchemeGuids()[i];
+        record.profileName = SchemeName(after, i);
+        records.push_back(record);
+    }
+    for (size_t i = 0; i < before.SchemeCount(); i++) {
+        if (schemeMatched[i])
+            continue;
+        PDiffRecord record;
+        record.kind = PDiffRecord::Kind::SchemeRemoved;
+        record.scheme = before.SchemeGuids()[i];
+        record.profileName = SchemeName(before, i);
+        records.push_back(record);
+    }
+
+    // Settings: build the baseline index once, probe it with every current setting
+    std::unordered_map<SettingKey, size_t, SettingKeyHash> index;
+    index.reserve(before.SettingCount());
+    for (size_t i = 0; i < before.SettingCount(); i++)
+        index.emplace(KeyOf(before, i), i);
+    std::vector<bool> matched(before.SettingCount());
+
+    for (size_t i = 0; i < after.SettingCount(); i++) {
+        size_t scheme = after.SettingSchemes()[i];
+        auto it = index.find(KeyOf(after, i));
+        if (it == index.end()) {
+            // Settings of a whole new scheme are implied by SchemeAdded
+            if (!schemeAdded[scheme])
+                records.push_back(SettingRecord(after, i, PDiffRecord::Kind::SettingAdded));
+            continue;
+        }
+        size_t j = it->second;
+        matched[j] = true;
+        auto compare = [&](const wchar_t* field, PValueType oldType, uint32_t oldValue, PValueType newType, uint32_t newValue) {
+            if (oldType == newType && (newType == PValueType::Error || oldValue == newValue))
+                return;
+            PDiffRecord record;
+            record.kind = PDiffRecord::Kind::ValueChanged;
+            record.scheme = after.SchemeGuids()[scheme];
+            record.subgroup = after.SubgroupGuids()[i];
+            record.setting = after.SettingGuids()[i];
+            record.field = field;
+            record.oldValue = ValueText(oldType, oldValue);
+            record.newValue = ValueText(newType, newValue);
+            record.profileName = SchemeName(after, scheme);
+            record.settingName = after.Strings().Get(after.NameIds()[i]);
+            records.push_back(record);
+        };
+        compare(L"ac", before.AcTypes()[j], before.AcValues()[j], after.AcTypes()[i], after.AcValues()[i]);
+        compare(L"dc", before.DcTypes()[j], before.DcValues()[j], after.DcTypes()[i], after.DcValues()[i]);
+    }
+    for (size_t j = 0; j < before.SettingCount(); j++) {
+        if (!matched[j] && schemeMatched[before.SettingSchemes()[j]])
+            records.push_back(SettingRecord(before, j, PDiffRecord::Kind::SettingRemoved));
+    }
+
+    DiffTopology(baseline.topology, current.topology, records);
+    return records;
+}
+
+// Record kind as written in the text output
+const wchar_t* DiffKindName(PDiffRecord::Kind kind)
+{
+    switch (kind) {
+    case PDiffRecord::Kind::ActiveScheme: return L"active";
+    case PDiffRecord::Kind::SchemeAdded: return L"scheme-added";
+    case PDiffRecord::Kind::SchemeRemoved: return L"scheme-removed";
+    case PDiffRecord::Kind::SettingAdded: return L"setting-added";
+    case PDiffRecord::Kind::SettingRemoved: return L"setting-removed";
+    case PDiffRecord::Kind::ValueChanged: return L"value";
+    case PDiffRecord::Kind::TopologyChanged: return L"topology";
+    case PDiffRecord::Kind::CpuAdded: return L"cpu-added";
+    case PDiffRecord::Kind::CpuRemoved: return L"cpu-removed";
+    }
+    return L"unknown";
+}
@@ -0,0 +1,42 @@
+// PSnapshotDiff.h - Declares the GUID-keyed diff between two PSystemSnapshots.
+//
+// Functions:
+//   - DiffSnapshots: Hash join of the baseline's (scheme, subgroup, setting) GUID triples against the current
+//     ones, linear in the number of settings. Names are carried along as labels but never compared, so the same
+//     configuration captured under two UI languages has no drift. CPUs present on one side only are reported
+//     as added or removed, with their attributes.
+//   - DiffKindName: Stable kind label of a record ("active", "value", "topology", ...) for the Diff command's
+//     output records: <kind> <scheme guid> <setting guid> <field> <old> <new> <profile name> <setting name>
+//     <subgroup guid>
+//
+#pragma once
+#include <string>
+#include <vector>
+#include "PSystemSnapshot.h"
+
+struct PDiffRecord {
+    enum class Kind {
+        ActiveScheme,
+        SchemeAdded,
+        SchemeRemoved,
+        SettingAdded,
+        SettingRemoved,
+        ValueChanged,
+        TopologyChanged,
+        CpuAdded,
+        CpuRemoved,
+    };
+    Kind kind = Kind::ValueChanged;
+    GUID scheme = {};
+    GUID subgroup = {};
+    GUID setting = {};
+    std::wstring field;        // "ac", "dc", "cpuCount", "cpu3.type", "cpu3" (added/removed), ...
+    std::wstring oldValue;
+    std::wstring newValue;
+    std::wstring profileName;  // label only
+    std::wstring settingName;  // label only
+};
+
+std::vector<PDiffRecord> DiffSnapshots(const PSystemSnapshot& baseline, const PSystemSnapshot& current);
+
+const wchar_t* DiffKindName(PDiffRecord::Kind kind);
@@ -0,0 +1,123 @@
+// PSysfsAttribute.cpp - Implements persistent-descriptor access to sysfs/procfs attributes.
+//
+#include "pch.h"
+#include "PSysfsAttribute.h"
+
+#ifndef _WIN32
+#include <cerrno>
+
+// Destructor
+PSysfsAttribute::~PSysfsAttribute()
+{
+    Close();
+}
+
+// Move constructor
+PSysfsAttribute::PSysfsAttribute(PSysfsAttribute&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+// Move assignment
+PSysfsAttribute& PSysfsAttribute::operator=(PSysfsAttribute&& other) noexcept
+{
+    if (this != &other) {
+        Close();
+        std::swap(fd, other.fd);
+        std::swap(writable, other.writable);
+        std::swap(path, other.path);
+    }
+    return *this;
+}
+
+// Open the attribute, preferring read-write when asked
+bool PSysfsAttribute::Open(const std::filesystem::path& attributePath, bool wantWritable)
+{
+    Close();
+    path = attributePath;
+    if (wantWritable) {
+        fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+        writable = fd >= 0;
+    }
+    if (fd < 0)
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    return fd >= 0;
+}
+
+// Close the descriptor
+void PSysfsAttribute::Close()
+{
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+    writable = false;
+}
+
+// Read the whole attribute from offset 0
+long PSysfsAttribute::Read(char* buffer, size_t size) const
+{
+    if (fd < 0)
+        return -1;
+    ssize_t total = 0;
+    while (static_cast<size_t>(total) < size) {
+        ssize_t n = ::pread(fd, buffer + total, size - total, total);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (n == 0)
+            break;
+        total += n;
+    }
+    return static_cast<long>(total);
+}
+
+// Read the attribute as text with trailing whitespace removed
+bool PSysfsAttribute::ReadText(std::string& out) const
+{
+    char buffer[4096];
+    long n = Read(buffer, sizeof(buffer));
+    if (n < 0)
+        return false;
+    while (n > 0 && (buffer[n - 1] == '\n' || buffer[n - 1] == ' ' || buffer[n - 1] == '\t'))
+        n--;
+    out.assign(buffer, static_cast<size_t>(n));
+    return true;
+}
+
+// Read the attribute as an unsigned decimal integer
+bool PSysfsAttribute::ReadUInt64(uint64_t& value) const
+{
+    char buffer[32];
+    long n = Read(buffer, sizeof(buffer));
+    if (n <= 0)
+        return false;
+    uint64_t result = 0;
+    long i = 0;
+    for (; i < n && buffer[i] >= '0' && buffer[i] <= '9'; i++)
+        result = result * 10 + static_cast<uint64_t>(buffer[i] - '0');
+    if (i == 0)
+        return false;
+    value = result;
+    return true;
+}
+
+// Replace the attribute's contents
+bool PSysfsAttribute::Write(std::string_view text) const
+{
+    if (fd < 0 || !writable)
+        return false;
+    ssize_t n;
+    do {
+        n = ::pwrite(fd, text.data(), text.size(), 0);
+    } while (n < 0 && errno == EINTR);
+    if (n != static_cast<ssize_t>(text.size()))
+        return false;
+    // Regular files (fixture trees) keep stale bytes past the new end; sysfs ignores truncate
+    if (ftruncate(fd, static_cast<off_t>(text.size())) != 0 && errno != EINVAL && errno != EPERM)
+        return false;
+    return true;
+}
+
+#endif
@@ -0,0 +1,46 @@
+// PSysfsAttribute.h - Declares PSysfsAttribute, a sysfs/procfs attribute kept open for repeated reads.
+//
+// PSysfsAttribute class:
+//   - Opens the attribute once and reads it with pread(fd, ..., 0), avoiding open/read/close per query.
+//   - Writes go through pwrite on the same descriptor when it was opened writable.
+//   - Move-only; the descriptor is closed on destruction.
+//
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+class PSysfsAttribute
+{
+public:
+    PSysfsAttribute() = default;
+    ~PSysfsAttribute();
+    PSysfsAttribute(PSysfsAttribute&& other) noexcept;
+    PSysfsAttribute& operator=(PSysfsAttribute&& other) noexcept;
+    PSysfsAttribute(const PSysfsAttribute&) = delete;
+    PSysfsAttribute& operator=(const PSysfsAttribute&) = delete;
+
+    // Open the attribute; with writable=true it falls back to read-only if write access is denied
+    bool Open(const std::filesystem::path& path, bool writable = false);
+    void Close();
+
+    bool IsOpen() const { return fd >= 0; }
+    bool IsWritable() const { return writable; }
+    int Fd() const { return fd; }
+    const std::filesystem::path& Path() const { return path; }
+
+    // Read the whole attribute into buffer (at most size bytes); returns bytes read or -1
+    long Read(char* buffer, size_t size) const;
+    // Read the attribute as text with trailing whitespace removed
+    bool ReadText(std::string& out) const;
+    // Read the attribute as an unsigned decimal integer
+    bool ReadUInt64(uint64_t& value) const;
+    // Replace the attribute's contents
+    bool Write(std::string_view text) const;
+
+private:
+    int fd = -1;
+    bool writable = false;
+    std::filesystem::path path;
+};
@@ -0,0 +1,186 @@
+// PSystemSnapshot.cpp - Implements capture and the text serialization of PSystemSnapshot.
+//
+#include "pch.h"
+#include "PSystemSnapshot.h"
+#include "PFields.h"
+#include "PInformation.h"
+#include "PGuid.h"
+#include "PUtf8.h"
+#include "PBinarySnapshot.h"
+#include <charconv>
+#include <fstream>
+
+static const char TextMagic[] = "PowerInformation-snapshot";
+
+// Capture the live configuration
+PSystemSnapshot PSystemSnapshot::Capture(PInformation& info, const PCpuTopology& topology)
+{
+    PSystemSnapshot snapshot;
+    snapshot.settings = PCompactSnapshot::Capture(info);
+    snapshot.topology = topology;
+    info.GetActiveSchemeGuid(snapshot.activeScheme);
+    return snapshot;
+}
+
+// GUID as UTF-8
+static std::string GuidText(const GUID& guid)
+{
+    return WideToUtf8(GuidToString(guid));
+}
+
+// Value field: decimal or "error"
+static std::string ValueText(PValueType type, uint32_t value)
+{
+    return type == PValueType::Dword ? std::to_string(value) : std::string("error");
+}
+
+// Serialize as tab-separated records
+std::string PSystemSnapshot::ToText() const
+{
+    std::string out = std::string(TextMagic) + "\t" + std::to_string(TextVersion) + "\n";
+    out += "active\t" + GuidText(activeScheme) + "\n";
+    const PStringTable& strings = settings.Strings();
+    size_t setting = 0;
+    for (size_t scheme = 0; scheme < settings.SchemeCount(); scheme++) {
+        out += "scheme\t" + GuidText(settings.SchemeGuids()[scheme]) + "\t" +
+               EscapeField(WideToUtf8(strings.Get(settings.SchemeNameIds()[scheme]))) + "\n";
+        for (; setting < settings.SettingCount() && settings.SettingSchemes()[setting] == scheme; setting++) {
+            out += "setting\t" + GuidText(settings.SubgroupGuids()[setting]) + "\t" + GuidText(settings.SettingGuids()[setting]) + "\t" +
+                   ValueText(settings.AcTypes()[setting], settings.AcValues()[setting]) + "\t" +
+                   ValueText(settings.DcTypes()[setting], settings.DcValues()[setting]) + "\t" +
+                   EscapeField(WideToUtf8(strings.Get(settings.NameIds()[setting]))) + "\t" +
+                   EscapeField(WideToUtf8(strings.Get(settings.DescriptionIds()[setting]))) + "\n";
+        }
+    }
+
+    out += "cpus\t" + std::to_string(topology.cpuCount) + "\n";
+    for (size_t cpu = 0; cpu < topology.cpuCount; cpu++) {
+        PCoreType type = topology.coreType[cpu];
+        out += "cpu\t" + std::to_string(cpu) + "\t" + (topology.online.Test(cpu) ? "1" : "0") + "\t" +
+               (type == PCoreType::Performance ? "P" : type == PCoreType::Efficiency ? "E" : "U") + "\t" +
+               std::to_string(topology.coreId[cpu]) + "\t" + std::to_string(topology.packageId[cpu]) + "\t" +
+               std::to_string(topology.dieId[cpu]) + "\t" + std::to_string(topology.numaNode[cpu]) + "\t" +
+               std::to_string(topology.capacity[cpu]) + "\t" + topology.smtSiblings[cpu].ToList() + "\n";
+    }
+    return out;
+}
+
+// Parse a decimal field
+template <typename T>
+static bool ParseNumber(std::string_view text, T& value)
+{
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Parse a GUID field
+static bool ParseGuid(std::string_view text, GUID& guid)
+{
+    return GuidFromString(Utf8ToWide(text), guid);
+}
+
+// Parse a value field into a view's value and ok flag
+static bool ParseValue(std::string_view text, DWORD& value, bool& ok)
+{
+    ok = text != "error";
+    value = 0;
+    return !ok || ParseNumber(text, value);
+}
+
+// Parse the text serialization
+bool PSystemSnapshot::FromText(std::string_view text, PSystemSnapshot& out)
+{
+    out = {};
+    bool header = false;
+    bool haveScheme = false;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string_view::npos)
+            end = text.size();
+        std::string_view line = text.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if (line.empty())
+            continue;
+        std::vector<std::string_view> fields = SplitFields(line);
+
+        if (!header) {
+            uint32_t version = 0;
+            if (fields.size() < 2 || fields[0] != TextMagic || !ParseNumber(fields[1], version) || version > TextVersion)
+                return false;
+            header = true;
+        } else if (fields[0] == "active" && fields.size() >= 2) {
+            if (!ParseGuid(fields[1], out.activeScheme))
+                return false;
+        } else if (fields[0] == "scheme" && fields.size() >= 3) {
+            GUID guid;
+            if (!ParseGuid(fields[1], guid))
+                return false;
+            out.settings.AddScheme(guid, Utf8ToWide(UnescapeField(fields[2])));
+            haveScheme = true;
+        } else if (fields[0] == "setting" && fields.size() >= 7) {
+            if (!haveScheme)
+                return false;
+            PSettingView view = {};
+            std::wstring name = Utf8ToWide(UnescapeField(fields[5]));
+            std::wstring description = Utf8ToWide(UnescapeField(fields[6]));
+            if (!ParseGuid(fields[1], view.subgroup) || !ParseGuid(fields[2], view.setting) ||
+                !ParseValue(fields[3], view.acValue, view.acOk) || !ParseValue(fields[4], view.dcValue, view.dcOk))
+                return false;
+            view.name = name;
+            view.description = description;
+            out.settings.AddSetting(view);
+        } else if (fields[0] == "cpus" && fields.size() >= 2) {
+            size_t count = 0;
+            if (!ParseNumber(fields[1], count) || count > 65536)
+                return false;
+            out.topology.Reset(count);
+        } else if (fields[0] == "cpu" && fields.size() >= 10) {
+            size_t cpu = 0;
+            PCpuTopology& topology = out.topology;
+            if (!ParseNumber(fields[1], cpu) || cpu >= topology.cpuCount)
+                return false;
+            if (fields[2] == "1")
+                topology.online.Set(cpu);
+            topology.coreType[cpu] = fields[3] == "P" ? PCoreType::Performance : fields[3] == "E" ? PCoreType::Efficiency : PCoreType::Unknown;
+            if (!ParseNumber(fields[4], topology.coreId[cpu]) || !ParseNumber(fields[5], topology.packageId[cpu]) ||
+                !ParseNumber(fields[6], topology.dieId[cpu]) || !ParseNumber(fields[7], topology.numaNode[cpu]) ||
+                !ParseNumber(fields[8], topology.capacity[cpu]))
+                return false;
+            PCpuMask siblings(topology.cpuCount);
+            PCpuMask::ParseList(fields[9], siblings);
+            siblings.Resize(topology.cpuCount);
+            topology.smtSiblings[cpu] = siblings;
+        }
+        // Unknown record types are skipped so newer writers stay readable
+    }
+    out.topology.BuildMasks();
+    return header;
+}
+
+// Write to a file
+bool PSystemSnapshot::Save(const std::filesystem::path& path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+    std::string text = ToText();
+    file.write(text.data(), static_cast<std::streamsize>(text.size()));
+    return static_cast<bool>(file);
+}
+
+// Read from a file; binary snapshots (PBinarySnapshot) are recognized by their magic
+bool PSystemSnapshot::Load(const std::filesystem::path& path, PSystemSnapshot& out)
+{
+    if (IsBinarySnapshot(path)) {
+        PBinarySnapshotReader reader;
+        return reader.Open(path) && reader.ToSystemSnapshot(out);
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return FromText(text, out);
+}
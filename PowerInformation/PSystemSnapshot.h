@@ -0,0 +1,39 @@
+// PSystemSnapshot.h - Declares PSystemSnapshot, the structured capture used for drift detection.
+//
+// PSystemSnapshot:
+//   - Every scheme and setting with AC/DC values (PCompactSnapshot), the active scheme and the CPU topology.
+//   - Save/Load use a versioned tab-separated UTF-8 text file, one record per line:
+//       PowerInformation-snapshot <version>
+//       active   <scheme guid>
+//       scheme   <scheme guid> <name>
+//       setting  <subgroup guid> <setting guid> <ac> <dc> <name> <description>   (belongs to the last scheme)
+//       cpus     <count>
+//       cpu      <n> <online> <P|E|U> <core> <package> <die> <node> <capacity> <smt sibling list>
+//     Values are decimal or "error"; tabs, newlines and backslashes in text are escaped as \t \n \r \\ (PFields.h).
+//   - Load also accepts the binary format (PBinarySnapshot.h).
+//
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "PCompactSnapshot.h"
+#include "PCpuTopology.h"
+
+class PInformation;
+
+struct PSystemSnapshot {
+    static constexpr uint32_t TextVersion = 1;
+
+    PCompactSnapshot settings;
+    PCpuTopology topology;
+    GUID activeScheme = {};
+
+    // Capture the live configuration
+    static PSystemSnapshot Capture(PInformation& info, const PCpuTopology& topology);
+
+    // Text serialization
+    std::string ToText() const;
+    static bool FromText(std::string_view text, PSystemSnapshot& out);
+    bool Save(const std::filesystem::path& path) const;
+    static bool Load(const std::filesystem::path& path, PSystemSnapshot& out);
+};
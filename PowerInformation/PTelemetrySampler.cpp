@@ -0,0 +1,236 @@
+// PTelemetrySampler.cpp - Implements the frequency/energy sampling thread.
+//
+#include "pch.h"
+#include "PTelemetrySampler.h"
+#include "PCpuTopology.h"
+#include <bit>
+
+#ifdef _WIN32
+// Layout documented for CallNtPowerInformation(ProcessorInformation); not declared by the SDK headers
+struct PProcessorPowerInformation {
+    ULONG Number;
+    ULONG MaxMhz;
+    ULONG CurrentMhz;
+    ULONG MhzLimit;
+    ULONG MaxIdleState;
+    ULONG CurrentIdleState;
+};
+#endif
+
+// Constructor: discover CPUs and energy domains and open their attributes once
+PTelemetrySampler::PTelemetrySampler(const std::filesystem::path& root, size_t ringCapacity)
+    : ring(ringCapacity)
+{
+#ifdef _WIN32
+    // One record lists every processor group with its active-processor mask
+    DWORD length = 0;
+    GetLogicalProcessorInformationEx(RelationGroup, nullptr, &length);
+    std::vector<BYTE> buffer(length);
+    auto relation = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data());
+    if (length != 0 && GetLogicalProcessorInformationEx(RelationGroup, relation, &length)) {
+        size_t largest = 0;
+        for (WORD g = 0; g < relation->Group.ActiveGroupCount; g++) {
+            const PROCESSOR_GROUP_INFO& group = relation->Group.GroupInfo[g];
+            if (group.ActiveProcessorMask == 0)
+                continue;
+            GROUP_AFFINITY affinity = {};
+            affinity.Mask = group.ActiveProcessorMask;
+            affinity.Group = g;
+            groups.push_back(affinity);
+            largest = std::max<size_t>(largest, group.MaximumProcessorCount);
+            cpuCount = std::max<size_t>(cpuCount, size_t(g) * 64 + 64 - std::countl_zero(static_cast<uint64_t>(group.ActiveProcessorMask)));
+        }
+        processorInfo.resize(largest * sizeof(PProcessorPowerInformation));
+    }
+#else
+    PCpuTopology topology;
+    if (PCpuTopology::LoadFromSysfs(root, topology))
+        cpuCount = topology.cpuCount;
+    frequencyFiles.resize(cpuCount);
+    const std::filesystem::path cpuDir = root / "sys/devices/system/cpu";
+    for (size_t cpu = 0; cpu < cpuCount; cpu++)
+        frequencyFiles[cpu].Open(cpuDir / ("cpu" + std::to_string(cpu)) / "cpufreq/scaling_cur_freq");
+    // No cpufreq at all: fall back to the per-processor "cpu MHz" of /proc/cpuinfo. The first read sizes the
+    // buffers so later samples do not allocate.
+    bool haveCpufreq = std::any_of(frequencyFiles.begin(), frequencyFiles.end(), [](const PSysfsAttribute& file) { return file.IsOpen(); });
+    if (cpuCount > 0 && !haveCpufreq && cpuInfo.Open(root / "proc/cpuinfo")) {
+        cpuInfoEntries.reserve(cpuCount);
+        if (!cpuInfo.ReadAgain() || !ParseCpuInfo(cpuInfo.Text(), cpuInfoEntries))
+            cpuInfo.Close();
+    }
+
+    // Every RAPL zone and subzone ("intel-rapl:0", "intel-rapl:0:0", ...) is a flat entry here
+    std::error_code ec;
+    std::vector<std::string> zones;
+    for (const auto& entry : std::filesystem::directory_iterator(root / "sys/class/powercap", ec)) {
+        std::string id = entry.path().filename().string();
+        if (id.rfind("intel-rapl:", 0) == 0)
+            zones.push_back(id);
+    }
+    std::sort(zones.begin(), zones.end());
+    for (const auto& id : zones) {
+        const std::filesystem::path zone = root / "sys/class/powercap" / id;
+        PSysfsAttribute energy;
+        if (!energy.Open(zone / "energy_uj"))
+            continue;
+        PEnergyDomain domain;
+        domain.id = id;
+        PSysfsAttribute attribute;
+        if (!attribute.Open(zone / "name") || !attribute.ReadText(domain.name))
+            domain.name = id;
+        if (attribute.Open(zone / "max_energy_range_uj"))
+            attribute.ReadUInt64(domain.maxRangeUj);
+        domains.push_back(std::move(domain));
+        energyFiles.push_back(std::move(energy));
+    }
+#endif
+    lastEnergy.resize(domains.size());
+    totalEnergy.resize(domains.size());
+
+    // Size every slot up front so the sampler thread never allocates
+    for (size_t i = 0; i < ring.Capacity(); i++) {
+        ring.Slot(i).frequencyKHz.resize(cpuCount);
+        ring.Slot(i).energyUj.resize(domains.size());
+    }
+}
+
+// Destructor
+PTelemetrySampler::~PTelemetrySampler()
+{
+    Stop();
+}
+
+// Start the sampling thread
+bool PTelemetrySampler::Start(std::chrono::microseconds interval)
+{
+    if (running.load() || (cpuCount == 0 && domains.empty()))
+        return false;
+    ResetEnergy();
+    stopRequested = false;
+    running = true;
+    thread = std::thread(&PTelemetrySampler::Run, this, std::max(interval, std::chrono::microseconds(100)));
+    return true;
+}
+
+// Stop the sampling thread and wait for it
+void PTelemetrySampler::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopRequested = true;
+    }
+    stopSignal.notify_all();
+    if (thread.joinable())
+        thread.join();
+    running = false;
+}
+
+// Take one sample on the calling thread
+bool PTelemetrySampler::SampleOnce(PTelemetrySample& sample)
+{
+    if (running.load())
+        return false;
+    if (sequence == 0)
+        ResetEnergy();
+    sample.frequencyKHz.resize(cpuCount);
+    sample.energyUj.resize(domains.size());
+    Capture(sample);
+    return true;
+}
+
+// Sampling loop: absolute deadlines so the capture time does not accumulate as drift
+void PTelemetrySampler::Run(std::chrono::microseconds interval)
+{
+    auto deadline = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(stopMutex);
+    while (!stopRequested) {
+        lock.unlock();
+        if (PTelemetrySample* sample = ring.BeginWrite()) {
+            Capture(*sample);
+            ring.EndWrite();
+        } else {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        deadline += interval;
+        auto now = std::chrono::steady_clock::now();
+        if (deadline < now)
+            deadline = now; // fell behind: skip missed ticks instead of bursting
+        lock.lock();
+        stopSignal.wait_until(lock, deadline, [this] { return stopRequested; });
+    }
+}
+
+// Baseline for cumulative energy
+void PTelemetrySampler::ResetEnergy()
+{
+    startTime = std::chrono::steady_clock::now();
+    sequence = 0;
+#ifndef _WIN32
+    for (size_t i = 0; i < domains.size(); i++) {
+        lastEnergy[i] = 0;
+        energyFiles[i].ReadUInt64(lastEnergy[i]);
+        totalEnergy[i] = 0;
+    }
+#endif
+}
+
+// Fill one preallocated sample
+void PTelemetrySampler::Capture(PTelemetrySample& sample)
+{
+    sample.sequence = sequence++;
+    sample.timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - startTime).count());
+#ifdef _WIN32
+    // ProcessorInformation answers for the calling thread's group only: visit each group in turn
+    auto info = reinterpret_cast<PProcessorPowerInformation*>(processorInfo.data());
+    GROUP_AFFINITY original = {};
+    bool moved = false;
+    for (const GROUP_AFFINITY& group : groups) {
+        if (groups.size() > 1) {
+            GROUP_AFFINITY previous = {};
+            if (!SetThreadGroupAffinity(GetCurrentThread(), &group, &previous))
+                continue;
+            if (!moved)
+                original = previous;
+            moved = true;
+        }
+        if (CallNtPowerInformation(ProcessorInformation, nullptr, 0, info, static_cast<ULONG>(processorInfo.size())) != 0)
+            continue;
+        size_t count = std::min<size_t>(std::popcount(static_cast<uint64_t>(group.Mask)),
+                                        processorInfo.size() / sizeof(PProcessorPowerInformation));
+        for (size_t i = 0; i < count; i++) {
+            size_t cpu = size_t(group.Group) * 64 + info[i].Number;
+            if (info[i].Number < 64 && cpu < cpuCount)
+                sample.frequencyKHz[cpu] = info[i].CurrentMhz * 1000;
+        }
+    }
+    if (moved)
+        SetThreadGroupAffinity(GetCurrentThread(), &original, nullptr);
+#else
+    for (size_t cpu = 0; cpu < cpuCount; cpu++) {
+        uint64_t value = 0;
+        sample.frequencyKHz[cpu] = frequencyFiles[cpu].ReadUInt64(value) ? static_cast<uint32_t>(value) : 0;
+    }
+    if (cpuInfo.ReadAgain() && ParseCpuInfo(cpuInfo.Text(), cpuInfoEntries)) {
+        for (const PCpuInfoEntry& entry : cpuInfoEntries) {
+            if (entry.processor < cpuCount)
+                sample.frequencyKHz[entry.processor] = entry.frequencyKHz;
+        }
+    }
+    for (size_t i = 0; i < domains.size(); i++) {
+        uint64_t raw = 0;
+        if (energyFiles[i].ReadUInt64(raw)) {
+            uint64_t last = lastEnergy[i];
+            // The counter restarts from 0 after max_energy_range_uj
+            if (raw >= last)
+                totalEnergy[i] += raw - last;
+            else if (domains[i].maxRangeUj >= last)
+                totalEnergy[i] += domains[i].maxRangeUj - last + raw;
+            else
+                totalEnergy[i] += raw;
+            lastEnergy[i] = raw;
+        }
+        sample.energyUj[i] = totalEnergy[i];
+    }
+#endif
+}
@@ -0,0 +1,104 @@
+// PTelemetrySampler.h - Declares PTelemetrySampler, a background sampler for CPU frequency and energy counters.
+//
+// PTelemetrySampler class:
+//   - A dedicated thread captures one PTelemetrySample per interval into a PSpscRing; the consumer drains it.
+//   - Linux: per-CPU cpufreq/scaling_cur_freq (or "cpu MHz" of /proc/cpuinfo, kept open and re-read into the
+//     same buffer, where cpufreq is missing, e.g. in VMs) and every /sys/class/powercap/intel-rapl:* energy_uj counter,
+//     each kept open as a PSysfsAttribute so a sample is one pread per attribute and no allocation.
+//   - Energy is reported cumulative since Start(); counter wraparound at max_energy_range_uj is folded in.
+//   - Windows: per-processor current MHz from CallNtPowerInformation(ProcessorInformation); no energy domains.
+//     That call only covers the calling thread's processor group, so on machines with more than one group a
+//     sample moves the capturing thread through each group in turn and then puts its group affinity back.
+//     CPUs are numbered group * 64 + index, as in PCpuTopology.
+//   - The sysfs root is injectable so a fixture cpufreq/powercap tree can stand in for /sys.
+//
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PProcText.h"
+#include "PRingBuffer.h"
+#include "PSysfsAttribute.h"
+
+struct PTelemetrySample {
+    uint64_t sequence = 0;
+    uint64_t timestampNs = 0;           // steady clock, relative to Start()
+    std::vector<uint32_t> frequencyKHz; // per logical CPU; 0 when unavailable
+    std::vector<uint64_t> energyUj;     // per energy domain, cumulative since Start()
+};
+
+struct PEnergyDomain {
+    std::string id;   // e.g. "intel-rapl:0"
+    std::string name; // e.g. "package-0"
+    uint64_t maxRangeUj = 0;
+};
+
+class PTelemetrySampler
+{
+public:
+    // root is the directory that contains "sys" ("/" on a live system)
+    explicit PTelemetrySampler(const std::filesystem::path& root = "/", size_t ringCapacity = 256);
+    ~PTelemetrySampler();
+    PTelemetrySampler(const PTelemetrySampler&) = delete;
+    PTelemetrySampler& operator=(const PTelemetrySampler&) = delete;
+
+    // Start the sampling thread; false if already running or nothing can be sampled
+    bool Start(std::chrono::microseconds interval);
+    void Stop();
+    bool IsRunning() const { return running.load(std::memory_order_relaxed); }
+
+    // Consumer: call fn(const PTelemetrySample&) for every published sample, oldest first
+    template <typename Fn>
+    size_t Drain(Fn&& fn)
+    {
+        size_t count = 0;
+        for (PTelemetrySample* sample = ring.BeginRead(); sample; sample = ring.BeginRead()) {
+            fn(static_cast<const PTelemetrySample&>(*sample));
+            ring.EndRead();
+            count++;
+        }
+        return count;
+    }
+
+    // Take one sample on the calling thread (only while the sampler thread is not running)
+    bool SampleOnce(PTelemetrySample& sample);
+
+    size_t CpuCount() const { return cpuCount; }
+    const std::vector<PEnergyDomain>& EnergyDomains() const { return domains; }
+    // Samples lost because the consumer fell behind
+    uint64_t Dropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    void Run(std::chrono::microseconds interval);
+    void Capture(PTelemetrySample& sample);
+    void ResetEnergy();
+
+    size_t cpuCount = 0;
+    std::vector<PEnergyDomain> domains;
+#ifndef _WIN32
+    std::vector<PSysfsAttribute> frequencyFiles;
+    std::vector<PSysfsAttribute> energyFiles;
+    PProcFile cpuInfo;                          // open only when no CPU has cpufreq
+    std::vector<PCpuInfoEntry> cpuInfoEntries;  // reused each sample
+#else
+    std::vector<GROUP_AFFINITY> groups; // active processors of each processor group
+    std::vector<BYTE> processorInfo;    // sized for the largest group
+#endif
+    std::vector<uint64_t> lastEnergy;
+    std::vector<uint64_t> totalEnergy;
+    std::chrono::steady_clock::time_point startTime;
+    uint64_t sequence = 0;
+
+    PSpscRing<PTelemetrySample> ring;
+    std::atomic<uint64_t> dropped{ 0 };
+    std::atomic<bool> running{ false };
+    bool stopRequested = false;
+    std::mutex stopMutex;
+    std::condition_variable stopSignal;
+    std::thread thread;
+};
@@ -0,0 +1,193 @@
+// PThreadPlacement.cpp - Implements thread pinning with CPU sets (Windows) and sched_setaffinity (Linux).
+//
+#include "pch.h"
+#include "PThreadPlacement.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+// CPUs a placement allows
+PCpuMask PlacementMask(const PCpuTopology& topology, PCorePlacement placement)
+{
+    PCpuMask mask;
+    switch (placement) {
+    case PCorePlacement::Performance: mask = topology.performance; break;
+    case PCorePlacement::Efficiency: mask = topology.efficiency; break;
+    case PCorePlacement::NoSmtSiblings: mask = topology.firstThreadPerCore; break;
+    case PCorePlacement::Any: mask = topology.online; break;
+    }
+    mask &= topology.online;
+    return mask;
+}
+
+// Pin the calling thread
+bool PinCurrentThread(const PCpuTopology& topology, PCorePlacement placement)
+{
+    return PinThread(CurrentThreadId(), PlacementMask(topology, placement));
+}
+
+// Pin another thread of this process
+bool PinThread(PThreadId thread, const PCpuTopology& topology, PCorePlacement placement)
+{
+    return PinThread(thread, PlacementMask(topology, placement));
+}
+
+#ifdef _WIN32
+
+// Native id of the calling thread (a pseudo-handle, only meaningful on this thread)
+PThreadId CurrentThreadId()
+{
+    return GetCurrentThread();
+}
+
+// Save the calling thread's selected CPU sets
+bool SaveCurrentThreadAffinity(PSavedAffinity& saved)
+{
+    ULONG count = 0;
+    saved.cpuSets.clear();
+    if (GetThreadSelectedCpuSets(GetCurrentThread(), nullptr, 0, &count))
+        return true; // nothing selected
+    if (GetLastError() != ERROR_INSUFFICIENT_BUFFER)
+        return false;
+    saved.cpuSets.resize(count);
+    if (!GetThreadSelectedCpuSets(GetCurrentThread(), saved.cpuSets.data(), count, &count))
+        return false;
+    saved.cpuSets.resize(count);
+    return true;
+}
+
+// Put the saved CPU sets back; an empty list clears the selection
+bool RestoreCurrentThreadAffinity(const PSavedAffinity& saved)
+{
+    return SetThreadSelectedCpuSets(GetCurrentThread(), saved.cpuSets.empty() ? nullptr : saved.cpuSets.data(),
+                                    static_cast<ULONG>(saved.cpuSets.size())) != FALSE;
+}
+
+// CPU set ids of the logical CPUs in a mask (logical CPU = group * 64 + index, as in PCpuTopology)
+static bool CpuSetIds(const PCpuMask& cpus, std::vector<ULONG>& ids)
+{
+    ids.clear();
+    if (cpus.Empty())
+        return false;
+    ULONG length = 0;
+    GetSystemCpuSetInformation(nullptr, 0, &length, GetCurrentProcess(), 0);
+    std::vector<BYTE> buffer(length);
+    if (!GetSystemCpuSetInformation(reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buffer.data()), length, &length, GetCurrentProcess(), 0))
+        return false;
+    for (BYTE* ptr = buffer.data(); ptr < buffer.data() + length;) {
+        auto info = reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(ptr);
+        if (info->Type == CpuSetInformation) {
+            size_t cpu = static_cast<size_t>(info->CpuSet.Group) * 64 + info->CpuSet.LogicalProcessorIndex;
+            if (cpus.Test(cpu))
+                ids.push_back(info->CpuSet.Id);
+        }
+        ptr += info->Size;
+    }
+    return !ids.empty();
+}
+
+// Pin a thread to an explicit CPU mask through CPU sets
+bool PinThread(PThreadId thread, const PCpuMask& cpus)
+{
+    std::vector<ULONG> ids;
+    if (!CpuSetIds(cpus, ids))
+        return false;
+    return SetThreadSelectedCpuSets(thread, ids.data(), static_cast<ULONG>(ids.size())) != FALSE;
+}
+
+// Default CPU sets for a whole process
+bool PinProcess(HANDLE process, const PCpuMask& cpus)
+{
+    std::vector<ULONG> ids;
+    if (!CpuSetIds(cpus, ids))
+        return false;
+    return SetProcessDefaultCpuSets(process, ids.data(), static_cast<ULONG>(ids.size())) != FALSE;
+}
+
+#else
+
+// Native id of the calling thread
+PThreadId CurrentThreadId()
+{
+    return static_cast<PThreadId>(syscall(SYS_gettid));
+}
+
+// Save the calling thread's affinity; the set grows until it covers the kernel's CPU count
+bool SaveCurrentThreadAffinity(PSavedAffinity& saved)
+{
+    for (size_t count = 1024; count <= (size_t(1) << 20); count *= 2) {
+        cpu_set_t* set = CPU_ALLOC(count);
+        if (!set)
+            return false;
+        size_t size = CPU_ALLOC_SIZE(count);
+        CPU_ZERO_S(size, set);
+        if (sched_getaffinity(0, size, set) == 0) {
+            saved.cpus = PCpuMask();
+            for (size_t cpu = 0; cpu < count; cpu++) {
+                if (CPU_ISSET_S(cpu, size, set))
+                    saved.cpus.Set(cpu);
+            }
+            CPU_FREE(set);
+            return true;
+        }
+        int error = errno;
+        CPU_FREE(set);
+        if (error != EINVAL)
+            return false;
+    }
+    return false;
+}
+
+// Put the saved affinity back
+bool RestoreCurrentThreadAffinity(const PSavedAffinity& saved)
+{
+    return PinThread(0, saved.cpus);
+}
+
+// Pin a thread to an explicit CPU mask through sched_setaffinity
+bool PinThread(PThreadId thread, const PCpuMask& cpus)
+{
+    if (cpus.Empty())
+        return false;
+    size_t count = cpus.Size();
+    cpu_set_t* set = CPU_ALLOC(count);
+    if (!set)
+        return false;
+    size_t size = CPU_ALLOC_SIZE(count);
+    CPU_ZERO_S(size, set);
+    for (size_t cpu = 0; cpu < count; cpu++) {
+        if (cpus.Test(cpu))
+            CPU_SET_S(cpu, size, set);
+    }
+    bool ok = sched_setaffinity(thread, size, set) == 0;
+    CPU_FREE(set);
+    return ok;
+}
+
+#endif
+
+// Name used on the command line
+const wchar_t* PlacementName(PCorePlacement placement)
+{
+    switch (placement) {
+    case PCorePlacement::Performance: return L"performance";
+    case PCorePlacement::Efficiency: return L"efficiency";
+    case PCorePlacement::NoSmtSiblings: return L"nosmt";
+    case PCorePlacement::Any: break;
+    }
+    return L"any";
+}
+
+// Parse a placement name (also accepts "p", "e" and "all")
+bool ParsePlacement(std::wstring_view text, PCorePlacement& placement)
+{
+    if (text == L"performance" || text == L"p") placement = PCorePlacement::Performance;
+    else if (text == L"efficiency" || text == L"e") placement = PCorePlacement::Efficiency;
+    else if (text == L"nosmt") placement = PCorePlacement::NoSmtSiblings;
+    else if (text == L"any" || text == L"all") placement = PCorePlacement::Any;
+    else return false;
+    return true;
+}
@@ -0,0 +1,65 @@
+// PThreadPlacement.h - Declares core-type-aware thread pinning on top of PCpuTopology.
+//
+// Types:
+//   - PCorePlacement: Performance cores, efficiency cores, one thread per core (no SMT sharing), or any CPU.
+//   - PThreadId: Native thread identifier (HANDLE on Windows, kernel tid elsewhere).
+//   - PSavedAffinity: The calling thread's affinity as the OS holds it, to put back after temporary pinning.
+//
+// Functions:
+//   - PlacementMask: CPUs a placement allows (empty if the machine has no such cores).
+//   - PinCurrentThread / PinThread: Restrict a thread to a placement or an explicit mask, using
+//     CPU sets (SetThreadSelectedCpuSets) on Windows and sched_setaffinity on Linux.
+//     Linux threads and forked children inherit the affinity of their creator; Windows uses PinProcess for children.
+//   - SaveCurrentThreadAffinity / RestoreCurrentThreadAffinity: Undo a temporary pin, including a Windows
+//     thread that had selected no CPU sets at all.
+//
+#pragma once
+#include <string_view>
+#include <vector>
+#include "PCpuTopology.h"
+
+enum class PCorePlacement {
+    Any,
+    Performance,
+    Efficiency,
+    NoSmtSiblings,
+};
+
+#ifdef _WIN32
+using PThreadId = HANDLE;
+#else
+using PThreadId = int; // pid_t of the thread (gettid)
+#endif
+
+// CPUs a placement allows
+PCpuMask PlacementMask(const PCpuTopology& topology, PCorePlacement placement);
+
+// Pin the calling thread; returns false if the placement is empty or the OS call fails
+bool PinCurrentThread(const PCpuTopology& topology, PCorePlacement placement);
+// Pin another thread of this process
+bool PinThread(PThreadId thread, const PCpuTopology& topology, PCorePlacement placement);
+// Pin a thread to an explicit CPU mask
+bool PinThread(PThreadId thread, const PCpuMask& cpus);
+// Native id of the calling thread. On Windows this is the GetCurrentThread() pseudo-handle, which names
+// whichever thread uses it: pass it only to calls made on the thread that obtained it, and use
+// OpenThread(THREAD_SET_LIMITED_INFORMATION, ...) for a handle that another thread can pin.
+PThreadId CurrentThreadId();
+
+struct PSavedAffinity {
+#ifdef _WIN32
+    std::vector<ULONG> cpuSets; // selected CPU set ids; empty when the thread follows the process default
+#else
+    PCpuMask cpus;
+#endif
+};
+
+bool SaveCurrentThreadAffinity(PSavedAffinity& saved);
+bool RestoreCurrentThreadAffinity(const PSavedAffinity& saved);
+#ifdef _WIN32
+// Default CPU sets for every thread of a process that has not selected its own (e.g. a suspended child)
+bool PinProcess(HANDLE process, const PCpuMask& cpus);
+#endif
+
+// Name used on the command line ("any", "performance", "efficiency", "nosmt")
+const wchar_t* PlacementName(PCorePlacement placement);
+bool ParsePlacement(std::wstring_view text, PCorePlacement& placement);
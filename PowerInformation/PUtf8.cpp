@@ -0,0 +1,465 @@
+// PUtf8.cpp - Implements the UTF-8 conversions.
+//
+#include "pch.h"
+#include "PUtf8.h"
+#include "PSimd.h"
+#include <type_traits>
+
+static constexpr char32_t Replacement = 0xFFFD;
+static constexpr size_t NoError = std::string_view::npos;
+
+// Code unit value without sign extension (POSIX wchar_t is signed)
+template <typename Unit>
+static char32_t UnitValue(Unit unit)
+{
+    return static_cast<char32_t>(static_cast<std::make_unsigned_t<Unit>>(unit));
+}
+
+// Block primitives: test a block for ASCII, and widen (bytes to units) or narrow (units to bytes) an
+// all-ASCII block. ByteBlock bytes are tested and widened at a time, UnitBlock units narrowed.
+#if defined(PSIMD_AVX2)
+
+static constexpr size_t ByteBlock = 32;
+
+static bool IsAsciiBytes(const unsigned char* s)
+{
+    return _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s))) == 0;
+}
+
+template <typename Unit>
+static void WidenBytes(const unsigned char* s, Unit* d)
+{
+    if constexpr (sizeof(Unit) == 2) {
+        for (size_t i = 0; i < ByteBlock; i += 16)
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i))));
+    } else {
+        for (size_t i = 0; i < ByteBlock; i += 8)
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + i))));
+    }
+}
+
+#elif defined(PSIMD_SSE2)
+
+static constexpr size_t ByteBlock = 16;
+
+static bool IsAsciiBytes(const unsigned char* s)
+{
+    return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s))) == 0;
+}
+
+template <typename Unit>
+static void WidenBytes(const unsigned char* s, Unit* d)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    __m128i low = _mm_unpacklo_epi8(bytes, zero), high = _mm_unpackhi_epi8(bytes, zero);
+    __m128i* out = reinterpret_cast<__m128i*>(d);
+    if constexpr (sizeof(Unit) == 2) {
+        _mm_storeu_si128(out, low);
+        _mm_storeu_si128(out + 1, high);
+    } else {
+        _mm_storeu_si128(out, _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+    }
+}
+
+#elif defined(PSIMD_NEON)
+
+static constexpr size_t ByteBlock = 16;
+
+static bool IsAsciiBytes(const unsigned char* s)
+{
+    return vmaxvq_u8(vld1q_u8(s)) < 0x80;
+}
+
+template <typename Unit>
+static void WidenBytes(const unsigned char* s, Unit* d)
+{
+    uint8x16_t bytes = vld1q_u8(s);
+    uint16x8_t low = vmovl_u8(vget_low_u8(bytes)), high = vmovl_u8(vget_high_u8(bytes));
+    if constexpr (sizeof(Unit) == 2) {
+        uint16_t* out = reinterpret_cast<uint16_t*>(d);
+        vst1q_u16(out, low);
+        vst1q_u16(out + 8, high);
+    } else {
+        uint32_t* out = reinterpret_cast<uint32_t*>(d);
+        vst1q_u32(out, vmovl_u16(vget_low_u16(low)));
+        vst1q_u32(out + 4, vmovl_u16(vget_high_u16(low)));
+        vst1q_u32(out + 8, vmovl_u16(vget_low_u16(high)));
+        vst1q_u32(out + 12, vmovl_u16(vget_high_u16(high)));
+    }
+}
+
+#else
+
+// Portable fallback: eight bytes in a 64-bit word
+static constexpr size_t ByteBlock = 8;
+
+static bool IsAsciiBytes(const unsigned char* s)
+{
+    uint64_t word;
+    memcpy(&word, s, sizeof(word));
+    return (word & 0x8080808080808080ull) == 0;
+}
+
+template <typename Unit>
+static void WidenBytes(const unsigned char* s, Unit* d)
+{
+    for (size_t i = 0; i < ByteBlock; i++)
+        d[i] = static_cast<Unit>(s[i]);
+}
+
+#endif
+
+#if defined(PSIMD_SSE2)
+
+static constexpr size_t UnitBlock = 16;
+
+template <typename Unit>
+static bool IsAsciiUnits(const Unit* s)
+{
+    const __m128i* in = reinterpret_cast<const __m128i*>(s);
+    __m128i any, mask;
+    if constexpr (sizeof(Unit) == 2) {
+        any = _mm_or_si128(_mm_loadu_si128(in), _mm_loadu_si128(in + 1));
+        mask = _mm_set1_epi16(static_cast<short>(0xFF80));
+    } else {
+        any = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(in), _mm_loadu_si128(in + 1)),
+                           _mm_or_si128(_mm_loadu_si128(in + 2), _mm_loadu_si128(in + 3)));
+        mask = _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(any, mask), _mm_setzero_si128())) == 0xFFFF;
+}
+
+template <typename Unit>
+static void NarrowUnits(const Unit* s, unsigned char* d)
+{
+    const __m128i* in = reinterpret_cast<const __m128i*>(s);
+    __m128i bytes;
+    if constexpr (sizeof(Unit) == 2) {
+        bytes = _mm_packus_epi16(_mm_loadu_si128(in), _mm_loadu_si128(in + 1));
+    } else {
+        // Values are below 0x80, so the signed saturation of packs_epi32 never triggers
+        bytes = _mm_packus_epi16(_mm_packs_epi32(_mm_loadu_si128(in), _mm_loadu_si128(in + 1)),
+                                 _mm_packs_epi32(_mm_loadu_si128(in + 2), _mm_loadu_si128(in + 3)));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d), bytes);
+}
+
+#elif defined(PSIMD_NEON)
+
+static constexpr size_t UnitBlock = 16;
+
+template <typename Unit>
+static bool IsAsciiUnits(const Unit* s)
+{
+    if constexpr (sizeof(Unit) == 2) {
+        const uint16_t* in = reinterpret_cast<const uint16_t*>(s);
+        return vmaxvq_u16(vorrq_u16(vld1q_u16(in), vld1q_u16(in + 8))) < 0x80;
+    } else {
+        const uint32_t* in = reinterpret_cast<const uint32_t*>(s);
+        uint32x4_t any = vorrq_u32(vorrq_u32(vld1q_u32(in), vld1q_u32(in + 4)), vorrq_u32(vld1q_u32(in + 8), vld1q_u32(in + 12)));
+        return vmaxvq_u32(any) < 0x80;
+    }
+}
+
+template <typename Unit>
+static void NarrowUnits(const Unit* s, unsigned char* d)
+{
+    uint16x8_t low, high;
+    if constexpr (sizeof(Unit) == 2) {
+        const uint16_t* in = reinterpret_cast<const uint16_t*>(s);
+        low = vld1q_u16(in);
+        high = vld1q_u16(in + 8);
+    } else {
+        const uint32_t* in = reinterpret_cast<const uint32_t*>(s);
+        low = vcombine_u16(vmovn_u32(vld1q_u32(in)), vmovn_u32(vld1q_u32(in + 4)));
+        high = vcombine_u16(vmovn_u32(vld1q_u32(in + 8)), vmovn_u32(vld1q_u32(in + 12)));
+    }
+    vst1q_u8(d, vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+}
+
+#else
+
+static constexpr size_t UnitBlock = 4;
+
+template <typename Unit>
+static bool IsAsciiUnits(const Unit* s)
+{
+    return (UnitValue(s[0]) | UnitValue(s[1]) | UnitValue(s[2]) | UnitValue(s[3])) < 0x80;
+}
+
+template <typename Unit>
+static void NarrowUnits(const Unit* s, unsigned char* d)
+{
+    for (size_t i = 0; i < UnitBlock; i++)
+        d[i] = static_cast<unsigned char>(s[i]);
+}
+
+#endif
+
+// Length of the ASCII run at the start of s
+static size_t AsciiRun(const unsigned char* s, size_t size)
+{
+    size_t i = 0;
+    while (i + ByteBlock <= size && IsAsciiBytes(s + i))
+        i += ByteBlock;
+    while (i < size && s[i] < 0x80)
+        i++;
+    return i;
+}
+
+// Copy the ASCII run at the start of s to d as units; returns its length
+template <typename Unit>
+static size_t WidenAscii(const unsigned char* s, size_t size, Unit* d)
+{
+    size_t i = 0;
+    for (; i + ByteBlock <= size && IsAsciiBytes(s + i); i += ByteBlock)
+        WidenBytes(s + i, d + i);
+    for (; i < size && s[i] < 0x80; i++)
+        d[i] = static_cast<Unit>(s[i]);
+    return i;
+}
+
+// Copy the ASCII run at the start of s to d as bytes; returns its length
+template <typename Unit>
+static size_t NarrowAscii(const Unit* s, size_t size, unsigned char* d)
+{
+    size_t i = 0;
+    for (; i + UnitBlock <= size && IsAsciiUnits(s + i); i += UnitBlock)
+        NarrowUnits(s + i, d + i);
+    for (; i < size && UnitValue(s[i]) < 0x80; i++)
+        d[i] = static_cast<unsigned char>(s[i]);
+    return i;
+}
+
+// Decode the multi-byte sequence at s (s[0] >= 0x80). Returns its length, or 0 if it is invalid, with the
+// length of its maximal invalid subpart in invalid (the bytes one U+FFFD replaces, per Unicode 3.9)
+static size_t DecodeSequence(const unsigned char* s, size_t size, char32_t& cp, size_t& invalid)
+{
+    unsigned char lead = s[0];
+    size_t length;
+    // Bounds of the second byte; they exclude overlong forms, surrogates and values above U+10FFFF
+    unsigned char low = 0x80, high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+        cp = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        cp = lead & 0x0F;
+        if (lead == 0xE0)
+            low = 0xA0;
+        else if (lead == 0xED)
+            high = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        cp = lead & 0x07;
+        if (lead == 0xF0)
+            low = 0x90;
+        else if (lead == 0xF4)
+            high = 0x8F;
+    } else {
+        invalid = 1;
+        return 0;
+    }
+    for (size_t n = 1; n < length; n++) {
+        if (n >= size || s[n] < low || s[n] > high) {
+            invalid = n;
+            return 0;
+        }
+        cp = (cp << 6) | (s[n] & 0x3F);
+        low = 0x80;
+        high = 0xBF;
+    }
+    return length;
+}
+
+// Store a code point as UTF-16 or UTF-32 units
+template <typename Unit>
+static Unit* StoreUnits(Unit* d, char32_t cp)
+{
+    if constexpr (sizeof(Unit) == 2) {
+        if (cp >= 0x10000) {
+            cp -= 0x10000;
+            *d++ = static_cast<Unit>(0xD800 | (cp >> 10));
+            *d++ = static_cast<Unit>(0xDC00 | (cp & 0x3FF));
+            return d;
+        }
+    }
+    *d++ = static_cast<Unit>(cp);
+    return d;
+}
+
+// Store a code point as UTF-8
+static unsigned char* StoreUtf8(unsigned char* d, char32_t cp)
+{
+    if (cp < 0x800) {
+        *d++ = static_cast<unsigned char>(0xC0 | (cp >> 6));
+    } else if (cp < 0x10000) {
+        *d++ = static_cast<unsigned char>(0xE0 | (cp >> 12));
+        *d++ = static_cast<unsigned char>(0x80 | ((cp >> 6) & 0x3F));
+    } else {
+        *d++ = static_cast<unsigned char>(0xF0 | (cp >> 18));
+        *d++ = static_cast<unsigned char>(0x80 | ((cp >> 12) & 0x3F));
+        *d++ = static_cast<unsigned char>(0x80 | ((cp >> 6) & 0x3F));
+    }
+    *d++ = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+    return d;
+}
+
+// UTF-8 to UTF-16/UTF-32 units appended to out. Strict stops at the first invalid sequence; otherwise it
+// becomes U+FFFD. Returns the offset of the invalid sequence, or NoError
+template <typename Unit>
+static size_t DecodeUtf8(std::string_view text, std::basic_string<Unit>& out, bool strict)
+{
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(text.data());
+    const size_t size = text.size();
+    const size_t base = out.size();
+    // A code point never takes more units than it has bytes
+    out.resize(base + size);
+    Unit* const start = out.data() + base;
+    Unit* d = start;
+    size_t i = 0, error = NoError;
+    while (i < size && error == NoError) {
+        size_t run = WidenAscii(s + i, size - i, d);
+        i += run;
+        d += run;
+        while (i < size && s[i] >= 0x80) {
+            char32_t cp = 0;
+            size_t invalid = 0;
+            size_t length = DecodeSequence(s + i, size - i, cp, invalid);
+            if (length == 0) {
+                if (strict) {
+                    error = i;
+                    break;
+                }
+                cp = Replacement;
+                length = invalid;
+            }
+            d = StoreUnits(d, cp);
+            i += length;
+        }
+    }
+    out.resize(base + static_cast<size_t>(d - start));
+    return error;
+}
+
+// UTF-16/UTF-32 units to UTF-8 appended to out; unpaired surrogates and values above U+10FFFF are invalid.
+// Same contract as DecodeUtf8
+template <typename Unit>
+static size_t EncodeUtf8(const Unit* s, size_t size, std::string& out, bool strict)
+{
+    const size_t base = out.size();
+    // UTF-16 takes at most 3 bytes per unit (a surrogate pair is 4 bytes), UTF-32 at most 4
+    out.resize(base + size * (sizeof(Unit) == 2 ? 3 : 4));
+    unsigned char* const start = reinterpret_cast<unsigned char*>(out.data() + base);
+    unsigned char* d = start;
+    size_t i = 0, error = NoError;
+    while (i < size && error == NoError) {
+        size_t run = NarrowAscii(s + i, size - i, d);
+        i += run;
+        d += run;
+        while (i < size && UnitValue(s[i]) >= 0x80) {
+            char32_t cp = UnitValue(s[i]);
+            size_t length = 1;
+            if constexpr (sizeof(Unit) == 2) {
+                if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < size) {
+                    char32_t next = UnitValue(s[i + 1]);
+                    if (next >= 0xDC00 && next <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (next - 0xDC00);
+                        length = 2;
+                    }
+                }
+            }
+            if ((cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF) {
+                if (strict) {
+                    error = i;
+                    break;
+                }
+                cp = Replacement;
+            }
+            d = StoreUtf8(d, cp);
+            i += length;
+        }
+    }
+    out.resize(base + static_cast<size_t>(d - start));
+    return error;
+}
+
+// Report a strict conversion's result
+static bool Finish(size_t error, size_t* errorPosition)
+{
+    if (error == NoError)
+        return true;
+    if (errorPosition)
+        *errorPosition = error;
+    return false;
+}
+
+// Wide to UTF-8
+std::string WideToUtf8(std::wstring_view text)
+{
+    std::string out;
+    WideToUtf8(text, out);
+    return out;
+}
+
+// Wide to UTF-8, appended to out
+void WideToUtf8(std::wstring_view text, std::string& out)
+{
+    EncodeUtf8(text.data(), text.size(), out, false);
+}
+
+// UTF-8 to wide
+std::wstring Utf8ToWide(std::string_view text)
+{
+    std::wstring out;
+    DecodeUtf8(text, out, false);
+    return out;
+}
+
+// Check that text is well-formed UTF-8
+bool ValidateUtf8(std::string_view text, size_t* errorPosition)
+{
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(text.data());
+    const size_t size = text.size();
+    size_t i = 0;
+    while (i < size) {
+        i += AsciiRun(s + i, size - i);
+        while (i < size && s[i] >= 0x80) {
+            char32_t cp = 0;
+            size_t invalid = 0;
+            size_t length = DecodeSequence(s + i, size - i, cp, invalid);
+            if (length == 0)
+                return Finish(i, errorPosition);
+            i += length;
+        }
+    }
+    return true;
+}
+
+// Strict UTF-8 to UTF-16
+bool Utf8ToUtf16(std::string_view text, std::u16string& out, size_t* errorPosition)
+{
+    return Finish(DecodeUtf8(text, out, true), errorPosition);
+}
+
+// Strict UTF-8 to UTF-32
+bool Utf8ToUtf32(std::string_view text, std::u32string& out, size_t* errorPosition)
+{
+    return Finish(DecodeUtf8(text, out, true), errorPosition);
+}
+
+// Strict UTF-16 to UTF-8
+bool Utf16ToUtf8(std::u16string_view text, std::string& out, size_t* errorPosition)
+{
+    return Finish(EncodeUtf8(text.data(), text.size(), out, true), errorPosition);
+}
+
+// Strict UTF-32 to UTF-8
+bool Utf32ToUtf8(std::u32string_view text, std::string& out, size_t* errorPosition)
+{
+    return Finish(EncodeUtf8(text.data(), text.size(), out, true), errorPosition);
+}
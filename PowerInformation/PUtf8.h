@@ -0,0 +1,31 @@
+// PUtf8.h - Portable UTF-8 <-> UTF-16/UTF-32 conversion for files, pipes and the C interface.
+// Replaces the StringUtil UTF-8/UTF-16 helpers of string_util.cpp, which is not built.
+//
+// Functions:
+//   - WideToUtf8: UTF-16 (Windows wchar_t) or UTF-32 (POSIX wchar_t) to UTF-8; the appending overload
+//     lets output buffers encode in place without a temporary string.
+//   - Utf8ToWide: UTF-8 to the native wide encoding.
+//   Malformed input (unpaired surrogates, bad UTF-8) becomes U+FFFD instead of failing, so a damaged
+//   name never makes a whole snapshot unreadable. Each maximal invalid subpart of a UTF-8 sequence
+//   becomes one U+FFFD, as MultiByteToWideChar does.
+//
+//   - ValidateUtf8, Utf8ToUtf16, Utf8ToUtf32, Utf16ToUtf8, Utf32ToUtf8: strict conversions for input that
+//     must be well formed. They append to out and stop at the first invalid sequence, returning false with
+//     its offset (in input code units) in errorPosition; out then holds the conversion of everything before it.
+//
+// All conversions copy ASCII runs 16 or 32 units at a time (SSE2/AVX2/NEON, chosen at compile time) and
+// only decode the other code points one at a time.
+//
+#pragma once
+#include <string>
+#include <string_view>
+
+std::string WideToUtf8(std::wstring_view text);
+void WideToUtf8(std::wstring_view text, std::string& out);
+std::wstring Utf8ToWide(std::string_view text);
+
+bool ValidateUtf8(std::string_view text, size_t* errorPosition = nullptr);
+bool Utf8ToUtf16(std::string_view text, std::u16string& out, size_t* errorPosition = nullptr);
+bool Utf8ToUtf32(std::string_view text, std::u32string& out, size_t* errorPosition = nullptr);
+bool Utf16ToUtf8(std::u16string_view text, std::string& out, size_t* errorPosition = nullptr);
+bool Utf32ToUtf8(std::u32string_view text, std::string& out, size_t* errorPosition = nullptr);
@@ -0,0 +1,187 @@
+// PWinPowerBackend.cpp - Implements PPowerBackend on top of powrprof.
+//
+#include "pch.h"
+#include "PWinPowerBackend.h"
+
+#ifdef _WIN32
+
+// Where powrprof keeps user schemes and the setting definitions (names, descriptions, attributes)
+static const wchar_t PowerSchemesKey[] = L"SYSTEM\\CurrentControlSet\\Control\\Power\\User\\PowerSchemes";
+static const wchar_t PowerSettingsKey[] = L"SYSTEM\\CurrentControlSet\\Control\\Power\\PowerSettings";
+
+// Open the keys GetGeneration() stamps; a key that fails to open just contributes nothing
+PWinPowerBackend::PWinPowerBackend()
+{
+    RegOpenKeyExW(HKEY_LOCAL_MACHINE, PowerSchemesKey, 0, KEY_READ, schemesKey.put());
+    RegOpenKeyExW(HKEY_LOCAL_MACHINE, PowerSettingsKey, 0, KEY_READ, settingsKey.put());
+    schemesChanged.reset(CreateEventW(nullptr, FALSE, FALSE, nullptr));
+    settingsChanged.reset(CreateEventW(nullptr, FALSE, FALSE, nullptr));
+}
+
+// Ask for one notification per key on any change below it; thread-agnostic, so the registration outlives
+// the calling thread (which may be a short-lived worker)
+static bool WatchKey(HKEY key, HANDLE event)
+{
+    const DWORD filter = REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_THREAD_AGNOSTIC;
+    return key && event && RegNotifyChangeKeyValue(key, TRUE, filter, event, TRUE) == ERROR_SUCCESS;
+}
+
+// Arm both notifications; false if either cannot be armed (then every call re-stamps)
+bool PWinPowerBackend::WatchKeys()
+{
+    bool schemes = WatchKey(schemesKey.get(), schemesChanged.get());
+    bool settings = WatchKey(settingsKey.get(), settingsChanged.get());
+    return schemes && settings;
+}
+
+// Consume a pending notification
+static bool Signaled(HANDLE event)
+{
+    return event && WaitForSingleObject(event, 0) == WAIT_OBJECT_0;
+}
+
+// FILETIME as one 64-bit tick count
+static uint64_t Ticks(const FILETIME& time)
+{
+    return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+}
+
+// Latest LastWriteTime of a key and its direct subkeys
+static uint64_t KeyStamp(HKEY key)
+{
+    if (!key)
+        return 0;
+    FILETIME time = {};
+    if (RegQueryInfoKeyW(key, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &time) != ERROR_SUCCESS)
+        return 0;
+    uint64_t stamp = Ticks(time);
+    wchar_t name[256];
+    for (DWORD index = 0;; index++) {
+        DWORD length = ARRAYSIZE(name);
+        LSTATUS status = RegEnumKeyExW(key, index, name, &length, nullptr, nullptr, nullptr, &time);
+        if (status == ERROR_NO_MORE_ITEMS)
+            break;
+        if (status == ERROR_SUCCESS)
+            stamp = std::max(stamp, Ticks(time));
+    }
+    return stamp;
+}
+
+// Enumerate power schemes
+DWORD PWinPowerBackend::EnumerateScheme(DWORD index, GUID& scheme)
+{
+    DWORD guid_size = sizeof(GUID);
+    return PowerEnumerate(nullptr, nullptr, nullptr, ACCESS_SCHEME, index, (UCHAR*)&scheme, &guid_size);
+}
+
+// Enumerate subgroups of a scheme
+DWORD PWinPowerBackend::EnumerateSubgroup(const GUID& scheme, DWORD index, GUID& subgroup)
+{
+    DWORD guid_size = sizeof(GUID);
+    return PowerEnumerate(nullptr, &scheme, nullptr, ACCESS_SUBGROUP, index, (UCHAR*)&subgroup, &guid_size);
+}
+
+// Enumerate settings of a subgroup
+DWORD PWinPowerBackend::EnumerateSetting(const GUID& scheme, const GUID& subgroup, DWORD index, GUID& setting)
+{
+    DWORD guid_size = sizeof(GUID);
+    return PowerEnumerate(nullptr, &scheme, &subgroup, ACCESS_INDIVIDUAL_SETTING, index, (UCHAR*)&setting, &guid_size);
+}
+
+// Read friendly name
+DWORD PWinPowerBackend::ReadFriendlyName(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& name)
+{
+    wchar_t buffer[512] = {};
+    DWORD bufSize = sizeof(buffer) - sizeof(wchar_t);
+    DWORD ret = PowerReadFriendlyName(nullptr, scheme, subgroup, setting, (PUCHAR)buffer, &bufSize);
+    if (ret == ERROR_SUCCESS)
+        name.assign(buffer);
+    else
+        name.clear();
+    return ret;
+}
+
+// Read description
+DWORD PWinPowerBackend::ReadDescription(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& description)
+{
+    wchar_t buffer[512] = {};
+    DWORD bufSize = sizeof(buffer) - sizeof(wchar_t);
+    DWORD ret = PowerReadDescription(nullptr, scheme, subgroup, setting, (PUCHAR)buffer, &bufSize);
+    if (ret == ERROR_SUCCESS)
+        description.assign(buffer);
+    else
+        description.clear();
+    return ret;
+}
+
+// Read AC or DC value
+DWORD PWinPowerBackend::ReadValue(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD& type, DWORD& value)
+{
+    BYTE buffer[256] = {};
+    DWORD bufferSize = sizeof(buffer);
+    DWORD ret;
+    if (ac)
+        ret = PowerReadACValue(nullptr, &scheme, &subgroup, &setting, &type, buffer, &bufferSize);
+    else
+        ret = PowerReadDCValue(nullptr, &scheme, &subgroup, &setting, &type, buffer, &bufferSize);
+    if (ret == ERROR_SUCCESS)
+        value = *(DWORD*)buffer;
+    return ret;
+}
+
+// Write AC or DC value index
+DWORD PWinPowerBackend::WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD value)
+{
+    if (ac)
+        return PowerWriteACValueIndex(nullptr, &scheme, &subgroup, &setting, value);
+    return PowerWriteDCValueIndex(nullptr, &scheme, &subgroup, &setting, value);
+}
+
+// Get the active scheme GUID
+DWORD PWinPowerBackend::GetActiveScheme(GUID& scheme)
+{
+    wil::unique_any<GUID*, decltype(&::LocalFree), ::LocalFree> pPwrGUID;
+    DWORD ret = PowerGetActiveScheme(nullptr, pPwrGUID.put());
+    if (ret == ERROR_SUCCESS)
+        scheme = *pPwrGUID.get();
+    return ret;
+}
+
+// Activate a scheme
+DWORD PWinPowerBackend::SetActiveScheme(const GUID& scheme)
+{
+    return PowerSetActiveScheme(nullptr, &scheme);
+}
+
+// Latest LastWriteTime of the scheme and setting definition keys
+uint64_t PWinPowerBackend::StoreStamp()
+{
+    return std::max(KeyStamp(schemesKey.get()), KeyStamp(settingsKey.get()));
+}
+
+// Setting names and descriptions live under PowerSettings; scheme writes and activations do not move it
+uint64_t PWinPowerBackend::MetadataFingerprint()
+{
+    return KeyStamp(settingsKey.get());
+}
+
+// Bump the generation when the registry stamp moved; only re-stamp after a change notification
+uint64_t PWinPowerBackend::GetGeneration()
+{
+    std::lock_guard<std::mutex> lock(generationMutex);
+    // Poll both events so neither keeps a stale signal
+    bool schemes = Signaled(schemesChanged.get());
+    bool settings = Signaled(settingsChanged.get());
+    if (generation != 0 && watching && !schemes && !settings)
+        return generation;
+    // Re-arm before stamping, so a change made while stamping signals the next call
+    watching = WatchKeys();
+    uint64_t stamp = StoreStamp();
+    if (generation == 0 || stamp != lastStamp) {
+        lastStamp = stamp;
+        generation++;
+    }
+    return generation;
+}
+
+#endif
@@ -0,0 +1,50 @@
+// PWinPowerBackend.h - Declares the powrprof implementation of PPowerBackend.
+//
+// Generation:
+//   - powrprof has no change counter, so GetGeneration() derives one from the registry keys it stores
+//     schemes and setting definitions in: the latest LastWriteTime of PowerSchemes and PowerSettings and of
+//     their direct subkeys (schemes, subgroups). Adding, removing or renaming a scheme or setting moves it;
+//     value writes land two levels deeper and do not.
+//   - The keys are watched with RegNotifyChangeKeyValue; the stamp is only recomputed after a notification,
+//     so a catalog lookup normally costs one event poll instead of a subkey enumeration.
+//
+#pragma once
+#include "PPowerBackend.h"
+#include <mutex>
+
+#ifdef _WIN32
+class PWinPowerBackend : public PPowerBackend
+{
+public:
+    PWinPowerBackend();
+
+    DWORD EnumerateScheme(DWORD index, GUID& scheme) override;
+    DWORD EnumerateSubgroup(const GUID& scheme, DWORD index, GUID& subgroup) override;
+    DWORD EnumerateSetting(const GUID& scheme, const GUID& subgroup, DWORD index, GUID& setting) override;
+    DWORD ReadFriendlyName(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& name) override;
+    DWORD ReadDescription(const GUID* scheme, const GUID* subgroup, const GUID* setting, std::wstring& description) override;
+    DWORD ReadValue(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD& type, DWORD& value) override;
+    DWORD WriteValueIndex(const GUID& scheme, const GUID& subgroup, const GUID& setting, bool ac, DWORD value) override;
+    DWORD GetActiveScheme(GUID& scheme) override;
+    DWORD SetActiveScheme(const GUID& scheme) override;
+    uint64_t GetGeneration() override;
+    // LastWriteTime of the setting definitions (PowerSettings and its subgroup keys)
+    uint64_t MetadataFingerprint() override;
+
+    // Latest LastWriteTime (FILETIME ticks) of the scheme and setting definition keys; 0 if unreadable
+    uint64_t StoreStamp();
+
+private:
+    bool WatchKeys();
+
+    wil::unique_hkey schemesKey;
+    wil::unique_hkey settingsKey;
+    // Signaled by the registry when anything under the keys changes; re-armed before each re-stamp
+    wil::unique_handle schemesChanged;
+    wil::unique_handle settingsChanged;
+    bool watching = false;
+    std::mutex generationMutex;
+    uint64_t generation = 0;
+    uint64_t lastStamp = 0;
+};
+#endif
@@ -3,18 +3,69 @@
 // AC: Value or behavior when plugged into external power (wall outlet/dock). Typically allows higher performance and longer display time.
 // DC: Value or behavior when running on battery. Typically uses conservative settings to save energy (dimming display, reducing CPU performance, etc).
 //
-// Main program:
+// Main program (command-line frontend; the work is done by PowerInformationLib):
 //   - Dumps processor core type info (Intel Hybrid arch).
 //   - Supports command-line Get/Set for power settings.
 //   - Dumps filtered power settings if no arguments are provided.
+//   - Samples CPU frequency and energy counters in Monitor mode.
+//   - Writes results as text, JSON, CSV or NDJSON through one buffered UTF-8 writer (POutputWriter).
 //
 // Usage:
 //   PowerInformation.exe Help
 //     - Prints usage instructions and sample commands.
 //   PowerInformation.exe Get "<profile name>" "<setting name>"
 //     - Prints AC/DC values for the specified setting in the specified profile.
-//   PowerInformation.exe Set "<profile name>" "<setting name>" <value>
-//     - Sets AC/DC values for the specified setting in the specified profile.
+//   PowerInformation.exe Set "<profile name>" "<setting name>" <value> [...]
+//     - Sets AC/DC values for the specified setting(s) in the specified profile(s).
+//     - Several triples are applied as one batch: one lookup pass, one activation per profile.
+//     - <value> may be prefixed with "ac:" or "dc:" to set only one of them.
+//   PowerInformation.exe Apply <manifest> [--dry-run]
+//     - Reconciles the settings listed in a tab-separated manifest (<profile> <setting> <ac> <dc>, "-" = unmanaged):
+//       only differing values are written, each affected profile is activated once; --dry-run prints the plan.
+//   PowerInformation.exe Monitor
+//     - Prints CPU frequency and RAPL package/domain power every interval for the given duration.
+//   PowerInformation.exe Bench [compute|memory]
+//   PowerInformation.exe Bench -- <command> [args...]
+//     - Runs a built-in kernel or a command pinned to P-cores, E-cores and all cores; reports wall time,
+//       CPU time and package energy with 95% confidence intervals (time only without RAPL).
+//   PowerInformation.exe Snapshot <file>
+//     - Saves every scheme, setting value, the active scheme and the CPU topology to <file>
+//       (binary, memory-mappable format when <file> ends in .pisnap; tab-separated text otherwise).
+//   PowerInformation.exe Diff <baseline file> [<current file>]
+//     - Prints GUID-keyed drift records against a saved snapshot or the live system; exit code 0 = no drift, 1 = drift.
+//   PowerInformation.exe Watch
+//     - Waits for power scheme/setting change notifications and prints only what changed.
+//   PowerInformation.exe Search "<text>"
+//     - Ranks the settings whose name or description contains every word of <text>, case-insensitive,
+//       through a trigram index over the distinct settings (PSearchIndex).
+//   PowerInformation.exe Daemon
+//     - Serves Get/Set/Dump/Search from cached, change-refreshed state over a Unix socket or named pipe (PDaemon).
+//   PowerInformation.exe Client Get|Set|Dump|Search|Ping ...
+//     - Runs the command against the daemon: one pipelined round trip, no enumeration in the client.
+//   PowerInformation.exe Scan <patterns file> [<file or directory> ...]
+//     - Reports every (pattern, offset) hit of a set of masked hex patterns in one pass per file (PBytePatternSet);
+//       files are memory-mapped, the Linux default is /sys/firmware/acpi/tables.
+//
+// Options:
+//   --socket <endpoint>
+//     - Daemon/Client endpoint: Unix socket path or \\.\pipe\<name>. By default a root daemon listens on
+//       /run/PowerInformation.sock and other users' daemons in their runtime directory (DefaultIpcEndpoint);
+//       the client tries the user's own endpoint, then the system one.
+//   --format text|json|csv|ndjson
+//     - Output format of result records (default text); structured formats send status lines to stderr.
+//   --threads <n>
+//     - Worker threads used to read settings for Dump and the default listing (default: cores, max 8).
+//   --sysfs-root <dir>
+//     - Linux: read sysfs from <dir>/sys instead of /sys.
+//   --filter <predicate>
+//     - Settings of the default listing (repeatable, any may match): a GUID, a '*'/'?' glob over the name or a
+//       name substring, case-insensitive (PSettingFilter). Default: the heterogeneous thread scheduling policies.
+//   --cache <file>
+//     - Serve setting names/descriptions from a memory-mapped cache file (see PMetadataCache).
+//   --interval <ms>, --duration <s>
+//     - Monitor sampling interval (default 100 ms) and run time (default 5 s; Watch runs until stopped).
+//   --repeat <n>
+//     - Bench runs per placement (default 5).
 //
 // Example:
 //   PowerInformation.exe Get "Balanced" "Heterogeneous thread scheduling policy"
@@ -30,44 +81,690 @@
 #include "pch.h"
 #include "PInformation.h"
 #include "PProcInformation.h"
-#include <iostream>
-#include <Windows.h>
+#include "PParallel.h"
+#include "PMetadataCache.h"
+#include "PTelemetrySampler.h"
+#include "PCpuTopology.h"
+#include "PBenchmark.h"
+#include "PChangeWatcher.h"
+#include "PSettingTracker.h"
+#include "PSystemSnapshot.h"
+#include "PFields.h"
+#include "PSnapshotDiff.h"
+#include "PBinarySnapshot.h"
+#include "POutputWriter.h"
+#include "PDesiredState.h"
+#include "PDaemon.h"
+#include "PBytePatternSet.h"
+#include "PSettingFilter.h"
+#include "PSearchIndex.h"
+#include "PMappedFile.h"
+#include "PUtf8.h"
 #include <algorithm>
+#include <charconv>
+#include <clocale>
+#include <fstream>
+
+// Streams the settings the filter accepts in every profile (one record per setting in structured formats)
+class FilteredSettingPrinter : public PSettingVisitor
+{
+public:
+	FilteredSettingPrinter(POutputWriter& out, PSettingFilter& filter) : out(out), filter(filter) {}
+
+	bool OnScheme(const GUID& /*scheme*/, std::wstring_view profileName) override {
+		if (!out.IsStructured())
+			out << L"Profile: " << profileName << L"\n";
+		return true;
+	}
+	bool Accept(const GUID& setting, std::wstring_view name) override {
+		return filter.Matches(setting, name);
+	}
+	bool OnSetting(const PSettingView& setting) override {
+		if (out.IsStructured()) {
+			out.BeginRecord();
+			out.Field("profile", setting.profileName);
+			out.Field("setting", setting.name);
+			out.Field("description", setting.description);
+			if (setting.acOk) out.Field("ac", setting.acValue); else out.NullField("ac");
+			if (setting.dcOk) out.Field("dc", setting.dcValue); else out.NullField("dc");
+			out.EndRecord();
+			return true;
+		}
+		out << L"    Setting: " << setting.name << L" - " << setting.description << L", AC: ";
+		if (setting.acOk) out << setting.acValue; else out << L"<error>";
+		out << L", DC: ";
+		if (setting.dcOk) out << setting.dcValue; else out << L"<error>";
+		out << L"\n";
+		return true;
+	}
+
+private:
+	POutputWriter& out;
+	PSettingFilter& filter;
+};
+
+// Parses a Set value: "<n>" sets AC and DC, "ac:<n>" or "dc:<n>" sets only one of them
+bool parseSetValue(const wchar_t* text, DWORD& value, bool& ac, bool& dc) {
+	ac = dc = true;
+	if (_wcsnicmp(text, L"ac:", 3) == 0) {
+		dc = false;
+		text += 3;
+	} else if (_wcsnicmp(text, L"dc:", 3) == 0) {
+		ac = false;
+		text += 3;
+	}
+	wchar_t* end = nullptr;
+	value = static_cast<DWORD>(wcstoul(text, &end, 10));
+	return end != text && *end == L'\0';
+}
 
-// Checks if a setting name matches thread scheduling policies
-bool containsThreadType(const std::wstring& text) {
-	std::wstring lowerText = text;
-	std::transform(lowerText.begin(), lowerText.end(), lowerText.begin(), ::towlower);
-	return lowerText.find(L"heterogeneous thread scheduling policy") != std::wstring::npos ||
-		   lowerText.find(L"heterogeneous short running thread scheduling policy") != std::wstring::npos;
+// Prints the AC/DC pairs of a Get batch (one record per setting in structured formats)
+static void printReads(POutputWriter& out, const std::vector<PSettingRead>& reads) {
+	for (size_t i = 0; i + 1 < reads.size(); i += 2)
+	{
+		if (out.IsStructured()) {
+			out.BeginRecord();
+			out.Field("profile", reads[i].profileName);
+			out.Field("setting", reads[i].settingName);
+			if (reads[i].ok) out.Field("ac", reads[i].value); else out.NullField("ac");
+			if (reads[i + 1].ok) out.Field("dc", reads[i + 1].value); else out.NullField("dc");
+			out.EndRecord();
+			continue;
+		}
+		if (reads.size() > 2)
+			out << L"Setting: " << reads[i].settingName << L" (" << reads[i].profileName << L")\n";
+		if (reads[i].ok)
+			out << L"AC value: " << reads[i].value << L"\n";
+		else
+			out << L"Failed to get AC value.\n";
+		if (reads[i + 1].ok)
+			out << L"DC value: " << reads[i + 1].value << L"\n";
+		else
+			out << L"Failed to get DC value.\n";
+	}
+	out.Finish();
+}
+
+// Prints every setting of a Dump
+static void printSettings(POutputWriter& out, const std::wstring& profile, const std::vector<SettingInfo>& settings) {
+	if (out.IsStructured()) {
+		for (const auto& setting : settings) {
+			out.BeginRecord();
+			out.Field("profile", profile);
+			out.Field("setting", setting.name);
+			out.Field("description", setting.description);
+			out.Field("ac", setting.acValue);
+			out.Field("dc", setting.dcValue);
+			out.EndRecord();
+		}
+		out.Finish();
+		return;
+	}
+	out << L"All settings for profile: " << profile << L"\n";
+	for (const auto& setting : settings) {
+		out << L"    Setting: " << setting.name << L" - " << setting.description
+			<< L", AC: " << setting.acValue << L", DC: " << setting.dcValue << L"\n";
+	}
+}
+
+// One Search hit as printed
+struct SearchRow {
+	std::wstring guid;
+	std::wstring name;
+	std::wstring description;
+	uint32_t score;
+};
+
+// Prints Search hits, best first (one record per hit in structured formats)
+static int printSearchHits(POutputWriter& out, POutputWriter& msg, const std::wstring& query, const std::vector<SearchRow>& rows) {
+	for (const auto& row : rows) {
+		if (out.IsStructured()) {
+			out.BeginRecord();
+			out.Field("guid", row.guid);
+			out.Field("setting", row.name);
+			out.Field("description", row.description);
+			out.Field("score", row.score);
+			out.EndRecord();
+			continue;
+		}
+		out << L"Setting: " << row.name << L" - " << row.description << L" " << row.guid << L"\n";
+	}
+	out.Finish();
+	msg << rows.size() << L" settings match \"" << query << L"\"\n";
+	return rows.empty() ? 1 : 0;
+}
+
+// Search text: the remaining arguments joined by spaces
+static std::wstring searchQuery(int argc, wchar_t* argv[], int first) {
+	std::wstring query;
+	for (int i = first; i < argc; i++) {
+		if (i > first)
+			query += L' ';
+		query += argv[i];
+	}
+	return query;
+}
+
+// Escaped UTF-8 protocol field
+static std::string requestField(std::wstring_view text) {
+	return EscapeField(WideToUtf8(text));
+}
+
+// Parses a daemon value ("error" for a failed read)
+static bool parseDaemonValue(const std::string& text, DWORD& value) {
+	auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+	return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// Client mode: sends Get/Set/Dump to a running daemon as one pipelined batch and prints the answers
+// like the local commands do
+static int runClient(POutputWriter& out, POutputWriter& msg, const std::vector<std::wstring>& endpoints, int argc, wchar_t* argv[]) {
+	std::wstring command = argc >= 2 ? argv[1] : L"";
+	std::vector<std::string> requests;
+	if (command == L"Get" && argc >= 4) {
+		for (int i = 2; i + 1 < argc; i += 2)
+			requests.push_back("GET\t" + requestField(argv[i]) + "\t" + requestField(argv[i + 1]));
+	} else if (command == L"Set" && argc >= 5) {
+		for (int i = 2; i + 2 < argc; i += 3) {
+			DWORD value = 0;
+			bool ac = true, dc = true;
+			if (!parseSetValue(argv[i + 2], value, ac, dc)) {
+				msg << L"Invalid value: " << argv[i + 2] << L"\n";
+				return 1;
+			}
+			std::string text = std::to_string(value);
+			requests.push_back("SET\t" + requestField(argv[i]) + "\t" + requestField(argv[i + 1]) + "\t" +
+				(ac ? text : "-") + "\t" + (dc ? text : "-"));
+		}
+	} else if (command == L"Dump" && argc >= 3) {
+		requests.push_back("DUMP\t" + requestField(argv[2]));
+	} else if (command == L"Search" && argc >= 3) {
+		requests.push_back("SEARCH\t" + requestField(searchQuery(argc, argv, 2)));
+	} else if (command == L"Ping") {
+		requests.push_back("PING");
+	} else {
+		msg << L"Client supports Get, Set, Dump, Search and Ping.\n";
+		return 1;
+	}
+
+	// First endpoint with a daemon on it
+	PDaemonClient client;
+	std::vector<std::vector<std::string>> responses;
+	auto endpoint = std::find_if(endpoints.begin(), endpoints.end(), [&](const std::wstring& e) { return client.Connect(e); });
+	if (endpoint == endpoints.end() || !client.Exchange(requests, responses)) {
+		msg << L"No daemon is answering on ";
+		for (size_t i = 0; i < endpoints.size(); i++)
+			msg << (i ? L" or " : L"") << endpoints[i];
+		msg << L"\n";
+		return 2;
+	}
+
+	if (command == L"Get") {
+		std::vector<PSettingRead> reads;
+		for (size_t i = 0; i < responses.size(); i++) {
+			std::wstring profile = argv[2 + 2 * i], setting = argv[3 + 2 * i];
+			PSettingRead ac = { profile, setting, true }, dc = { profile, setting, false };
+			std::vector<std::string_view> fields = SplitFields(responses[i][0]);
+			if (fields[0] == "OK" && fields.size() == 3) {
+				ac.found = dc.found = true;
+				ac.ok = parseDaemonValue(std::string(fields[1]), ac.value);
+				dc.ok = parseDaemonValue(std::string(fields[2]), dc.value);
+			}
+			reads.push_back(ac);
+			reads.push_back(dc);
+		}
+		printReads(out, reads);
+		return 0;
+	}
+	if (command == L"Set") {
+		// The first refusal says why (e.g. another user's write to the system daemon)
+		auto failed = std::find_if(responses.begin(), responses.end(), [](const auto& response) { return response[0] != "OK"; });
+		if (failed == responses.end())
+			msg << L"Set value successfully.\n";
+		else if ((*failed)[0].compare(0, 4, "ERR\t") == 0 && (*failed)[0] != "ERR\tfailed to set value")
+			msg << L"Failed to set value: " << Utf8ToWide((*failed)[0].substr(4)) << L".\n";
+		else
+			msg << L"Failed to set value.\n";
+		return 0;
+	}
+	if (command == L"Dump") {
+		if (responses[0][0].compare(0, 3, "OK\t") != 0) {
+			msg << L"Profile not found: " << argv[2] << L"\n";
+			return 1;
+		}
+		std::vector<SettingInfo> settings;
+		for (size_t i = 1; i < responses[0].size(); i++) {
+			std::vector<std::string_view> fields = SplitFields(responses[0][i]);
+			if (fields.size() != 4)
+				continue;
+			settings.push_back({ Utf8ToWide(UnescapeField(fields[0])), Utf8ToWide(UnescapeField(fields[1])),
+				Utf8ToWide(fields[2]), Utf8ToWide(fields[3]) });
+		}
+		printSettings(out, argv[2], settings);
+		return 0;
+	}
+	if (command == L"Search") {
+		std::wstring query = searchQuery(argc, argv, 2);
+		if (responses[0][0].compare(0, 3, "OK\t") != 0) {
+			msg << L"Empty search text.\n";
+			return 2;
+		}
+		std::vector<SearchRow> rows;
+		for (size_t i = 1; i < responses[0].size(); i++) {
+			std::vector<std::string_view> fields = SplitFields(responses[0][i]);
+			uint32_t score = 0;
+			if (fields.size() != 4 || std::from_chars(fields[3].data(), fields[3].data() + fields[3].size(), score).ec != std::errc())
+				continue;
+			rows.push_back({ Utf8ToWide(fields[0]), Utf8ToWide(UnescapeField(fields[1])), Utf8ToWide(UnescapeField(fields[2])), score });
+		}
+		return printSearchHits(out, msg, query, rows);
+	}
+	msg << L"Daemon is running on " << *endpoint << L"\n";
+	return 0;
+}
+
+// Scan files for every pattern of a patterns file, one pass per file (default: the ACPI tables on Linux)
+static int runScan(POutputWriter& out, POutputWriter& msg, const std::wstring& sysfsRoot, int argc, wchar_t* argv[]) {
+	PBytePatternSet patterns;
+	size_t errorLine = 0;
+	if (!PBytePatternSet::Load(fs::path(argv[1]), patterns, errorLine)) {
+		if (errorLine)
+			msg << L"Invalid pattern line " << errorLine << L": " << argv[1] << L"\n";
+		else
+			msg << L"Failed to read patterns: " << argv[1] << L"\n";
+		return 2;
+	}
+	std::vector<fs::path> targets(argv + 2, argv + argc);
+#ifndef _WIN32
+	if (targets.empty())
+		targets.push_back((sysfsRoot.empty() ? fs::path("/") : fs::path(sysfsRoot)) / "sys/firmware/acpi/tables");
+#endif
+	if (targets.empty()) {
+		msg << L"Scan needs a file or directory to scan.\n";
+		return 2;
+	}
+	std::vector<fs::path> files;
+	for (const auto& target : targets) {
+		std::error_code ec;
+		if (!fs::is_directory(target, ec)) {
+			files.push_back(target);
+			continue;
+		}
+		for (fs::recursive_directory_iterator it(target, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+			if (it->is_regular_file(ec))
+				files.push_back(it->path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+
+	std::vector<PPatternHit> hits;
+	std::vector<uint8_t> buffer;
+	size_t matches = 0, scanned = 0;
+	uint64_t bytes = 0;
+	for (const auto& file : files) {
+		// sysfs attributes (the ACPI tables among them) cannot be mapped; those are read instead
+		PMappedFile mapped;
+		std::span<const uint8_t> data;
+		if (mapped.Open(file)) {
+			data = std::span<const uint8_t>(mapped.Data(), mapped.Size());
+		} else {
+			std::ifstream in(file, std::ios::binary);
+			if (!in) {
+				msg << L"Failed to read: " << file.wstring() << L"\n";
+				continue;
+			}
+			buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+			data = buffer;
+		}
+		hits.clear();
+		patterns.Scan(data, hits);
+		for (const auto& hit : hits) {
+			if (out.IsStructured()) {
+				out.BeginRecord();
+				out.Field("file", file.wstring());
+				out.Field("pattern", patterns.Name(hit.pattern));
+				out.Field("offset", static_cast<uint64_t>(hit.offset));
+				out.EndRecord();
+				continue;
+			}
+			char offset[24];
+			auto result = std::to_chars(offset, offset + sizeof(offset), static_cast<uint64_t>(hit.offset), 16);
+			out << file.wstring() << L": " << patterns.Name(hit.pattern) << L" at 0x" << std::string_view(offset, result.ptr - offset) << L"\n";
+		}
+		matches += hits.size();
+		scanned++;
+		bytes += data.size();
+	}
+	out.Finish();
+	msg << matches << L" matches of " << patterns.Size() << L" patterns in " << scanned << L" files (" << bytes << L" bytes)\n";
+	return matches ? 0 : 1;
+}
+
+// Prints one Monitor line (or record) per sample: average/min/max frequency (and P/E averages on hybrid parts) and power per energy domain
+class MonitorPrinter
+{
+public:
+	MonitorPrinter(POutputWriter& out, const PTelemetrySampler& sampler, const PCpuTopology& topology)
+		: out(out), sampler(sampler), topology(topology), lastEnergy(sampler.EnergyDomains().size()) {}
+
+	void operator()(const PTelemetrySample& sample) {
+		uint64_t sum = 0, pSum = 0, eSum = 0;
+		size_t count = 0, pCount = 0, eCount = 0;
+		uint32_t low = UINT32_MAX, high = 0;
+		for (size_t cpu = 0; cpu < sample.frequencyKHz.size(); cpu++) {
+			uint32_t khz = sample.frequencyKHz[cpu];
+			if (khz == 0)
+				continue;
+			sum += khz; count++;
+			low = std::min(low, khz); high = std::max(high, khz);
+			if (topology.performance.Test(cpu)) { pSum += khz; pCount++; }
+			if (topology.efficiency.Test(cpu)) { eSum += khz; eCount++; }
+		}
+		const auto& domains = sampler.EnergyDomains();
+		bool structured = out.IsStructured();
+		if (structured) {
+			// Fixed columns so CSV rows line up: missing values are null
+			out.BeginRecord();
+			out.SetPrecision(3);
+			out.Field("time", sample.timestampNs / 1e9);
+			out.SetPrecision(0);
+			if (count) {
+				out.Field("freqAvgMHz", sum / count / 1000.0);
+				out.Field("freqMinMHz", low / 1000.0);
+				out.Field("freqMaxMHz", high / 1000.0);
+			} else {
+				out.NullField("freqAvgMHz");
+				out.NullField("freqMinMHz");
+				out.NullField("freqMaxMHz");
+			}
+			if (pCount && eCount) {
+				out.Field("pAvgMHz", pSum / pCount / 1000.0);
+				out.Field("eAvgMHz", eSum / eCount / 1000.0);
+			} else {
+				out.NullField("pAvgMHz");
+				out.NullField("eAvgMHz");
+			}
+		} else {
+			out.SetPrecision(3);
+			out << L"t=" << sample.timestampNs / 1e9 << L"s";
+			out.SetPrecision(0);
+			if (count)
+				out << L"  freq avg " << sum / count / 1000.0 << L" MHz (" << low / 1000.0 << L".." << high / 1000.0 << L")";
+			if (pCount && eCount)
+				out << L"  P " << pSum / pCount / 1000.0 << L" MHz  E " << eSum / eCount / 1000.0 << L" MHz";
+		}
+		out.SetPrecision(2);
+		for (size_t i = 0; i < domains.size(); i++) {
+			double seconds = (sample.timestampNs - lastTimestamp) / 1e9;
+			double watts = haveLast && seconds > 0 ? (sample.energyUj[i] - lastEnergy[i]) / 1e6 / seconds : 0.0;
+			if (structured) {
+				std::string name = domains[i].name + "W";
+				if (haveLast) out.Field(name, watts); else out.NullField(name);
+			} else if (haveLast) {
+				out << L"  " << domains[i].name << L" " << watts << L" W";
+			}
+			lastEnergy[i] = sample.energyUj[i];
+		}
+		lastTimestamp = sample.timestampNs;
+		haveLast = true;
+		if (structured)
+			out.EndRecord();
+		else
+			out << L"\n";
+	}
+
+private:
+	POutputWriter& out;
+	const PTelemetrySampler& sampler;
+	const PCpuTopology& topology;
+	std::vector<uint64_t> lastEnergy;
+	uint64_t lastTimestamp = 0;
+	bool haveLast = false;
+};
+
+// Prints "<mean> +/- <ci95> <unit>" for a Bench column, or its mean/ci95 fields in structured formats
+static void printStats(POutputWriter& out, const char* label, const std::vector<double>& samples, const wchar_t* unit) {
+	PBenchStats stats = PBenchStats::FromSamples(samples);
+	if (out.IsStructured()) {
+		out.Field(std::string(label) + "Mean", stats.mean);
+		out.Field(std::string(label) + "Ci95", stats.ci95);
+		out.Field(std::string(label) + "Median", stats.median);
+		return;
+	}
+	out << L"  " << label << L" " << stats.mean << L" +/- " << stats.ci95 << L" " << unit << L" (median " << stats.median << L")";
+}
+
+// Prints one AC/DC value of a Watch change ("<error>" for a failed read)
+static void printValue(POutputWriter& out, bool ok, DWORD value) {
+	if (ok) out << value; else out << L"<error>";
+}
+
+// One AC/DC value as a record field (null for a failed read or an unchanged value)
+static void valueField(POutputWriter& out, const char* name, bool present, bool ok, DWORD value) {
+	if (present && ok) out.Field(name, value); else out.NullField(name);
+}
+
+// Prints a Watch delta
+static void printChange(POutputWriter& out, const PSettingChange& change) {
+	if (out.IsStructured()) {
+		static const char* const kinds[] = { "active", "value", "added", "removed" };
+		bool value = change.kind == PSettingChange::Kind::Value;
+		bool hasOld = value || change.kind == PSettingChange::Kind::Removed;
+		bool hasNew = value || change.kind == PSettingChange::Kind::Added;
+		out.BeginRecord();
+		out.Field("kind", kinds[static_cast<int>(change.kind)]);
+		out.Field("profile", change.profileName);
+		out.Field("previousProfile", change.previousProfile);
+		out.Field("setting", change.settingName);
+		valueField(out, "oldAc", hasOld && (!value || change.acChanged), change.oldAcOk, change.oldAc);
+		valueField(out, "newAc", hasNew && (!value || change.acChanged), change.newAcOk, change.newAc);
+		valueField(out, "oldDc", hasOld && (!value || change.dcChanged), change.oldDcOk, change.oldDc);
+		valueField(out, "newDc", hasNew && (!value || change.dcChanged), change.newDcOk, change.newDc);
+		out.EndRecord();
+		return;
+	}
+	switch (change.kind) {
+	case PSettingChange::Kind::ActiveScheme:
+		out << L"Active profile: " << change.previousProfile << L" -> " << change.profileName << L"\n";
+		return;
+	case PSettingChange::Kind::Added:
+		out << L"Added: " << change.profileName << L" / " << change.settingName << L", AC: ";
+		printValue(out, change.newAcOk, change.newAc);
+		out << L", DC: ";
+		printValue(out, change.newDcOk, change.newDc);
+		break;
+	case PSettingChange::Kind::Removed:
+		out << L"Removed: " << change.profileName << L" / " << change.settingName;
+		break;
+	case PSettingChange::Kind::Value:
+		out << L"Changed: " << change.profileName << L" / " << change.settingName;
+		if (change.acChanged) {
+			out << L", AC: ";
+			printValue(out, change.oldAcOk, change.oldAc);
+			out << L" -> ";
+			printValue(out, change.newAcOk, change.newAc);
+		}
+		if (change.dcChanged) {
+			out << L", DC: ";
+			printValue(out, change.oldDcOk, change.oldDc);
+			out << L" -> ";
+			printValue(out, change.newDcOk, change.newDc);
+		}
+		break;
+	}
+	out << L"\n";
 }
 
 // Entry point
 int wmain(int argc, wchar_t* argv[])
 {
-	PInformation pInfo;
-	// Change stdout to Unicode UTF-16
-	_setmode(_fileno(stdout), _O_U16TEXT);
+#ifdef _WIN32
+	// All output is UTF-8 from POutputWriter: write bytes untranslated and have the console decode them as UTF-8
+	_setmode(_fileno(stdout), _O_BINARY);
+	_setmode(_fileno(stderr), _O_BINARY);
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	// Global options, removed from the argument list before command dispatch
+	unsigned threads = DefaultEnumerationThreads();
+	std::wstring cachePath;
+	std::wstring sysfsRoot;
+	unsigned intervalMs = 100;
+	unsigned durationSeconds = 5;
+	bool durationGiven = false;
+	unsigned repeats = 5;
+	POutputFormat format = POutputFormat::Text;
+	std::wstring endpoint = DefaultIpcEndpoint();
+	bool endpointGiven = false;
+	std::vector<std::wstring> filters;
+	std::vector<wchar_t*> args;
+	for (int i = 0; i < argc; i++) {
+		// Everything after "--" belongs to the command being run (Bench)
+		if (wcscmp(argv[i], L"--") == 0) {
+			args.insert(args.end(), argv + i, argv + argc);
+			break;
+		}
+		if (wcscmp(argv[i], L"--threads") == 0 && i + 1 < argc) {
+			threads = std::max(1u, static_cast<unsigned>(wcstoul(argv[++i], nullptr, 10)));
+			continue;
+		}
+		if (wcscmp(argv[i], L"--cache") == 0 && i + 1 < argc) {
+			cachePath = argv[++i];
+			continue;
+		}
+		if (wcscmp(argv[i], L"--sysfs-root") == 0 && i + 1 < argc) {
+			sysfsRoot = argv[++i];
+			continue;
+		}
+		if (wcscmp(argv[i], L"--interval") == 0 && i + 1 < argc) {
+			intervalMs = std::max(1u, static_cast<unsigned>(wcstoul(argv[++i], nullptr, 10)));
+			continue;
+		}
+		if (wcscmp(argv[i], L"--duration") == 0 && i + 1 < argc) {
+			durationSeconds = static_cast<unsigned>(wcstoul(argv[++i], nullptr, 10));
+			durationGiven = true;
+			continue;
+		}
+		if (wcscmp(argv[i], L"--repeat") == 0 && i + 1 < argc) {
+			repeats = std::max(1u, static_cast<unsigned>(wcstoul(argv[++i], nullptr, 10)));
+			continue;
+		}
+		if (wcscmp(argv[i], L"--filter") == 0 && i + 1 < argc) {
+			filters.push_back(argv[++i]);
+			continue;
+		}
+		if (wcscmp(argv[i], L"--socket") == 0 && i + 1 < argc) {
+			endpoint = argv[++i];
+			endpointGiven = true;
+			continue;
+		}
+		if (wcscmp(argv[i], L"--format") == 0 && i + 1 < argc) {
+			if (!ParseOutputFormat(argv[++i], format)) {
+				POutputWriter(stderr) << L"Unknown format: " << argv[i] << L" (text, json, csv or ndjson)\n";
+				return 2;
+			}
+			continue;
+		}
+		args.push_back(argv[i]);
+	}
+	argc = static_cast<int>(args.size());
+	argv = args.data();
+
+	// Results go to stdout in the selected format; in structured formats, status lines go to stderr
+	// so that stdout stays machine-readable
+	POutputWriter out(stdout, format);
+	POutputWriter err(stderr);
+	POutputWriter& msg = out.IsStructured() ? err : out;
+
+	// Thin client: no power store access in this process, the daemon answers from its cache
+	if (argc >= 2 && wcscmp(argv[1], L"Client") == 0)
+		return runClient(out, msg, endpointGiven ? std::vector<std::wstring>{ endpoint } : DefaultClientIpcEndpoints(), argc - 1, argv + 1);
+
+	// Byte pattern scan: files only, no power store access
+	if (argc >= 3 && wcscmp(argv[1], L"Scan") == 0)
+		return runScan(out, msg, sysfsRoot, argc - 1, argv + 1);
+
+	// Power store, optionally fronted by the persistent name/description cache
+	std::unique_ptr<PPowerBackend> backend = CreateDefaultPowerBackend(fs::path(sysfsRoot));
+	if (!backend) {
+		msg << L"No power backend is available on this platform.\n";
+		return 1;
+	}
+	std::unique_ptr<PCachedPowerBackend> cachedBackend;
+	if (!cachePath.empty())
+		cachedBackend = std::make_unique<PCachedPowerBackend>(*backend, fs::path(cachePath));
+	PInformation pInfo(cachedBackend ? static_cast<PPowerBackend&>(*cachedBackend) : *backend);
 
 
 	// Help parameter support
 	if (argc >= 2 && (wcscmp(argv[1], L"Help") == 0 || wcscmp(argv[1], L"--help") == 0 || wcscmp(argv[1], L"-h") == 0)) {
-		std::wcout << L"Usage:\n"
+		msg << L"Usage:\n"
 			<< L"  PowerInformation.exe Help\n"
 			<< L"    - Prints usage instructions and sample commands.\n"
-			<< L"  PowerInformation.exe Get \"<profile name>\" \"<setting name>\"\n"
-			<< L"    - Prints AC/DC values for the specified setting in the specified profile.\n"
-			<< L"  PowerInformation.exe Set \"<profile name>\" \"<setting name>\" <value>\n"
-			<< L"    - Sets AC/DC values for the specified setting in the specified profile.\n"
-			<< L"  PowerInformation.exe Dump \"<profile name>\"\n"
-			<< L"    - Prints all settings and their AC/DC values for the specified profile.\n"
-			<< L"  PowerInformation.exe Dump \"<profile name>\"\n"
-			<< L"    - Prints all settings and their AC/DC values for the specified profile.\n"
+			<< L"  PowerInformation.exe Get \"<profile name>\" \"<setting name>\" [\"<profile name>\" \"<setting name>\" ...]\n"
+			<< L"    - Prints AC/DC values for the specified setting(s) in the specified profile(s).\n"
+			<< L"  PowerInformation.exe Set \"<profile name>\" \"<setting name>\" <value> [\"<profile name>\" \"<setting name>\" <value> ...]\n"
+			<< L"    - Sets AC/DC values for the specified setting(s) as one batch; each profile is activated once.\n"
+			<< L"      <value> is \"<n>\" for AC and DC, or \"ac:<n>\" / \"dc:<n>\" for one of them.\n"
+			<< L"  PowerInformation.exe Apply <manifest> [--dry-run]\n"
+			<< L"    - Brings the settings listed in <manifest> to their desired values, writing only the values that\n"
+			<< L"      differ and activating each changed profile once. Lines are tab-separated UTF-8:\n"
+			<< L"      <profile> <setting> <ac> <dc>, with \"-\" for a value that is not managed and '#' comments.\n"
+			<< L"      --dry-run prints the plan without writing (exit code 1 if anything would change).\n"
 			<< L"  PowerInformation.exe Dump \"<profile name>\"\n"
 			<< L"    - Prints all settings and their AC/DC values for the specified profile.\n"
+			<< L"  PowerInformation.exe Search \"<text>\"\n"
+			<< L"    - Lists the settings whose name or description contains every word of <text> (case-insensitive),\n"
+			<< L"      best matches first: name matches before description matches. Exit code 1 if nothing matched.\n"
+			<< L"  PowerInformation.exe Monitor [--interval <ms>] [--duration <s>]\n"
+			<< L"    - Samples per-CPU frequency and RAPL energy on a background thread and prints each sample.\n"
+			<< L"  PowerInformation.exe Bench [compute|memory] [--repeat <n>]\n"
+			<< L"  PowerInformation.exe Bench [--repeat <n>] -- <command> [args...]\n"
+			<< L"    - Runs the kernel or command pinned to P-cores, E-cores and all cores and reports wall time,\n"
+			<< L"      CPU time and package energy (joules) with 95% confidence intervals; time only without RAPL.\n"
+			<< L"  PowerInformation.exe Snapshot <file>\n"
+			<< L"    - Saves all schemes, setting values, the active scheme and the CPU topology to <file>.\n"
+			<< L"      A .pisnap extension selects the compact binary format; Diff reads both formats.\n"
+			<< L"  PowerInformation.exe Diff <baseline file> [<current file>]\n"
+			<< L"    - Prints tab-separated drift records keyed by GUID against a snapshot or the live system:\n"
+			<< L"      <kind> <scheme> <setting> <field> <old> <new> <profile> <setting name>. Exit code 1 on drift.\n"
+			<< L"  PowerInformation.exe Watch [--duration <s>]\n"
+			<< L"    - Waits for active profile and setting changes and prints only the changed entries.\n"
+			<< L"  PowerInformation.exe Daemon [--socket <endpoint>] [--duration <s>]\n"
+			<< L"    - Keeps all settings in memory, refreshed on change, and answers Get/Set/Dump/Search over a local\n"
+			<< L"      socket (Linux) or named pipe (Windows).\n"
+			<< L"  PowerInformation.exe Client Get|Set|Dump|Search|Ping ... [--socket <endpoint>]\n"
+			<< L"    - Sends the command to a running daemon instead of reading the power store; same output.\n"
+			<< L"  PowerInformation.exe Scan <patterns file> [<file or directory> ...]\n"
+			<< L"    - Finds every byte pattern of <patterns file> (lines: <name> <hex pattern>, tab-separated,\n"
+			<< L"      \"??\" or \"?\" for wildcard bytes or nibbles) in each file, one pass per file. Linux default:\n"
+			<< L"      the ACPI tables in /sys/firmware/acpi/tables. Exit code 1 if nothing matched.\n"
+			<< L"\nOptions:\n"
+			<< L"  --format text|json|csv|ndjson\n"
+			<< L"    - Output format of Get, Apply, Dump, Search, Diff, Monitor, Bench, Watch, Scan and the default listing (default text).\n"
+			<< L"      Structured formats write one record per result to stdout and status messages to stderr.\n"
+			<< L"  --socket <endpoint>\n"
+			<< L"    - Daemon/Client endpoint (default " << DefaultIpcEndpoint() << L"; Client also tries the system daemon).\n"
+			<< L"  --threads <n>\n"
+			<< L"    - Number of worker threads used to read settings for Dump and the default listing.\n"
+			<< L"  --sysfs-root <dir>\n"
+			<< L"    - Linux: read sysfs from <dir>/sys instead of /sys (fixture trees).\n"
+			<< L"  --filter <predicate>\n"
+			<< L"    - Settings shown by the default listing; repeat to show several. A GUID selects that setting,\n"
+			<< L"      text with * or ? is a glob over the whole name, other text a name substring (case-insensitive).\n"
+			<< L"      Default: the heterogeneous thread scheduling policies.\n"
+			<< L"  --cache <file>\n"
+			<< L"    - Keep setting names/descriptions in a memory-mapped cache file, rebuilt when the UI language changes.\n"
+			<< L"  --interval <ms>\n"
+			<< L"    - Monitor sampling interval (default 100).\n"
+			<< L"  --duration <s>\n"
+			<< L"    - Monitor run time in seconds (default 5); Watch runs until stopped unless given.\n"
+			<< L"  --repeat <n>\n"
+			<< L"    - Bench runs per placement (default 5).\n"
 			<< L"\nExample:\n"
 			<< L"  PowerInformation.exe Get \"Balanced\" \"Heterogeneous thread scheduling policy\"\n"
 			<< L"  PowerInformation.exe Set \"Balanced\" \"Heterogeneous thread scheduling policy\" 1\n"
+			<< L"  PowerInformation.exe --format json Dump \"Balanced\"\n"
 			<< L"\nAC refers to plugged-in power, DC refers to battery. Both are always shown/set.\n";
 		return 0;
 	}
@@ -78,95 +775,422 @@ int wmain(int argc, wchar_t* argv[])
 		std::wstring command = argv[1];
 		if (command == L"Get" && argc >= 4)
 		{
-			std::wstring profile = argv[2];
-			std::wstring setting = argv[3];
-			DWORD value = 0;
-			if (pInfo.GetPowerSettingValue(profile, setting, true, value))
-				std::wcout << L"AC value: " << value << std::endl;
-			else
-				std::wcout << L"Failed to get AC value." << std::endl;
-			if (pInfo.GetPowerSettingValue(profile, setting, false, value))
-				std::wcout << L"DC value: " << value << std::endl;
-			else
-				std::wcout << L"Failed to get DC value." << std::endl;
+			// One or more "<profile>" "<setting>" pairs, read as a single batch
+			std::vector<PSettingRead> reads;
+			for (int i = 2; i + 1 < argc; i += 2)
+			{
+				reads.push_back({ argv[i], argv[i + 1], true });
+				reads.push_back({ argv[i], argv[i + 1], false });
+			}
+			pInfo.GetPowerSettingValues(reads);
+			printReads(out, reads);
 			return 0;
 		}
 		else if (command == L"Set" && argc >= 5)
 		{
-			std::wstring profile = argv[2];
-			std::wstring setting = argv[3];
-			DWORD value = _wtoi(argv[4]);
-			bool okAC = pInfo.SetPowerSettingValue(profile, setting, value, true);
-			bool okDC = pInfo.SetPowerSettingValue(profile, setting, value, false);
-			if (okAC || okDC)
-				std::wcout << L"Set value successfully." << std::endl;
-			else
-				std::wcout << L"Failed to set value." << std::endl;
+			// One or more "<profile>" "<setting>" <value> triples, applied as a single batch
+			std::vector<PSettingWrite> writes;
+			for (int i = 2; i + 2 < argc; i += 3)
+			{
+				DWORD value = 0;
+				bool ac = true, dc = true;
+				if (!parseSetValue(argv[i + 2], value, ac, dc)) {
+					msg << L"Invalid value: " << argv[i + 2] << L"\n";
+					return 1;
+				}
+				if (ac)
+					writes.push_back({ argv[i], argv[i + 1], true, value });
+				if (dc)
+					writes.push_back({ argv[i], argv[i + 1], false, value });
+			}
+			switch (pInfo.SetPowerSettingValues(writes)) {
+			case PSetResult::Applied:
+				msg << L"Set value successfully.\n";
+				break;
+			case PSetResult::NotActivated:
+				msg << L"Set value, but the profile could not be activated.\n";
+				break;
+			case PSetResult::PartlyApplied:
+				msg << L"Failed to set value; some values could not be restored.\n";
+				break;
+			default:
+				msg << L"Failed to set value; no values were changed.\n";
+				break;
+			}
 			return 0;
 		}
+		else if (command == L"Apply" && argc >= 3)
+		{
+			// Desired state: read everything it manages in one batch and write only the values that differ
+			bool dryRun = argc >= 4 && wcscmp(argv[3], L"--dry-run") == 0;
+			PDesiredState desired;
+			size_t errorLine = 0;
+			if (!PDesiredState::Load(fs::path(argv[2]), desired, errorLine)) {
+				if (errorLine)
+					msg << L"Invalid manifest line " << errorLine << L": " << argv[2] << L"\n";
+				else
+					msg << L"Failed to read manifest: " << argv[2] << L"\n";
+				return 2;
+			}
+			PReconcilePlan plan = PlanReconcile(pInfo, desired);
+			for (const PDesiredValue* value : plan.unresolved)
+				msg << L"Not found (line " << value->line << L"): " << value->profileName << L" / " << value->settingName << L"\n";
+			if (!plan.unresolved.empty())
+				return 2;
+			for (const auto& planned : plan.writes) {
+				if (out.IsStructured()) {
+					out.BeginRecord();
+					out.Field("profile", planned.write.profileName);
+					out.Field("setting", planned.write.settingName);
+					out.Field("field", planned.write.ac ? "ac" : "dc");
+					out.Field("old", planned.current);
+					out.Field("new", planned.write.value);
+					out.EndRecord();
+					continue;
+				}
+				out << (dryRun ? L"Would set: " : L"Set: ") << planned.write.profileName << L" / " << planned.write.settingName
+					<< (planned.write.ac ? L", AC: " : L", DC: ") << planned.current << L" -> " << planned.write.value << L"\n";
+			}
+			out.Finish();
+			for (const PDesiredValue* value : plan.unreadable)
+				msg << L"Unreadable, left alone (line " << value->line << L"): " << value->profileName << L" / " << value->settingName
+					<< (value->ac ? L", AC\n" : L", DC\n");
+			if (dryRun) {
+				msg << plan.writes.size() << L" writes to " << plan.ProfileCount() << L" profiles planned, "
+					<< plan.unchanged << L" values already as desired.\n";
+				return plan.Converged() ? 0 : 1;
+			}
+			switch (ApplyReconcile(pInfo, plan)) {
+			case PSetResult::Applied:
+				break;
+			case PSetResult::NotActivated:
+				msg << plan.writes.size() << L" writes to " << plan.ProfileCount() << L" profiles, but a profile could not be activated.\n";
+				return 1;
+			case PSetResult::PartlyApplied:
+				msg << L"Failed to apply manifest; some values could not be restored.\n";
+				return 1;
+			case PSetResult::NotApplied:
+				msg << L"Failed to apply manifest; no values were changed.\n";
+				return 1;
+			}
+			if (plan.writes.empty())
+				msg << L"Already converged: " << plan.unchanged << L" values as desired, nothing written.\n";
+			else
+				msg << plan.writes.size() << L" writes to " << plan.ProfileCount() << L" profiles, "
+					<< plan.unchanged << L" values already as desired.\n";
+			return plan.unreadable.empty() ? 0 : 1;
+		}
 		else if (command == L"Dump" && argc >= 3)
 		{
 			std::wstring profile = argv[2];
 			// Find the GUID for the profile name
-			int scheme_idx = 0;
 			GUID scheme_guid = {};
-			DWORD guid_size = sizeof(GUID);
-			bool found = false;
-			while (ERROR_SUCCESS == PowerEnumerate(nullptr, nullptr, nullptr, ACCESS_SCHEME, scheme_idx++, (UCHAR*)&scheme_guid, &guid_size)) {
-				wchar_t wszName[512] = {};
-				DWORD dwLen = 511;
-				DWORD dwRet = PowerReadFriendlyName(nullptr, &scheme_guid, nullptr, nullptr, (PUCHAR)wszName, &dwLen);
-				std::wstring foundProfile = (dwRet == ERROR_SUCCESS) ? wszName : L"";
-				if (foundProfile.empty()) {
-					wchar_t scheme_guid_str[64] = {};
-					if (StringFromGUID2(scheme_guid, scheme_guid_str, 64) > 0) {
-						foundProfile = scheme_guid_str;
-					} else {
-						foundProfile = L"<invalid GUID>";
+			bool found = pInfo.FindProfileGuid(profile, scheme_guid);
+			if (!found) {
+				msg << L"Profile not found: " << profile << L"\n";
+				return 1;
+			}
+			printSettings(out, profile, pInfo.EnumerateAllSettingsValues(&scheme_guid, threads));
+			return 0;
+		}
+		else if (command == L"Search" && argc >= 3)
+		{
+			// One document per distinct setting, read from names and descriptions only (no values)
+			std::wstring query = searchQuery(argc, argv, 2);
+			PSearchIndex index = PSearchIndex::Build(pInfo, threads);
+			std::vector<PSearchHit> hits;
+			if (!index.Search(query, hits)) {
+				msg << L"Empty search text.\n";
+				return 2;
+			}
+			std::vector<SearchRow> rows;
+			for (const PSearchHit& hit : hits) {
+				rows.push_back({ GuidToString(index.Setting(hit.document)), std::wstring(index.Name(hit.document)),
+					std::wstring(index.Description(hit.document)), hit.score });
+			}
+			return printSearchHits(out, msg, query, rows);
+		}
+		else if (command == L"Monitor")
+		{
+			fs::path root = sysfsRoot.empty() ? fs::path("/") : fs::path(sysfsRoot);
+			PTelemetrySampler sampler(root);
+			PCpuTopology topology;
+#ifdef _WIN32
+			PCpuTopology::LoadFromWindows(topology);
+#else
+			PCpuTopology::LoadFromSysfs(root, topology);
+#endif
+			if (!sampler.Start(std::chrono::milliseconds(intervalMs))) {
+				msg << L"Nothing to sample: no cpufreq or energy counters found.\n";
+				return 1;
+			}
+			msg << L"Monitoring " << sampler.CpuCount() << L" CPUs and " << sampler.EnergyDomains().size()
+				<< L" energy domains every " << intervalMs << L" ms\n";
+			msg.Flush();
+			// Drain a few times per second; the ring holds well over one drain period of samples
+			MonitorPrinter printer(out, sampler, topology);
+			auto end = std::chrono::steady_clock::now() + std::chrono::seconds(durationSeconds);
+			while (std::chrono::steady_clock::now() < end) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(std::max(intervalMs, 200u)));
+				sampler.Drain(printer);
+				out.Flush();
+			}
+			sampler.Stop();
+			sampler.Drain(printer);
+			out.Finish();
+			if (sampler.Dropped())
+				msg << L"Dropped samples: " << sampler.Dropped() << L"\n";
+			return 0;
+		}
+		else if (command == L"Bench")
+		{
+			fs::path root = sysfsRoot.empty() ? fs::path("/") : fs::path(sysfsRoot);
+			PCpuTopology topology;
+#ifdef _WIN32
+			PCpuTopology::LoadFromWindows(topology);
+#else
+			PCpuTopology::LoadFromSysfs(root, topology);
+#endif
+			PBenchWorkload workload;
+			if (argc >= 3 && wcscmp(argv[2], L"--") == 0) {
+				workload.external = true;
+				workload.command.assign(argv + 3, argv + argc);
+				if (workload.command.empty()) {
+					msg << L"Bench: no command given after --\n";
+					return 1;
+				}
+			} else if (argc >= 3 && !PBenchmark::ParseKernel(argv[2], workload.kernel)) {
+				msg << L"Unknown kernel: " << argv[2] << L"\n";
+				return 1;
+			}
+
+			PBenchmark bench(topology, root);
+			const PCorePlacement placements[] = { PCorePlacement::Performance, PCorePlacement::Efficiency, PCorePlacement::Any };
+			std::vector<PBenchResult> completed;
+			out.SetPrecision(3);
+			for (PCorePlacement placement : placements) {
+				PBenchResult result;
+				if (out.IsStructured()) {
+					// Fixed columns: a skipped or failed placement has null statistics
+					bool ran = bench.Run(placement, workload, repeats, result);
+					out.BeginRecord();
+					out.Field("placement", PlacementName(placement));
+					out.Field("cpus", result.cpuCount);
+					out.Field("runs", result.wallSeconds.size());
+					out.Field("status", ran ? "ok" : result.cpuCount == 0 ? "skipped" : "failed");
+					static const char* const columns[] = { "wallMean", "wallCi95", "wallMedian", "cpuMean", "cpuCi95", "cpuMedian",
+					                                       "joulesMean", "joulesCi95", "joulesMedian" };
+					size_t written = 0;
+					if (ran) {
+						printStats(out, "wall", result.wallSeconds, L"s");
+						printStats(out, "cpu", result.cpuSeconds, L"s");
+						written = 6;
+						if (result.haveEnergy) {
+							printStats(out, "joules", result.joules, L"J");
+							written = 9;
+						}
+					}
+					for (size_t i = written; i < std::size(columns); i++)
+						out.NullField(columns[i]);
+					out.EndRecord();
+					if (!ran)
+						continue;
+				} else {
+					out << PlacementName(placement) << L":";
+					if (!bench.Run(placement, workload, repeats, result)) {
+						out << (result.cpuCount == 0 ? L" no such cores, skipped" : L" run failed") << L"\n";
+						out.Flush();
+						continue;
 					}
+					out << L" " << result.cpuCount << L" CPUs, n=" << result.wallSeconds.size();
+					printStats(out, "wall", result.wallSeconds, L"s");
+					printStats(out, "cpu", result.cpuSeconds, L"s");
+					if (result.haveEnergy)
+						printStats(out, "package", result.joules, L"J");
+					out << L"\n";
 				}
-				if (foundProfile == profile) {
-					found = true;
-					break;
+				out.Flush();
+				completed.push_back(std::move(result));
+			}
+			out.Finish();
+			// Rank every placement by the same metric: energy per job only when all of them measured it
+			bool energy = !completed.empty() && std::all_of(completed.begin(), completed.end(), [](const PBenchResult& result) {
+				return result.haveEnergy && !result.joules.empty();
+			});
+			const PBenchResult* best = nullptr;
+			double bestValue = 0.0;
+			for (const PBenchResult& result : completed) {
+				double value = PBenchStats::FromSamples(energy ? result.joules : result.wallSeconds).mean;
+				if (!best || value < bestValue) {
+					best = &result;
+					bestValue = value;
 				}
-				scheme_guid = {};
-				guid_size = sizeof(GUID);
 			}
-			if (!found) {
-				std::wcout << L"Profile not found: " << profile << std::endl;
+			if (best)
+				msg << (energy ? L"Lowest energy per job: " : L"Fastest (energy counters not available): ") << PlacementName(best->placement) << L"\n";
+			return 0;
+		}
+		else if ((command == L"Snapshot" || command == L"Diff") && argc >= 3)
+		{
+			// Live side: settings through the (possibly cached) backend plus the machine's topology
+			auto captureLive = [&]() {
+				PCpuTopology topology;
+#ifdef _WIN32
+				PCpuTopology::LoadFromWindows(topology);
+#else
+				PCpuTopology::LoadFromSysfs(sysfsRoot.empty() ? fs::path("/") : fs::path(sysfsRoot), topology);
+#endif
+				return PSystemSnapshot::Capture(pInfo, topology);
+			};
+			if (command == L"Snapshot") {
+				fs::path file(argv[2]);
+				PSystemSnapshot snapshot = captureLive();
+				bool saved = file.extension() == L".pisnap" ? WriteBinarySnapshot(snapshot, file) : snapshot.Save(file);
+				if (!saved) {
+					msg << L"Failed to write snapshot: " << argv[2] << L"\n";
+					return 2;
+				}
+				return 0;
+			}
+			PSystemSnapshot baseline, current;
+			if (!PSystemSnapshot::Load(fs::path(argv[2]), baseline)) {
+				msg << L"Failed to read snapshot: " << argv[2] << L"\n";
+				return 2;
+			}
+			if (argc >= 4) {
+				if (!PSystemSnapshot::Load(fs::path(argv[3]), current)) {
+					msg << L"Failed to read snapshot: " << argv[3] << L"\n";
+					return 2;
+				}
+			} else {
+				current = captureLive();
+			}
+			// Text format: one tab-separated line per record, "-" for empty fields and GUIDs
+			static const GUID empty = {};
+			std::vector<PDiffRecord> records = DiffSnapshots(baseline, current);
+			for (const auto& record : records) {
+				out.BeginRecord();
+				out.Field("kind", DiffKindName(record.kind));
+				out.Field("scheme", record.scheme == empty ? std::wstring() : GuidToString(record.scheme));
+				out.Field("setting", record.setting == empty ? std::wstring() : GuidToString(record.setting));
+				out.Field("field", record.field);
+				out.Field("old", record.oldValue);
+				out.Field("new", record.newValue);
+				out.Field("profile", record.profileName);
+				out.Field("settingName", record.settingName);
+				out.Field("subgroup", record.subgroup == empty ? std::wstring() : GuidToString(record.subgroup));
+				out.EndRecord();
+			}
+			out.Finish();
+			return records.empty() ? 0 : 1;
+		}
+		else if (command == L"Daemon")
+		{
+			PPowerBackend& source = cachedBackend ? static_cast<PPowerBackend&>(*cachedBackend) : *backend;
+			PIpcListener listener;
+			// The system endpoint serves every local user; only root's own clients may Set
+			if (!listener.Open(endpoint, IsSystemIpcEndpoint(endpoint))) {
+				msg << L"Cannot listen on " << endpoint << L" (is a daemon already running?)\n";
+				return 2;
+			}
+			// One full capture; afterwards values are re-read on change notifications and after every Set
+			PDaemon daemon(pInfo, source);
+			daemon.Start();
+			msg << L"Serving " << daemon.SettingCount() << L" settings in " << daemon.SchemeCount()
+				<< L" profiles on " << endpoint << L"\n";
+			msg.Flush();
+			auto deadline = durationGiven ? std::chrono::steady_clock::now() + std::chrono::seconds(durationSeconds)
+										  : std::chrono::steady_clock::time_point::max();
+			daemon.Serve(listener, deadline);
+			daemon.Stop();
+			return 0;
+		}
+		else if (command == L"Watch")
+		{
+			PPowerBackend& source = cachedBackend ? static_cast<PPowerBackend&>(*cachedBackend) : *backend;
+			PChangeWatcher watcher;
+			if (!watcher.Open(source.ChangeSources())) {
+				msg << L"No change notifications are available for this power backend.\n";
 				return 1;
 			}
-			std::vector<SettingInfo> settings = pInfo.EnumerateAllSettingsValues(&scheme_guid);
-			std::wcout << L"All settings for profile: " << profile << std::endl;
-			for (const auto& setting : settings) {
-				std::wcout << L"    Setting: " << setting.name << L" - " << setting.description
-						   << L", AC: " << setting.acValue << L", DC: " << setting.dcValue << std::endl;
+			// One full capture up front; afterwards only values are re-read, and only when notified
+			PSettingTracker tracker(pInfo, source);
+			tracker.Capture();
+			msg << L"Watching " << tracker.Snapshot().SettingCount() << L" settings in "
+				<< tracker.Snapshot().SchemeCount() << L" profiles\n";
+			msg.Flush();
+			auto end = std::chrono::steady_clock::now() + std::chrono::seconds(durationSeconds);
+			std::vector<PSettingChange> changes;
+			for (;;) {
+				auto timeout = std::chrono::milliseconds::max();
+				if (durationGiven) {
+					auto now = std::chrono::steady_clock::now();
+					if (now >= end)
+						break;
+					timeout = std::chrono::duration_cast<std::chrono::milliseconds>(end - now);
+				}
+				if (!watcher.Wait(timeout))
+					continue;
+				changes.clear();
+				tracker.Refresh(changes);
+				for (const auto& change : changes)
+					printChange(out, change);
+				out.Flush();
 			}
+			out.Finish();
 			return 0;
 		}
 	}
 
-	// Default: dump processor info and filtered settings
+	// Default: dump processor info and filtered settings (only the setting records in structured formats)
+	PSettingFilter filter = PSettingFilter::ThreadScheduling();
+	size_t badFilter = 0;
+	if (!filters.empty() && !PSettingFilter::Compile(filters, filter, badFilter)) {
+		msg << L"Empty --filter (number " << badFilter + 1 << L")\n";
+		return 2;
+	}
+	FilteredSettingPrinter printer(out, filter);
+	if (out.IsStructured()) {
+		pInfo.VisitSettings(printer, nullptr, threads);
+		out.Finish();
+		return 0;
+	}
+#ifdef _WIN32
 	PProcInformation procInfo;
-	procInfo.DumpCoreTypes();
+#else
+	PProcInformation procInfo(sysfsRoot.empty() ? fs::path("/") : fs::path(sysfsRoot));
+#endif
+	procInfo.DumpCoreTypes(out);
 
 	auto defaultprofile = pInfo.GetDefaultPowerProfileName();
 
 
-	std::wcout << L"Default Power Profile: " << defaultprofile << std::endl;
-	std::map<std::wstring, std::vector<SettingInfo>> profiles = pInfo.PowerEnumerateProfiles();
-	std::wcout << L"Available Power Profiles and Filtered Settings:\n";
-	for (const auto& profile : profiles)
-	{
-		// dump the profile name and description
-		std::wcout << L"Profile: " << profile.first << std::endl;
-		for (const auto& setting : profile.second)
-		{			
-			if (containsThreadType(setting.name)) {
-				std::wcout << L"    Setting: " << setting.name << L" - " << setting.description
-						   << L", AC: " << setting.acValue << L", DC: " << setting.dcValue << std::endl;
-			}
+	out << L"Default Power Profile: " << defaultprofile << L"\n";
+	out << L"Available Power Profiles and Filtered Settings:\n";
+	// Stream the settings; only the matching ones have their description and values read
+	pInfo.VisitSettings(printer, nullptr, threads);
+	return 0;
+}
+
+#ifndef _WIN32
+// Non-Windows entry point: widen the arguments with the user's locale and run wmain
+int main(int argc, char* argv[])
+{
+	std::setlocale(LC_ALL, "");
+	std::vector<std::wstring> wideArgs;
+	for (int i = 0; i < argc; i++) {
+		std::wstring wide;
+		size_t length = std::mbstowcs(nullptr, argv[i], 0);
+		if (length != static_cast<size_t>(-1)) {
+			wide.resize(length + 1);
+			wide.resize(std::mbstowcs(wide.data(), argv[i], wide.size()));
 		}
+		wideArgs.push_back(std::move(wide));
 	}
-	return 0;
+	std::vector<wchar_t*> wideArgv;
+	for (auto& arg : wideArgs)
+		wideArgv.push_back(arg.data());
+	wideArgv.push_back(nullptr);
+	return wmain(argc, wideArgv.data());
 }
+#endif
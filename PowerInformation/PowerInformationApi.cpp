@@ -0,0 +1,275 @@
+// PowerInformationApi.cpp - Implements the C interface on top of PInformation, PCompactSnapshot and PCpuTopology.
+//
+#include "pch.h"
+#include "PowerInformationApi.h"
+#include "PowerInformationApiBackend.h"
+#include "PInformation.h"
+#include "PCompactSnapshot.h"
+#include "PCpuTopology.h"
+#include "PUtf8.h"
+#include <new>
+
+#ifdef _WIN32
+static_assert(PI_OK == ERROR_SUCCESS && PI_ERROR_INVALID_PARAMETER == ERROR_INVALID_PARAMETER &&
+              PI_ERROR_INSUFFICIENT_BUFFER == ERROR_INSUFFICIENT_BUFFER && PI_ERROR_NOT_FOUND == ERROR_NOT_FOUND &&
+              PI_ERROR_FAILED == ERROR_FUNCTION_FAILED, "PiStatus values are Win32 error codes");
+#endif
+static_assert(sizeof(PiGuid) == sizeof(GUID), "PiGuid has the GUID layout");
+static_assert(PI_CORE_PERFORMANCE == static_cast<uint32_t>(PCoreType::Performance) &&
+              PI_CORE_EFFICIENCY == static_cast<uint32_t>(PCoreType::Efficiency), "PI_CORE_* match PCoreType");
+
+// Everything a handle owns; the capture and topology are refreshed in place
+struct PiContext {
+    std::unique_ptr<PPowerBackend> backend;
+    std::unique_ptr<PInformation> info;
+    PCompactSnapshot snapshot;
+    PCpuTopology topology;
+    std::filesystem::path sysfsRoot;
+    std::string scratch; // reused UTF-8 encoding buffer
+};
+
+// Exceptions (allocation failure) must not cross the C boundary
+template <typename Function>
+static PiStatus Guarded(Function function)
+{
+    try {
+        return function();
+    } catch (...) {
+        return PI_ERROR_FAILED;
+    }
+}
+
+static PiGuid ToPiGuid(const GUID& guid)
+{
+    PiGuid out;
+    memcpy(&out, &guid, sizeof(out));
+    return out;
+}
+
+// Copy a wide string as UTF-8 into a caller buffer; the required length is always reported
+static PiStatus CopyString(PiContext* context, std::wstring_view text, char* buffer, size_t size, size_t* length)
+{
+    context->scratch.clear();
+    WideToUtf8(text, context->scratch);
+    if (length)
+        *length = context->scratch.size();
+    if (!buffer && size == 0)
+        return PI_OK;
+    if (!buffer || size <= context->scratch.size()) {
+        if (buffer && size)
+            buffer[0] = '\0';
+        return PI_ERROR_INSUFFICIENT_BUFFER;
+    }
+    memcpy(buffer, context->scratch.data(), context->scratch.size());
+    buffer[context->scratch.size()] = '\0';
+    return PI_OK;
+}
+
+// Reload the topology from the platform source
+static void LoadTopology(PiContext* context)
+{
+#ifdef _WIN32
+    PCpuTopology::LoadFromWindows(context->topology);
+#else
+    PCpuTopology::LoadFromSysfs(context->sysfsRoot.empty() ? std::filesystem::path("/") : context->sysfsRoot, context->topology);
+#endif
+}
+
+uint32_t PiGetApiVersion(void)
+{
+    return PI_API_VERSION;
+}
+
+// Capture once and hand the context out
+static PiStatus OpenContext(std::unique_ptr<PiContext> created, PiContext** context)
+{
+    created->info = std::make_unique<PInformation>(*created->backend);
+    created->snapshot = PCompactSnapshot::Capture(*created->info);
+    LoadTopology(created.get());
+    *context = created.release();
+    return PI_OK;
+}
+
+PiStatus PiOpen(const char* sysfsRoot, PiContext** context)
+{
+    if (!context)
+        return PI_ERROR_INVALID_PARAMETER;
+    *context = nullptr;
+    return Guarded([&]() -> PiStatus {
+        auto created = std::make_unique<PiContext>();
+        if (sysfsRoot)
+            created->sysfsRoot = std::filesystem::u8path(sysfsRoot);
+        created->backend = CreateDefaultPowerBackend(created->sysfsRoot);
+        if (!created->backend)
+            return PI_ERROR_FAILED;
+        return OpenContext(std::move(created), context);
+    });
+}
+
+PiStatus PiOpenOnBackend(std::unique_ptr<PPowerBackend> backend, const char* sysfsRoot, PiContext** context)
+{
+    if (!context || !backend)
+        return PI_ERROR_INVALID_PARAMETER;
+    *context = nullptr;
+    return Guarded([&]() -> PiStatus {
+        auto created = std::make_unique<PiContext>();
+        if (sysfsRoot)
+            created->sysfsRoot = std::filesystem::u8path(sysfsRoot);
+        created->backend = std::move(backend);
+        return OpenContext(std::move(created), context);
+    });
+}
+
+void PiClose(PiContext* context)
+{
+    delete context;
+}
+
+PiStatus PiRefresh(PiContext* context)
+{
+    if (!context)
+        return PI_ERROR_INVALID_PARAMETER;
+    return Guarded([&]() -> PiStatus {
+        context->info->InvalidateCatalog();
+        context->snapshot = PCompactSnapshot::Capture(*context->info);
+        LoadTopology(context);
+        return PI_OK;
+    });
+}
+
+uint32_t PiGetSchemeCount(PiContext* context)
+{
+    return context ? static_cast<uint32_t>(context->snapshot.SchemeCount()) : 0;
+}
+
+uint32_t PiGetSettingCount(PiContext* context)
+{
+    return context ? static_cast<uint32_t>(context->snapshot.SettingCount()) : 0;
+}
+
+PiStatus PiGetScheme(PiContext* context, uint32_t index, PiGuid* guid, char* name, size_t nameSize, size_t* nameLength)
+{
+    if (!context)
+        return PI_ERROR_INVALID_PARAMETER;
+    const PCompactSnapshot& snapshot = context->snapshot;
+    if (index >= snapshot.SchemeCount())
+        return PI_ERROR_NOT_FOUND;
+    if (guid)
+        *guid = ToPiGuid(snapshot.SchemeGuids()[index]);
+    return Guarded([&] { return CopyString(context, snapshot.Strings().Get(snapshot.SchemeNameIds()[index]), name, nameSize, nameLength); });
+}
+
+PiStatus PiGetSetting(PiContext* context, uint32_t index, PiSetting* setting,
+                      char* name, size_t nameSize, size_t* nameLength,
+                      char* description, size_t descriptionSize, size_t* descriptionLength)
+{
+    if (!context)
+        return PI_ERROR_INVALID_PARAMETER;
+    const PCompactSnapshot& snapshot = context->snapshot;
+    if (index >= snapshot.SettingCount())
+        return PI_ERROR_NOT_FOUND;
+    if (setting) {
+        uint32_t scheme = snapshot.SettingSchemes()[index];
+        setting->scheme = ToPiGuid(snapshot.SchemeGuids()[scheme]);
+        setting->subgroup = ToPiGuid(snapshot.SubgroupGuids()[index]);
+        setting->setting = ToPiGuid(snapshot.SettingGuids()[index]);
+        setting->schemeIndex = scheme;
+        setting->acValue = snapshot.AcValues()[index];
+        setting->dcValue = snapshot.DcValues()[index];
+        setting->acOk = snapshot.AcTypes()[index] == PValueType::Dword;
+        setting->dcOk = snapshot.DcTypes()[index] == PValueType::Dword;
+    }
+    return Guarded([&]() -> PiStatus {
+        PiStatus nameStatus = CopyString(context, snapshot.Strings().Get(snapshot.NameIds()[index]), name, nameSize, nameLength);
+        PiStatus descriptionStatus = CopyString(context, snapshot.Strings().Get(snapshot.DescriptionIds()[index]),
+                                                description, descriptionSize, descriptionLength);
+        return nameStatus != PI_OK ? nameStatus : descriptionStatus;
+    });
+}
+
+PiStatus PiGetValue(PiContext* context, const char* profile, const char* setting, uint32_t* acValue, uint32_t* dcValue)
+{
+    if (!context || !profile || !setting)
+        return PI_ERROR_INVALID_PARAMETER;
+    return Guarded([&]() -> PiStatus {
+        std::wstring profileName = Utf8ToWide(profile), settingName = Utf8ToWide(setting);
+        std::vector<PSettingRead> reads = { { profileName, settingName, true }, { profileName, settingName, false } };
+        context->info->GetPowerSettingValues(reads);
+        if (!reads[0].found)
+            return PI_ERROR_NOT_FOUND;
+        if (!reads[0].ok || !reads[1].ok)
+            return PI_ERROR_FAILED;
+        if (acValue)
+            *acValue = reads[0].value;
+        if (dcValue)
+            *dcValue = reads[1].value;
+        return PI_OK;
+    });
+}
+
+PiStatus PiSetValue(PiContext* context, const char* profile, const char* setting, uint32_t which, uint32_t value)
+{
+    if (!context || !profile || !setting || which == 0 || (which & ~PI_BOTH) != 0)
+        return PI_ERROR_INVALID_PARAMETER;
+    return Guarded([&]() -> PiStatus {
+        std::wstring profileName = Utf8ToWide(profile), settingName = Utf8ToWide(setting);
+        std::vector<PSettingWrite> writes;
+        if (which & PI_AC)
+            writes.push_back({ profileName, settingName, true, value });
+        if (which & PI_DC)
+            writes.push_back({ profileName, settingName, false, value });
+        if (context->info->SetPowerSettingValues(writes) == PSetResult::Applied)
+            return PI_OK;
+        GUID scheme;
+        return context->info->FindProfileGuid(profileName, scheme) ? PI_ERROR_FAILED : PI_ERROR_NOT_FOUND;
+    });
+}
+
+PiStatus PiGetActiveScheme(PiContext* context, PiGuid* guid)
+{
+    if (!context || !guid)
+        return PI_ERROR_INVALID_PARAMETER;
+    return Guarded([&]() -> PiStatus {
+        GUID active = {};
+        if (!context->info->GetActiveSchemeGuid(active))
+            return PI_ERROR_FAILED;
+        *guid = ToPiGuid(active);
+        return PI_OK;
+    });
+}
+
+PiStatus PiGetTopology(PiContext* context, PiCpuInfo* cpus, size_t capacity, size_t* count)
+{
+    if (!context || !count || (!cpus && capacity))
+        return PI_ERROR_INVALID_PARAMETER;
+    const PCpuTopology& topology = context->topology;
+    *count = topology.cpuCount;
+    if (capacity < topology.cpuCount)
+        return PI_ERROR_INSUFFICIENT_BUFFER;
+    for (size_t cpu = 0; cpu < topology.cpuCount; cpu++) {
+        PiCpuInfo& info = cpus[cpu];
+        info.cpu = static_cast<uint32_t>(cpu);
+        info.online = topology.online.Test(cpu);
+        info.coreType = static_cast<uint32_t>(topology.coreType[cpu]);
+        info.capacity = topology.capacity[cpu];
+        info.coreId = topology.coreId[cpu];
+        info.packageId = topology.packageId[cpu];
+        info.dieId = topology.dieId[cpu];
+        info.numaNode = topology.numaNode[cpu];
+    }
+    return PI_OK;
+}
+
+PiStatus PiGetCoreCounts(PiContext* context, uint32_t* performanceCores, uint32_t* efficiencyCores, uint32_t* logicalCpus)
+{
+    if (!context)
+        return PI_ERROR_INVALID_PARAMETER;
+    const PCpuTopology& topology = context->topology;
+    if (performanceCores)
+        *performanceCores = static_cast<uint32_t>(topology.CoreCount(PCoreType::Performance));
+    if (efficiencyCores)
+        *efficiencyCores = static_cast<uint32_t>(topology.CoreCount(PCoreType::Efficiency));
+    if (logicalCpus)
+        *logicalCpus = static_cast<uint32_t>(topology.online.Count());
+    return PI_OK;
+}
@@ -0,0 +1,123 @@
+/* PowerInformationApi.h - Stable C interface of the PowerInformation library.
+ *
+ * For agents that link the library instead of running PowerInformation.exe and parsing its text.
+ *
+ * Conventions:
+ *   - Plain C (C89 plus <stddef.h>/<stdint.h>), so C, C++, Go (cgo) and others can bind it directly.
+ *   - Part of the static PowerInformationLib; there is no shared-library build.
+ *   - Every function returns a PiStatus. The values are Win32 error codes on every platform:
+ *     PI_OK (0), PI_ERROR_INVALID_PARAMETER, PI_ERROR_NOT_FOUND, PI_ERROR_INSUFFICIENT_BUFFER, PI_ERROR_FAILED.
+ *   - Strings are UTF-8 and NUL-terminated. Output strings and arrays go into caller-provided buffers.
+ *     The required length (string: without the NUL; array: element count) is always stored, so a caller
+ *     can ask with a zero-sized buffer first. A buffer that is too small yields PI_ERROR_INSUFFICIENT_BUFFER.
+ *     The library never returns memory for the caller to free.
+ *   - A PiContext is not thread-safe; use one context per thread or serialize the calls.
+ *   - The layout of the structs below only ever grows at the end; PI_API_VERSION is bumped when it does.
+ *
+ * Usage:
+ *   PiContext* context;
+ *   if (PiOpen(NULL, &context) == PI_OK) {
+ *       uint32_t ac, dc;
+ *       PiGetValue(context, "Balanced", "Heterogeneous thread scheduling policy", &ac, &dc);
+ *       PiClose(context);
+ *   }
+ */
+#ifndef POWERINFORMATION_API_H
+#define POWERINFORMATION_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PI_API_VERSION 1
+
+typedef uint32_t PiStatus;
+#define PI_OK                         0u    /* ERROR_SUCCESS */
+#define PI_ERROR_INVALID_PARAMETER    87u   /* ERROR_INVALID_PARAMETER */
+#define PI_ERROR_INSUFFICIENT_BUFFER  122u  /* ERROR_INSUFFICIENT_BUFFER */
+#define PI_ERROR_NOT_FOUND            1168u /* ERROR_NOT_FOUND */
+#define PI_ERROR_FAILED               1627u /* ERROR_FUNCTION_FAILED */
+
+/* Which value a write addresses */
+#define PI_AC    1u
+#define PI_DC    2u
+#define PI_BOTH  3u
+
+/* Core types of PiCpuInfo.coreType */
+#define PI_CORE_UNKNOWN      0u
+#define PI_CORE_PERFORMANCE  1u
+#define PI_CORE_EFFICIENCY   2u
+
+typedef struct PiContext PiContext;
+
+/* Same layout as the Win32 GUID */
+typedef struct PiGuid {
+    uint32_t data1;
+    uint16_t data2;
+    uint16_t data3;
+    uint8_t data4[8];
+} PiGuid;
+
+/* One (scheme, setting) entry of the captured state */
+typedef struct PiSetting {
+    PiGuid scheme;
+    PiGuid subgroup;
+    PiGuid setting;
+    uint32_t schemeIndex;  /* index for PiGetScheme */
+    uint32_t acValue;
+    uint32_t dcValue;
+    uint32_t acOk;         /* nonzero if acValue was read */
+    uint32_t dcOk;         /* nonzero if dcValue was read */
+} PiSetting;
+
+/* One logical CPU; ids are -1 when unknown */
+typedef struct PiCpuInfo {
+    uint32_t cpu;
+    uint32_t online;
+    uint32_t coreType;     /* PI_CORE_* */
+    uint32_t capacity;     /* relative, largest core = 1024; 0 if unknown */
+    int32_t coreId;
+    int32_t packageId;
+    int32_t dieId;
+    int32_t numaNode;
+} PiCpuInfo;
+
+/* Version of this interface the library implements (PI_API_VERSION at build time) */
+uint32_t PiGetApiVersion(void);
+
+/* Create a context on the platform's power store. sysfsRoot (Linux only, may be NULL) reads sysfs from
+ * <sysfsRoot>/sys instead of /sys. */
+PiStatus PiOpen(const char* sysfsRoot, PiContext** context);
+void PiClose(PiContext* context);
+
+/* Capture every scheme and setting with its names and AC/DC values. PiOpen captures once; call again to
+ * pick up changes. The index-based accessors below read this capture and do not touch the power store. */
+PiStatus PiRefresh(PiContext* context);
+uint32_t PiGetSchemeCount(PiContext* context);
+uint32_t PiGetSettingCount(PiContext* context);
+PiStatus PiGetScheme(PiContext* context, uint32_t index, PiGuid* guid,
+                     char* name, size_t nameSize, size_t* nameLength);
+/* name/description may be NULL with a zero size when only the values are wanted */
+PiStatus PiGetSetting(PiContext* context, uint32_t index, PiSetting* setting,
+                      char* name, size_t nameSize, size_t* nameLength,
+                      char* description, size_t descriptionSize, size_t* descriptionLength);
+
+/* Live access by (profile name, setting name), as the Get/Set commands */
+PiStatus PiGetValue(PiContext* context, const char* profile, const char* setting, uint32_t* acValue, uint32_t* dcValue);
+/* which is PI_AC, PI_DC or PI_BOTH; the profile is activated once after the write */
+PiStatus PiSetValue(PiContext* context, const char* profile, const char* setting, uint32_t which, uint32_t value);
+PiStatus PiGetActiveScheme(PiContext* context, PiGuid* guid);
+
+/* Processor topology: one PiCpuInfo per logical CPU slot */
+PiStatus PiGetTopology(PiContext* context, PiCpuInfo* cpus, size_t capacity, size_t* count);
+/* Physical P-core and E-core counts (0 on non-hybrid parts) and online logical CPUs */
+PiStatus PiGetCoreCounts(PiContext* context, uint32_t* performanceCores, uint32_t* efficiencyCores, uint32_t* logicalCpus);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POWERINFORMATION_API_H */
@@ -0,0 +1,12 @@
+// PowerInformationApiBackend.h - C++ entry to the C interface: a PiContext on a caller's PPowerBackend.
+//
+// Functions:
+//   - PiOpenOnBackend: PiOpen on the given backend instead of the platform's power store; the context owns it.
+//     Tests use it to drive the C functions against PFakePowerBackend.
+//
+#pragma once
+#include <memory>
+#include "PPowerBackend.h"
+#include "PowerInformationApi.h"
+
+PiStatus PiOpenOnBackend(std::unique_ptr<PPowerBackend> backend, const char* sysfsRoot, PiContext** context);
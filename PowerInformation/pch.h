@@ -8,24 +8,24 @@
 #define PCH_H
 
 
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
 #define BOOST_USE_WINAPI_VERSION	0x0601
+#endif
 
 
 
 #include <iostream>
-#include <Windows.h>
-#include <powersetting.h>
-#include <powrprof.h>
 #include <cstdlib>
 #include <cstdio>
-#include <malloc.h>
-#include <memory.h>
-#include <tchar.h>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <string_view>
 #include <filesystem>
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include <functional>
 #include <regex>
 #include <chrono>
@@ -34,10 +34,19 @@
 #include <unordered_set>
 #include <sstream>
 #include <algorithm>
+#include <memory>
 #include <fcntl.h>
-#include <io.h>
 #include <stdio.h>
 
+#ifdef _WIN32
+#include <Windows.h>
+#include <powersetting.h>
+#include <powrprof.h>
+#include <malloc.h>
+#include <memory.h>
+#include <tchar.h>
+#include <io.h>
+
 #include <wil/result.h>
 #include <wil/resource.h>
 
@@ -46,6 +55,40 @@
 #include <Shlobj.h>
 #include <atlconv.h>
 #include <atltrace.h>
+#else
+// Minimal stand-ins for the Win32 types and error codes used by the portable sources
+#include <unistd.h>
+#include <cwchar>
+#include <cwctype>
+
+typedef std::uint32_t DWORD;
+typedef std::uint8_t BYTE;
+typedef unsigned char UCHAR;
+typedef UCHAR* PUCHAR;
+
+struct GUID {
+    std::uint32_t Data1;
+    std::uint16_t Data2;
+    std::uint16_t Data3;
+    std::uint8_t Data4[8];
+};
+
+inline bool operator==(const GUID& a, const GUID& b) { return std::memcmp(&a, &b, sizeof(GUID)) == 0; }
+inline bool operator!=(const GUID& a, const GUID& b) { return !(a == b); }
+
+#define ERROR_SUCCESS           0L
+#define ERROR_FILE_NOT_FOUND    2L
+#define ERROR_ACCESS_DENIED     5L
+#define ERROR_INVALID_DATA      13L
+#define ERROR_NOT_SUPPORTED     50L
+#define ERROR_INVALID_PARAMETER 87L
+#define ERROR_MORE_DATA         234L
+#define ERROR_NO_MORE_ITEMS     259L
+#define ERROR_NOT_FOUND         1168L
+#define REG_DWORD               4
+
+#define _wcsnicmp wcsncasecmp
+#endif
 
 
 //namespaces
@@ -0,0 +1,92 @@
+// BinarySnapshotBench.cpp - Snapshot parse throughput: the text format, the binary reader's Open (which
+// validates every record) and a walk over its records, plus Find lookups.
+//
+// Usage: BinarySnapshotBench [schemes subgroups settings]   (default 10 20 50)
+//
+#include "pch.h"
+#include "PBenchTimer.h"
+#include "PBinarySnapshot.h"
+#include "PFakePowerBackend.h"
+#include "PInformation.h"
+#include <fstream>
+
+int main(int argc, char* argv[])
+{
+    size_t schemes = 10, subgroups = 20, settings = 50;
+    if (argc == 4) {
+        schemes = std::strtoul(argv[1], nullptr, 10);
+        subgroups = std::strtoul(argv[2], nullptr, 10);
+        settings = std::strtoul(argv[3], nullptr, 10);
+    }
+    PFakePowerBackend backend;
+    backend.Populate(schemes, subgroups, settings);
+    PInformation info(backend);
+    PSystemSnapshot snapshot = PSystemSnapshot::Capture(info, PCpuTopology());
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+    std::filesystem::path textPath = dir / "BinarySnapshotBench.txt", binaryPath = dir / "BinarySnapshotBench.bin";
+    if (!snapshot.Save(textPath) || !WriteBinarySnapshot(snapshot, binaryPath)) {
+        std::printf("cannot write the snapshots to %s\n", dir.string().c_str());
+        return 1;
+    }
+    std::string text = snapshot.ToText();
+    double textBytes = static_cast<double>(text.size());
+    double binaryBytes = static_cast<double>(std::filesystem::file_size(binaryPath));
+    std::printf("%zu settings: text %.0f KiB, binary %.0f KiB\n", snapshot.settings.SettingCount(), textBytes / 1024, binaryBytes / 1024);
+
+    double parseText = BestOf(5, [&] {
+        PSystemSnapshot parsed;
+        PSystemSnapshot::FromText(text, parsed);
+        KeepAlive(parsed.settings.SettingCount());
+    });
+    Report("text FromText (in memory)", parseText, textBytes);
+
+    double loadText = BestOf(5, [&] {
+        PSystemSnapshot parsed;
+        PSystemSnapshot::Load(textPath, parsed);
+        KeepAlive(parsed.settings.SettingCount());
+    });
+    Report("text Load (file)", loadText, textBytes);
+
+    double open = BestOf(20, [&] {
+        PBinarySnapshotReader reader;
+        reader.Open(binaryPath);
+        KeepAlive(reader.SettingCount());
+    });
+    Report("binary Open (map + validate)", open, binaryBytes, loadText);
+
+    PBinarySnapshotReader reader;
+    if (!reader.Open(binaryPath))
+        return 1;
+    double walk = BestOf(20, [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < reader.SettingCount(); i++) {
+            PBinarySnapshotReader::SettingView view = reader.Setting(i);
+            sum += view.acValue + view.name.size() + view.description.size();
+        }
+        KeepAlive(sum);
+    });
+    Report("binary walk of every record", walk, binaryBytes);
+
+    double expand = BestOf(5, [&] {
+        PSystemSnapshot parsed;
+        reader.ToSystemSnapshot(parsed);
+        KeepAlive(parsed.settings.SettingCount());
+    });
+    Report("binary ToSystemSnapshot", expand, binaryBytes, loadText);
+
+    const PCompactSnapshot& compact = snapshot.settings;
+    double find = BestOf(5, [&] {
+        uint64_t found = 0;
+        for (size_t i = 0; i < compact.SettingCount(); i++)
+            found += reader.Find(compact.SchemeGuids()[compact.SettingSchemes()[i]], compact.SettingGuids()[i]) != PBinarySnapshotReader::NotFound;
+        KeepAlive(found);
+    });
+    Report("binary Find of every setting", find);
+    std::printf("  %.1f ns per Find\n", find * 1e9 / compact.SettingCount());
+
+    std::error_code ec;
+    std::filesystem::remove(textPath, ec);
+    std::filesystem::remove(binaryPath, ec);
+    return 0;
+}
@@ -0,0 +1,94 @@
+// BytePatternSetBench.cpp - One PBytePatternSet::Scan pass against searching each pattern on its own
+// (PBytePattern::FindAll, and the naive masked scan), for 8 and 40 patterns over a 64 MiB firmware-like image.
+//
+// The patterns are ACPI table signatures, ACPI method names, code sequences and file magics.
+//
+#include "pch.h"
+#include "PBenchTimer.h"
+#include "PBytePatternSet.h"
+#include <random>
+
+// Masked compare at every offset until the first mismatching byte
+static size_t NaiveCount(const std::vector<uint8_t>& data, const PBytePattern& pattern)
+{
+    size_t count = 0;
+    for (size_t i = 0; i + pattern.Size() <= data.size(); i++) {
+        size_t j = 0;
+        while (j < pattern.Size() && (data[i + j] & pattern.Mask(j)) == pattern.Value(j))
+            j++;
+        count += j == pattern.Size();
+    }
+    return count;
+}
+
+int main()
+{
+    std::mt19937 rng(5);
+    std::vector<uint8_t> image(64 << 20);
+    const uint8_t code[] = { 0x48, 0x8B, 0x89, 0x0F, 0xE8, 0x00, 0x4C, 0x24, 0x83, 0xC3, 0x74, 0x01 };
+    for (size_t i = 0; i < image.size();) {
+        size_t run = 64 + rng() % 4096;
+        unsigned kind = rng() % 4;
+        for (size_t j = 0; j < run && i < image.size(); j++, i++) {
+            if (kind == 0) image[i] = 0x00;
+            else if (kind == 1) image[i] = 0xFF;
+            else if (kind == 2) image[i] = code[rng() % 12] ^ (rng() % 8 == 0 ? static_cast<uint8_t>(rng()) : 0);
+            else image[i] = static_cast<uint8_t>('a' + rng() % 26);
+        }
+    }
+
+    const char* texts[] = {
+        "46 41 43 50", "44 53 44 54", "53 53 44 54", "41 50 49 43", "48 50 45 54", "4D 43 46 47", "42 47 52 54", "46 50 44 54",
+        "5F 53 42 5F", "5F 50 52 5F", "5F 53 54 41", "5F 43 52 53", "5F 44 53 4D", "5F 4F 53 43", "5F 50 53 53", "5F 43 50 43",
+        "E8 ?? ?? ?? ?? 48 89", "48 8B 0D ?? ?? ?? ?? E8", "0F 05 C3", "CC CC CC CC 48 83 EC ??", "4C 8D 05 ?? ?? ?? ?? 48",
+        "FF 15 ?? ?? ?? ?? 85 C0", "24 56 42 54", "5F 53 4D 5F", "5F 44 4D 49", "52 53 44 20 50 54 52 20", "49 4E 54 4C",
+        "41 4D 44 20", "78 56 34 12", "EF BE AD DE", "?? 5A 91 3C", "8D 4? ?? 66", "00 00 ?? 48 8B", "55 AA", "4D 5A 90 00",
+        "50 45 00 00", "7F 45 4C 46", "D0 CF 11 E0", "1F 8B 08", "EB 3C 90",
+    };
+
+    const double bytes = static_cast<double>(image.size());
+    std::printf("%.0f MiB image\n", bytes / (1 << 20));
+    for (size_t count : { size_t(8), size_t(40) }) {
+        PBytePatternSet set;
+        for (size_t k = 0; k < count; k++) {
+            PBytePattern pattern;
+            if (!PBytePattern::Parse(texts[k], pattern))
+                return 1;
+            set.Add(texts[k], pattern);
+        }
+        set.Compile();
+
+        std::vector<PPatternHit> hits;
+        double scan = BestOf(3, [&] {
+            hits.clear();
+            set.Scan(image, hits);
+            KeepAlive(hits.size());
+        });
+        size_t separateHits = 0;
+        double separate = BestOf(3, [&] {
+            std::vector<size_t> offsets;
+            separateHits = 0;
+            for (uint32_t id = 0; id < set.Size(); id++) {
+                offsets.clear();
+                set.Pattern(id).FindAll(image, offsets);
+                separateHits += offsets.size();
+            }
+        });
+        size_t naiveHits = 0;
+        double naive = BestOf(1, [&] {
+            naiveHits = 0;
+            for (uint32_t id = 0; id < set.Size(); id++)
+                naiveHits += NaiveCount(image, set.Pattern(id));
+        });
+        if (hits.size() != separateHits || hits.size() != naiveHits) {
+            std::printf("hit counts differ: scan %zu, FindAll %zu, naive %zu\n", hits.size(), separateHits, naiveHits);
+            return 1;
+        }
+        std::printf("%zu patterns (%zu hits)\n", count, hits.size());
+        Report("  naive scan per pattern", naive, bytes);
+        Report("  PBytePattern::FindAll per pattern", separate, bytes, naive);
+        Report("  PBytePatternSet::Scan, one pass", scan, bytes, naive);
+        std::printf("  one pass vs FindAll per pattern: x%.2f\n", separate / scan);
+    }
+    return 0;
+}
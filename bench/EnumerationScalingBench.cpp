@@ -0,0 +1,58 @@
+// EnumerationScalingBench.cpp - VisitSettings wall time by thread count over a store with per-call latency,
+// the way powrprof calls block on the registry.
+//
+// Usage: EnumerationScalingBench [latencyMicroseconds]   (default 50)
+//
+#include "pch.h"
+#include "PBenchTimer.h"
+#include "PFakePowerBackend.h"
+#include "PInformation.h"
+
+namespace {
+
+// Accepts every setting, or only every tenth (like the default thread-scheduling filter)
+class CountingVisitor : public PSettingVisitor
+{
+public:
+    explicit CountingVisitor(bool filtered) : filtered(filtered) {}
+    bool Accept(const GUID& /*setting*/, std::wstring_view name) override {
+        return !filtered || name.back() == L'0';
+    }
+    bool OnSetting(const PSettingView& setting) override {
+        count += setting.acValue + 1;
+        return true;
+    }
+    uint64_t count = 0;
+
+private:
+    bool filtered;
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    long latency = argc > 1 ? std::strtol(argv[1], nullptr, 10) : 50;
+    PFakePowerBackend backend;
+    // About a Windows store: 5 schemes x 20 subgroups x 15 settings
+    backend.Populate(5, 20, 15);
+    backend.SetCallLatency(std::chrono::microseconds(latency));
+    PInformation info(backend);
+    std::printf("5 schemes x 300 settings, %ld us per backend call\n", latency);
+
+    for (bool filtered : { false, true }) {
+        std::printf("%s\n", filtered ? "filtered listing (10% accepted)" : "full listing");
+        double serial = 0;
+        for (unsigned threads : { 1u, 2u, 4u, 8u, 16u }) {
+            CountingVisitor visitor(filtered);
+            double seconds = BestOf(2, [&] { info.VisitSettings(visitor, nullptr, threads); });
+            KeepAlive(visitor.count);
+            if (threads == 1)
+                serial = seconds;
+            char label[64];
+            std::snprintf(label, sizeof(label), "  VisitSettings, %2u threads", threads);
+            Report(label, seconds, 0, threads == 1 ? 0 : serial);
+        }
+    }
+    return 0;
+}
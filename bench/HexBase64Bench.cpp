@@ -0,0 +1,170 @@
+// HexBase64Bench.cpp - PHexBase64 throughput against the byte-at-a-time StringUtil hex and Base64
+// functions it replaced, on 16 MiB of random data; GB/s are of binary data.
+//
+// The StringUtil bodies are reproduced here because string_util.cpp is not part of any build.
+//
+#include "pch.h"
+#include "PBenchTimer.h"
+#include "PHexBase64.h"
+#include <charconv>
+#include <random>
+#include <vector>
+
+namespace Old {
+
+const char Base64Table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// StringUtil::EncodeHex: two push_backs per byte
+std::string EncodeHex(const uint8_t* bytes, size_t length)
+{
+    constexpr auto hexChar = [](int x) { return static_cast<char>(x >= 0xA ? x - 0xA + 'a' : x + '0'); };
+    std::string ret;
+    ret.reserve(length * 2);
+    for (size_t i = 0; i < length; i++) {
+        ret.push_back(hexChar(bytes[i] >> 4));
+        ret.push_back(hexChar(bytes[i] & 0xF));
+    }
+    return ret;
+}
+
+// StringUtil::DecodeHex: FromChars on each two-character substring
+size_t DecodeHex(uint8_t* dest, std::string_view str)
+{
+    size_t bytes = str.size() / 2;
+    for (size_t i = 0; i < bytes; i++) {
+        const char* first = str.data() + i * 2;
+        uint8_t value = 0;
+        auto result = std::from_chars(first, first + 2, value, 16);
+        if (result.ec != std::errc() || result.ptr != first + 2)
+            return i;
+        dest[i] = value;
+    }
+    return bytes;
+}
+
+// StringUtil::EncodeBase64: one switch per three-byte group
+size_t EncodeBase64(char* dest, const uint8_t* data, size_t length)
+{
+    size_t pos = 0;
+    for (size_t i = 0; i < length;) {
+        size_t count = std::min<size_t>(length - i, 3);
+        switch (count) {
+        case 1:
+            dest[pos++] = Base64Table[(data[i] >> 2) & 63];
+            dest[pos++] = Base64Table[(data[i] & 3) << 4];
+            dest[pos++] = '=';
+            dest[pos++] = '=';
+            break;
+        case 2:
+            dest[pos++] = Base64Table[(data[i] >> 2) & 63];
+            dest[pos++] = Base64Table[((data[i] & 3) << 4) | ((data[i + 1] >> 4) & 15)];
+            dest[pos++] = Base64Table[(data[i + 1] & 15) << 2];
+            dest[pos++] = '=';
+            break;
+        default:
+            dest[pos++] = Base64Table[(data[i] >> 2) & 63];
+            dest[pos++] = Base64Table[((data[i] & 3) << 4) | ((data[i + 1] >> 4) & 15)];
+            dest[pos++] = Base64Table[((data[i + 1] & 15) << 2) | ((data[i + 2] >> 6) & 3)];
+            dest[pos++] = Base64Table[data[i + 2] & 63];
+            break;
+        }
+        i += count;
+    }
+    return pos;
+}
+
+// StringUtil::DecodeBase64: 128-entry table, four lookups per group
+size_t DecodeBase64(uint8_t* data, std::string_view str)
+{
+    uint8_t table[128];
+    std::fill(std::begin(table), std::end(table), uint8_t(64));
+    for (uint8_t i = 0; i < 64; i++)
+        table[static_cast<uint8_t>(Base64Table[i])] = i;
+    table['='] = 0;
+
+    if (str.size() % 4 != 0)
+        return 0;
+    size_t pos = 0;
+    for (size_t i = 0; i < str.size();) {
+        uint8_t a = table[str[i++] & 0x7F], b = table[str[i++] & 0x7F];
+        uint8_t c = table[str[i++] & 0x7F], d = table[str[i++] & 0x7F];
+        if (a == 64 || b == 64 || c == 64 || d == 64)
+            break;
+        data[pos++] = static_cast<uint8_t>((a << 2) | (b >> 4));
+        if (str[i - 2] != '=')
+            data[pos++] = static_cast<uint8_t>((b << 4) | (c >> 2));
+        if (str[i - 1] != '=')
+            data[pos++] = static_cast<uint8_t>((c << 6) | d);
+    }
+    return pos;
+}
+
+} // namespace Old
+
+int main()
+{
+    const size_t size = 16 << 20;
+    std::vector<uint8_t> data(size);
+    std::mt19937 rng(3);
+    for (auto& byte : data)
+        byte = static_cast<uint8_t>(rng());
+
+    std::string hex;
+    EncodeHex(data, hex);
+    std::string base64;
+    EncodeBase64(data, base64);
+    std::vector<uint8_t> decoded(size + 64);
+    std::string chars(HexEncodedSize(size) + 64, '\0');
+    if (Old::EncodeHex(data.data(), size) != hex || Old::EncodeBase64(chars.data(), data.data(), size) != base64.size() ||
+        chars.compare(0, base64.size(), base64) != 0) {
+        std::printf("encoders disagree\n");
+        return 1;
+    }
+
+    const double bytes = static_cast<double>(size);
+    std::printf("%.0f MiB of random bytes\n", bytes / (1 << 20));
+
+    double oldHexEncode = BestOf(5, [&] { KeepAlive(Old::EncodeHex(data.data(), size).size()); });
+    Report("hex encode, StringUtil", oldHexEncode, bytes);
+    Report("hex encode, PHexBase64 to string", BestOf(5, [&] {
+        std::string out;
+        EncodeHex(data, out);
+        KeepAlive(out.size());
+    }), bytes, oldHexEncode);
+    Report("hex encode, PHexBase64 to buffer", BestOf(5, [&] { KeepAlive(EncodeHex(data, chars.data())); }), bytes, oldHexEncode);
+
+    double oldHexDecode = BestOf(5, [&] { KeepAlive(Old::DecodeHex(decoded.data(), hex)); });
+    Report("hex decode, StringUtil", oldHexDecode, bytes);
+    Report("hex decode, PHexBase64", BestOf(5, [&] { KeepAlive(DecodeHex(hex, decoded.data())); }), bytes, oldHexDecode);
+
+    double oldBase64Encode = BestOf(5, [&] { KeepAlive(Old::EncodeBase64(chars.data(), data.data(), size)); });
+    Report("Base64 encode, StringUtil", oldBase64Encode, bytes);
+    Report("Base64 encode, PHexBase64", BestOf(5, [&] { KeepAlive(EncodeBase64(data, chars.data())); }), bytes, oldBase64Encode);
+    Report("Base64 encode, 4 KiB chunks", BestOf(5, [&] {
+        PBase64Encoder encoder;
+        size_t written = 0;
+        for (size_t at = 0; at < size; at += 4096)
+            written += encoder.Feed({ data.data() + at, std::min<size_t>(4096, size - at) }, chars.data() + written);
+        written += encoder.Finish(chars.data() + written);
+        KeepAlive(written);
+    }), bytes, oldBase64Encode);
+
+    double oldBase64Decode = BestOf(5, [&] { KeepAlive(Old::DecodeBase64(decoded.data(), base64)); });
+    Report("Base64 decode, StringUtil", oldBase64Decode, bytes);
+    Report("Base64 decode, PHexBase64", BestOf(5, [&] {
+        size_t written = 0;
+        DecodeBase64(base64, decoded.data(), written);
+        KeepAlive(written);
+    }), bytes, oldBase64Decode);
+    Report("Base64 decode, 4 KiB chunks", BestOf(5, [&] {
+        PBase64Decoder decoder;
+        size_t written = 0, chunk = 0;
+        for (size_t at = 0; at < base64.size(); at += 4096) {
+            decoder.Feed(std::string_view(base64).substr(at, 4096), decoded.data() + written, chunk);
+            written += chunk;
+        }
+        decoder.Finish(decoded.data() + written, chunk);
+        KeepAlive(written + chunk);
+    }), bytes, oldBase64Decode);
+    return 0;
+}
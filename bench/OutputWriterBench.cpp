@@ -0,0 +1,92 @@
+// OutputWriterBench.cpp - Writing 100k settings: the old per-line std::wcout << ... << std::endl against
+// POutputWriter in each format. Output goes to /dev/null, so only formatting, encoding and write calls count.
+//
+// Usage: OutputWriterBench [settings]   (default 100000)
+//
+#include "pch.h"
+#include "PBenchTimer.h"
+#include "POutputWriter.h"
+#include <iostream>
+
+#ifdef _WIN32
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define close _close
+static const char* NullDevice = "NUL";
+#else
+#include <unistd.h>
+static const char* NullDevice = "/dev/null";
+#endif
+
+int main(int argc, char* argv[])
+{
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    // wcout keeps its own buffer and UTF-8 locale, so stdout stays byte-oriented for the results
+    std::ios::sync_with_stdio(false);
+    try {
+        std::wcout.imbue(std::locale("C.UTF-8"));
+    } catch (const std::runtime_error&) {
+        std::printf("needs the C.UTF-8 locale\n");
+        return 1;
+    }
+    // Setting text is mostly ASCII with one accented character, like localized names
+    std::vector<std::wstring> names, descriptions;
+    for (size_t i = 0; i < count; i++) {
+        names.push_back(L"Setting é number " + std::to_wstring(i));
+        descriptions.push_back(L"Description of a power setting that is reasonably long " + std::to_wstring(i));
+    }
+
+    // Point stdout (fd 1) at the null device for the timed part, then restore it for the results
+    std::fflush(stdout);
+    int savedStdout = dup(1);
+    FILE* sink = std::fopen(NullDevice, "w");
+    if (savedStdout < 0 || !sink)
+        return 1;
+    dup2(fileno(sink), 1);
+
+    double wcoutTime = BestOf(3, [&] {
+        for (size_t i = 0; i < count; i++)
+            std::wcout << L"    Setting: " << names[i] << L" - " << descriptions[i] << L", AC: " << i % 100 << L", DC: " << i % 7 << std::endl;
+    });
+
+    struct Case { const char* label; POutputFormat format; };
+    const Case cases[] = {
+        { "POutputWriter text", POutputFormat::Text },
+        { "POutputWriter csv", POutputFormat::Csv },
+        { "POutputWriter json", POutputFormat::Json },
+        { "POutputWriter ndjson", POutputFormat::Ndjson },
+    };
+    double times[4] = {};
+    for (size_t c = 0; c < 4; c++) {
+        times[c] = BestOf(3, [&] {
+            POutputWriter out(stdout, cases[c].format);
+            for (size_t i = 0; i < count; i++) {
+                if (cases[c].format == POutputFormat::Text) {
+                    out << L"    Setting: " << names[i] << L" - " << descriptions[i] << L", AC: " << i % 100 << L", DC: " << i % 7 << L"\n";
+                    continue;
+                }
+                out.BeginRecord();
+                out.Field("profile", L"Balanced");
+                out.Field("setting", names[i]);
+                out.Field("description", descriptions[i]);
+                out.Field("ac", i % 100);
+                out.Field("dc", i % 7);
+                out.EndRecord();
+            }
+            out.Finish();
+        });
+    }
+
+    std::wcout.flush();
+    std::fflush(stdout);
+    dup2(savedStdout, 1);
+    close(savedStdout);
+    std::fclose(sink);
+
+    std::printf("%zu settings\n", count);
+    Report("std::wcout << ... << std::endl", wcoutTime);
+    for (size_t c = 0; c < 4; c++)
+        Report(cases[c].label, times[c], 0, wcoutTime);
+    return 0;
+}
@@ -0,0 +1,43 @@
+// PBenchTimer.h - Timing helpers shared by the micro-benchmarks in bench/ (not part of ctest).
+//
+// Functions:
+//   - BestOf(repeats, fn): fastest wall time of fn in seconds; the minimum filters scheduler noise.
+//   - Report(label, seconds, ...): one aligned result line (time, optional throughput and speedup).
+//   - KeepAlive(value): fold a result into a volatile sink so the optimizer cannot drop the work.
+//
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+template <typename Fn>
+double BestOf(int repeats, Fn&& fn)
+{
+    double best = 1e300;
+    for (int i = 0; i < repeats; i++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() < best)
+            best = elapsed.count();
+    }
+    return best;
+}
+
+// "label  12.345 ms  [1.23 GB/s]  [x4.56]"; bytes and baseline are optional (0 = omitted)
+inline void Report(const char* label, double seconds, double bytes = 0, double baselineSeconds = 0)
+{
+    std::printf("%-40s %10.3f ms", label, seconds * 1e3);
+    if (bytes > 0)
+        std::printf("  %8.2f GB/s", bytes / seconds / 1e9);
+    if (baselineSeconds > 0)
+        std::printf("  x%.2f", baselineSeconds / seconds);
+    std::printf("\n");
+}
+
+inline volatile uint64_t benchSink = 0;
+
+inline void KeepAlive(uint64_t value)
+{
+    benchSink = benchSink + value;
+}
@@ -0,0 +1,230 @@
+// ProcTextBench.cpp - PProcText on a synthetic 256-CPU machine: /proc/cpuinfo read and parse, /proc/stat
+// parse and PCpuMask::ParseList, against the getline/std::string parsing and per-CPU list loop they replaced.
+//
+#include "pch.h"
+#include "PBenchTimer.h"
+#include "PCpuTopology.h"
+#include "PProcText.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace Old {
+
+struct CpuInfoEntry {
+    unsigned processor = 0;
+    int physicalId = -1, coreId = -1;
+    unsigned frequencyKHz = 0;
+};
+
+std::string Trim(const std::string& text)
+{
+    size_t first = text.find_first_not_of(" \t");
+    if (first == std::string::npos)
+        return {};
+    return text.substr(first, text.find_last_not_of(" \t") - first + 1);
+}
+
+// getline, then a trimmed std::string key and value per line
+std::vector<CpuInfoEntry> ParseCpuInfo(const std::string& text)
+{
+    std::vector<CpuInfoEntry> out;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos)
+            continue;
+        std::string key = Trim(line.substr(0, colon)), value = Trim(line.substr(colon + 1));
+        if (key == "processor") {
+            out.push_back({});
+            out.back().processor = static_cast<unsigned>(std::stoul(value));
+        } else if (out.empty()) {
+            continue;
+        } else if (key == "physical id") {
+            out.back().physicalId = std::stoi(value);
+        } else if (key == "core id") {
+            out.back().coreId = std::stoi(value);
+        } else if (key == "cpu MHz") {
+            out.back().frequencyKHz = static_cast<unsigned>(std::stod(value) * 1000 + 0.5);
+        }
+    }
+    return out;
+}
+
+// getline, then stream extraction of every column of each cpuN line
+size_t ParseProcStat(const std::string& text)
+{
+    std::vector<std::vector<unsigned long long>> rows;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.size() < 4 || line.compare(0, 3, "cpu") != 0 || line[3] < '0' || line[3] > '9')
+            continue;
+        std::istringstream fields(line);
+        std::string name;
+        fields >> name;
+        std::vector<unsigned long long> row;
+        unsigned long long value = 0;
+        while (fields >> value)
+            row.push_back(value);
+        rows.push_back(std::move(row));
+    }
+    return rows.size();
+}
+
+std::string ReadFile(const std::filesystem::path& path)
+{
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+// PCpuMask::ParseList before SetRange: one Set per CPU
+bool ParseList(std::string_view text, PCpuMask& mask)
+{
+    size_t pos = 0;
+    auto skipSpace = [&]() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\t'))
+            pos++;
+    };
+    auto number = [&](size_t& value) {
+        size_t start = pos;
+        value = 0;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9')
+            value = value * 10 + static_cast<size_t>(text[pos++] - '0');
+        return pos != start;
+    };
+    skipSpace();
+    while (pos < text.size()) {
+        size_t first = 0, last = 0;
+        if (!number(first))
+            return false;
+        last = first;
+        if (pos < text.size() && text[pos] == '-') {
+            pos++;
+            if (!number(last) || last < first)
+                return false;
+        }
+        for (size_t cpu = first; cpu <= last; cpu++)
+            mask.Set(cpu);
+        skipSpace();
+        if (pos < text.size()) {
+            if (text[pos] != ',')
+                return false;
+            pos++;
+            skipSpace();
+        }
+    }
+    return true;
+}
+
+} // namespace Old
+
+// 2 packages x 64 cores x 2 threads, with the flag list of a current x86 server
+static std::string CpuInfo256()
+{
+    const char* flags =
+        "fpu vme de pse tsc msr pae mce cx8 apic sep mtrr pge mca cmov pat pse36 clflush dts acpi mmx fxsr sse sse2 ss ht tm pbe "
+        "syscall nx pdpe1gb rdtscp lm constant_tsc art arch_perfmon pebs bts rep_good nopl xtopology nonstop_tsc cpuid aperfmperf "
+        "tsc_known_freq pni pclmulqdq dtes64 monitor ds_cpl vmx smx est tm2 ssse3 sdbg fma cx16 xtpr pdcm sse4_1 sse4_2 x2apic movbe "
+        "popcnt tsc_deadline_timer aes xsave avx f16c rdrand lahf_lm abm 3dnowprefetch cpuid_fault epb ssbd ibrs ibpb stibp "
+        "ibrs_enhanced tpr_shadow flexpriority ept vpid ept_ad fsgsbase tsc_adjust bmi1 avx2 smep bmi2 erms invpcid rdseed adx smap "
+        "clflushopt clwb intel_pt sha_ni xsaveopt xsavec xgetbv1 xsaves split_lock_detect avx_vnni dtherm ida arat pln pts hwp "
+        "hwp_notify hwp_act_window hwp_epp hwp_pkg_req hfi vnmi umip pku ospke waitpkg gfni vaes vpclmulqdq rdpid movdiri movdir64b "
+        "fsrm md_clear serialize pconfig arch_lbr ibt flush_l1d arch_capabilities";
+    std::string text;
+    for (unsigned cpu = 0; cpu < 256; cpu++) {
+        unsigned package = cpu / 128, core = cpu % 64;
+        text += "processor\t: " + std::to_string(cpu) + "\nvendor_id\t: GenuineIntel\ncpu family\t: 6\nmodel\t\t: 143\n";
+        text += "model name\t: Intel(R) Xeon(R) Platinum 8480+\nstepping\t: 8\nmicrocode\t: 0x2b000461\n";
+        text += "cpu MHz\t\t: " + std::to_string(800 + cpu * 13 % 3000) + ".000\ncache size\t: 107520 KB\n";
+        text += "physical id\t: " + std::to_string(package) + "\nsiblings\t: 128\ncore id\t\t: " + std::to_string(core);
+        text += "\ncpu cores\t: 64\napicid\t\t: " + std::to_string(cpu * 2) + "\ninitial apicid\t: " + std::to_string(cpu * 2);
+        text += "\nfpu\t\t: yes\nfpu_exception\t: yes\ncpuid level\t: 32\nwp\t\t: yes\nflags\t\t: ";
+        text += flags;
+        text += "\nbugs\t\t: spectre_v1 spectre_v2 spec_store_bypass swapgs eibrs_pbrsb\nbogomips\t: 4000.00\n";
+        text += "clflush size\t: 64\ncache_alignment\t: 64\naddress sizes\t: 46 bits physical, 57 bits virtual\npower management:\n\n";
+    }
+    return text;
+}
+
+static std::string ProcStat256()
+{
+    std::string text = "cpu  2560000 256 768000 115200000 2560 0 3840 0 0 0\n";
+    for (unsigned cpu = 0; cpu < 256; cpu++) {
+        text += "cpu" + std::to_string(cpu) + " " + std::to_string(10000 + cpu * 37) + " 1 " + std::to_string(3000 + cpu) + " " +
+                std::to_string(450000 + cpu * 101) + " 10 0 15 0 0 0\n";
+    }
+    text += "intr 987654321 9 0 0 0 0 0 0 0 1 0 0 0 0\nctxt 123456789\nbtime 1760000000\nprocesses 54321\n";
+    text += "procs_running 3\nprocs_blocked 0\nsoftirq 1234567 0 1 2 3 4 5 6 7 8 9\n";
+    return text;
+}
+
+int main()
+{
+    const std::string cpuInfo = CpuInfo256();
+    const std::string procStat = ProcStat256();
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "ProcTextBench-cpuinfo";
+    std::ofstream(path, std::ios::binary) << cpuInfo;
+
+    std::vector<PCpuInfoEntry> entries;
+    std::vector<PCpuTimes> times;
+    std::vector<Old::CpuInfoEntry> oldEntries = Old::ParseCpuInfo(cpuInfo);
+    bool same = ParseCpuInfo(cpuInfo, entries) && entries.size() == 256 && oldEntries.size() == 256 &&
+                ParseProcStat(procStat, times) && times.size() == 256 && Old::ParseProcStat(procStat) == 256;
+    for (size_t i = 0; same && i < entries.size(); i++) {
+        same = entries[i].processor == oldEntries[i].processor && entries[i].coreId == oldEntries[i].coreId &&
+               entries[i].physicalId == oldEntries[i].physicalId && entries[i].frequencyKHz == oldEntries[i].frequencyKHz;
+    }
+    if (!same) {
+        std::printf("parsers disagree\n");
+        return 1;
+    }
+
+    const double bytes = static_cast<double>(cpuInfo.size());
+    std::printf("/proc/cpuinfo, 256 CPUs, %.0f KB\n", bytes / 1024);
+    double oldRead = BestOf(200, [&] { KeepAlive(Old::ParseCpuInfo(Old::ReadFile(path)).size()); });
+    Report("  read + parse, getline", oldRead, bytes);
+    PProcFile file;
+    Report("  read + parse, PProcFile + ParseCpuInfo", BestOf(200, [&] {
+        file.Read(path);
+        ParseCpuInfo(file.Text(), entries);
+        KeepAlive(entries.size());
+    }), bytes, oldRead);
+    double oldParse = BestOf(200, [&] { KeepAlive(Old::ParseCpuInfo(cpuInfo).size()); });
+    Report("  parse only, getline", oldParse, bytes);
+    Report("  parse only, ParseCpuInfo", BestOf(200, [&] {
+        ParseCpuInfo(cpuInfo, entries);
+        KeepAlive(entries.size());
+    }), bytes, oldParse);
+
+    std::printf("/proc/stat, 256 CPUs, %zu bytes\n", procStat.size());
+    double oldStat = BestOf(500, [&] { KeepAlive(Old::ParseProcStat(procStat)); });
+    Report("  getline + istringstream", oldStat, static_cast<double>(procStat.size()));
+    Report("  ParseProcStat", BestOf(500, [&] {
+        ParseProcStat(procStat, times);
+        KeepAlive(times.size());
+    }), static_cast<double>(procStat.size()), oldStat);
+
+    std::printf("CPU lists\n");
+    for (const char* list : { "0-7,16-23,32-39,48-55,64-71,80-87,96-103,112-119,128-135,144-151,160-167,176-183,192-199,208-215,224-231,240-255", "0-4095" }) {
+        double oldList = BestOf(2000, [&] {
+            PCpuMask mask;
+            Old::ParseList(list, mask);
+            KeepAlive(mask.Size());
+        });
+        std::string label = std::string("  \"") + std::string(list).substr(0, 12) + (std::strlen(list) > 12 ? "...\"" : "\"");
+        Report((label + ", Set per CPU").c_str(), oldList);
+        Report((label + ", ParseList").c_str(), BestOf(2000, [&] {
+            PCpuMask mask;
+            PCpuMask::ParseList(list, mask);
+            KeepAlive(mask.Size());
+        }), 0, oldList);
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    return 0;
+}
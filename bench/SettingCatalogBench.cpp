@@ -0,0 +1,80 @@
+// SettingCatalogBench.cpp - Catalog lookups against the linear name walk they replaced.
+//
+// Usage: SettingCatalogBench [schemes subgroups settings]   (default 10 8 40)
+//
+#include "pch.h"
+#include "PBenchTimer.h"
+#include "PFakePowerBackend.h"
+#include "PSettingCatalog.h"
+
+// The pre-catalog lookup: walk schemes, subgroups and settings reading names until both match
+static bool LinearFind(PPowerBackend& backend, const std::wstring& profile, const std::wstring& setting, PSettingLocation& out)
+{
+    std::wstring name;
+    GUID scheme = {}, subgroup = {}, guid = {};
+    for (DWORD s = 0; backend.EnumerateScheme(s, scheme) == ERROR_SUCCESS; s++) {
+        backend.ReadFriendlyName(&scheme, nullptr, nullptr, name);
+        if (name != profile)
+            continue;
+        for (DWORD g = 0; backend.EnumerateSubgroup(scheme, g, subgroup) == ERROR_SUCCESS; g++) {
+            for (DWORD i = 0; backend.EnumerateSetting(scheme, subgroup, i, guid) == ERROR_SUCCESS; i++) {
+                backend.ReadFriendlyName(&scheme, &subgroup, &guid, name);
+                if (name == setting) {
+                    out = { scheme, subgroup, guid };
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t schemes = 10, subgroups = 8, settings = 40;
+    if (argc == 4) {
+        schemes = std::strtoul(argv[1], nullptr, 10);
+        subgroups = std::strtoul(argv[2], nullptr, 10);
+        settings = std::strtoul(argv[3], nullptr, 10);
+    }
+    PFakePowerBackend backend;
+    backend.Populate(schemes, subgroups, settings);
+
+    // Every (profile, setting) pair once, in a scattered order
+    std::vector<std::pair<std::wstring, std::wstring>> keys;
+    for (size_t s = 0; s < schemes; s++) {
+        for (size_t g = 0; g < subgroups; g++) {
+            for (size_t i = 0; i < settings; i++)
+                keys.emplace_back(L"Scheme " + std::to_wstring(s), L"Setting " + std::to_wstring(g) + L"." + std::to_wstring(i));
+        }
+    }
+    for (size_t i = 1; i < keys.size(); i++)
+        std::swap(keys[i], keys[(i * 7919) % (i + 1)]);
+    std::printf("%zu lookups over %zu schemes x %zu settings\n", keys.size(), schemes, subgroups * settings);
+
+    PSettingLocation location = {};
+    size_t found = 0;
+    backend.ResetCallCount();
+    double linear = BestOf(3, [&] {
+        for (const auto& [profile, setting] : keys)
+            found += LinearFind(backend, profile, setting, location);
+    });
+    uint64_t linearCalls = backend.CallCount() / 3;
+
+    PSettingCatalog catalog(backend);
+    backend.ResetCallCount();
+    double cold = BestOf(1, [&] { found += catalog.Find(keys[0].first, keys[0].second, location); });
+    uint64_t buildCalls = backend.CallCount();
+    double warm = BestOf(3, [&] {
+        for (const auto& [profile, setting] : keys)
+            found += catalog.Find(profile, setting, location);
+    });
+    KeepAlive(found);
+
+    Report("linear walk (all keys)", linear);
+    Report("catalog build (first lookup)", cold);
+    Report("catalog lookups (all keys)", warm, 0, linear);
+    std::printf("backend calls: linear %llu, catalog %llu (build only)\n",
+                static_cast<unsigned long long>(linearCalls), static_cast<unsigned long long>(buildCalls));
+    return 0;
+}
@@ -0,0 +1,100 @@
+// SnapshotMemoryBench.cpp - Memory of a 10-scheme snapshot: PCompactSnapshot (interned strings, value
+// columns) against the legacy PowerEnumerateProfiles map of SettingInfo, plus the time to build each.
+//
+// Both the layouts' own estimates (MemoryUsage) and the live heap bytes measured by counting every
+// operator new/delete in this process are printed, so the estimates are checked against real allocations.
+//
+// Usage: SnapshotMemoryBench [schemes subgroups settings]   (default 10 20 15)
+//
+#include "pch.h"
+#include "PBenchTimer.h"
+#include "PCompactSnapshot.h"
+#include "PFakePowerBackend.h"
+#include "PInformation.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<size_t> liveBytes{ 0 };
+
+// Each block carries its size in a header so delete can subtract it
+constexpr size_t BlockHeader = alignof(std::max_align_t);
+
+void* CountedAlloc(size_t size)
+{
+    void* block = std::malloc(size + BlockHeader);
+    if (!block)
+        throw std::bad_alloc();
+    *static_cast<size_t*>(block) = size;
+    liveBytes.fetch_add(size, std::memory_order_relaxed);
+    return static_cast<char*>(block) + BlockHeader;
+}
+
+void CountedFree(void* ptr)
+{
+    if (!ptr)
+        return;
+    void* block = static_cast<char*>(ptr) - BlockHeader;
+    liveBytes.fetch_sub(*static_cast<size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+// Heap bytes still held after make() returns, kept alive until the value is destroyed
+template <typename Fn>
+size_t MeasureHeap(Fn&& make)
+{
+    size_t before = liveBytes.load();
+    auto value = make();
+    size_t after = liveBytes.load();
+    KeepAlive(reinterpret_cast<uintptr_t>(&value));
+    return after - before;
+}
+
+} // namespace
+
+void* operator new(size_t size) { return CountedAlloc(size); }
+void* operator new[](size_t size) { return CountedAlloc(size); }
+void operator delete(void* ptr) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { CountedFree(ptr); }
+
+int main(int argc, char* argv[])
+{
+    size_t schemes = 10, subgroups = 20, settings = 15;
+    if (argc == 4) {
+        schemes = std::strtoul(argv[1], nullptr, 10);
+        subgroups = std::strtoul(argv[2], nullptr, 10);
+        settings = std::strtoul(argv[3], nullptr, 10);
+    }
+    PFakePowerBackend backend;
+    backend.Populate(schemes, subgroups, settings);
+    PInformation info(backend);
+
+    auto legacy = info.PowerEnumerateProfiles();
+    PCompactSnapshot compact = PCompactSnapshot::Capture(info);
+    std::printf("%zu schemes, %zu settings, %zu distinct strings\n", compact.SchemeCount(), compact.SettingCount(),
+                compact.Strings().Count());
+
+    size_t legacyEstimate = PCompactSnapshot::MemoryUsage(legacy);
+    size_t compactEstimate = compact.MemoryUsage();
+    size_t legacyHeap = MeasureHeap([&] { return info.PowerEnumerateProfiles(); });
+    size_t compactHeap = MeasureHeap([&] { return PCompactSnapshot::Capture(info); });
+
+    std::printf("%-40s %12s %12s\n", "", "estimate", "heap");
+    std::printf("%-40s %10.1f K %10.1f K\n", "legacy map<wstring, vector<SettingInfo>>", legacyEstimate / 1024.0, legacyHeap / 1024.0);
+    std::printf("%-40s %10.1f K %10.1f K\n", "PCompactSnapshot", compactEstimate / 1024.0, compactHeap / 1024.0);
+    std::printf("%-40s %11.2fx %11.2fx\n", "legacy / compact", static_cast<double>(legacyEstimate) / compactEstimate,
+                static_cast<double>(legacyHeap) / compactHeap);
+    std::printf("%-40s %10.1f B %10.1f B\n", "compact bytes per setting", static_cast<double>(compactEstimate) / compact.SettingCount(),
+                static_cast<double>(compactHeap) / compact.SettingCount());
+
+    double legacyTime = BestOf(5, [&] { KeepAlive(info.PowerEnumerateProfiles().size()); });
+    Report("build legacy map", legacyTime);
+    double compactTime = BestOf(5, [&] { KeepAlive(PCompactSnapshot::Capture(info).SettingCount()); });
+    Report("build PCompactSnapshot", compactTime, 0, legacyTime);
+    return 0;
+}
@@ -0,0 +1,72 @@
+// TelemetryOverheadBench.cpp - CPU cost of the PTelemetrySampler thread, as a share of one core.
+//
+// The sampler thread's CPU time is the process CPU time (RUSAGE_SELF) minus the main thread's own
+// (RUSAGE_THREAD), which only sleeps and drains. The target is under 1% of a core at the Monitor default
+// of 100 Hz; the process total is printed too.
+//
+// Usage: TelemetryOverheadBench [root [hz [seconds]]]   (default / 100 2)
+//
+#include "pch.h"
+#include "PBenchTimer.h"
+
+#ifndef _WIN32
+#include "PTelemetrySampler.h"
+#include <sys/resource.h>
+#include <thread>
+
+// User plus system CPU seconds of the process (RUSAGE_SELF) or the calling thread (RUSAGE_THREAD)
+static double CpuSeconds(int who)
+{
+    rusage usage = {};
+    getrusage(who, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+int main(int argc, char* argv[])
+{
+    std::filesystem::path root = argc > 1 ? argv[1] : "/";
+    unsigned hz = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 100;
+    double seconds = argc > 3 ? std::strtod(argv[3], nullptr) : 2.0;
+    if (hz == 0 || seconds <= 0)
+        return 1;
+
+    PTelemetrySampler sampler(root);
+    std::printf("%zu CPUs, %zu energy domains, %u Hz for %.1f s\n", sampler.CpuCount(), sampler.EnergyDomains().size(), hz, seconds);
+    PTelemetrySample sample;
+    double once = BestOf(100, [&] { sampler.SampleOnce(sample); });
+    Report("one sample (SampleOnce)", once);
+
+    double processStart = CpuSeconds(RUSAGE_SELF), mainStart = CpuSeconds(RUSAGE_THREAD);
+    auto wallStart = std::chrono::steady_clock::now();
+    if (!sampler.Start(std::chrono::microseconds(1000000 / hz))) {
+        std::printf("nothing to sample under %s\n", root.string().c_str());
+        return 1;
+    }
+    size_t samples = 0;
+    auto end = wallStart + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        samples += sampler.Drain([](const PTelemetrySample& s) { KeepAlive(s.sequence); });
+    }
+    sampler.Stop();
+    samples += sampler.Drain([](const PTelemetrySample& s) { KeepAlive(s.sequence); });
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart;
+    double process = CpuSeconds(RUSAGE_SELF) - processStart;
+    double cpu = process - (CpuSeconds(RUSAGE_THREAD) - mainStart);
+
+    double share = cpu / wall.count() * 100;
+    std::printf("%zu samples, %llu dropped, process %.4f s CPU over %.2f s\n", samples,
+                static_cast<unsigned long long>(sampler.Dropped()), process, wall.count());
+    std::printf("sampler thread %.4f s CPU = %.3f%% of a core (%s 1%%)\n", cpu, share, share < 1.0 ? "under" : "OVER");
+    return share < 1.0 ? 0 : 2;
+}
+
+#else
+
+int main()
+{
+    std::printf("TelemetryOverheadBench measures the Linux sampler only\n");
+    return 0;
+}
+
+#endif
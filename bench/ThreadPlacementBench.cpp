@@ -0,0 +1,62 @@
+// ThreadPlacementBench.cpp - A fixed single-thread compute kernel pinned to each PCorePlacement of this
+// machine, relative to running anywhere, and the cost of a PinCurrentThread call.
+//
+// Placements with no CPUs here (no E-cores on a non-hybrid machine) are listed and skipped. The thread's
+// original affinity is restored at the end.
+//
+#include "pch.h"
+#include "PBenchTimer.h"
+#include "PThreadPlacement.h"
+
+// Dependent multiply-adds: latency-bound, so it tracks the core's clock and pipeline rather than memory
+static double ComputeKernel(uint64_t iterations)
+{
+    double x = 1.0;
+    for (uint64_t i = 0; i < iterations; i++)
+        x = x * 1.0000001 + 1e-9;
+    return x;
+}
+
+int main()
+{
+    PCpuTopology topology;
+#ifdef _WIN32
+    bool loaded = PCpuTopology::LoadFromWindows(topology);
+#else
+    bool loaded = PCpuTopology::LoadFromSysfs("/", topology);
+#endif
+    PSavedAffinity saved;
+    if (!loaded || !SaveCurrentThreadAffinity(saved)) {
+        std::printf("no topology\n");
+        return 1;
+    }
+
+    const uint64_t iterations = 50000000;
+    std::printf("%zu CPUs, %zu P-cores, %zu E-cores; %llu dependent multiply-adds\n", topology.online.Count(),
+                topology.CoreCount(PCoreType::Performance), topology.CoreCount(PCoreType::Efficiency),
+                static_cast<unsigned long long>(iterations));
+    double anywhere = 0;
+    for (PCorePlacement placement : { PCorePlacement::Any, PCorePlacement::Performance, PCorePlacement::Efficiency,
+                                      PCorePlacement::NoSmtSiblings }) {
+        char label[64];
+        PCpuMask cpus = PlacementMask(topology, placement);
+        std::snprintf(label, sizeof(label), "  %ls (%zu CPUs)", PlacementName(placement), cpus.Count());
+        if (!PinCurrentThread(topology, placement)) {
+            std::printf("%-40s %13s\n", label, cpus.Empty() ? "no such CPUs" : "pin refused");
+            continue;
+        }
+        double seconds = BestOf(5, [&] { KeepAlive(static_cast<uint64_t>(ComputeKernel(iterations))); });
+        if (placement == PCorePlacement::Any)
+            anywhere = seconds;
+        Report(label, seconds, 0, placement == PCorePlacement::Any ? 0 : anywhere);
+    }
+
+    std::printf("PinCurrentThread, alternating placements\n");
+    Report("  per call", BestOf(5, [&] {
+        for (int i = 0; i < 1000; i++)
+            PinCurrentThread(topology, i % 2 ? PCorePlacement::NoSmtSiblings : PCorePlacement::Any);
+    }) / 1000);
+
+    RestoreCurrentThreadAffinity(saved);
+    return 0;
+}
@@ -0,0 +1,129 @@
+// Utf8Bench.cpp - PUtf8 throughput against the scalar, one-code-point-at-a-time loops of StringUtil
+// (DecodeUTF8 / EncodeAndAppendUTF8), on 4 MiB of ASCII-heavy and of mixed-script setting text.
+//
+// The StringUtil helpers are reproduced here because string_util.cpp is not part of any build; the loops
+// are the same shape: decode or encode one code point, push it, advance.
+//
+#include "pch.h"
+#include "PBenchTimer.h"
+#include "PUtf8.h"
+#include <random>
+
+namespace Scalar {
+
+// StringUtil::DecodeUTF8: one code point, no overlong/surrogate checks
+size_t DecodeUtf8(const unsigned char* s, size_t length, char32_t& ch)
+{
+    if (s[0] < 0x80) {
+        ch = s[0];
+        return 1;
+    }
+    if ((s[0] & 0xe0) == 0xc0 && length >= 2) {
+        ch = (char32_t(s[0] & 0x1f) << 6) | (s[1] & 0x3f);
+        return 2;
+    }
+    if ((s[0] & 0xf0) == 0xe0 && length >= 3) {
+        ch = (char32_t(s[0] & 0x0f) << 12) | (char32_t(s[1] & 0x3f) << 6) | (s[2] & 0x3f);
+        return 3;
+    }
+    if ((s[0] & 0xf8) == 0xf0 && s[0] <= 0xf4 && length >= 4) {
+        ch = (char32_t(s[0] & 0x07) << 18) | (char32_t(s[1] & 0x3f) << 12) | (char32_t(s[2] & 0x3f) << 6) | (s[3] & 0x3f);
+        return 4;
+    }
+    ch = 0xFFFD;
+    return 1;
+}
+
+// StringUtil::EncodeAndAppendUTF8
+void EncodeAndAppendUtf8(std::string& s, char32_t ch)
+{
+    if (ch <= 0x7F) {
+        s.push_back(static_cast<char>(ch));
+    } else if (ch <= 0x07FF) {
+        s.push_back(static_cast<char>(0xc0 | ((ch >> 6) & 0x1f)));
+        s.push_back(static_cast<char>(0x80 | (ch & 0x3f)));
+    } else if (ch <= 0xFFFF) {
+        s.push_back(static_cast<char>(0xe0 | ((ch >> 12) & 0x0f)));
+        s.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3f)));
+        s.push_back(static_cast<char>(0x80 | (ch & 0x3f)));
+    } else {
+        s.push_back(static_cast<char>(0xf0 | ((ch >> 18) & 0x07)));
+        s.push_back(static_cast<char>(0x80 | ((ch >> 12) & 0x3f)));
+        s.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3f)));
+        s.push_back(static_cast<char>(0x80 | (ch & 0x3f)));
+    }
+}
+
+std::wstring Utf8ToWide(std::string_view text)
+{
+    std::wstring out;
+    out.reserve(text.size());
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text.data());
+    for (size_t i = 0; i < text.size();) {
+        char32_t ch;
+        i += DecodeUtf8(bytes + i, text.size() - i, ch);
+        if (sizeof(wchar_t) == 2 && ch >= 0x10000) {
+            out.push_back(static_cast<wchar_t>(0xD800 | ((ch - 0x10000) >> 10)));
+            out.push_back(static_cast<wchar_t>(0xDC00 | ((ch - 0x10000) & 0x3FF)));
+        } else {
+            out.push_back(static_cast<wchar_t>(ch));
+        }
+    }
+    return out;
+}
+
+std::string WideToUtf8(std::wstring_view text)
+{
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++) {
+        char32_t ch = static_cast<char32_t>(text[i]);
+        if (sizeof(wchar_t) == 2 && ch >= 0xD800 && ch <= 0xDBFF && i + 1 < text.size())
+            ch = 0x10000 + ((ch - 0xD800) << 10) + (static_cast<char32_t>(text[++i]) - 0xDC00);
+        EncodeAndAppendUtf8(out, ch);
+    }
+    return out;
+}
+
+} // namespace Scalar
+
+int main()
+{
+    std::mt19937 rng(1);
+    const char* words[] = { "Processor performance boost mode ", "Energy performance preference ", "Heterogeneous thread scheduling policy " };
+    const char* international[] = { "\xc3\x89" "conomie d'\xc3\xa9nergie ", "\xd0\xad\xd0\xbd\xd0\xb5\xd1\x80\xd0\xb3\xd0\xb8\xd1\x8f ",
+                                    "\xe9\x9b\xbb\xe6\xba\x90\xe3\x83\x97\xe3\x83\xa9\xe3\x83\xb3 ", "Leistung \xf0\x9f\x94\x8b " };
+    std::string ascii, mixed;
+    while (ascii.size() < (4u << 20))
+        ascii += words[rng() % 3];
+    while (mixed.size() < (4u << 20))
+        mixed += (rng() % 2) ? words[rng() % 3] : international[rng() % 4];
+
+    for (const std::string* input : { &ascii, &mixed }) {
+        const std::string& text = *input;
+        const double bytes = static_cast<double>(text.size());
+        const std::wstring wide = Utf8ToWide(text);
+        if (Scalar::Utf8ToWide(text) != wide || Scalar::WideToUtf8(wide) != text) {
+            std::printf("scalar baseline disagrees with PUtf8\n");
+            return 1;
+        }
+        std::printf("%s, %.1f MiB of UTF-8:\n", input == &ascii ? "ASCII-heavy" : "mixed scripts", bytes / (1 << 20));
+
+        double scalarDecode = BestOf(10, [&] { KeepAlive(Scalar::Utf8ToWide(text).size()); });
+        Report("  UTF-8 -> wide, scalar StringUtil", scalarDecode, bytes);
+        double decode = BestOf(10, [&] { KeepAlive(Utf8ToWide(text).size()); });
+        Report("  UTF-8 -> wide, PUtf8", decode, bytes, scalarDecode);
+
+        double scalarEncode = BestOf(10, [&] { KeepAlive(Scalar::WideToUtf8(wide).size()); });
+        Report("  wide -> UTF-8, scalar StringUtil", scalarEncode, bytes);
+        double encode = BestOf(10, [&] { KeepAlive(WideToUtf8(wide).size()); });
+        Report("  wide -> UTF-8, PUtf8", encode, bytes, scalarEncode);
+
+        std::u16string utf16;
+        Utf8ToUtf16(text, utf16);
+        Report("  ValidateUtf8", BestOf(10, [&] { KeepAlive(ValidateUtf8(text)); }), bytes);
+        Report("  Utf8ToUtf16", BestOf(10, [&] { std::u16string out; Utf8ToUtf16(text, out); KeepAlive(out.size()); }), bytes);
+        Report("  Utf16ToUtf8", BestOf(10, [&] { std::string out; Utf16ToUtf8(utf16, out); KeepAlive(out.size()); }), bytes);
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+// BatchWriteTests.cpp - PInformation::SetPowerSettingValues over the fake backend: unresolved names,
+// rollback of a failed batch in reverse order, unreadable old values, and one activation per scheme.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PFakePowerBackend.h"
+#include "PInformation.h"
+
+namespace {
+
+std::vector<std::wstring> Activations(const std::vector<std::wstring>& journal)
+{
+    std::vector<std::wstring> out;
+    for (const auto& entry : journal)
+        if (entry.compare(0, 9, L"activate ") == 0)
+            out.push_back(entry.substr(9));
+    return out;
+}
+
+DWORD AcValue(PInformation& info, const wchar_t* profile, const wchar_t* setting)
+{
+    DWORD value = 0;
+    P_CHECK(info.GetPowerSettingValue(profile, setting, true, value));
+    return value;
+}
+
+} // namespace
+
+P_TEST(BatchWrite, UnresolvedNameWritesNothing)
+{
+    PFakePowerBackend backend;
+    backend.Populate(2, 1, 3);
+    PInformation info(backend);
+    backend.TakeJournal();
+
+    PSetResult result = info.SetPowerSettingValues({ { L"Scheme 0", L"Setting 0.0", true, 9 },
+                                                     { L"Scheme 1", L"Setting 0.1", false, 9 },
+                                                     { L"Scheme 1", L"No such setting", true, 9 } });
+    P_CHECK(result == PSetResult::NotApplied);
+    P_CHECK(backend.TakeJournal().empty());
+    P_CHECK_EQ(AcValue(info, L"Scheme 0", L"Setting 0.0"), DWORD(0));
+}
+
+P_TEST(BatchWrite, FailedWriteRestoresEarlierWritesInReverse)
+{
+    PFakePowerBackend backend;
+    backend.Populate(2, 1, 3);
+    PInformation info(backend);
+    backend.FailSetting(L"Setting 0.2", false, true);
+    backend.TakeJournal();
+
+    PSetResult result = info.SetPowerSettingValues({ { L"Scheme 0", L"Setting 0.0", true, 10 },
+                                                     { L"Scheme 1", L"Setting 0.1", true, 11 },
+                                                     { L"Scheme 0", L"Setting 0.0", true, 12 },
+                                                     { L"Scheme 0", L"Setting 0.2", true, 13 } });
+    P_CHECK(result == PSetResult::NotApplied);
+    std::vector<std::wstring> expected = { L"write Scheme 0/Setting 0.0 AC 10", L"write Scheme 1/Setting 0.1 AC 11",
+                                           L"write Scheme 0/Setting 0.0 AC 12", L"write Scheme 0/Setting 0.0 AC 10",
+                                           L"write Scheme 1/Setting 0.1 AC 1", L"write Scheme 0/Setting 0.0 AC 0" };
+    P_CHECK(backend.TakeJournal() == expected);
+    P_CHECK_EQ(AcValue(info, L"Scheme 0", L"Setting 0.0"), DWORD(0));
+    P_CHECK_EQ(AcValue(info, L"Scheme 1", L"Setting 0.1"), DWORD(1));
+}
+
+P_TEST(BatchWrite, UnreadableOldValueIsWrittenButNotRestored)
+{
+    PFakePowerBackend backend;
+    backend.Populate(1, 1, 3);
+    PInformation info(backend);
+    backend.FailSetting(L"Setting 0.1", true, false);
+
+    // Nothing to undo: the batch goes through
+    P_CHECK(info.SetPowerSettingValues({ { L"Scheme 0", L"Setting 0.1", true, 7 }, { L"Scheme 0", L"Setting 0.0", true, 8 } }) ==
+            PSetResult::Applied);
+
+    // A later failure restores what it can and says that something changed
+    backend.FailSetting(L"Setting 0.2", false, true);
+    PSetResult result = info.SetPowerSettingValues({ { L"Scheme 0", L"Setting 0.0", true, 5 },
+                                                     { L"Scheme 0", L"Setting 0.1", true, 6 },
+                                                     { L"Scheme 0", L"Setting 0.2", true, 9 } });
+    P_CHECK(result == PSetResult::PartlyApplied);
+    backend.ClearFailures();
+    P_CHECK_EQ(AcValue(info, L"Scheme 0", L"Setting 0.0"), DWORD(8));
+    P_CHECK_EQ(AcValue(info, L"Scheme 0", L"Setting 0.1"), DWORD(6));
+}
+
+P_TEST(BatchWrite, EachSchemeActivatedOnce)
+{
+    PFakePowerBackend backend;
+    backend.Populate(3, 1, 2);
+    PInformation info(backend);
+    backend.TakeJournal();
+
+    PSetResult result = info.SetPowerSettingValues({ { L"Scheme 0", L"Setting 0.0", true, 1 },
+                                                     { L"Scheme 1", L"Setting 0.0", true, 1 },
+                                                     { L"Scheme 0", L"Setting 0.1", false, 1 },
+                                                     { L"Scheme 2", L"Setting 0.0", true, 1 },
+                                                     { L"Scheme 1", L"Setting 0.1", true, 1 } });
+    P_CHECK(result == PSetResult::Applied);
+    // Ordered by each scheme's last write, so the last scheme written ends up active
+    std::vector<std::wstring> expected = { L"Scheme 0", L"Scheme 2", L"Scheme 1" };
+    P_CHECK(Activations(backend.TakeJournal()) == expected);
+}
+
+P_TEST(BatchWrite, ActivationFailureKeepsTheWrites)
+{
+    PFakePowerBackend backend;
+    backend.Populate(1, 1, 2);
+    PInformation info(backend);
+    backend.FailActivation();
+
+    P_CHECK(info.SetPowerSettingValues({ { L"Scheme 0", L"Setting 0.1", true, 4 } }) == PSetResult::NotActivated);
+    P_CHECK_EQ(AcValue(info, L"Scheme 0", L"Setting 0.1"), DWORD(4));
+}
@@ -0,0 +1,65 @@
+// BenchStatsTests.cpp - PBenchStats on known samples: mean, sample standard deviation, Student's t
+// confidence half-width, median, and interpolated percentiles.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PBenchmark.h"
+#include <cmath>
+
+namespace {
+
+bool Near(double a, double b)
+{
+    return std::fabs(a - b) < 1e-9 * std::max(1.0, std::fabs(b));
+}
+
+} // namespace
+
+P_TEST(BenchStats, MeanDeviationAndConfidence)
+{
+    PBenchStats stats = PBenchStats::FromSamples({ 2, 4, 4, 4, 5, 5, 7, 9 });
+    P_CHECK_EQ(stats.count, size_t(8));
+    P_CHECK(Near(stats.mean, 5.0));
+    // Squared deviations sum to 32; n - 1 = 7 degrees of freedom, t = 2.365
+    P_CHECK(Near(stats.stddev, std::sqrt(32.0 / 7.0)));
+    P_CHECK(Near(stats.ci95, 2.365 * std::sqrt(32.0 / 7.0) / std::sqrt(8.0)));
+    P_CHECK(Near(stats.median, 4.5));
+
+    // Past 30 degrees of freedom the normal quantile is used
+    std::vector<double> many(41);
+    for (size_t i = 0; i < many.size(); i++)
+        many[i] = static_cast<double>(i);
+    stats = PBenchStats::FromSamples(many);
+    P_CHECK(Near(stats.ci95, 1.960 * stats.stddev / std::sqrt(41.0)));
+    P_CHECK(Near(stats.median, 20.0));
+}
+
+P_TEST(BenchStats, FewSamples)
+{
+    PBenchStats stats = PBenchStats::FromSamples({});
+    P_CHECK_EQ(stats.count, size_t(0));
+    P_CHECK(stats.mean == 0.0 && stats.median == 0.0);
+
+    stats = PBenchStats::FromSamples({ 3.5 });
+    P_CHECK(stats.mean == 3.5 && stats.median == 3.5);
+    P_CHECK(stats.stddev == 0.0 && stats.ci95 == 0.0);
+
+    stats = PBenchStats::FromSamples({ 1, 3 });
+    P_CHECK(Near(stats.ci95, 12.706 * std::sqrt(2.0) / std::sqrt(2.0)));
+}
+
+P_TEST(BenchStats, PercentilesInterpolate)
+{
+    // Unsorted input; ranks 0..4 hold 10, 20, 30, 40, 50
+    std::vector<double> samples = { 40, 10, 50, 30, 20 };
+    P_CHECK(Near(PBenchStats::Percentile(samples, 0), 10.0));
+    P_CHECK(Near(PBenchStats::Percentile(samples, 25), 20.0));
+    P_CHECK(Near(PBenchStats::Percentile(samples, 50), 30.0));
+    P_CHECK(Near(PBenchStats::Percentile(samples, 90), 46.0));
+    P_CHECK(Near(PBenchStats::Percentile(samples, 100), 50.0));
+    // Out-of-range p is clamped
+    P_CHECK(Near(PBenchStats::Percentile(samples, -5), 10.0));
+    P_CHECK(Near(PBenchStats::Percentile(samples, 250), 50.0));
+    P_CHECK(Near(PBenchStats::Percentile({ 7 }, 95), 7.0));
+    P_CHECK(PBenchStats::Percentile({}, 50) == 0.0);
+}
@@ -0,0 +1,226 @@
+// BinarySnapshotTests.cpp - PBinarySnapshot write/read round trips and the reader's rejection of files that
+// are truncated, misaligned or out of the order Find() relies on.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PBinarySnapshot.h"
+#include "PFakePowerBackend.h"
+#include "PGuid.h"
+#include "PInformation.h"
+#include "PUtf8.h"
+#include <fstream>
+
+namespace {
+
+// Schemes and settings deliberately out of GUID order; one value unreadable, one non-ASCII name
+const char* SnapshotText =
+    "PowerInformation-snapshot\t1\n"
+    "active\t{22222222-0000-0000-0000-000000000000}\n"
+    "scheme\t{33333333-0000-0000-0000-000000000000}\tHigh\n"
+    "setting\t{AAAAAAAA-0000-0000-0000-000000000000}\t{00000003-0000-0000-0000-000000000000}\t1\t2\tThird\tThird setting\n"
+    "setting\t{AAAAAAAA-0000-0000-0000-000000000000}\t{00000001-0000-0000-0000-000000000000}\t3\terror\tFirst\tFirst setting\n"
+    "scheme\t{11111111-0000-0000-0000-000000000000}\tLow\n"
+    "scheme\t{22222222-0000-0000-0000-000000000000}\tBalanced \xC3\xA9\n"
+    "setting\t{BBBBBBBB-0000-0000-0000-000000000000}\t{00000002-0000-0000-0000-000000000000}\t5\t6\tSecond \xE4\xB8\xAD\t\n"
+    "setting\t{AAAAAAAA-0000-0000-0000-000000000000}\t{00000001-0000-0000-0000-000000000000}\t7\t8\tFirst\tFirst setting\n"
+    "cpus\t4\n"
+    "cpu\t0\t1\tP\t0\t0\t0\t0\t1024\t0-1\n"
+    "cpu\t1\t1\tP\t0\t0\t0\t0\t1024\t0-1\n"
+    "cpu\t2\t1\tE\t2\t0\t0\t0\t512\t2\n"
+    "cpu\t3\t0\tE\t3\t0\t0\t0\t512\t3\n";
+
+// Header field offsets (see SnapshotHeader in PBinarySnapshot.cpp)
+constexpr size_t SchemeCountOffset = 16;
+constexpr size_t SettingCountOffset = 20;
+constexpr size_t SchemesOffsetOffset = 48;
+constexpr size_t SettingsOffsetOffset = 56;
+constexpr size_t SchemeRecordSize = 32;
+constexpr size_t SettingRecordSize = 64;
+
+std::string ReadFile(const std::filesystem::path& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+void WriteFile(const std::filesystem::path& path, const std::string& bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size());
+}
+
+template <typename T>
+T Field(const std::string& bytes, size_t offset)
+{
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void SetField(std::string& bytes, size_t offset, T value)
+{
+    std::memcpy(bytes.data() + offset, &value, sizeof(T));
+}
+
+bool Opens(const std::filesystem::path& path)
+{
+    PBinarySnapshotReader reader;
+    return reader.Open(path);
+}
+
+// Write the sample snapshot and return the file's bytes
+std::string WriteSample(const std::filesystem::path& path)
+{
+    PSystemSnapshot snapshot;
+    if (!PSystemSnapshot::FromText(SnapshotText, snapshot) || !WriteBinarySnapshot(snapshot, path))
+        return {};
+    return ReadFile(path);
+}
+
+} // namespace
+
+P_TEST(BinarySnapshot, RoundTrip)
+{
+    PTempDir dir;
+    std::filesystem::path path = dir.Path() / "snap.bin";
+    PSystemSnapshot source;
+    P_REQUIRE(PSystemSnapshot::FromText(SnapshotText, source));
+    P_REQUIRE(WriteBinarySnapshot(source, path));
+    P_CHECK(IsBinarySnapshot(path));
+
+    PBinarySnapshotReader reader;
+    P_REQUIRE(reader.Open(path));
+    P_CHECK_EQ(reader.SchemeCount(), 3u);
+    P_CHECK_EQ(reader.SettingCount(), 4u);
+    P_CHECK_EQ(reader.CpuCount(), 4u);
+    P_CHECK(reader.ActiveScheme() == source.activeScheme);
+    // Sorted by GUID on disk
+    P_CHECK_EQ(reader.Scheme(0).name, std::string_view("Low"));
+    P_CHECK_EQ(reader.Scheme(1).name, std::string_view("Balanced \xC3\xA9"));
+    P_CHECK_EQ(reader.Scheme(2).name, std::string_view("High"));
+
+    // Every source setting is found with its values and text
+    const PCompactSnapshot& settings = source.settings;
+    for (size_t i = 0; i < settings.SettingCount(); i++) {
+        const GUID& scheme = settings.SchemeGuids()[settings.SettingSchemes()[i]];
+        size_t index = reader.Find(scheme, settings.SettingGuids()[i]);
+        P_REQUIRE(index != PBinarySnapshotReader::NotFound);
+        PBinarySnapshotReader::SettingView view = reader.Setting(index);
+        P_CHECK(*view.scheme == scheme);
+        P_CHECK(*view.subgroup == settings.SubgroupGuids()[i]);
+        P_CHECK_EQ(std::string(view.name), WideToUtf8(settings.Strings().Get(settings.NameIds()[i])));
+        P_CHECK_EQ(std::string(view.description), WideToUtf8(settings.Strings().Get(settings.DescriptionIds()[i])));
+        P_CHECK_EQ(view.acOk, settings.AcTypes()[i] == PValueType::Dword);
+        P_CHECK_EQ(view.dcOk, settings.DcTypes()[i] == PValueType::Dword);
+        if (view.acOk)
+            P_CHECK_EQ(view.acValue, settings.AcValues()[i]);
+        if (view.dcOk)
+            P_CHECK_EQ(view.dcValue, settings.DcValues()[i]);
+    }
+    GUID missing = {};
+    P_CHECK_EQ(reader.Find(source.activeScheme, missing), PBinarySnapshotReader::NotFound);
+    P_CHECK_EQ(reader.Find(missing, settings.SettingGuids()[0]), PBinarySnapshotReader::NotFound);
+
+    P_CHECK_EQ(reader.Cpu(2).coreType, PCoreType::Efficiency);
+    P_CHECK(!reader.Cpu(3).online);
+    P_CHECK_EQ(reader.Cpu(0).siblings[0], uint64_t(0x3));
+
+    // Expanding and re-serializing as text reproduces the binary file's content
+    PSystemSnapshot expanded;
+    P_REQUIRE(reader.ToSystemSnapshot(expanded));
+    std::filesystem::path again = dir.Path() / "again.bin";
+    P_REQUIRE(WriteBinarySnapshot(expanded, again));
+    P_CHECK(ReadFile(again) == ReadFile(path));
+}
+
+P_TEST(BinarySnapshot, RoundTripCapturedStore)
+{
+    PTempDir dir;
+    PFakePowerBackend backend;
+    backend.Populate(4, 5, 6);
+    PInformation info(backend);
+    PSystemSnapshot source = PSystemSnapshot::Capture(info, PCpuTopology());
+    std::filesystem::path path = dir.Path() / "snap.bin";
+    P_REQUIRE(WriteBinarySnapshot(source, path));
+
+    PBinarySnapshotReader reader;
+    P_REQUIRE(reader.Open(path));
+    P_CHECK_EQ(reader.SettingCount(), source.settings.SettingCount());
+    for (size_t i = 0; i < source.settings.SettingCount(); i++) {
+        const GUID& scheme = source.settings.SchemeGuids()[source.settings.SettingSchemes()[i]];
+        size_t index = reader.Find(scheme, source.settings.SettingGuids()[i]);
+        P_REQUIRE(index != PBinarySnapshotReader::NotFound);
+        P_CHECK_EQ(reader.Setting(index).acValue, source.settings.AcValues()[i]);
+    }
+    // No temp files left next to the snapshot
+    P_CHECK_EQ(static_cast<size_t>(std::distance(std::filesystem::directory_iterator(dir.Path()), std::filesystem::directory_iterator())), 1u);
+}
+
+P_TEST(BinarySnapshot, RejectsTruncatedAndMisaligned)
+{
+    PTempDir dir;
+    std::filesystem::path path = dir.Path() / "snap.bin", bad = dir.Path() / "bad.bin";
+    std::string bytes = WriteSample(path);
+    P_REQUIRE(!bytes.empty());
+    P_CHECK(Opens(path));
+
+    WriteFile(bad, bytes.substr(0, bytes.size() - 1));
+    P_CHECK(!Opens(bad));
+    WriteFile(bad, bytes.substr(0, 40));
+    P_CHECK(!Opens(bad));
+
+    std::string patched = bytes;
+    SetField<uint64_t>(patched, SettingsOffsetOffset, Field<uint64_t>(bytes, SettingsOffsetOffset) + 4);
+    WriteFile(bad, patched);
+    P_CHECK(!Opens(bad));
+
+    // Scheme records overlapping the header
+    patched = bytes;
+    SetField<uint64_t>(patched, SchemesOffsetOffset, 8);
+    WriteFile(bad, patched);
+    P_CHECK(!Opens(bad));
+
+    patched = bytes;
+    SetField<uint32_t>(patched, SettingCountOffset, 1u << 30);
+    WriteFile(bad, patched);
+    P_CHECK(!Opens(bad));
+}
+
+P_TEST(BinarySnapshot, RejectsUnsortedRecords)
+{
+    PTempDir dir;
+    std::filesystem::path path = dir.Path() / "snap.bin", bad = dir.Path() / "bad.bin";
+    std::string bytes = WriteSample(path);
+    P_REQUIRE(!bytes.empty());
+    size_t schemes = Field<uint64_t>(bytes, SchemesOffsetOffset);
+    size_t settings = Field<uint64_t>(bytes, SettingsOffsetOffset);
+    P_REQUIRE(Field<uint32_t>(bytes, SchemeCountOffset) == 3);
+
+    // Swap the GUIDs of two schemes: ranges stay valid but the scheme order is broken
+    std::string patched = bytes;
+    std::swap_ranges(patched.begin() + schemes, patched.begin() + schemes + 16, patched.begin() + schemes + SchemeRecordSize);
+    WriteFile(bad, patched);
+    P_CHECK(!Opens(bad));
+
+    // Scheme 2 ("High") holds settings 2..3; swap their setting GUIDs (offset 16 in the record)
+    patched = bytes;
+    size_t first = settings + 2 * SettingRecordSize + 16;
+    std::swap_ranges(patched.begin() + first, patched.begin() + first + 16, patched.begin() + first + SettingRecordSize);
+    WriteFile(bad, patched);
+    P_CHECK(!Opens(bad));
+
+    // A record pointing at another scheme (schemeIndex at offset 32 in the record)
+    patched = bytes;
+    SetField<uint32_t>(patched, settings + 32, 2);
+    WriteFile(bad, patched);
+    P_CHECK(!Opens(bad));
+
+    // Scheme ranges that overlap instead of tiling the setting array (firstSetting at offset 24)
+    patched = bytes;
+    SetField<uint32_t>(patched, schemes + 2 * SchemeRecordSize + 24, 1);
+    WriteFile(bad, patched);
+    P_CHECK(!Opens(bad));
+}
@@ -0,0 +1,104 @@
+// BytePatternSetTests.cpp - PBytePatternSet single-pass scans against per-pattern FindAll, and patterns files.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PBytePatternSet.h"
+#include <random>
+
+namespace {
+
+// Hits of every pattern searched on its own, in Scan's order (offset, then pattern id)
+std::vector<std::pair<size_t, uint32_t>> PerPatternHits(const PBytePatternSet& set, const std::vector<uint8_t>& data)
+{
+    std::vector<std::pair<size_t, uint32_t>> hits;
+    for (uint32_t id = 0; id < set.Size(); id++) {
+        std::vector<size_t> offsets;
+        set.Pattern(id).FindAll(data, offsets);
+        for (size_t offset : offsets)
+            hits.push_back({ offset, id });
+    }
+    std::sort(hits.begin(), hits.end());
+    return hits;
+}
+
+std::vector<std::pair<size_t, uint32_t>> ScanHits(const PBytePatternSet& set, const std::vector<uint8_t>& data)
+{
+    std::vector<PPatternHit> hits;
+    set.Scan(data, hits);
+    std::vector<std::pair<size_t, uint32_t>> out;
+    for (const PPatternHit& hit : hits)
+        out.push_back({ hit.offset, hit.pattern });
+    return out;
+}
+
+} // namespace
+
+P_TEST(BytePatternSet, ScanMatchesPerPatternSearch)
+{
+    std::mt19937 rng(9);
+    const uint8_t common[] = { 0x00, 0x48, 0x8B, 0xFF, 0x01 };
+    for (int round = 0; round < 1500; round++) {
+        std::vector<uint8_t> data(rng() % 400);
+        for (auto& byte : data)
+            byte = rng() % 3 == 0 ? static_cast<uint8_t>(rng()) : common[rng() % 5];
+        // 1 to 30 patterns of 1 to 8 bytes, including single-byte and all-wildcard ones
+        PBytePatternSet set;
+        int count = 1 + rng() % 30;
+        for (int k = 0; k < count; k++) {
+            size_t size = 1 + rng() % 8;
+            size_t source = data.size() > size ? rng() % (data.size() - size) : 0;
+            std::string text;
+            for (size_t j = 0; j < size; j++) {
+                uint8_t byte = data.size() > size && rng() % 3 ? data[source + j] : static_cast<uint8_t>(rng());
+                const char* digits = "0123456789ABCDEF";
+                unsigned wildcard = rng() % 7;
+                text.push_back(wildcard == 0 || wildcard == 2 ? '?' : digits[byte >> 4]);
+                text.push_back(wildcard == 1 || wildcard == 2 ? '?' : digits[byte & 0xF]);
+            }
+            PBytePattern pattern;
+            P_REQUIRE(PBytePattern::Parse(text, pattern));
+            set.Add(std::to_string(k), pattern);
+        }
+        if (ScanHits(set, data) != PerPatternHits(set, data)) {
+            PTestFail(__FILE__, __LINE__, "scan mismatch in round " + std::to_string(round));
+            return;
+        }
+    }
+}
+
+P_TEST(BytePatternSet, AddAfterScanRecompiles)
+{
+    std::vector<uint8_t> data = { 'F', 'A', 'C', 'P', 0, 'D', 'S', 'D', 'T' };
+    PBytePatternSet set;
+    PBytePattern facp, dsdt;
+    P_REQUIRE(PBytePattern::Parse("46 41 43 50", facp) && PBytePattern::Parse("44 53 44 54", dsdt));
+    set.Add("FACP", facp);
+    P_CHECK(ScanHits(set, data) == (std::vector<std::pair<size_t, uint32_t>>{ { 0, 0 } }));
+    set.Add("DSDT", dsdt);
+    P_CHECK(ScanHits(set, data) == (std::vector<std::pair<size_t, uint32_t>>{ { 0, 0 }, { 5, 1 } }));
+    P_CHECK(ScanHits(PBytePatternSet(), data).empty());
+}
+
+P_TEST(BytePatternSet, ParsesPatternsFiles)
+{
+    PBytePatternSet set;
+    size_t errorLine = 99;
+    P_REQUIRE(PBytePatternSet::FromText("# ACPI tables\nFACP\t46 41 43 50\n\nname\\twith tab\t44 53 44 54\r\n", set, errorLine));
+    P_CHECK_EQ(errorLine, size_t(0));
+    P_REQUIRE(set.Size() == 2);
+    P_CHECK_EQ(set.Name(0), std::string("FACP"));
+    P_CHECK_EQ(set.Name(1), std::string("name\twith tab"));
+    P_CHECK_EQ(set.Pattern(1).Size(), size_t(4));
+
+    P_CHECK(!PBytePatternSet::FromText("ok\t46\nbad\t4G\n", set, errorLine));
+    P_CHECK_EQ(errorLine, size_t(2));
+    P_CHECK(!PBytePatternSet::FromText("\tnameless 46\n", set, errorLine));
+    P_CHECK_EQ(errorLine, size_t(1));
+    P_CHECK(!PBytePatternSet::FromText("three\t46\textra\n", set, errorLine));
+
+    PTempDir dir;
+    dir.Write("acpi.pat", "FACP\t46 41 43 50\n");
+    P_CHECK(PBytePatternSet::Load(dir.Path() / "acpi.pat", set, errorLine) && set.Size() == 1);
+    P_CHECK(!PBytePatternSet::Load(dir.Path() / "missing.pat", set, errorLine));
+    P_CHECK_EQ(errorLine, size_t(0));
+}
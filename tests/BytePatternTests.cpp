@@ -0,0 +1,148 @@
+// BytePatternTests.cpp - PBytePattern parsing, Find/FindAll against a naive masked scan, and the chunked
+// PBytePatternStream.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PBytePattern.h"
+#include <random>
+
+namespace {
+
+// Every offset where the pattern matches, one masked compare at a time
+std::vector<size_t> NaiveFindAll(const std::vector<uint8_t>& data, const PBytePattern& pattern)
+{
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i + pattern.Size() <= data.size(); i++) {
+        size_t j = 0;
+        while (j < pattern.Size() && (data[i + j] & pattern.Mask(j)) == pattern.Value(j))
+            j++;
+        if (j == pattern.Size())
+            offsets.push_back(i);
+    }
+    return offsets;
+}
+
+std::vector<uint8_t> Bytes(std::string_view text)
+{
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+} // namespace
+
+P_TEST(BytePattern, ParsesValuesMasksAndRejectsBadText)
+{
+    PBytePattern pattern;
+    P_REQUIRE(PBytePattern::Parse("48 8b ?? 4? ?F", pattern));
+    P_REQUIRE(pattern.Size() == 5);
+    P_CHECK_EQ(int(pattern.Value(0)), 0x48);
+    P_CHECK_EQ(int(pattern.Mask(0)), 0xFF);
+    P_CHECK_EQ(int(pattern.Value(1)), 0x8B);
+    P_CHECK_EQ(int(pattern.Mask(2)), 0x00);
+    P_CHECK_EQ(int(pattern.Value(3)), 0x40);
+    P_CHECK_EQ(int(pattern.Mask(3)), 0xF0);
+    P_CHECK_EQ(int(pattern.Value(4)), 0x0F);
+    P_CHECK_EQ(int(pattern.Mask(4)), 0x0F);
+    P_CHECK(PBytePattern::Parse("488B0D", pattern) && pattern.Size() == 3);
+
+    P_CHECK(!PBytePattern::Parse("", pattern));
+    P_CHECK(!PBytePattern::Parse("   ", pattern));
+    P_CHECK(!PBytePattern::Parse("4", pattern));
+    P_CHECK(!PBytePattern::Parse("48 8", pattern));
+    P_CHECK(!PBytePattern::Parse("4G", pattern));
+}
+
+P_TEST(BytePattern, FindsFirstLastAndOverlappingMatches)
+{
+    PBytePattern pattern;
+    P_REQUIRE(PBytePattern::Parse("AA AA", pattern));
+    std::vector<uint8_t> data = Bytes("\xaa\xaa\xaa\x01\xaa\xaa");
+    std::vector<size_t> offsets;
+    pattern.FindAll(data, offsets);
+    P_CHECK(offsets == std::vector<size_t>({ 0, 1, 4 }));
+
+    size_t offset = 0;
+    P_CHECK(pattern.Find(data, offset) && offset == 0);
+    P_CHECK(pattern.Find(data, offset, 2) && offset == 4);
+    // The last possible offset is searched; input shorter than the pattern matches nothing
+    P_CHECK(pattern.Find(data, offset, 4) && offset == 4);
+    P_CHECK(!pattern.Find(data, offset, 5));
+    P_CHECK(!pattern.Find(Bytes("\xaa"), offset));
+    P_CHECK(!pattern.Find(std::span<const uint8_t>(), offset));
+}
+
+P_TEST(BytePattern, MatchesNaiveScanOnRandomPatterns)
+{
+    std::mt19937 rng(3);
+    const uint8_t common[] = { 0x00, 0x48, 0x8B, 0xFF, 0x01 };
+    for (int round = 0; round < 3000; round++) {
+        // Up to 300 bytes, so matches land inside and across the 16/32-byte prefilter blocks
+        std::vector<uint8_t> data(rng() % 300);
+        for (auto& byte : data)
+            byte = rng() % 4 == 0 ? static_cast<uint8_t>(rng()) : common[rng() % 5];
+        size_t size = 1 + rng() % 12;
+        size_t source = data.size() > size ? rng() % (data.size() - size) : 0;
+        std::string text;
+        for (size_t j = 0; j < size; j++) {
+            uint8_t byte = data.size() > size && rng() % 3 ? data[source + j] : common[rng() % 5];
+            char hex[3];
+            std::snprintf(hex, sizeof(hex), "%02X", byte);
+            switch (rng() % 6) {
+            case 0: hex[0] = '?'; break;
+            case 1: hex[1] = '?'; break;
+            case 2: hex[0] = hex[1] = '?'; break;
+            }
+            text += hex;
+            text += ' ';
+        }
+        PBytePattern pattern;
+        P_REQUIRE(PBytePattern::Parse(text, pattern));
+        std::vector<size_t> expected = NaiveFindAll(data, pattern);
+
+        std::vector<size_t> all;
+        pattern.FindAll(data, all);
+        size_t first = 0;
+        bool found = pattern.Find(data, first);
+        bool ok = all == expected && found == !expected.empty() && (!found || first == expected[0]);
+        if (ok && expected.size() > 1) {
+            size_t next = 0;
+            ok = pattern.Find(data, next, expected[0] + 1) && next == expected[1];
+        }
+        if (!ok) {
+            PTestFail(__FILE__, __LINE__, "mismatch for pattern " + text);
+            return;
+        }
+    }
+}
+
+P_TEST(BytePattern, StreamFindsMatchesAcrossChunks)
+{
+    std::mt19937 rng(7);
+    PBytePattern pattern;
+    P_REQUIRE(PBytePattern::Parse("5F 53 ?? 5F", pattern));
+    std::vector<uint8_t> data(5000);
+    for (auto& byte : data)
+        byte = static_cast<uint8_t>("_SB_."[rng() % 5]);
+    std::vector<size_t> expected = NaiveFindAll(data, pattern);
+    P_REQUIRE(!expected.empty());
+
+    for (size_t maxChunk : { size_t(1), size_t(3), size_t(17), size_t(4096) }) {
+        PBytePatternStream stream(pattern);
+        std::vector<uint64_t> offsets;
+        for (size_t position = 0; position < data.size();) {
+            size_t chunk = std::min(data.size() - position, 1 + rng() % maxChunk);
+            stream.Feed(std::span<const uint8_t>(data.data() + position, chunk), offsets);
+            position += chunk;
+        }
+        P_CHECK(std::vector<size_t>(offsets.begin(), offsets.end()) == expected);
+    }
+
+    // Reset starts the offsets over
+    PBytePatternStream stream(pattern);
+    std::vector<uint64_t> offsets;
+    stream.Feed(Bytes("xx_S"), offsets);
+    stream.Reset();
+    stream.Feed(Bytes("B_"), offsets);
+    P_CHECK(offsets.empty());
+    stream.Feed(Bytes("_SB_"), offsets);
+    P_CHECK(offsets == std::vector<uint64_t>({ 2 }));
+}
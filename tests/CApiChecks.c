@@ -0,0 +1,94 @@
+/* CApiChecks.c - PiGetValue/PiSetValue from C against the fake backend: values, writes, unknown names,
+ * failing reads and writes, and NULL or invalid arguments. Compiled as C so the header stays valid C.
+ */
+#include <string.h>
+#include "CApiChecks.h"
+
+#define C_CHECK(condition) do { if (!(condition)) CApiFail(__FILE__, __LINE__, #condition); } while (0)
+
+void CApiCheckGetValue(void)
+{
+    PiContext* context = NULL;
+    uint32_t ac = 0, dc = 0;
+    C_CHECK(PiGetApiVersion() == PI_API_VERSION);
+    if (CApiOpenFake(2, 1, 3, &context) != PI_OK) {
+        CApiFail(__FILE__, __LINE__, "CApiOpenFake");
+        return;
+    }
+    /* Populate: AC is the setting index, DC the scheme index */
+    C_CHECK(PiGetValue(context, "Scheme 1", "Setting 0.2", &ac, &dc) == PI_OK);
+    C_CHECK(ac == 2 && dc == 1);
+    /* Either output may be left out */
+    ac = 99;
+    C_CHECK(PiGetValue(context, "Scheme 0", "Setting 0.1", NULL, &dc) == PI_OK);
+    C_CHECK(ac == 99 && dc == 0);
+    C_CHECK(PiGetValue(context, "Scheme 0", "Setting 0.1", &ac, NULL) == PI_OK);
+    C_CHECK(ac == 1);
+    PiClose(context);
+}
+
+void CApiCheckSetValue(void)
+{
+    PiContext* context = NULL;
+    uint32_t ac = 0, dc = 0;
+    if (CApiOpenFake(2, 1, 3, &context) != PI_OK) {
+        CApiFail(__FILE__, __LINE__, "CApiOpenFake");
+        return;
+    }
+    C_CHECK(PiSetValue(context, "Scheme 1", "Setting 0.0", PI_DC, 7) == PI_OK);
+    C_CHECK(PiGetValue(context, "Scheme 1", "Setting 0.0", &ac, &dc) == PI_OK);
+    C_CHECK(ac == 0 && dc == 7);
+    C_CHECK(PiSetValue(context, "Scheme 1", "Setting 0.0", PI_BOTH, 4) == PI_OK);
+    C_CHECK(PiGetValue(context, "Scheme 1", "Setting 0.0", &ac, &dc) == PI_OK);
+    C_CHECK(ac == 4 && dc == 4);
+    /* Other schemes are untouched */
+    C_CHECK(PiGetValue(context, "Scheme 0", "Setting 0.0", &ac, &dc) == PI_OK);
+    C_CHECK(ac == 0 && dc == 0);
+    PiClose(context);
+}
+
+void CApiCheckNotFoundAndFailures(void)
+{
+    PiContext* context = NULL;
+    uint32_t ac = 5, dc = 5;
+    if (CApiOpenFake(1, 1, 3, &context) != PI_OK) {
+        CApiFail(__FILE__, __LINE__, "CApiOpenFake");
+        return;
+    }
+    C_CHECK(PiGetValue(context, "No scheme", "Setting 0.0", &ac, &dc) == PI_ERROR_NOT_FOUND);
+    C_CHECK(PiGetValue(context, "Scheme 0", "No setting", &ac, &dc) == PI_ERROR_NOT_FOUND);
+    C_CHECK(ac == 5 && dc == 5);
+    C_CHECK(PiSetValue(context, "No scheme", "Setting 0.0", PI_AC, 1) == PI_ERROR_NOT_FOUND);
+
+    /* A setting that exists but cannot be read or written */
+    CApiFailSetting("Setting 0.2");
+    C_CHECK(PiGetValue(context, "Scheme 0", "Setting 0.2", &ac, &dc) == PI_ERROR_FAILED);
+    C_CHECK(ac == 5 && dc == 5);
+    C_CHECK(PiSetValue(context, "Scheme 0", "Setting 0.2", PI_BOTH, 1) == PI_ERROR_FAILED);
+    C_CHECK(PiGetValue(context, "Scheme 0", "Setting 0.1", &ac, &dc) == PI_OK);
+    PiClose(context);
+}
+
+void CApiCheckNullArguments(void)
+{
+    PiContext* context = NULL;
+    uint32_t ac = 0, dc = 0;
+    C_CHECK(PiOpen(NULL, NULL) == PI_ERROR_INVALID_PARAMETER);
+    C_CHECK(PiGetValue(NULL, "Scheme 0", "Setting 0.0", &ac, &dc) == PI_ERROR_INVALID_PARAMETER);
+    C_CHECK(PiSetValue(NULL, "Scheme 0", "Setting 0.0", PI_AC, 1) == PI_ERROR_INVALID_PARAMETER);
+    PiClose(NULL);
+    if (CApiOpenFake(1, 1, 1, &context) != PI_OK) {
+        CApiFail(__FILE__, __LINE__, "CApiOpenFake");
+        return;
+    }
+    C_CHECK(PiGetValue(context, NULL, "Setting 0.0", &ac, &dc) == PI_ERROR_INVALID_PARAMETER);
+    C_CHECK(PiGetValue(context, "Scheme 0", NULL, &ac, &dc) == PI_ERROR_INVALID_PARAMETER);
+    C_CHECK(PiSetValue(context, NULL, "Setting 0.0", PI_AC, 1) == PI_ERROR_INVALID_PARAMETER);
+    C_CHECK(PiSetValue(context, "Scheme 0", NULL, PI_AC, 1) == PI_ERROR_INVALID_PARAMETER);
+    /* which must be PI_AC, PI_DC or PI_BOTH */
+    C_CHECK(PiSetValue(context, "Scheme 0", "Setting 0.0", 0, 1) == PI_ERROR_INVALID_PARAMETER);
+    C_CHECK(PiSetValue(context, "Scheme 0", "Setting 0.0", 4, 1) == PI_ERROR_INVALID_PARAMETER);
+    C_CHECK(PiGetValue(context, "Scheme 0", "Setting 0.0", &ac, &dc) == PI_OK);
+    C_CHECK(ac == 0 && dc == 0);
+    PiClose(context);
+}
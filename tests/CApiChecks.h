@@ -0,0 +1,30 @@
+/* CApiChecks.h - Checks of PowerInformationApi.h compiled as C (CApiChecks.c), run by the CApi suite.
+ *
+ * CApiTests.cpp provides the fixture: a context on PFakePowerBackend and failure reporting into PTest.
+ */
+#ifndef CAPI_CHECKS_H
+#define CAPI_CHECKS_H
+
+#include "PowerInformationApi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fixture, in CApiTests.cpp. CApiOpenFake fills the fake with PFakePowerBackend::Populate; CApiFailSetting
+ * makes reads and writes of every setting with that name fail on the fake opened last. */
+PiStatus CApiOpenFake(uint32_t schemes, uint32_t subgroups, uint32_t settings, PiContext** context);
+void CApiFailSetting(const char* setting);
+void CApiFail(const char* file, int line, const char* condition);
+
+/* Checks, in CApiChecks.c */
+void CApiCheckGetValue(void);
+void CApiCheckSetValue(void);
+void CApiCheckNotFoundAndFailures(void);
+void CApiCheckNullArguments(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAPI_CHECKS_H */
@@ -0,0 +1,53 @@
+// CApiTests.cpp - The C interface: runs the checks in CApiChecks.c, which is compiled as C, on contexts
+// over PFakePowerBackend.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "CApiChecks.h"
+#include "PFakePowerBackend.h"
+#include "PUtf8.h"
+#include "PowerInformationApiBackend.h"
+
+namespace {
+
+PFakePowerBackend* lastFake = nullptr; // owned by the context CApiOpenFake returned last
+
+} // namespace
+
+extern "C" PiStatus CApiOpenFake(uint32_t schemes, uint32_t subgroups, uint32_t settings, PiContext** context)
+{
+    auto backend = std::make_unique<PFakePowerBackend>();
+    backend->Populate(schemes, subgroups, settings);
+    lastFake = backend.get();
+    return PiOpenOnBackend(std::move(backend), nullptr, context);
+}
+
+extern "C" void CApiFailSetting(const char* setting)
+{
+    lastFake->FailSetting(Utf8ToWide(setting), true, true);
+}
+
+extern "C" void CApiFail(const char* file, int line, const char* condition)
+{
+    PTestFail(file, line, std::string("check failed: ") + condition);
+}
+
+P_TEST(CApi, GetValue)
+{
+    CApiCheckGetValue();
+}
+
+P_TEST(CApi, SetValue)
+{
+    CApiCheckSetValue();
+}
+
+P_TEST(CApi, NotFoundAndFailures)
+{
+    CApiCheckNotFoundAndFailures();
+}
+
+P_TEST(CApi, NullArguments)
+{
+    CApiCheckNullArguments();
+}
@@ -0,0 +1,93 @@
+// ChangeWatcherTests.cpp - PChangeWatcher over fixture attribute files: wakeups, timeouts, Wake() and
+// coalescing of write bursts.
+//
+#include "pch.h"
+#include "PTest.h"
+
+#ifndef _WIN32
+#include "PChangeWatcher.h"
+#include <thread>
+
+namespace {
+
+const char* Profile = "sys/firmware/acpi/platform_profile";
+const char* Governor = "sys/devices/system/cpu/cpufreq/policy0/scaling_governor";
+
+void WriteFixture(const PTempDir& dir)
+{
+    dir.Write(Profile, "balanced\n");
+    dir.Write(Governor, "powersave\n");
+}
+
+} // namespace
+
+P_TEST(ChangeWatcher, WriteWakesWait)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    PChangeWatcher watcher;
+    P_REQUIRE(watcher.Open({ dir.Path() / Profile, dir.Path() / Governor }));
+    P_CHECK(watcher.IsOpen());
+
+    std::thread writer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        dir.Write(Governor, "performance\n");
+    });
+    bool changed = watcher.Wait(std::chrono::seconds(5));
+    writer.join();
+    P_CHECK(changed);
+}
+
+P_TEST(ChangeWatcher, TimesOutWithoutChanges)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    PChangeWatcher watcher;
+    P_REQUIRE(watcher.Open({ dir.Path() / Profile }));
+
+    auto start = std::chrono::steady_clock::now();
+    P_CHECK(!watcher.Wait(std::chrono::milliseconds(50)));
+    P_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(50));
+}
+
+P_TEST(ChangeWatcher, WakeEndsAnUnboundedWait)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    PChangeWatcher watcher;
+    P_REQUIRE(watcher.Open({ dir.Path() / Profile }));
+
+    std::thread waker([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        watcher.Wake();
+    });
+    bool changed = watcher.Wait(std::chrono::milliseconds::max());
+    waker.join();
+    P_CHECK(!changed);
+}
+
+P_TEST(ChangeWatcher, BurstIsOneWakeup)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    PChangeWatcher watcher;
+    P_REQUIRE(watcher.Open({ dir.Path() / Profile, dir.Path() / Governor }));
+
+    // Writes landing before the settle window ends fold into the same wakeup
+    dir.Write(Profile, "performance\n");
+    dir.Write(Governor, "performance\n");
+    dir.Write(Profile, "low-power\n");
+    P_CHECK(watcher.Wait(std::chrono::seconds(5)));
+    P_CHECK(!watcher.Wait(std::chrono::milliseconds(50)));
+}
+
+P_TEST(ChangeWatcher, OpenFailsWithoutAnyAttribute)
+{
+    PTempDir dir;
+    PChangeWatcher watcher;
+    P_CHECK(!watcher.Open({ dir.Path() / "missing" }));
+    P_CHECK(!watcher.IsOpen());
+    P_CHECK(!watcher.Wait(std::chrono::milliseconds(10)));
+}
+
+#endif
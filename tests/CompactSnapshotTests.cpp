@@ -0,0 +1,75 @@
+// CompactSnapshotTests.cpp - PCompactSnapshot capture, string interning and memory against the legacy map.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PCompactSnapshot.h"
+#include "PFakePowerBackend.h"
+#include "PInformation.h"
+
+P_TEST(CompactSnapshot, ExpandsToTheLegacyMap)
+{
+    PFakePowerBackend backend;
+    backend.Populate(3, 4, 5);
+    PInformation info(backend);
+
+    PCompactSnapshot snapshot = PCompactSnapshot::Capture(info);
+    P_CHECK_EQ(snapshot.SchemeCount(), size_t(3));
+    P_CHECK_EQ(snapshot.SettingCount(), size_t(3 * 4 * 5));
+
+    auto expected = info.PowerEnumerateProfiles();
+    auto actual = snapshot.ToProfileMap();
+    P_REQUIRE(actual.size() == expected.size());
+    for (const auto& [scheme, settings] : expected) {
+        auto it = actual.find(scheme);
+        P_REQUIRE(it != actual.end());
+        P_REQUIRE(it->second.size() == settings.size());
+        for (size_t i = 0; i < settings.size(); i++) {
+            P_CHECK(it->second[i].name == settings[i].name);
+            P_CHECK(it->second[i].description == settings[i].description);
+            P_CHECK(it->second[i].acValue == settings[i].acValue);
+            P_CHECK(it->second[i].dcValue == settings[i].dcValue);
+        }
+    }
+}
+
+P_TEST(CompactSnapshot, InternsStringsRepeatedAcrossSchemes)
+{
+    PFakePowerBackend backend;
+    backend.Populate(10, 4, 5);
+    PInformation info(backend);
+
+    PCompactSnapshot snapshot = PCompactSnapshot::Capture(info);
+    // 10 scheme names plus one name and one description per distinct setting
+    P_CHECK_EQ(snapshot.Strings().Count(), size_t(10 + 2 * 4 * 5));
+    P_CHECK_EQ(snapshot.NameIds()[0], snapshot.NameIds()[4 * 5]);
+    P_CHECK_EQ(snapshot.DescriptionIds()[0], snapshot.DescriptionIds()[4 * 5]);
+}
+
+P_TEST(CompactSnapshot, TenSchemesUseLessMemoryThanTheLegacyMap)
+{
+    PFakePowerBackend backend;
+    backend.Populate(10, 20, 15);
+    PInformation info(backend);
+
+    PCompactSnapshot snapshot = PCompactSnapshot::Capture(info);
+    size_t legacy = PCompactSnapshot::MemoryUsage(info.PowerEnumerateProfiles());
+    P_CHECK(snapshot.MemoryUsage() * 2 < legacy);
+}
+
+P_TEST(CompactSnapshot, SetValueRecordsFailedReads)
+{
+    PFakePowerBackend backend;
+    backend.Populate(1, 1, 2);
+    PInformation info(backend);
+
+    PCompactSnapshot snapshot = PCompactSnapshot::Capture(info);
+    snapshot.SetValue(1, true, PValueType::Error, 7);
+    snapshot.SetValue(1, false, PValueType::Dword, 42);
+    P_CHECK(snapshot.AcTypes()[1] == PValueType::Error);
+    P_CHECK_EQ(snapshot.AcValues()[1], uint32_t(0));
+    P_CHECK_EQ(snapshot.DcValues()[1], uint32_t(42));
+    auto profiles = snapshot.ToProfileMap();
+    P_REQUIRE(profiles.size() == 1);
+    P_CHECK(profiles.begin()->second[1].acValue == L"<error>");
+    P_CHECK(profiles.begin()->second[1].dcValue == L"42");
+}
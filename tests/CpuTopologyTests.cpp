@@ -0,0 +1,107 @@
+// CpuTopologyTests.cpp - PCpuTopology::LoadFromSysfs on fixture trees: hybrid P/E cores from the PMU
+// lists, SMT siblings, core types from asymmetric capacities, and NUMA nodes including malformed entries.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PCpuTopology.h"
+
+namespace {
+
+// One cpuN directory: topology ids, sibling list and optional capacity
+void WriteCpu(PTempDir& dir, unsigned cpu, int core, int package, const char* siblings, int capacity = 0)
+{
+    std::string base = "sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    dir.Write(base + "/topology/core_id", std::to_string(core) + "\n");
+    dir.Write(base + "/topology/physical_package_id", std::to_string(package) + "\n");
+    dir.Write(base + "/topology/die_id", "0\n");
+    dir.Write(base + "/topology/core_cpus_list", std::string(siblings) + "\n");
+    if (capacity)
+        dir.Write(base + "/cpu_capacity", std::to_string(capacity) + "\n");
+}
+
+} // namespace
+
+P_TEST(CpuTopology, HybridCoresWithSmtSiblings)
+{
+    // Two P-cores with two threads each (0-1, 2-3), four single-thread E-cores (4-7)
+    PTempDir dir;
+    dir.Write("sys/devices/system/cpu/present", "0-7\n");
+    dir.Write("sys/devices/system/cpu/online", "0-7\n");
+    dir.Write("sys/devices/cpu_core/cpus", "0-3\n");
+    dir.Write("sys/devices/cpu_atom/cpus", "4-7\n");
+    WriteCpu(dir, 0, 0, 0, "0-1");
+    WriteCpu(dir, 1, 0, 0, "0-1");
+    WriteCpu(dir, 2, 4, 0, "2-3");
+    WriteCpu(dir, 3, 4, 0, "2-3");
+    for (unsigned cpu = 4; cpu < 8; cpu++)
+        WriteCpu(dir, cpu, static_cast<int>(cpu) + 4, 0, std::to_string(cpu).c_str());
+
+    PCpuTopology topology;
+    P_REQUIRE(PCpuTopology::LoadFromSysfs(dir.Path(), topology));
+    P_REQUIRE(topology.cpuCount == 8);
+    P_CHECK(topology.IsHybrid());
+    P_CHECK_EQ(topology.performance.ToList(), std::string("0-3"));
+    P_CHECK_EQ(topology.efficiency.ToList(), std::string("4-7"));
+    P_CHECK_EQ(topology.smtSiblings[3].ToList(), std::string("2-3"));
+    P_CHECK_EQ(topology.smtSiblings[5].ToList(), std::string("5"));
+    P_CHECK_EQ(topology.firstThreadPerCore.ToList(), std::string("0,2,4-7"));
+    P_CHECK_EQ(topology.CoreCount(PCoreType::Performance), size_t(2));
+    P_CHECK_EQ(topology.CoreCount(PCoreType::Efficiency), size_t(4));
+    P_CHECK_EQ(topology.coreId[2], int32_t(4));
+    P_CHECK_EQ(topology.dieId[7], int32_t(0));
+}
+
+P_TEST(CpuTopology, CapacityTellsCoreTypesApart)
+{
+    // big.LITTLE without hybrid PMUs; capacities are normalized so the largest core is 1024
+    PTempDir dir;
+    dir.Write("sys/devices/system/cpu/present", "0-3\n");
+    WriteCpu(dir, 0, 0, 0, "0", 300);
+    WriteCpu(dir, 1, 1, 0, "1", 300);
+    WriteCpu(dir, 2, 2, 0, "2", 800);
+    WriteCpu(dir, 3, 3, 0, "3", 800);
+
+    PCpuTopology topology;
+    P_REQUIRE(PCpuTopology::LoadFromSysfs(dir.Path(), topology));
+    P_CHECK_EQ(topology.online.ToList(), std::string("0-3"));
+    P_CHECK_EQ(topology.efficiency.ToList(), std::string("0-1"));
+    P_CHECK_EQ(topology.performance.ToList(), std::string("2-3"));
+    P_CHECK_EQ(topology.capacity[0], uint32_t(300 * 1024 / 800));
+    P_CHECK_EQ(topology.capacity[3], uint32_t(1024));
+
+    // Equal capacities say nothing about core types
+    for (unsigned cpu = 0; cpu < 4; cpu++)
+        WriteCpu(dir, cpu, static_cast<int>(cpu), 0, std::to_string(cpu).c_str(), 1024);
+    P_REQUIRE(PCpuTopology::LoadFromSysfs(dir.Path(), topology));
+    P_CHECK(!topology.IsHybrid());
+    P_CHECK(topology.performance.Empty() && topology.efficiency.Empty());
+}
+
+P_TEST(CpuTopology, NumaNodesAndMalformedEntries)
+{
+    PTempDir dir;
+    dir.Write("sys/devices/system/cpu/present", "0-5\n");
+    dir.Write("sys/devices/system/cpu/online", "0-3,5\n");
+    for (unsigned cpu = 0; cpu < 6; cpu++)
+        WriteCpu(dir, cpu, static_cast<int>(cpu % 3), static_cast<int>(cpu / 3), std::to_string(cpu).c_str());
+    dir.Write("sys/devices/system/node/node0/cpulist", "0-2\n");
+    dir.Write("sys/devices/system/node/node1/cpulist", "3-5\n");
+    // Not nodes, or ids that overflow int32 or exceed the kernel's limit: skipped, not thrown on
+    dir.Write("sys/devices/system/node/node/cpulist", "0\n");
+    dir.Write("sys/devices/system/node/nodex1/cpulist", "0\n");
+    dir.Write("sys/devices/system/node/node1a/cpulist", "0\n");
+    dir.Write("sys/devices/system/node/node99999999999/cpulist", "0\n");
+    dir.Write("sys/devices/system/node/node2000000000/cpulist", "0\n");
+    dir.Write("sys/devices/system/node/possible", "0-1\n");
+
+    PCpuTopology topology;
+    P_REQUIRE(PCpuTopology::LoadFromSysfs(dir.Path(), topology));
+    P_REQUIRE(topology.cpuCount == 6);
+    P_CHECK_EQ(topology.numaNode[0], int32_t(0));
+    P_CHECK_EQ(topology.numaNode[4], int32_t(1));
+    P_CHECK_EQ(topology.packageId[4], int32_t(1));
+    P_REQUIRE(topology.numaNodes.size() == 2);
+    P_CHECK_EQ(topology.numaNodes[0].ToList(), std::string("0-2"));
+    // Offline CPUs keep their node but are left out of the masks
+    P_CHECK_EQ(topology.numaNodes[1].ToList(), std::string("3,5"));
+}
@@ -0,0 +1,158 @@
+// DaemonTests.cpp - PDaemon over the fake backend on a Unix socket in a temporary directory: the line
+// protocol, windowed pipelining of large batches, refused writes, and the default endpoints.
+//
+#include "pch.h"
+#include "PTest.h"
+
+#ifndef _WIN32
+#include "PDaemon.h"
+#include "PFakePowerBackend.h"
+#include "PInformation.h"
+#include <sys/stat.h>
+
+namespace {
+
+// A daemon serving a socket from a background thread until the fixture goes away
+struct RunningDaemon {
+    RunningDaemon(size_t schemes, size_t subgroups, size_t settings) : info(backend), daemon(info, backend)
+    {
+        backend.Populate(schemes, subgroups, settings);
+        daemon.Start();
+        opened = listener.Open(endpoint);
+        server = std::thread([this] { daemon.Serve(listener, std::chrono::steady_clock::time_point::max()); });
+    }
+    ~RunningDaemon()
+    {
+        daemon.Stop();
+        server.join();
+    }
+
+    PTempDir dir;
+    std::wstring endpoint = (dir.Path() / "daemon.sock").wstring();
+    PFakePowerBackend backend;
+    PInformation info;
+    PDaemon daemon;
+    PIpcListener listener;
+    bool opened = false;
+    std::thread server;
+};
+
+} // namespace
+
+P_TEST(Daemon, AnswersGetSetAndDump)
+{
+    RunningDaemon running(2, 2, 3);
+    P_REQUIRE(running.opened);
+    PDaemonClient client;
+    P_REQUIRE(client.Connect(running.endpoint));
+
+    std::vector<std::vector<std::string>> responses;
+    P_REQUIRE(client.Exchange({ "PING", "GET\tScheme 1\tSetting 0.2", "SET\tScheme 1\tSetting 0.2\t7\t-",
+                                "GET\tScheme 1\tSetting 0.2", "GET\tScheme 9\tSetting 0.2", "DUMP\tScheme 0", "BOGUS" },
+                              responses));
+    P_REQUIRE(responses.size() == 7);
+    P_CHECK_EQ(responses[0][0], std::string("OK"));
+    P_CHECK_EQ(responses[1][0], std::string("OK\t2\t1"));
+    P_CHECK_EQ(responses[2][0], std::string("OK"));
+    // The write is visible to the next request, before any change notification
+    P_CHECK_EQ(responses[3][0], std::string("OK\t7\t1"));
+    P_CHECK_EQ(responses[4][0], std::string("ERR\tsetting not found"));
+    P_REQUIRE(responses[5].size() == 1 + 2 * 3);
+    P_CHECK_EQ(responses[5][0], std::string("OK\t6"));
+    P_CHECK_EQ(responses[5][1], std::string("Setting 0.0\tSynthetic setting 0.0\t0\t0"));
+    P_CHECK_EQ(responses[6][0], std::string("ERR\tunknown request"));
+}
+
+P_TEST(Daemon, LargeBatchIsExchangedInWindows)
+{
+    // About 400 KB of requests and 15 MB of responses: more than both socket buffers hold, so sending the
+    // whole batch before reading would leave client and daemon both blocked in write
+    RunningDaemon running(1, 2, 5);
+    P_REQUIRE(running.opened);
+    PDaemonClient client;
+    P_REQUIRE(client.Connect(running.endpoint));
+
+    std::vector<std::string> requests(30000, "DUMP\tScheme 0");
+    std::vector<std::vector<std::string>> responses;
+    P_REQUIRE(client.Exchange(requests, responses));
+    P_REQUIRE(responses.size() == requests.size());
+    P_CHECK(std::all_of(responses.begin(), responses.end(), [](const auto& response) { return response.size() == 11; }));
+
+    // The connection stays usable after the batch
+    P_REQUIRE(client.Exchange({ "PING" }, responses));
+    P_CHECK_EQ(responses[0][0], std::string("OK"));
+}
+
+P_TEST(Daemon, RefusesSetWithoutPermission)
+{
+    PFakePowerBackend backend;
+    backend.Populate(1, 1, 2);
+    PInformation info(backend);
+    PDaemon daemon(info, backend);
+    daemon.Start();
+
+    std::string response;
+    daemon.Handle("SET\tScheme 0\tSetting 0.1\t5\t5", response, false);
+    P_CHECK_EQ(response, std::string("ERR\tpermission denied\n"));
+    response.clear();
+    daemon.Handle("GET\tScheme 0\tSetting 0.1", response, false);
+    P_CHECK_EQ(response, std::string("OK\t1\t0\n"));
+    daemon.Stop();
+}
+
+P_TEST(Daemon, SharedSocketLetsEveryUserConnect)
+{
+    PTempDir dir;
+    struct stat info = {};
+    PIpcListener own, shared;
+    P_REQUIRE(own.Open((dir.Path() / "own.sock").wstring()));
+    P_REQUIRE(shared.Open((dir.Path() / "shared.sock").wstring(), true));
+    P_REQUIRE(stat((dir.Path() / "own.sock").c_str(), &info) == 0);
+    P_CHECK_EQ(info.st_mode & 0077, mode_t(0));
+    P_REQUIRE(stat((dir.Path() / "shared.sock").c_str(), &info) == 0);
+    P_CHECK_EQ(info.st_mode & 0666, mode_t(0666));
+
+    // Our own connection is the owner's: SET is allowed on it
+    std::unique_ptr<PIpcConnection> client = ConnectIpc((dir.Path() / "shared.sock").wstring());
+    P_REQUIRE(client);
+    std::unique_ptr<PIpcConnection> accepted = shared.Accept(std::chrono::seconds(5));
+    P_REQUIRE(accepted);
+    P_CHECK(accepted->PeerIsOwner());
+}
+
+P_TEST(Daemon, ClientsFallBackToTheSystemEndpoint)
+{
+    std::vector<std::wstring> endpoints = DefaultClientIpcEndpoints();
+    P_REQUIRE(!endpoints.empty());
+    P_CHECK(IsSystemIpcEndpoint(endpoints.back()));
+    // Whatever a daemon of this user listens on is tried first
+    P_CHECK(endpoints.front() == DefaultIpcEndpoint());
+    P_CHECK(!IsSystemIpcEndpoint(L"/tmp/PowerInformation-1000/PowerInformation.sock"));
+}
+
+P_TEST(Daemon, OnlyPrivateDirectoriesAreTrusted)
+{
+    PTempDir dir;
+    std::filesystem::path directory = dir.Path() / "private";
+    P_REQUIRE(mkdir(directory.c_str(), 0700) == 0);
+    P_CHECK(IsPrivateIpcDirectory(directory.wstring()));
+
+    // Open to the group, a symlink to a private directory, a file, and a missing path
+    P_REQUIRE(chmod(directory.c_str(), 0750) == 0);
+    P_CHECK(!IsPrivateIpcDirectory(directory.wstring()));
+    P_REQUIRE(chmod(directory.c_str(), 0700) == 0);
+    std::filesystem::create_directory_symlink(directory, dir.Path() / "link");
+    P_CHECK(!IsPrivateIpcDirectory((dir.Path() / "link").wstring()));
+    dir.Write("file", "");
+    P_REQUIRE(chmod((dir.Path() / "file").c_str(), 0600) == 0);
+    P_CHECK(!IsPrivateIpcDirectory((dir.Path() / "file").wstring()));
+    P_CHECK(!IsPrivateIpcDirectory((dir.Path() / "missing").wstring()));
+
+    // Another user's directory, which only root can create here
+    if (geteuid() == 0) {
+        P_REQUIRE(chown(directory.c_str(), 65534, 65534) == 0);
+        P_CHECK(!IsPrivateIpcDirectory(directory.wstring()));
+    }
+}
+
+#endif
@@ -0,0 +1,141 @@
+// DesiredStateTests.cpp - PDesiredState manifest parsing and the reconcile over the fake backend: a
+// converged plan, partial drift, unreadable and unresolved values, and the result of a failed activation.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PDesiredState.h"
+#include "PFakePowerBackend.h"
+
+P_TEST(DesiredState, ParsesManifest)
+{
+    PDesiredState desired;
+    size_t errorLine = 0;
+    P_REQUIRE(PDesiredState::FromText("# comment\r\n"
+                                      "\n"
+                                      "Scheme 0\tSetting 0.1\t5\t-\r\n"
+                                      "Back\\\\slash\tTab\\tin name\t-\t7\n"
+                                      "Scheme 1\tSetting 0.0\t1\t2",
+                                      desired, errorLine));
+    P_CHECK_EQ(errorLine, size_t(0));
+    P_REQUIRE(desired.values.size() == 4);
+    P_CHECK(desired.values[0].profileName == L"Scheme 0" && desired.values[0].settingName == L"Setting 0.1");
+    P_CHECK(desired.values[0].ac);
+    P_CHECK_EQ(desired.values[0].value, DWORD(5));
+    P_CHECK_EQ(desired.values[0].line, size_t(3));
+    // "-" leaves AC unmanaged; escapes are undone
+    P_CHECK(desired.values[1].profileName == L"Back\\slash" && desired.values[1].settingName == L"Tab\tin name");
+    P_CHECK(!desired.values[1].ac);
+    P_CHECK_EQ(desired.values[1].value, DWORD(7));
+    P_CHECK(desired.values[2].ac && !desired.values[3].ac);
+    P_CHECK_EQ(desired.values[3].line, size_t(5));
+
+    for (const char* bad : { "a\tb\t1\n", "a\tb\t1\t2\t3\n", "\tb\t1\t2\n", "a\tb\tx\t2\n", "a\tb\t1\t-1\n", "a\tb\t1\t\n" }) {
+        P_CHECK(!PDesiredState::FromText(std::string("# ok\n") + bad, desired, errorLine));
+        P_CHECK_EQ(errorLine, size_t(2));
+    }
+}
+
+P_TEST(DesiredState, MatchingValuesWriteNothing)
+{
+    PFakePowerBackend backend;
+    backend.Populate(2, 1, 3);
+    PInformation info(backend);
+    PDesiredState desired;
+    size_t errorLine = 0;
+    P_REQUIRE(PDesiredState::FromText("Scheme 0\tSetting 0.1\t1\t0\nScheme 1\tSetting 0.2\t2\t1\n", desired, errorLine));
+    backend.TakeJournal();
+
+    PReconcilePlan plan = PlanReconcile(info, desired);
+    P_CHECK(plan.Converged());
+    P_CHECK_EQ(plan.unchanged, size_t(4));
+    P_CHECK(ApplyReconcile(info, plan) == PSetResult::Applied);
+    // Not even an activation
+    P_CHECK(backend.TakeJournal().empty());
+}
+
+P_TEST(DesiredState, PartialDriftWritesOnlyTheDifference)
+{
+    PFakePowerBackend backend;
+    backend.Populate(2, 1, 3);
+    PInformation info(backend);
+    PDesiredState desired;
+    size_t errorLine = 0;
+    // A later line for the same setting wins
+    P_REQUIRE(PDesiredState::FromText("Scheme 1\tSetting 0.0\t3\t-\n"
+                                      "Scheme 1\tSetting 0.0\t0\t1\n"
+                                      "Scheme 1\tSetting 0.2\t2\t9\n"
+                                      "Scheme 0\tSetting 0.1\t1\t0\n",
+                                      desired, errorLine));
+    backend.TakeJournal();
+
+    PReconcilePlan plan = PlanReconcile(info, desired);
+    P_REQUIRE(plan.writes.size() == 1);
+    P_CHECK(plan.writes[0].write.settingName == L"Setting 0.2" && !plan.writes[0].write.ac);
+    P_CHECK_EQ(plan.writes[0].current, DWORD(1));
+    P_CHECK_EQ(plan.writes[0].line, size_t(3));
+    P_CHECK_EQ(plan.unchanged, size_t(5));
+    P_CHECK_EQ(plan.ProfileCount(), size_t(1));
+
+    P_REQUIRE(ApplyReconcile(info, plan) == PSetResult::Applied);
+    std::vector<std::wstring> expected = { L"write Scheme 1/Setting 0.2 DC 9", L"activate Scheme 1" };
+    P_CHECK(backend.TakeJournal() == expected);
+    P_CHECK(PlanReconcile(info, desired).Converged());
+}
+
+P_TEST(DesiredState, UnreadableValueIsReportedNotWritten)
+{
+    PFakePowerBackend backend;
+    backend.Populate(1, 1, 3);
+    PInformation info(backend);
+    backend.FailSetting(L"Setting 0.1", true, false);
+    PDesiredState desired;
+    size_t errorLine = 0;
+    P_REQUIRE(PDesiredState::FromText("Scheme 0\tSetting 0.1\t8\t-\nScheme 0\tSetting 0.2\t8\t-\n", desired, errorLine));
+    backend.TakeJournal();
+
+    PReconcilePlan plan = PlanReconcile(info, desired);
+    P_REQUIRE(plan.unreadable.size() == 1);
+    P_CHECK(plan.unreadable[0]->settingName == L"Setting 0.1");
+    P_CHECK(plan.unresolved.empty());
+    P_REQUIRE(plan.writes.size() == 1);
+    P_CHECK(plan.writes[0].write.settingName == L"Setting 0.2");
+    P_CHECK(!plan.Converged());
+
+    P_REQUIRE(ApplyReconcile(info, plan) == PSetResult::Applied);
+    std::vector<std::wstring> expected = { L"write Scheme 0/Setting 0.2 AC 8", L"activate Scheme 0" };
+    P_CHECK(backend.TakeJournal() == expected);
+}
+
+P_TEST(DesiredState, UnresolvedNameIsRefused)
+{
+    PFakePowerBackend backend;
+    backend.Populate(1, 1, 2);
+    PInformation info(backend);
+    PDesiredState desired;
+    size_t errorLine = 0;
+    P_REQUIRE(PDesiredState::FromText("Scheme 0\tSetting 0.1\t8\t8\nScheme 0\tMissing\t1\t1\n", desired, errorLine));
+    backend.TakeJournal();
+
+    PReconcilePlan plan = PlanReconcile(info, desired);
+    // Reported once per line, not once per AC/DC value
+    P_REQUIRE(plan.unresolved.size() == 1);
+    P_CHECK_EQ(plan.unresolved[0]->line, size_t(2));
+    P_CHECK(ApplyReconcile(info, plan) == PSetResult::NotApplied);
+    P_CHECK(backend.TakeJournal().empty());
+}
+
+P_TEST(DesiredState, FailedActivationKeepsTheWrites)
+{
+    PFakePowerBackend backend;
+    backend.Populate(1, 1, 2);
+    PInformation info(backend);
+    backend.FailActivation();
+    PDesiredState desired;
+    size_t errorLine = 0;
+    P_REQUIRE(PDesiredState::FromText("Scheme 0\tSetting 0.1\t6\t-\n", desired, errorLine));
+
+    PReconcilePlan plan = PlanReconcile(info, desired);
+    P_CHECK(ApplyReconcile(info, plan) == PSetResult::NotActivated);
+    backend.ClearFailures();
+    P_CHECK(PlanReconcile(info, desired).Converged());
+}
@@ -0,0 +1,38 @@
+// FieldsTests.cpp - EscapeField/UnescapeField/SplitFields shared by the tab-separated formats.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PFields.h"
+
+P_TEST(Fields, EscapeRoundTrips)
+{
+    P_CHECK_EQ(EscapeField("plain"), std::string("plain"));
+    P_CHECK_EQ(EscapeField("a\tb\nc\rd\\e"), std::string("a\\tb\\nc\\rd\\\\e"));
+    P_CHECK_EQ(EscapeField(""), std::string(""));
+
+    for (std::string_view text : { "", "\\", "\\t literal", "tab\there\n", "\r\n\t\\\\", "trailing\\" }) {
+        std::string escaped = EscapeField(text);
+        P_CHECK(escaped.find_first_of("\t\n\r") == std::string::npos);
+        P_CHECK_EQ(UnescapeField(escaped), std::string(text));
+    }
+}
+
+P_TEST(Fields, UnescapeKeepsUnknownAndTrailingBackslashes)
+{
+    P_CHECK_EQ(UnescapeField("\\q"), std::string("q"));
+    P_CHECK_EQ(UnescapeField("end\\"), std::string("end\\"));
+    P_CHECK_EQ(UnescapeField("\\\\t"), std::string("\\t"));
+}
+
+P_TEST(Fields, SplitKeepsEmptyFields)
+{
+    P_CHECK(SplitFields("a\tb\tc") == std::vector<std::string_view>({ "a", "b", "c" }));
+    P_CHECK(SplitFields("") == std::vector<std::string_view>({ "" }));
+    P_CHECK(SplitFields("\t") == std::vector<std::string_view>({ "", "" }));
+    P_CHECK(SplitFields("a\t\tb\t") == std::vector<std::string_view>({ "a", "", "b", "" }));
+    // Escaped tabs stay inside their field
+    std::string line = EscapeField("x\ty") + "\t" + EscapeField("z");
+    std::vector<std::string_view> fields = SplitFields(line);
+    P_REQUIRE(fields.size() == 2);
+    P_CHECK_EQ(UnescapeField(fields[0]), std::string("x\ty"));
+}
@@ -0,0 +1,224 @@
+// HexBase64Tests.cpp - PHexBase64 codecs: RFC 4648 vectors, every invalid character inside a vector block,
+// random round trips against a byte-at-a-time reference, padding rules, and the chunked codecs.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PHexBase64.h"
+#include <cstring>
+#include <random>
+
+namespace {
+
+const char* Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::span<const uint8_t> Bytes(std::string_view text)
+{
+    return { reinterpret_cast<const uint8_t*>(text.data()), text.size() };
+}
+
+// One character at a time, as StringUtil did before PHexBase64
+std::string ReferenceHex(const std::vector<uint8_t>& data)
+{
+    const char* digits = "0123456789abcdef";
+    std::string out;
+    for (uint8_t byte : data) {
+        out.push_back(digits[byte >> 4]);
+        out.push_back(digits[byte & 0xF]);
+    }
+    return out;
+}
+
+std::string ReferenceBase64(const std::vector<uint8_t>& data)
+{
+    std::string out;
+    for (size_t i = 0; i < data.size(); i += 3) {
+        size_t count = std::min<size_t>(data.size() - i, 3);
+        uint32_t group = uint32_t(data[i]) << 16;
+        if (count > 1)
+            group |= uint32_t(data[i + 1]) << 8;
+        if (count > 2)
+            group |= data[i + 2];
+        out.push_back(Alphabet[group >> 18]);
+        out.push_back(Alphabet[(group >> 12) & 63]);
+        out.push_back(count > 1 ? Alphabet[(group >> 6) & 63] : '=');
+        out.push_back(count > 2 ? Alphabet[group & 63] : '=');
+    }
+    return out;
+}
+
+} // namespace
+
+P_TEST(HexBase64, Rfc4648Vectors)
+{
+    const char* plain[] = { "", "f", "fo", "foo", "foob", "fooba", "foobar" };
+    const char* base64[] = { "", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy" };
+    const char* hex[] = { "", "66", "666f", "666f6f", "666f6f62", "666f6f6261", "666f6f626172" };
+    for (size_t i = 0; i < 7; i++) {
+        std::string encoded;
+        EncodeBase64(Bytes(plain[i]), encoded);
+        P_CHECK_EQ(encoded, std::string(base64[i]));
+        encoded.clear();
+        EncodeHex(Bytes(plain[i]), encoded);
+        P_CHECK_EQ(encoded, std::string(hex[i]));
+
+        uint8_t decoded[8];
+        size_t written = 0;
+        P_CHECK(DecodeBase64(base64[i], decoded, written));
+        P_CHECK_EQ(std::string(reinterpret_cast<char*>(decoded), written), std::string(plain[i]));
+        P_CHECK(DecodeHex(hex[i], decoded));
+        P_CHECK_EQ(std::string(reinterpret_cast<char*>(decoded), std::strlen(plain[i])), std::string(plain[i]));
+    }
+}
+
+P_TEST(HexBase64, EveryInvalidCharacterInsideABlock)
+{
+    // Offsets 37 and 41 fall in the middle of the 16/24/32-byte vector blocks
+    std::vector<uint8_t> out(128);
+    for (int c = 0; c < 256; c++) {
+        std::string text(128, 'A');
+        text[37] = static_cast<char>(c);
+        size_t written = 0, position = SIZE_MAX;
+        bool valid = c != 0 && std::strchr(Alphabet, c) != nullptr;
+        bool ok = DecodeBase64(text, out.data(), written, &position);
+        if (ok != valid || (!ok && position != 37)) {
+            PTestFail(__FILE__, __LINE__, "Base64 character " + std::to_string(c));
+            return;
+        }
+
+        std::string digits(128, '0');
+        digits[41] = static_cast<char>(c);
+        valid = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+        ok = DecodeHex(digits, out.data(), &position);
+        if (ok != valid || (!ok && position != 41)) {
+            PTestFail(__FILE__, __LINE__, "hex character " + std::to_string(c));
+            return;
+        }
+    }
+}
+
+P_TEST(HexBase64, RandomDataMatchesTheReference)
+{
+    std::mt19937 rng(22);
+    for (int round = 0; round < 3000; round++) {
+        std::vector<uint8_t> data(rng() % 300);
+        for (auto& byte : data)
+            byte = static_cast<uint8_t>(rng());
+        std::vector<uint8_t> decoded(data.size() + 4);
+
+        std::string hex;
+        EncodeHex(data, hex);
+        std::string base64;
+        EncodeBase64(data, base64);
+        bool ok = hex == ReferenceHex(data) && base64 == ReferenceBase64(data);
+
+        // Mixed-case hex and unpadded Base64 decode to the same bytes
+        for (auto& c : hex)
+            if (rng() % 2)
+                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        ok = ok && DecodeHex(hex, decoded.data()) && std::equal(data.begin(), data.end(), decoded.begin());
+        size_t written = 0;
+        ok = ok && DecodeBase64(base64, decoded.data(), written) && written == data.size() &&
+             std::equal(data.begin(), data.end(), decoded.begin());
+        while (!base64.empty() && base64.back() == '=')
+            base64.pop_back();
+        ok = ok && DecodeBase64(base64, decoded.data(), written) && written == data.size() &&
+             std::equal(data.begin(), data.end(), decoded.begin());
+        if (!ok) {
+            PTestFail(__FILE__, __LINE__, "mismatch for " + std::to_string(data.size()) + " bytes");
+            return;
+        }
+    }
+}
+
+P_TEST(HexBase64, PaddingAndLengthRules)
+{
+    uint8_t out[16];
+    size_t written = 0, position = 0;
+    for (const char* text : { "QQ==", "QUI=", "QUJD", "QQ", "QUI" })
+        P_CHECK(DecodeBase64(text, out, written));
+    for (const char* text : { "Q===", "QQ=A", "QQ==QUJD", "=QQQ", "Q", "QQ=", "QUJDQ" })
+        P_CHECK(!DecodeBase64(text, out, written));
+
+    // Complete groups before the error are still written
+    P_CHECK(!DecodeBase64("QUJDQUJD!UJD", out, written, &position));
+    P_CHECK_EQ(position, size_t(8));
+    P_CHECK_EQ(written, size_t(6));
+
+    P_CHECK(!DecodeHex("abc", out, &position));
+    P_CHECK_EQ(position, size_t(2));
+}
+
+P_TEST(HexBase64, ChunkedCodecsMatchOneShot)
+{
+    std::mt19937 rng(64);
+    for (int round = 0; round < 500; round++) {
+        std::vector<uint8_t> data(rng() % 400);
+        for (auto& byte : data)
+            byte = static_cast<uint8_t>(rng());
+        std::string base64, hex;
+        EncodeBase64(data, base64);
+        EncodeHex(data, hex);
+
+        PBase64Encoder encoder;
+        std::string streamed;
+        char chars[PBase64Encoder::MaxOutput(64)];
+        for (size_t at = 0; at < data.size();) {
+            size_t size = std::min<size_t>(data.size() - at, rng() % 64);
+            streamed.append(chars, encoder.Feed({ data.data() + at, size }, chars));
+            at += size;
+        }
+        streamed.append(chars, encoder.Finish(chars));
+
+        PBase64Decoder base64Decoder;
+        PHexDecoder hexDecoder;
+        std::vector<uint8_t> fromBase64, fromHex;
+        uint8_t bytes[PBase64Decoder::MaxOutput(96)];
+        size_t written = 0;
+        bool ok = streamed == base64;
+        for (size_t at = 0; ok && at < base64.size();) {
+            size_t size = std::min<size_t>(base64.size() - at, rng() % 96);
+            ok = base64Decoder.Feed(std::string_view(base64).substr(at, size), bytes, written);
+            fromBase64.insert(fromBase64.end(), bytes, bytes + written);
+            at += size;
+        }
+        ok = ok && base64Decoder.Finish(bytes, written);
+        fromBase64.insert(fromBase64.end(), bytes, bytes + written);
+        for (size_t at = 0; ok && at < hex.size();) {
+            size_t size = std::min<size_t>(hex.size() - at, rng() % 96);
+            ok = hexDecoder.Feed(std::string_view(hex).substr(at, size), bytes, written);
+            fromHex.insert(fromHex.end(), bytes, bytes + written);
+            at += size;
+        }
+        ok = ok && hexDecoder.Finish() && fromBase64 == data && fromHex == data;
+        if (!ok) {
+            PTestFail(__FILE__, __LINE__, "chunked mismatch for " + std::to_string(data.size()) + " bytes");
+            return;
+        }
+    }
+}
+
+P_TEST(HexBase64, ChunkedDecoderReportsTheTotalOffset)
+{
+    std::string text = "QUJDQUJDQUJDQUJD";
+    text[13] = '*';
+    PBase64Decoder decoder;
+    uint8_t bytes[PBase64Decoder::MaxOutput(5)];
+    size_t written = 0;
+    bool ok = true;
+    for (size_t at = 0; ok && at < text.size(); at += 5)
+        ok = decoder.Feed(std::string_view(text).substr(at, 5), bytes, written);
+    P_CHECK(!ok);
+    P_CHECK_EQ(decoder.ErrorPosition(), uint64_t(13));
+
+    PHexDecoder hexDecoder;
+    P_CHECK(hexDecoder.Feed("0a1", bytes, written));
+    P_CHECK_EQ(written, size_t(1));
+    P_CHECK(!hexDecoder.Feed("bz", bytes, written));
+    P_CHECK_EQ(hexDecoder.ErrorPosition(), uint64_t(4));
+    P_CHECK(!hexDecoder.Finish());
+    // Finish starts over; an odd digit left at the end fails
+    P_CHECK(hexDecoder.Feed("ab", bytes, written));
+    P_CHECK(hexDecoder.Finish());
+    P_CHECK(hexDecoder.Feed("f", bytes, written));
+    P_CHECK(!hexDecoder.Finish());
+}
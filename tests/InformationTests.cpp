@@ -0,0 +1,100 @@
+// InformationTests.cpp - PInformation streaming enumeration: the parallel VisitSettings reports exactly
+// what the serial walk reports, honours OnScheme/Accept filtering and stops early.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PFakePowerBackend.h"
+#include "PInformation.h"
+
+namespace {
+
+// Records every callback as one line; skips odd schemes and settings whose name ends in "1"
+class RecordingVisitor : public PSettingVisitor
+{
+public:
+    explicit RecordingVisitor(size_t stopAfter = SIZE_MAX) : stopAfter(stopAfter) {}
+
+    bool OnScheme(const GUID& /*scheme*/, std::wstring_view profileName) override {
+        bool keep = profileName.back() % 2 == 0;
+        schemes.push_back(std::wstring(profileName) + (keep ? L"" : L" (skipped)"));
+        return keep;
+    }
+    bool Accept(const GUID& /*setting*/, std::wstring_view name) override {
+        return name.back() != L'1';
+    }
+    bool OnSetting(const PSettingView& setting) override {
+        settings.push_back(std::wstring(setting.profileName) + L"|" + std::wstring(setting.name) + L"|" +
+                           std::wstring(setting.description) + L"|" + std::to_wstring(setting.acValue) + L"|" +
+                           std::to_wstring(setting.dcValue) + (setting.acOk && setting.dcOk ? L"" : L"|error"));
+        return settings.size() < stopAfter;
+    }
+
+    std::vector<std::wstring> schemes;
+    std::vector<std::wstring> settings;
+
+private:
+    size_t stopAfter;
+};
+
+} // namespace
+
+P_TEST(Information, ParallelVisitMatchesSerial)
+{
+    PFakePowerBackend backend;
+    backend.Populate(5, 6, 7);
+    PInformation info(backend);
+
+    RecordingVisitor serial;
+    P_CHECK(info.VisitSettings(serial));
+    P_CHECK_EQ(serial.schemes.size(), 5u);
+    P_CHECK(!serial.settings.empty());
+    for (unsigned threads : { 2u, 3u, 8u }) {
+        RecordingVisitor parallel;
+        P_CHECK(info.VisitSettings(parallel, nullptr, threads));
+        P_CHECK(parallel.schemes == serial.schemes);
+        P_CHECK(parallel.settings == serial.settings);
+    }
+}
+
+P_TEST(Information, ParallelVisitOneScheme)
+{
+    PFakePowerBackend backend;
+    backend.Populate(3, 4, 5);
+    PInformation info(backend);
+    GUID scheme = {};
+    P_REQUIRE(backend.EnumerateScheme(2, scheme) == ERROR_SUCCESS);
+
+    RecordingVisitor serial, parallel;
+    info.VisitSettings(serial, &scheme);
+    info.VisitSettings(parallel, &scheme, 4);
+    P_CHECK(parallel.schemes == std::vector<std::wstring>({ L"Scheme 2" }));
+    P_CHECK(parallel.settings == serial.settings);
+}
+
+P_TEST(Information, ParallelVisitStopsEarly)
+{
+    PFakePowerBackend backend;
+    backend.Populate(4, 4, 4);
+    PInformation info(backend);
+
+    RecordingVisitor serial(5), parallel(5);
+    P_CHECK(!info.VisitSettings(serial));
+    P_CHECK(!info.VisitSettings(parallel, nullptr, 4));
+    P_CHECK(parallel.settings == serial.settings);
+}
+
+P_TEST(Information, ParallelVisitSkipsRejectedReads)
+{
+    PFakePowerBackend backend;
+    backend.Populate(2, 2, 10);
+    PInformation info(backend);
+
+    // Scheme 1 is skipped by OnScheme: only its name is read
+    RecordingVisitor serial, parallel;
+    backend.ResetCallCount();
+    info.VisitSettings(serial);
+    uint64_t serialCalls = backend.CallCount();
+    backend.ResetCallCount();
+    info.VisitSettings(parallel, nullptr, 4);
+    P_CHECK_EQ(backend.CallCount(), serialCalls);
+}
@@ -0,0 +1,173 @@
+// LinuxPowerBackendTests.cpp - PLinuxPowerBackend over a fixture sysfs tree: live-scheme semantics,
+// generation, and Apply/Watch on top of it.
+//
+#include "pch.h"
+#include "PTest.h"
+
+#ifndef _WIN32
+#include "PDesiredState.h"
+#include "PInformation.h"
+#include "PLinuxPowerBackend.h"
+#include "PSettingTracker.h"
+
+namespace {
+
+const char* CpufreqDir = "sys/devices/system/cpu/cpufreq/";
+
+// Three platform profiles, "balanced" active, two cpufreq policies running powersave
+void WriteFixture(const PTempDir& dir)
+{
+    dir.Write("sys/firmware/acpi/platform_profile", "balanced\n");
+    dir.Write("sys/firmware/acpi/platform_profile_choices", "low-power balanced performance\n");
+    for (const char* policy : { "policy0", "policy1" }) {
+        std::string base = std::string(CpufreqDir) + policy + "/";
+        dir.Write(base + "scaling_governor", "powersave\n");
+        dir.Write(base + "scaling_available_governors", "performance powersave\n");
+        dir.Write(base + "energy_performance_preference", "balance_performance\n");
+        dir.Write(base + "energy_performance_available_preferences", "default performance balance_performance balance_power power\n");
+    }
+}
+
+// Number of subgroups each scheme enumerates, in scheme order
+std::vector<int> SubgroupCounts(PPowerBackend& backend)
+{
+    std::vector<int> counts;
+    GUID scheme = {}, subgroup = {};
+    for (DWORD s = 0; backend.EnumerateScheme(s, scheme) == ERROR_SUCCESS; s++) {
+        int count = 0;
+        while (backend.EnumerateSubgroup(scheme, count, subgroup) == ERROR_SUCCESS)
+            count++;
+        counts.push_back(count);
+    }
+    return counts;
+}
+
+} // namespace
+
+P_TEST(LinuxPowerBackend, SettingsOnlyUnderActiveScheme)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    PLinuxPowerBackend backend(dir.Path());
+    P_CHECK(SubgroupCounts(backend) == std::vector<int>({ 0, 1, 0 }));
+
+    GUID performance = {};
+    P_REQUIRE(backend.EnumerateScheme(2, performance) == ERROR_SUCCESS);
+    DWORD type = 0, value = 0;
+    P_CHECK_EQ(backend.ReadValue(performance, PLinuxPowerBackend::ProcessorSubgroup, PLinuxPowerBackend::ScalingGovernorSetting,
+                                 true, type, value), static_cast<DWORD>(ERROR_FILE_NOT_FOUND));
+}
+
+P_TEST(LinuxPowerBackend, WriteToInactiveSchemeRejected)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    PLinuxPowerBackend backend(dir.Path());
+    PInformation info(backend);
+
+    P_CHECK(!info.SetPowerSettingValue(L"performance", L"Scaling governor", 0, true));
+    P_CHECK_EQ(dir.Read(std::string(CpufreqDir) + "policy0/scaling_governor"), std::string("powersave\n"));
+    P_CHECK_EQ(dir.Read("sys/firmware/acpi/platform_profile"), std::string("balanced\n"));
+
+    P_CHECK(info.SetPowerSettingValue(L"balanced", L"Scaling governor", 0, true));
+    P_CHECK_EQ(dir.Read(std::string(CpufreqDir) + "policy0/scaling_governor"), std::string("performance"));
+    P_CHECK_EQ(dir.Read(std::string(CpufreqDir) + "policy1/scaling_governor"), std::string("performance"));
+    DWORD ac = 9, dc = 9;
+    P_CHECK(info.GetPowerSettingValue(L"balanced", L"Scaling governor", true, ac));
+    P_CHECK(info.GetPowerSettingValue(L"balanced", L"Scaling governor", false, dc));
+    P_CHECK_EQ(ac, 0u);
+    P_CHECK_EQ(dc, 0u);
+}
+
+P_TEST(LinuxPowerBackend, ProfileSwitchMovesSettings)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    PLinuxPowerBackend backend(dir.Path());
+    PInformation info(backend);
+    uint64_t generation = backend.GetGeneration();
+    P_CHECK_EQ(backend.GetGeneration(), generation);
+
+    GUID performance = {};
+    P_REQUIRE(backend.EnumerateScheme(2, performance) == ERROR_SUCCESS);
+    P_REQUIRE(backend.SetActiveScheme(performance) == ERROR_SUCCESS);
+    P_CHECK(backend.GetGeneration() != generation);
+    P_CHECK(SubgroupCounts(backend) == std::vector<int>({ 0, 0, 1 }));
+
+    // The catalog follows the generation, so names resolve under the new profile only
+    DWORD value = 0;
+    P_CHECK(info.GetPowerSettingValue(L"performance", L"Scaling governor", true, value));
+    P_CHECK(!info.GetPowerSettingValue(L"balanced", L"Scaling governor", true, value));
+}
+
+P_TEST(LinuxPowerBackend, ApplyConverges)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    PLinuxPowerBackend backend(dir.Path());
+    PInformation info(backend);
+
+    PDesiredState desired;
+    size_t errorLine = 0;
+    P_REQUIRE(PDesiredState::FromText("balanced\tScaling governor\t0\t0\n"
+                                      "balanced\tEnergy performance preference\t4\t-\n", desired, errorLine));
+    PReconcilePlan plan = PlanReconcile(info, desired);
+    P_CHECK(plan.unresolved.empty());
+    P_CHECK_EQ(plan.writes.size(), 3u);
+    P_REQUIRE(ApplyReconcile(info, plan) == PSetResult::Applied);
+    P_CHECK(PlanReconcile(info, desired).Converged());
+    P_CHECK_EQ(dir.Read(std::string(CpufreqDir) + "policy1/energy_performance_preference"), std::string("power"));
+
+    // A profile that is not live cannot be managed; it stays unresolved instead of fighting the live one
+    P_REQUIRE(PDesiredState::FromText("performance\tScaling governor\t1\t1\n", desired, errorLine));
+    plan = PlanReconcile(info, desired);
+    P_CHECK(!plan.unresolved.empty());
+    P_CHECK(plan.writes.empty());
+}
+
+P_TEST(LinuxPowerBackend, ExternalWriteIsOneChange)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    PLinuxPowerBackend backend(dir.Path());
+    PInformation info(backend);
+    PSettingTracker tracker(info, backend);
+    tracker.Capture();
+
+    dir.Write(std::string(CpufreqDir) + "policy0/scaling_governor", "performance\n");
+    std::vector<PSettingChange> changes;
+    tracker.Refresh(changes);
+    P_REQUIRE(changes.size() == 1);
+    P_CHECK(changes[0].kind == PSettingChange::Kind::Value);
+    P_CHECK_EQ(changes[0].profileName, std::wstring(L"balanced"));
+    P_CHECK_EQ(changes[0].newAc, 0u);
+
+    changes.clear();
+    tracker.Refresh(changes);
+    P_CHECK(changes.empty());
+}
+
+P_TEST(LinuxPowerBackend, PoliciesInNumericOrder)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    for (const char* policy : { "policy10", "policy2" }) {
+        std::string base = std::string(CpufreqDir) + policy + "/";
+        dir.Write(base + "scaling_governor", "powersave\n");
+        dir.Write(base + "scaling_available_governors", "performance powersave\n");
+    }
+    // Not cpufreq policies; must be skipped rather than throw
+    dir.Write(std::string(CpufreqDir) + "policyX/scaling_governor", "powersave\n");
+    dir.Write(std::string(CpufreqDir) + "policy/scaling_governor", "powersave\n");
+    dir.Write(std::string(CpufreqDir) + "boost", "1\n");
+
+    PLinuxPowerBackend backend(dir.Path());
+    std::vector<std::string> governors;
+    for (const auto& path : backend.ChangeSources()) {
+        if (path.filename() == "scaling_governor")
+            governors.push_back(path.parent_path().filename().string());
+    }
+    P_CHECK(governors == std::vector<std::string>({ "policy0", "policy1", "policy2", "policy10" }));
+}
+
+#endif
@@ -0,0 +1,252 @@
+// MetadataCacheTests.cpp - PMetadataCache file format, reader validation and invalidation, and the
+// PCachedPowerBackend decorator over PFakePowerBackend.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PFakePowerBackend.h"
+#include "PMetadataCache.h"
+#include <fstream>
+#include <thread>
+
+#ifndef _WIN32
+#include "PLinuxPowerBackend.h"
+#endif
+
+namespace {
+
+GUID TestGuid(uint32_t data1)
+{
+    GUID guid = {};
+    guid.Data1 = data1;
+    return guid;
+}
+
+// Overwrite bytes of a file in place
+void Patch(const std::filesystem::path& path, size_t offset, const void* bytes, size_t length)
+{
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(offset);
+    file.write(static_cast<const char*>(bytes), length);
+}
+
+// Save a small cache with the given fingerprint
+void WriteCache(const std::filesystem::path& path, uint64_t fingerprint)
+{
+    PMetadataCache cache(path);
+    cache.Open(fingerprint);
+    cache.Record(PMetadataCache::Kind::Setting, TestGuid(2), L"Setting two", L"");
+    cache.Record(PMetadataCache::Kind::Setting, TestGuid(1), L"Setting one", L"Desc é中");
+    cache.Record(PMetadataCache::Kind::Subgroup, TestGuid(1), L"Group", L"Group description");
+    P_REQUIRE(cache.Save());
+}
+
+} // namespace
+
+P_TEST(MetadataCache, RoundTrip)
+{
+    PTempDir dir;
+    std::filesystem::path path = dir.Path() / "meta.bin";
+    WriteCache(path, 42);
+
+    PMetadataCache cache(path);
+    P_REQUIRE(cache.Open(42));
+    P_CHECK(!cache.IsDirty());
+    std::wstring_view name, description;
+    P_REQUIRE(cache.Lookup(PMetadataCache::Kind::Setting, TestGuid(1), name, description));
+    P_CHECK_EQ(name, std::wstring_view(L"Setting one"));
+    P_CHECK(description == L"Desc é中");
+    P_REQUIRE(cache.Lookup(PMetadataCache::Kind::Setting, TestGuid(2), name, description));
+    P_CHECK(description.empty());
+    // Same GUID, other kind: the key is (kind, GUID)
+    P_REQUIRE(cache.Lookup(PMetadataCache::Kind::Subgroup, TestGuid(1), name, description));
+    P_CHECK_EQ(name, std::wstring_view(L"Group"));
+    P_CHECK(!cache.Lookup(PMetadataCache::Kind::Subgroup, TestGuid(2), name, description));
+}
+
+P_TEST(MetadataCache, SaveMergesAndLeavesNoTempFiles)
+{
+    PTempDir dir;
+    std::filesystem::path path = dir.Path() / "meta.bin";
+    WriteCache(path, 7);
+    {
+        PMetadataCache cache(path);
+        P_REQUIRE(cache.Open(7));
+        cache.Record(PMetadataCache::Kind::Setting, TestGuid(3), L"Setting three", L"");
+        P_REQUIRE(cache.Save());
+    }
+    PMetadataCache cache(path);
+    P_REQUIRE(cache.Open(7));
+    std::wstring_view name, description;
+    P_CHECK(cache.Lookup(PMetadataCache::Kind::Setting, TestGuid(1), name, description));
+    P_CHECK(cache.Lookup(PMetadataCache::Kind::Setting, TestGuid(3), name, description));
+
+    size_t files = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir.Path())) {
+        (void)entry;
+        files++;
+    }
+    P_CHECK_EQ(files, 1u);
+}
+
+P_TEST(MetadataCache, RejectsStaleAndCorruptFiles)
+{
+    PTempDir dir;
+    std::filesystem::path path = dir.Path() / "meta.bin";
+    WriteCache(path, 42);
+    std::wstring_view name, description;
+    {
+        PMetadataCache cache(path);
+        P_CHECK(!cache.Open(43));
+        P_CHECK(!cache.Lookup(PMetadataCache::Kind::Setting, TestGuid(1), name, description));
+    }
+
+    // Header: magic[8], version, wcharSize, fingerprint, entryCount, ...
+    std::filesystem::path copy = dir.Path() / "copy.bin";
+    std::filesystem::copy_file(path, copy);
+    Patch(copy, 0, "X", 1);
+    P_CHECK(!PMetadataCache(copy).Open(42));
+
+    std::filesystem::copy_file(path, copy, std::filesystem::copy_options::overwrite_existing);
+    uint32_t version = PMetadataCache::FormatVersion + 1;
+    Patch(copy, 8, &version, sizeof(version));
+    P_CHECK(!PMetadataCache(copy).Open(42));
+
+    std::filesystem::copy_file(path, copy, std::filesystem::copy_options::overwrite_existing);
+    uint64_t entryCount = 1ull << 40;
+    Patch(copy, 24, &entryCount, sizeof(entryCount));
+    P_CHECK(!PMetadataCache(copy).Open(42));
+
+    std::filesystem::copy_file(path, copy, std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::resize_file(copy, std::filesystem::file_size(copy) - 4);
+    P_CHECK(!PMetadataCache(copy).Open(42));
+
+    std::filesystem::resize_file(copy, 10);
+    P_CHECK(!PMetadataCache(copy).Open(42));
+}
+
+P_TEST(MetadataCache, ConcurrentSavesStayValid)
+{
+    PTempDir dir;
+    std::filesystem::path path = dir.Path() / "meta.bin";
+    std::vector<std::thread> savers;
+    for (uint32_t t = 0; t < 4; t++) {
+        savers.emplace_back([&path, t] {
+            for (uint32_t i = 0; i < 25; i++) {
+                PMetadataCache cache(path);
+                cache.Open(5);
+                cache.Record(PMetadataCache::Kind::Setting, TestGuid(t * 100 + i), L"Name", L"Description");
+                cache.Save();
+            }
+        });
+    }
+    for (auto& saver : savers)
+        saver.join();
+
+    PMetadataCache cache(path);
+    P_CHECK(cache.Open(5));
+    size_t files = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir.Path())) {
+        (void)entry;
+        files++;
+    }
+    P_CHECK_EQ(files, 1u);
+}
+
+P_TEST(MetadataCache, CachedBackendServesWarmRuns)
+{
+    PTempDir dir;
+    std::filesystem::path path = dir.Path() / "meta.bin";
+    PFakePowerBackend backend;
+    backend.Populate(2, 2, 3);
+    GUID scheme = {}, subgroup = {}, setting = {};
+    P_REQUIRE(backend.EnumerateScheme(0, scheme) == ERROR_SUCCESS);
+    P_REQUIRE(backend.EnumerateSubgroup(scheme, 1, subgroup) == ERROR_SUCCESS);
+    P_REQUIRE(backend.EnumerateSetting(scheme, subgroup, 2, setting) == ERROR_SUCCESS);
+
+    std::wstring name;
+    {
+        PCachedPowerBackend cached(backend, path);
+        P_CHECK(!cached.WasWarm());
+        P_CHECK_EQ(cached.ReadFriendlyName(&scheme, &subgroup, &setting, name), static_cast<DWORD>(ERROR_SUCCESS));
+        P_CHECK_EQ(name, std::wstring(L"Setting 1.2"));
+    }
+    {
+        PCachedPowerBackend cached(backend, path);
+        P_CHECK(cached.WasWarm());
+        backend.ResetCallCount();
+        std::wstring description;
+        P_CHECK_EQ(cached.ReadFriendlyName(&scheme, &subgroup, &setting, name), static_cast<DWORD>(ERROR_SUCCESS));
+        P_CHECK_EQ(cached.ReadDescription(&scheme, &subgroup, &setting, description), static_cast<DWORD>(ERROR_SUCCESS));
+        P_CHECK_EQ(name, std::wstring(L"Setting 1.2"));
+        P_CHECK_EQ(description, std::wstring(L"Synthetic setting 1.2"));
+        P_CHECK_EQ(backend.CallCount(), 0u);
+    }
+
+    // A name change moves the backend's metadata fingerprint, so the file is discarded
+    P_REQUIRE(backend.RenameScheme(scheme, L"Renamed"));
+    PCachedPowerBackend cached(backend, path);
+    P_CHECK(!cached.WasWarm());
+}
+
+P_TEST(MetadataCache, CachedBackendNoticesChangesAfterOpen)
+{
+    PTempDir dir;
+    std::filesystem::path path = dir.Path() / "meta.bin";
+    PFakePowerBackend backend;
+    backend.Populate(1, 2, 3);
+    GUID scheme = {}, subgroup = {}, setting = {};
+    P_REQUIRE(backend.EnumerateScheme(0, scheme) == ERROR_SUCCESS);
+    P_REQUIRE(backend.EnumerateSubgroup(scheme, 1, subgroup) == ERROR_SUCCESS);
+    P_REQUIRE(backend.EnumerateSetting(scheme, subgroup, 2, setting) == ERROR_SUCCESS);
+    std::wstring name;
+    {
+        PCachedPowerBackend cached(backend, path);
+        cached.ReadFriendlyName(&scheme, &subgroup, &setting, name);
+    }
+
+    {
+        PCachedPowerBackend cached(backend, path);
+        P_REQUIRE(cached.WasWarm());
+        cached.SetRecheckInterval(std::chrono::steady_clock::duration::zero());
+        P_CHECK_EQ(cached.ReadFriendlyName(&scheme, &subgroup, &setting, name), static_cast<DWORD>(ERROR_SUCCESS));
+        P_CHECK_EQ(name, std::wstring(L"Setting 1.2"));
+
+        // Changed while the cache is open: the next read sees the new name, not the mapped one
+        P_REQUIRE(backend.RenameSetting(scheme, subgroup, setting, L"Renamed setting"));
+        P_CHECK_EQ(cached.ReadFriendlyName(&scheme, &subgroup, &setting, name), static_cast<DWORD>(ERROR_SUCCESS));
+        P_CHECK_EQ(name, std::wstring(L"Renamed setting"));
+    }
+
+    // The file was rewritten for the new fingerprint
+    PCachedPowerBackend cached(backend, path);
+    P_CHECK(cached.WasWarm());
+    backend.ResetCallCount();
+    P_CHECK_EQ(cached.ReadFriendlyName(&scheme, &subgroup, &setting, name), static_cast<DWORD>(ERROR_SUCCESS));
+    P_CHECK_EQ(name, std::wstring(L"Renamed setting"));
+    P_CHECK_EQ(backend.CallCount(), 0u);
+}
+
+#ifndef _WIN32
+P_TEST(MetadataCache, LinuxFingerprintTracksStore)
+{
+    PTempDir first, second;
+    for (const PTempDir* dir : { &first, &second }) {
+        dir->Write("sys/firmware/acpi/platform_profile", "balanced\n");
+        dir->Write("sys/firmware/acpi/platform_profile_choices", "balanced performance\n");
+        dir->Write("sys/devices/system/cpu/cpufreq/policy0/scaling_governor", "powersave\n");
+        dir->Write("sys/devices/system/cpu/cpufreq/policy0/scaling_available_governors", "performance powersave\n");
+    }
+    uint64_t a = PLinuxPowerBackend(first.Path()).MetadataFingerprint();
+    P_CHECK_EQ(PLinuxPowerBackend(first.Path()).MetadataFingerprint(), a);
+    // Another root is another store
+    P_CHECK(PLinuxPowerBackend(second.Path()).MetadataFingerprint() != a);
+    // Another choice list changes the descriptions
+    first.Write("sys/devices/system/cpu/cpufreq/policy0/scaling_available_governors", "performance powersave schedutil\n");
+    P_CHECK(PLinuxPowerBackend(first.Path()).MetadataFingerprint() != a);
+    // The active profile and live values are not metadata
+    first.Write("sys/firmware/acpi/platform_profile", "performance\n");
+    uint64_t b = PLinuxPowerBackend(first.Path()).MetadataFingerprint();
+    first.Write("sys/devices/system/cpu/cpufreq/policy0/scaling_governor", "performance\n");
+    P_CHECK_EQ(PLinuxPowerBackend(first.Path()).MetadataFingerprint(), b);
+}
+#endif
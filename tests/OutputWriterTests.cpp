@@ -0,0 +1,139 @@
+// OutputWriterTests.cpp - POutputWriter record formats, escaping, UTF-8 encoding and buffering.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "POutputWriter.h"
+#include <functional>
+#include <limits>
+
+namespace {
+
+// Everything fn writes through a writer on a temp file, after the writer is destroyed
+std::string Capture(POutputFormat format, const std::function<void(POutputWriter&)>& fn, size_t capacity = POutputWriter::DefaultCapacity)
+{
+    FILE* file = std::tmpfile();
+    if (!file)
+        return "<no tmpfile>";
+    {
+        POutputWriter out(file, format, capacity);
+        fn(out);
+    }
+    std::string text;
+    std::rewind(file);
+    char chunk[4096];
+    for (size_t read; (read = std::fread(chunk, 1, sizeof(chunk), file)) > 0;)
+        text.append(chunk, read);
+    std::fclose(file);
+    return text;
+}
+
+// Two records with a string needing escapes, an integer and a null
+void WriteRecords(POutputWriter& out)
+{
+    out.BeginRecord();
+    out.Field("name", L"Boost, \"max\"");
+    out.Field("ac", 2u);
+    out.NullField("dc");
+    out.EndRecord();
+    out.BeginRecord();
+    out.Field("name", L"tab\there");
+    out.Field("ac", 0u);
+    out.Field("dc", 1u);
+    out.EndRecord();
+}
+
+} // namespace
+
+P_TEST(OutputWriter, ParsesFormatNames)
+{
+    POutputFormat format = POutputFormat::Text;
+    P_CHECK(ParseOutputFormat(L"json", format) && format == POutputFormat::Json);
+    P_CHECK(ParseOutputFormat(L"csv", format) && format == POutputFormat::Csv);
+    P_CHECK(ParseOutputFormat(L"ndjson", format) && format == POutputFormat::Ndjson);
+    P_CHECK(ParseOutputFormat(L"text", format) && format == POutputFormat::Text);
+    P_CHECK(!ParseOutputFormat(L"xml", format));
+}
+
+P_TEST(OutputWriter, TextRecords)
+{
+    std::string text = Capture(POutputFormat::Text, WriteRecords);
+    P_CHECK_EQ(text, std::string("Boost, \"max\"\t2\t-\ntab\\there\t0\t1\n"));
+}
+
+P_TEST(OutputWriter, CsvRecords)
+{
+    std::string text = Capture(POutputFormat::Csv, WriteRecords);
+    P_CHECK_EQ(text, std::string("name,ac,dc\n\"Boost, \"\"max\"\"\",2,\ntab\there,0,1\n"));
+}
+
+P_TEST(OutputWriter, JsonRecords)
+{
+    std::string text = Capture(POutputFormat::Json, WriteRecords);
+    P_CHECK_EQ(text, std::string("[\n{\"name\":\"Boost, \\\"max\\\"\",\"ac\":2,\"dc\":null},\n"
+                                 "{\"name\":\"tab\\there\",\"ac\":0,\"dc\":1}\n]\n"));
+    P_CHECK_EQ(Capture(POutputFormat::Json, [](POutputWriter& out) { out.Finish(); }), std::string("[]\n"));
+}
+
+P_TEST(OutputWriter, NdjsonRecords)
+{
+    std::string text = Capture(POutputFormat::Ndjson, WriteRecords);
+    P_CHECK_EQ(text, std::string("{\"name\":\"Boost, \\\"max\\\"\",\"ac\":2,\"dc\":null}\n"
+                                 "{\"name\":\"tab\\there\",\"ac\":0,\"dc\":1}\n"));
+}
+
+P_TEST(OutputWriter, EncodesWideTextAsUtf8)
+{
+    std::string text = Capture(POutputFormat::Text, [](POutputWriter& out) {
+        out << L"café € " << std::wstring(1, static_cast<wchar_t>(0x1F50B)) << L"\n";
+    });
+    P_CHECK_EQ(text, std::string("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x94\x8b\n"));
+
+    std::string json = Capture(POutputFormat::Json, [](POutputWriter& out) {
+        out.BeginRecord();
+        out.Field("v", L"é\x01");
+        out.EndRecord();
+    });
+    P_CHECK_EQ(json, std::string("[\n{\"v\":\"\xc3\xa9\\u0001\"}\n]\n"));
+}
+
+P_TEST(OutputWriter, NumbersAndPrecision)
+{
+    std::string text = Capture(POutputFormat::Text, [](POutputWriter& out) {
+        out << -42 << " " << uint64_t(18446744073709551615ull) << " " << 1.5 << " ";
+        out.SetPrecision(2);
+        out << 3.14159 << "\n";
+    });
+    P_CHECK_EQ(text, std::string("-42 18446744073709551615 1.5 3.14\n"));
+}
+
+P_TEST(OutputWriter, NonFiniteDoublesAreNull)
+{
+    auto write = [](POutputWriter& out) {
+        out.BeginRecord();
+        out.Field("nan", std::numeric_limits<double>::quiet_NaN());
+        out.Field("inf", -std::numeric_limits<double>::infinity());
+        out.Field("ok", 0.5);
+        out.EndRecord();
+    };
+    P_CHECK_EQ(Capture(POutputFormat::Json, write), std::string("[\n{\"nan\":null,\"inf\":null,\"ok\":0.5}\n]\n"));
+    P_CHECK_EQ(Capture(POutputFormat::Ndjson, write), std::string("{\"nan\":null,\"inf\":null,\"ok\":0.5}\n"));
+    P_CHECK_EQ(Capture(POutputFormat::Csv, write), std::string("nan,inf,ok\n,,0.5\n"));
+    P_CHECK_EQ(Capture(POutputFormat::Text, write), std::string("-\t-\t0.5\n"));
+}
+
+P_TEST(OutputWriter, SmallBufferKeepsRecordsWhole)
+{
+    // A tiny capacity flushes after nearly every record; CSV still gets its header once, in front
+    std::string text = Capture(POutputFormat::Csv, [](POutputWriter& out) {
+        for (unsigned i = 0; i < 100; i++) {
+            out.BeginRecord();
+            out.Field("index", i);
+            out.Field("name", L"Setting");
+            out.EndRecord();
+        }
+    }, 16);
+    std::string expected = "index,name\n";
+    for (unsigned i = 0; i < 100; i++)
+        expected += std::to_string(i) + ",Setting\n";
+    P_CHECK_EQ(text, expected);
+}
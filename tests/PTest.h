@@ -0,0 +1,101 @@
+// PTest.h - Minimal test registry, checks and fixture helpers for PowerInformationTests (no external framework).
+//
+// Tests:
+//   - P_TEST(Suite, Name) defines and registers a test; PTestMain runs every test of the suites named on the
+//     command line (all suites without arguments). ctest runs one suite per test entry.
+//   - P_CHECK / P_CHECK_EQ record a failure and let the test continue; P_REQUIRE stops the test.
+//
+// PTempDir class:
+//   - A fresh directory under the system temp directory, removed on destruction; Write() creates files and
+//     their parent directories, so a test can lay out a fake sysfs/procfs tree ("sys/...", "proc/...").
+//
+#pragma once
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct PTestCase {
+    const char* suite;
+    const char* name;
+    void (*run)();
+};
+
+// Every registered test, in registration order
+std::vector<PTestCase>& PTestRegistry();
+
+struct PTestRegistrar {
+    PTestRegistrar(const char* suite, const char* name, void (*run)()) { PTestRegistry().push_back({ suite, name, run }); }
+};
+
+// Thrown by P_REQUIRE to end the current test
+struct PTestAbort {};
+
+// Record a failure of the running test
+void PTestFail(const char* file, int line, const std::string& message);
+
+// Printable form of a checked value; values without operator<< print as "?"
+template <typename T>
+std::string PTestFormat(const T& value)
+{
+    if constexpr (std::is_convertible_v<const T&, std::wstring_view>) {
+        std::wstring_view wide = value;
+        std::string narrow;
+        for (wchar_t ch : wide)
+            narrow += static_cast<uint32_t>(ch) < 128 ? static_cast<char>(ch) : '?';
+        return '"' + narrow + '"';
+    } else if constexpr (requires(std::ostream& out, const T& v) { out << v; }) {
+        std::ostringstream out;
+        out << value;
+        return out.str();
+    } else {
+        return "?";
+    }
+}
+
+#define P_TEST(suite, name)                                                                    \
+    static void suite##_##name();                                                              \
+    static PTestRegistrar suite##_##name##_registrar(#suite, #name, &suite##_##name);          \
+    static void suite##_##name()
+
+#define P_CHECK(condition)                                                                     \
+    do {                                                                                       \
+        if (!(condition))                                                                      \
+            PTestFail(__FILE__, __LINE__, #condition);                                         \
+    } while (0)
+
+#define P_CHECK_EQ(actual, expected)                                                           \
+    do {                                                                                       \
+        const auto& checkActual = (actual);                                                    \
+        const auto& checkExpected = (expected);                                                \
+        if (!(checkActual == checkExpected))                                                   \
+            PTestFail(__FILE__, __LINE__, std::string(#actual " == " #expected ": ") +         \
+                      PTestFormat(checkActual) + " vs " + PTestFormat(checkExpected));         \
+    } while (0)
+
+#define P_REQUIRE(condition)                                                                   \
+    do {                                                                                       \
+        if (!(condition)) {                                                                    \
+            PTestFail(__FILE__, __LINE__, #condition);                                         \
+            throw PTestAbort();                                                                \
+        }                                                                                      \
+    } while (0)
+
+class PTempDir
+{
+public:
+    PTempDir();
+    ~PTempDir();
+    PTempDir(const PTempDir&) = delete;
+    PTempDir& operator=(const PTempDir&) = delete;
+
+    const std::filesystem::path& Path() const { return root; }
+    // Create (or replace) root/relative with text, creating parent directories
+    void Write(const std::filesystem::path& relative, std::string_view text) const;
+    // Contents of root/relative ("" if missing)
+    std::string Read(const std::filesystem::path& relative) const;
+
+private:
+    std::filesystem::path root;
+};
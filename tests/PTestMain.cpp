@@ -0,0 +1,103 @@
+// PTestMain.cpp - Runs the registered tests: PowerInformationTests [suite ...]
+//
+#include "pch.h"
+#include "PTest.h"
+#include <fstream>
+#include <random>
+
+namespace {
+
+int failures = 0;           // failures of the running test
+bool verbose = false;
+
+} // namespace
+
+// Every registered test
+std::vector<PTestCase>& PTestRegistry()
+{
+    static std::vector<PTestCase> registry;
+    return registry;
+}
+
+// Record a failure of the running test
+void PTestFail(const char* file, int line, const std::string& message)
+{
+    failures++;
+    std::printf("  %s:%d: %s\n", file, line, message.c_str());
+}
+
+// Fresh directory under the temp directory
+PTempDir::PTempDir()
+{
+    std::random_device seed;
+    std::filesystem::path base = std::filesystem::temp_directory_path();
+    for (;;) {
+        root = base / ("PowerInformationTest-" + std::to_string(seed()));
+        std::error_code ec;
+        if (std::filesystem::create_directory(root, ec))
+            break;
+    }
+}
+
+// Remove the directory and everything in it
+PTempDir::~PTempDir()
+{
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+}
+
+// Create (or replace) a file
+void PTempDir::Write(const std::filesystem::path& relative, std::string_view text) const
+{
+    std::filesystem::path path = root / relative;
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(text.data(), text.size());
+}
+
+// Contents of a file
+std::string PTempDir::Read(const std::filesystem::path& relative) const
+{
+    std::ifstream in(root / relative, std::ios::binary);
+    std::ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+// Run the tests of the named suites (all without arguments); -v lists passing tests too
+int main(int argc, char* argv[])
+{
+    std::vector<std::string_view> suites;
+    for (int i = 1; i < argc; i++) {
+        if (std::string_view(argv[i]) == "-v")
+            verbose = true;
+        else
+            suites.push_back(argv[i]);
+    }
+
+    size_t run = 0, failed = 0;
+    for (const PTestCase& test : PTestRegistry()) {
+        if (!suites.empty() && std::find(suites.begin(), suites.end(), test.suite) == suites.end())
+            continue;
+        failures = 0;
+        try {
+            test.run();
+        } catch (const PTestAbort&) {
+        } catch (const std::exception& e) {
+            PTestFail(__FILE__, __LINE__, std::string("exception: ") + e.what());
+        }
+        run++;
+        if (failures) {
+            failed++;
+            std::printf("FAIL %s.%s\n", test.suite, test.name);
+        } else if (verbose) {
+            std::printf("ok   %s.%s\n", test.suite, test.name);
+        }
+    }
+    std::printf("%zu tests, %zu failed\n", run, failed);
+    if (run == 0) {
+        std::printf("no tests matched\n");
+        return 1;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+// ProcTextTests.cpp - PProcText tokenizer, key/value scanner and cpuinfo/stat parsers, PCpuMask lists,
+// PProcFile re-reads, and the /proc/cpuinfo topology fallback on a fixture tree.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PCpuTopology.h"
+#include "PProcText.h"
+#include <random>
+
+namespace {
+
+std::string Joined(const PTokenRange& range)
+{
+    std::string out;
+    for (std::string_view token : range) {
+        out += '[';
+        out += token;
+        out += ']';
+    }
+    return out;
+}
+
+// Record of /proc/cpuinfo as the kernel prints it (tab before the colon, blank line after)
+std::string CpuInfoRecord(unsigned processor, unsigned package, unsigned core, const char* mhz)
+{
+    return "processor\t: " + std::to_string(processor) + "\nvendor_id\t: GenuineIntel\ncpu MHz\t\t: " + mhz +
+           "\nphysical id\t: " + std::to_string(package) + "\ncore id\t\t: " + std::to_string(core) +
+           "\nflags\t\t: fpu vme de pse tsc\n\n";
+}
+
+} // namespace
+
+P_TEST(ProcText, TokenRangeSkipsOrKeepsEmptyTokens)
+{
+    P_CHECK_EQ(Joined(PTokenRange("a,,b,c,", ",")), std::string("[a][b][c]"));
+    P_CHECK_EQ(Joined(PTokenRange("a,,b,c,", ",", true)), std::string("[a][][b][c]"));
+    P_CHECK_EQ(Joined(PTokenRange("  x  y\tz ", " \t")), std::string("[x][y][z]"));
+    P_CHECK_EQ(Joined(PTokenRange("", ",")), std::string());
+    P_CHECK_EQ(Joined(PTokenRange(",,,", ",")), std::string());
+}
+
+P_TEST(ProcText, KeyValueScannerTrimsBothSides)
+{
+    PKeyValueScanner scanner("cpu MHz\t\t: 2400.000\n\npower management:\nno separator  \nlast : value", ':');
+    std::string_view key, value;
+    P_REQUIRE(scanner.Next(key, value));
+    P_CHECK(key == "cpu MHz" && value == "2400.000");
+    P_REQUIRE(scanner.Next(key, value));
+    P_CHECK(key.empty() && value.empty());
+    P_REQUIRE(scanner.Next(key, value));
+    P_CHECK(key == "power management" && value.empty());
+    P_REQUIRE(scanner.Next(key, value));
+    P_CHECK(key == "no separator" && value.empty());
+    P_REQUIRE(scanner.Next(key, value));
+    P_CHECK(key == "last" && value == "value");
+    P_CHECK(!scanner.Next(key, value));
+
+    uint64_t number = 0;
+    P_CHECK(ParseUInt("123abc", number));
+    P_CHECK_EQ(number, uint64_t(123));
+    P_CHECK(!ParseUInt("", number));
+    P_CHECK(!ParseUInt("-1", number));
+    P_CHECK(!ParseUInt(" 1", number));
+}
+
+P_TEST(ProcText, ParsesCpuInfoRecords)
+{
+    std::string text = CpuInfoRecord(0, 0, 0, "2400.000") + CpuInfoRecord(1, 0, 4, "800.5") +
+                       "processor\t: 2\ncpu MHz\t\t: 3000\n\n" + CpuInfoRecord(3, 1, 2, "4999.999");
+    std::vector<PCpuInfoEntry> entries(7);
+    P_REQUIRE(ParseCpuInfo(text, entries));
+    P_REQUIRE(entries.size() == 4);
+    P_CHECK_EQ(entries[0].frequencyKHz, uint32_t(2400000));
+    P_CHECK_EQ(entries[1].coreId, int32_t(4));
+    P_CHECK_EQ(entries[1].frequencyKHz, uint32_t(800500));
+    // A record without ids keeps the "not listed" values
+    P_CHECK_EQ(entries[2].processor, uint32_t(2));
+    P_CHECK_EQ(entries[2].physicalId, int32_t(-1));
+    P_CHECK_EQ(entries[2].coreId, int32_t(-1));
+    P_CHECK_EQ(entries[2].frequencyKHz, uint32_t(3000000));
+    P_CHECK_EQ(entries[3].physicalId, int32_t(1));
+    P_CHECK_EQ(entries[3].frequencyKHz, uint32_t(4999999));
+
+    // Keys outside a processor record (ARM's trailing "Hardware" block) are ignored
+    P_REQUIRE(ParseCpuInfo("Hardware\t: BCM2835\ncore id\t: 9\n\n" + CpuInfoRecord(0, 0, 1, "600.000"), entries));
+    P_REQUIRE(entries.size() == 1);
+    P_CHECK_EQ(entries[0].coreId, int32_t(1));
+    P_CHECK(!ParseCpuInfo("", entries));
+}
+
+P_TEST(ProcText, ParsesProcStatCpuLines)
+{
+    const char* text =
+        "cpu  10 1 20 3000 4 0 5 0 0 0\n"
+        "cpu0 6 1 12 1500 2 0 3 0 0 0\n"
+        "cpu1 4 0 8 1500 2 0 2 7 0 0\n"
+        "intr 123 4 5\n"
+        "cpu12 1 2 3 4\n"
+        "ctxt 99\n";
+    std::vector<PCpuTimes> times;
+    P_REQUIRE(ParseProcStat(text, times));
+    P_REQUIRE(times.size() == 3);
+    P_CHECK_EQ(times[0].cpu, uint32_t(0));
+    P_CHECK_EQ(times[0].idle, uint64_t(1500));
+    P_CHECK_EQ(times[0].Busy(), uint64_t(6 + 1 + 12 + 3));
+    P_CHECK_EQ(times[1].steal, uint64_t(7));
+    P_CHECK_EQ(times[1].Total(), uint64_t(4 + 8 + 1500 + 2 + 2 + 7));
+    // Older kernels print fewer columns; the missing ones stay zero
+    P_CHECK_EQ(times[2].cpu, uint32_t(12));
+    P_CHECK_EQ(times[2].idle, uint64_t(4));
+    P_CHECK_EQ(times[2].iowait, uint64_t(0));
+}
+
+P_TEST(ProcText, CpuListsRoundTrip)
+{
+    PCpuMask mask;
+    P_REQUIRE(PCpuMask::ParseList("0-3, 8,62-65\n", mask));
+    P_CHECK_EQ(mask.Count(), size_t(4 + 1 + 4));
+    P_CHECK_EQ(mask.ToList(), std::string("0-3,8,62-65"));
+    P_CHECK(PCpuMask::ParseList("", mask));
+    for (const char* bad : { "3-1", "1-", "-2", "1,,2", "a", "1 2" }) {
+        PCpuMask ignored;
+        P_CHECK(!PCpuMask::ParseList(bad, ignored));
+    }
+
+    // Ranges across and inside 64-bit words
+    std::mt19937 rng(24);
+    for (int round = 0; round < 5000; round++) {
+        PCpuMask expected;
+        for (int k = rng() % 6; k > 0; k--) {
+            size_t first = rng() % 300;
+            size_t last = first + rng() % 200;
+            for (size_t cpu = first; cpu <= last; cpu++)
+                expected.Set(cpu);
+        }
+        PCpuMask parsed;
+        if (!PCpuMask::ParseList(expected.ToList() + "\n", parsed) || !(parsed == expected)) {
+            PTestFail(__FILE__, __LINE__, "round trip failed for " + expected.ToList());
+            return;
+        }
+    }
+}
+
+P_TEST(ProcText, ProcFileReadsAgainAndGrows)
+{
+    PTempDir dir;
+    dir.Write("stat", "cpu0 1 2 3 4\n");
+    PProcFile file;
+    P_CHECK(!file.Read(dir.Path() / "missing"));
+    P_REQUIRE(file.Open(dir.Path() / "stat"));
+    P_REQUIRE(file.ReadAgain());
+    P_CHECK(file.Text() == "cpu0 1 2 3 4\n");
+
+    // Rewritten in place, as the kernel regenerates procfs text
+    std::string large(200 * 1024, 'x');
+    dir.Write("stat", large);
+    P_REQUIRE(file.ReadAgain());
+    P_CHECK_EQ(file.Text().size(), large.size());
+    dir.Write("stat", "short\n");
+    P_REQUIRE(file.ReadAgain());
+    P_CHECK(file.Text() == "short\n");
+    file.Close();
+    P_CHECK(!file.ReadAgain());
+}
+
+P_TEST(ProcText, TopologyFallsBackToCpuInfo)
+{
+    // No cpuN/topology directories: ids and SMT siblings come from /proc/cpuinfo
+    PTempDir dir;
+    dir.Write("sys/devices/system/cpu/present", "0-3\n");
+    dir.Write("proc/cpuinfo", CpuInfoRecord(0, 0, 0, "2400.000") + CpuInfoRecord(1, 0, 1, "2400.000") +
+                                  CpuInfoRecord(2, 0, 0, "2400.000") + CpuInfoRecord(3, 0, 1, "2400.000"));
+    PCpuTopology topology;
+    P_REQUIRE(PCpuTopology::LoadFromSysfs(dir.Path(), topology));
+    P_REQUIRE(topology.cpuCount == 4);
+    P_CHECK_EQ(topology.coreId[2], int32_t(0));
+    P_CHECK_EQ(topology.coreId[3], int32_t(1));
+    P_CHECK_EQ(topology.packageId[1], int32_t(0));
+    P_CHECK_EQ(topology.smtSiblings[0].ToList(), std::string("0,2"));
+    P_CHECK_EQ(topology.smtSiblings[3].ToList(), std::string("1,3"));
+    P_CHECK_EQ(topology.firstThreadPerCore.Count(), size_t(2));
+}
@@ -0,0 +1,172 @@
+// SearchIndexTests.cpp - PSearchIndex over PFakePowerBackend: trigram hits and their ranking, words shorter
+// than a trigram, case folding, queries without hits, and the names-only build from the live store.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PCompactSnapshot.h"
+#include "PFakePowerBackend.h"
+#include "PSearchIndex.h"
+
+namespace {
+
+GUID TestGuid(uint32_t data1)
+{
+    GUID guid = {};
+    guid.Data1 = data1;
+    return guid;
+}
+
+// Two profiles with the same five settings; only the first profile's descriptions are distinct
+void AddSettings(PFakePowerBackend& backend)
+{
+    const wchar_t* names[][2] = {
+        { L"Heterogeneous thread scheduling policy", L"Which cores threads are scheduled on" },
+        { L"Heterogeneous short running thread scheduling policy", L"Which cores short threads run on" },
+        { L"Processor performance boost mode", L"How the CPU raises its frequency above base" },
+        { L"Économiseur d'énergie", L"Réduit la luminosité" },
+        { L"USB selective suspend", L"Lets the hub suspend idle ports" },
+    };
+    for (uint32_t scheme = 1; scheme <= 2; scheme++) {
+        backend.AddScheme(TestGuid(scheme), scheme == 1 ? L"Balanced" : L"Power saver");
+        backend.AddSubgroup(TestGuid(scheme), TestGuid(10), L"Group");
+        for (uint32_t i = 0; i < 5; i++) {
+            backend.AddSetting(TestGuid(scheme), TestGuid(10), TestGuid(100 + i), names[i][0],
+                               scheme == 1 ? names[i][1] : L"Second profile", i, i);
+        }
+    }
+}
+
+std::vector<std::wstring> HitNames(const PSearchIndex& index, std::wstring_view query)
+{
+    std::vector<PSearchHit> hits;
+    P_CHECK(index.Search(query, hits));
+    std::vector<std::wstring> names;
+    for (const PSearchHit& hit : hits)
+        names.emplace_back(index.Name(hit.document));
+    return names;
+}
+
+} // namespace
+
+P_TEST(SearchIndex, TrigramHitsAreRanked)
+{
+    PFakePowerBackend backend;
+    AddSettings(backend);
+    PInformation info(backend);
+    PSearchIndex index = PSearchIndex::Build(info);
+    P_REQUIRE(index.DocumentCount() == 5);
+    P_CHECK(index.TrigramCount() > 0);
+
+    // Every word must occur; the shorter name wins a tie
+    std::vector<std::wstring> expected = { L"Heterogeneous thread scheduling policy",
+                                           L"Heterogeneous short running thread scheduling policy" };
+    P_CHECK(HitNames(index, L"thread scheduling") == expected);
+    expected = { L"Heterogeneous short running thread scheduling policy" };
+    P_CHECK(HitNames(index, L"short thread") == expected);
+
+    // A name hit outranks a description hit
+    std::vector<PSearchHit> hits;
+    P_REQUIRE(index.Search(L"cores", hits));
+    P_CHECK_EQ(hits.size(), size_t(2));
+    P_REQUIRE(index.Search(L"boost", hits));
+    P_REQUIRE(hits.size() == 1);
+    P_CHECK(index.Setting(hits[0].document) == TestGuid(102));
+    uint32_t nameScore = hits[0].score;
+    P_REQUIRE(index.Search(L"frequency", hits));
+    P_REQUIRE(hits.size() == 1);
+    P_CHECK(hits[0].score < nameScore);
+
+    // limit keeps the best hits
+    P_REQUIRE(index.Search(L"policy", hits, 1));
+    P_REQUIRE(hits.size() == 1);
+    P_CHECK(index.Name(hits[0].document) == L"Heterogeneous thread scheduling policy");
+}
+
+P_TEST(SearchIndex, ShortWordsScanEveryDocument)
+{
+    PFakePowerBackend backend;
+    AddSettings(backend);
+    PInformation info(backend);
+    PSearchIndex index = PSearchIndex::Build(info);
+
+    // No trigram to look up: every document is checked against the text
+    std::vector<std::wstring> expected = { L"USB selective suspend" };
+    P_CHECK(HitNames(index, L"sb") == expected);
+    expected = { L"Processor performance boost mode" };
+    P_CHECK(HitNames(index, L"cpu") == expected);
+    P_CHECK(HitNames(index, L"po").size() == 3);
+    // A short word still narrows a long one
+    expected = { L"Heterogeneous short running thread scheduling policy" };
+    P_CHECK(HitNames(index, L"policy ru") == expected);
+}
+
+P_TEST(SearchIndex, QueriesIgnoreCase)
+{
+    PFakePowerBackend backend;
+    AddSettings(backend);
+    PInformation info(backend);
+    PSearchIndex index = PSearchIndex::Build(info);
+
+    std::vector<std::wstring> expected = { L"USB selective suspend" };
+    P_CHECK(HitNames(index, L"usb SELECTIVE") == expected);
+    expected = { L"Économiseur d'énergie" };
+    P_CHECK(HitNames(index, L"ÉCONOMISEUR") == expected);
+    P_CHECK(HitNames(index, L"ÉNERGIE") == expected);
+    // Names come back as stored, not folded
+    P_CHECK(HitNames(index, L"luminosité") == expected);
+}
+
+P_TEST(SearchIndex, QueriesWithoutHits)
+{
+    PFakePowerBackend backend;
+    AddSettings(backend);
+    PInformation info(backend);
+    PSearchIndex index = PSearchIndex::Build(info);
+
+    std::vector<PSearchHit> hits = { { 0, 1 } };
+    P_CHECK(index.Search(L"zqx", hits));
+    P_CHECK(hits.empty());
+    // Both words exist, but never in the same document
+    P_CHECK(index.Search(L"usb boost", hits));
+    P_CHECK(hits.empty());
+    // Every trigram exists, the word does not
+    P_CHECK(index.Search(L"threadheterogeneous", hits));
+    P_CHECK(hits.empty());
+    P_CHECK(!index.Search(L"  \t ", hits));
+    P_CHECK(!index.Search(L"", hits));
+
+    PFakePowerBackend empty;
+    PInformation emptyInfo(empty);
+    PSearchIndex none = PSearchIndex::Build(emptyInfo);
+    P_CHECK_EQ(none.DocumentCount(), size_t(0));
+    P_CHECK(none.Search(L"th", hits));
+    P_CHECK(hits.empty());
+}
+
+P_TEST(SearchIndex, LiveBuildReadsNamesOnly)
+{
+    PFakePowerBackend backend;
+    backend.Populate(4, 3, 8);
+    PInformation info(backend);
+
+    backend.ResetCallCount();
+    PCompactSnapshot snapshot = PCompactSnapshot::Capture(info);
+    uint64_t captureCalls = backend.CallCount();
+    backend.ResetCallCount();
+    PSearchIndex live = PSearchIndex::Build(info);
+    uint64_t liveCalls = backend.CallCount();
+    PSearchIndex parallel = PSearchIndex::Build(info, 4);
+    PSearchIndex fromSnapshot = PSearchIndex::Build(snapshot);
+
+    // Four profiles of 24 settings: descriptions of the first profile only, and no values
+    P_CHECK(liveCalls < captureCalls / 2);
+    P_REQUIRE(live.DocumentCount() == 24);
+    P_REQUIRE(parallel.DocumentCount() == 24 && fromSnapshot.DocumentCount() == 24);
+    for (uint32_t document = 0; document < 24; document++) {
+        P_CHECK(live.Setting(document) == fromSnapshot.Setting(document));
+        P_CHECK(live.Name(document) == fromSnapshot.Name(document));
+        P_CHECK(live.Description(document) == fromSnapshot.Description(document));
+        P_CHECK(parallel.Setting(document) == live.Setting(document));
+    }
+    P_CHECK_EQ(live.TrigramCount(), fromSnapshot.TrigramCount());
+}
@@ -0,0 +1,117 @@
+// SettingCatalogTests.cpp - PSettingCatalog lookups and invalidation over PFakePowerBackend.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PFakePowerBackend.h"
+#include "PSettingCatalog.h"
+
+namespace {
+
+GUID TestGuid(uint32_t data1)
+{
+    GUID guid = {};
+    guid.Data1 = data1;
+    return guid;
+}
+
+} // namespace
+
+P_TEST(SettingCatalog, FindResolvesEveryLevel)
+{
+    PFakePowerBackend backend;
+    backend.AddScheme(TestGuid(1), L"Balanced");
+    backend.AddSubgroup(TestGuid(1), TestGuid(10), L"Processor");
+    backend.AddSetting(TestGuid(1), TestGuid(10), TestGuid(100), L"Boost mode");
+    PSettingCatalog catalog(backend);
+
+    PSettingLocation location = {};
+    P_REQUIRE(catalog.Find(L"Balanced", L"Boost mode", location));
+    P_CHECK(CompareGuid(location.scheme, TestGuid(1)) == 0);
+    P_CHECK(CompareGuid(location.subgroup, TestGuid(10)) == 0);
+    P_CHECK(CompareGuid(location.setting, TestGuid(100)) == 0);
+    P_CHECK(!catalog.Find(L"Balanced", L"Missing", location));
+    P_CHECK(!catalog.Find(L"Missing", L"Boost mode", location));
+    GUID scheme = {};
+    P_CHECK(catalog.FindScheme(L"Balanced", scheme));
+    P_CHECK(CompareGuid(scheme, TestGuid(1)) == 0);
+}
+
+P_TEST(SettingCatalog, WarmLookupsMakeNoBackendCalls)
+{
+    PFakePowerBackend backend;
+    backend.Populate(3, 4, 10);
+    PSettingCatalog catalog(backend);
+    PSettingLocation location = {};
+    P_REQUIRE(catalog.Find(L"Scheme 2", L"Setting 3.9", location));
+
+    backend.ResetCallCount();
+    for (int i = 0; i < 100; i++)
+        P_CHECK(catalog.Find(L"Scheme 1", L"Setting 0.0", location));
+    // Only the generation check reaches the backend, and the fake does not count it
+    P_CHECK_EQ(backend.CallCount(), 0u);
+    P_CHECK_EQ(catalog.SchemeCount(), 3u);
+}
+
+P_TEST(SettingCatalog, GenerationChangeRebuilds)
+{
+    PFakePowerBackend backend;
+    backend.Populate(2, 1, 1);
+    PSettingCatalog catalog(backend);
+    GUID scheme = {};
+    P_REQUIRE(catalog.FindScheme(L"Scheme 0", scheme));
+
+    P_REQUIRE(backend.RenameScheme(scheme, L"Renamed"));
+    GUID renamed = {};
+    P_CHECK(catalog.FindScheme(L"Renamed", renamed));
+    P_CHECK(CompareGuid(renamed, scheme) == 0);
+    P_CHECK(!catalog.FindScheme(L"Scheme 0", renamed));
+
+    P_REQUIRE(backend.RemoveScheme(scheme));
+    P_CHECK(!catalog.FindScheme(L"Renamed", renamed));
+    P_CHECK_EQ(catalog.SchemeCount(), 1u);
+}
+
+P_TEST(SettingCatalog, InvalidateForcesRebuild)
+{
+    PFakePowerBackend backend;
+    backend.Populate(1, 1, 1);
+    PSettingCatalog catalog(backend);
+    P_CHECK_EQ(catalog.SchemeCount(), 1u);
+
+    backend.ResetCallCount();
+    P_CHECK_EQ(catalog.SchemeCount(), 1u);
+    P_CHECK_EQ(backend.CallCount(), 0u);
+    catalog.Invalidate();
+    P_CHECK_EQ(catalog.SchemeCount(), 1u);
+    P_CHECK(backend.CallCount() > 0);
+}
+
+P_TEST(SettingCatalog, FirstDuplicateWins)
+{
+    PFakePowerBackend backend;
+    backend.AddScheme(TestGuid(1), L"Same");
+    backend.AddScheme(TestGuid(2), L"Same");
+    backend.AddSubgroup(TestGuid(1), TestGuid(10), L"Group");
+    backend.AddSetting(TestGuid(1), TestGuid(10), TestGuid(100), L"Twice");
+    backend.AddSetting(TestGuid(1), TestGuid(10), TestGuid(101), L"Twice");
+    PSettingCatalog catalog(backend);
+
+    GUID scheme = {};
+    P_REQUIRE(catalog.FindScheme(L"Same", scheme));
+    P_CHECK(CompareGuid(scheme, TestGuid(1)) == 0);
+    PSettingLocation location = {};
+    P_REQUIRE(catalog.Find(L"Same", L"Twice", location));
+    P_CHECK(CompareGuid(location.setting, TestGuid(100)) == 0);
+}
+
+P_TEST(SettingCatalog, EmptyNamesIndexedByGuid)
+{
+    PFakePowerBackend backend;
+    backend.AddScheme(TestGuid(1), L"");
+    backend.AddSubgroup(TestGuid(1), TestGuid(10), L"Group");
+    backend.AddSetting(TestGuid(1), TestGuid(10), TestGuid(100), L"");
+    PSettingCatalog catalog(backend);
+
+    PSettingLocation location = {};
+    P_CHECK(catalog.Find(GuidToString(TestGuid(1)), GuidToString(TestGuid(100)), location));
+}
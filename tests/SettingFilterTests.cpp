@@ -0,0 +1,116 @@
+// SettingFilterTests.cpp - PSettingFilter predicates: globs, substrings, locale-independent case folding
+// of non-ASCII names, GUIDs with and without braces, and the per-name memo.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PGuid.h"
+#include "PSettingFilter.h"
+
+namespace {
+
+PSettingFilter Compiled(const std::vector<std::wstring>& predicates)
+{
+    PSettingFilter filter;
+    size_t errorIndex = 0;
+    P_CHECK(PSettingFilter::Compile(predicates, filter, errorIndex));
+    return filter;
+}
+
+const GUID SchedulingPolicy = { 0x93b8b6dc, 0x0698, 0x4d1c, { 0x9e, 0xe4, 0x06, 0x44, 0xe9, 0x00, 0xc8, 0x5d } };
+
+} // namespace
+
+P_TEST(SettingFilter, GlobsMatchTheWholeName)
+{
+    PSettingFilter filter = Compiled({ L"Processor*state" });
+    P_CHECK(filter.MatchesName(L"Processor performance state"));
+    P_CHECK(filter.MatchesName(L"processorstate"));
+    P_CHECK(!filter.MatchesName(L"Minimum processor state"));
+    P_CHECK(!filter.MatchesName(L"Processor state policy"));
+
+    filter = Compiled({ L"P?ST" });
+    P_CHECK(filter.MatchesName(L"past"));
+    P_CHECK(!filter.MatchesName(L"pst"));
+    P_CHECK(!filter.MatchesName(L"paste"));
+
+    // A later '*' backtracks to the last star only
+    filter = Compiled({ L"*a*b*c" });
+    P_CHECK(filter.MatchesName(L"xaybzzc"));
+    P_CHECK(filter.MatchesName(L"abcabc"));
+    P_CHECK(!filter.MatchesName(L"abcab"));
+    filter = Compiled({ L"**" });
+    P_CHECK(filter.MatchesName(L""));
+    P_CHECK(filter.MatchesName(L"anything"));
+
+    // Without '*' or '?' the predicate is a substring
+    filter = Compiled({ L"thread" });
+    P_CHECK(filter.MatchesName(L"Heterogeneous thread scheduling policy"));
+    P_CHECK(!filter.MatchesName(L"Heterogeneous policy"));
+    size_t errorIndex = 0;
+    P_CHECK(!PSettingFilter::Compile({ L"x", L"" }, filter, errorIndex));
+    P_CHECK_EQ(errorIndex, size_t(1));
+}
+
+P_TEST(SettingFilter, NonAsciiNamesIgnoreCase)
+{
+    // The "C" locale, as the tests and most services run: towlower alone leaves these unchanged
+    PSettingFilter filter = Compiled({ L"ÉNERGIE", L"Политика*", L"ΕΞΟΙΚΟΝΌΜΗΣΗ" });
+    P_CHECK(filter.MatchesName(L"Économie d'énergie du processeur"));
+    P_CHECK(filter.MatchesName(L"политика планирования потоков"));
+    P_CHECK(filter.MatchesName(L"Εξοικονόμηση ενέργειας"));
+    P_CHECK(!filter.MatchesName(L"Planification des threads"));
+
+    P_CHECK(FoldCase(L'Ä') == L'ä');
+    P_CHECK(FoldCase(L'Ł') == L'ł');
+    P_CHECK(FoldCase(L'Ž') == L'ž');
+    P_CHECK(FoldCase(L'Ё') == L'ё');
+    P_CHECK(FoldCase(L'Ÿ') == L'ÿ');
+    P_CHECK(FoldCase(L'×') == L'×');
+    P_CHECK(FoldCase(L'ß') == L'ß');
+}
+
+P_TEST(SettingFilter, GuidWithAndWithoutBraces)
+{
+    const GUID other = { 0xbae08b81, 0x2d5e, 0x4688, { 0xad, 0x6a, 0x13, 0x24, 0x33, 0x56, 0x65, 0x4b } };
+    std::wstring braced = GuidToString(SchedulingPolicy);
+    for (const std::wstring& predicate : { braced, braced.substr(1, braced.size() - 2) }) {
+        PSettingFilter filter = Compiled({ predicate });
+        P_CHECK_EQ(filter.PredicateCount(), size_t(1));
+        // Whatever the setting is called
+        P_CHECK(filter.Matches(SchedulingPolicy, L"Renamed setting"));
+        P_CHECK(!filter.Matches(other, L"Renamed setting"));
+        // A GUID is not a name predicate
+        P_CHECK(!filter.MatchesName(predicate));
+    }
+    // A malformed GUID is text
+    PSettingFilter filter = Compiled({ braced.substr(0, braced.size() - 2) });
+    P_CHECK(!filter.Matches(SchedulingPolicy, L"Renamed setting"));
+}
+
+P_TEST(SettingFilter, RepeatedNamesAreEvaluatedOnce)
+{
+    PSettingFilter filter = Compiled({ L"*scheduling*" });
+    const GUID other = { 1, 2, 3, { 4, 5, 6, 7, 8, 9, 10, 11 } };
+    for (int profile = 0; profile < 3; profile++) {
+        P_CHECK(filter.Matches(SchedulingPolicy, L"Heterogeneous thread scheduling policy"));
+        P_CHECK(!filter.Matches(other, L"Processor idle disable"));
+    }
+    P_CHECK_EQ(filter.CachedNames(), size_t(2));
+    // The memo is keyed on the name, so the same name under another GUID gives the same answer
+    P_CHECK(filter.Matches(other, L"Heterogeneous thread scheduling policy"));
+    P_CHECK_EQ(filter.CachedNames(), size_t(2));
+
+    // GUID-only filters never intern names
+    PSettingFilter byGuid = Compiled({ GuidToString(SchedulingPolicy) });
+    P_CHECK(!byGuid.Matches(other, L"Heterogeneous thread scheduling policy"));
+    P_CHECK_EQ(byGuid.CachedNames(), size_t(0));
+}
+
+P_TEST(SettingFilter, DefaultListingFilter)
+{
+    PSettingFilter filter = PSettingFilter::ThreadScheduling();
+    P_CHECK_EQ(filter.PredicateCount(), size_t(2));
+    P_CHECK(filter.MatchesName(L"Heterogeneous thread scheduling policy"));
+    P_CHECK(filter.MatchesName(L"HETEROGENEOUS SHORT RUNNING THREAD SCHEDULING POLICY"));
+    P_CHECK(!filter.MatchesName(L"Heterogeneous policy in effect"));
+}
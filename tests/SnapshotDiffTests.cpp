@@ -0,0 +1,159 @@
+// SnapshotDiffTests.cpp - DiffSnapshots over fake-backend captures: changed values, added and removed
+// settings and profiles, a setting GUID shared by two subgroups, topology changes, and identical snapshots.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PFakePowerBackend.h"
+#include "PInformation.h"
+#include "PSnapshotDiff.h"
+
+namespace {
+
+GUID TestGuid(uint32_t data1)
+{
+    GUID guid = {};
+    guid.Data1 = data1;
+    guid.Data4[7] = 0x13;
+    return guid;
+}
+
+// All CPUs online, one core each, no core types
+PCpuTopology FlatTopology(size_t count)
+{
+    PCpuTopology topology;
+    topology.Reset(count);
+    for (size_t cpu = 0; cpu < count; cpu++) {
+        topology.online.Set(cpu);
+        topology.coreId[cpu] = static_cast<int32_t>(cpu);
+        topology.packageId[cpu] = 0;
+    }
+    topology.BuildMasks();
+    return topology;
+}
+
+// "kind field old new setting-name", one line per record
+std::vector<std::wstring> Lines(const std::vector<PDiffRecord>& records)
+{
+    std::vector<std::wstring> lines;
+    for (const auto& record : records)
+        lines.push_back(std::wstring(DiffKindName(record.kind)) + L" " + record.field + L" " + record.oldValue + L" " +
+                        record.newValue + L" " + record.settingName);
+    return lines;
+}
+
+} // namespace
+
+P_TEST(SnapshotDiff, IdenticalSnapshotsHaveNoRecords)
+{
+    PFakePowerBackend backend;
+    backend.Populate(3, 2, 4);
+    PInformation info(backend);
+    PSystemSnapshot before = PSystemSnapshot::Capture(info, FlatTopology(4));
+    P_CHECK(DiffSnapshots(before, PSystemSnapshot::Capture(info, FlatTopology(4))).empty());
+
+    // Names are labels, not compared
+    GUID scheme = {};
+    P_REQUIRE(backend.EnumerateScheme(1, scheme) == ERROR_SUCCESS);
+    P_REQUIRE(backend.RenameScheme(scheme, L"Renamed"));
+    P_CHECK(DiffSnapshots(before, PSystemSnapshot::Capture(info, FlatTopology(4))).empty());
+}
+
+P_TEST(SnapshotDiff, ChangedValuesAndSettings)
+{
+    PFakePowerBackend backend;
+    backend.Populate(2, 1, 3);
+    PInformation info(backend);
+    PSystemSnapshot before = PSystemSnapshot::Capture(info, FlatTopology(2));
+
+    GUID scheme0 = {}, scheme1 = {}, subgroup = {}, setting = {};
+    P_REQUIRE(backend.EnumerateScheme(0, scheme0) == ERROR_SUCCESS);
+    P_REQUIRE(backend.EnumerateScheme(1, scheme1) == ERROR_SUCCESS);
+    P_REQUIRE(backend.EnumerateSubgroup(scheme0, 0, subgroup) == ERROR_SUCCESS);
+    P_REQUIRE(backend.EnumerateSetting(scheme0, subgroup, 1, setting) == ERROR_SUCCESS);
+    P_REQUIRE(backend.WriteValueIndex(scheme0, subgroup, setting, true, 9) == ERROR_SUCCESS);
+    P_REQUIRE(backend.AddSetting(scheme1, subgroup, TestGuid(77), L"New setting", L"", 4, 5));
+    PSystemSnapshot after = PSystemSnapshot::Capture(info, FlatTopology(2));
+
+    std::vector<PDiffRecord> records = DiffSnapshots(before, after);
+    std::vector<std::wstring> expected = { L"value ac 1 9 Setting 0.1", L"setting-added   ac=4,dc=5 New setting" };
+    P_CHECK(Lines(records) == expected);
+    P_REQUIRE(records.size() == 2);
+    P_CHECK(records[0].scheme == scheme0 && records[0].subgroup == subgroup && records[0].setting == setting);
+
+    // The other way round the new setting is removed
+    expected = { L"value ac 9 1 Setting 0.1", L"setting-removed  ac=4,dc=5  New setting" };
+    P_CHECK(Lines(DiffSnapshots(after, before)) == expected);
+}
+
+P_TEST(SnapshotDiff, ProfilesAddedAndRemoved)
+{
+    PFakePowerBackend backend;
+    backend.Populate(2, 1, 2);
+    PInformation info(backend);
+    PSystemSnapshot before = PSystemSnapshot::Capture(info, FlatTopology(2));
+
+    GUID removed = {};
+    P_REQUIRE(backend.EnumerateScheme(1, removed) == ERROR_SUCCESS);
+    P_REQUIRE(backend.RemoveScheme(removed));
+    backend.AddScheme(TestGuid(5), L"Custom");
+    P_REQUIRE(backend.AddSubgroup(TestGuid(5), TestGuid(6), L"Group"));
+    P_REQUIRE(backend.AddSetting(TestGuid(5), TestGuid(6), TestGuid(7), L"Only here"));
+    PSystemSnapshot after = PSystemSnapshot::Capture(info, FlatTopology(2));
+
+    // The settings of a whole added or removed profile are implied, not listed
+    std::vector<PDiffRecord> records = DiffSnapshots(before, after);
+    P_REQUIRE(records.size() == 2);
+    P_CHECK(records[0].kind == PDiffRecord::Kind::SchemeAdded && records[0].scheme == TestGuid(5));
+    P_CHECK_EQ(records[0].profileName, std::wstring(L"Custom"));
+    P_CHECK(records[1].kind == PDiffRecord::Kind::SchemeRemoved && records[1].scheme == removed);
+    P_CHECK_EQ(records[1].profileName, std::wstring(L"Scheme 1"));
+}
+
+P_TEST(SnapshotDiff, SettingUnderTwoSubgroups)
+{
+    // The same setting GUID listed under two subgroups is two settings
+    PFakePowerBackend backend;
+    backend.AddScheme(TestGuid(1), L"Scheme");
+    P_REQUIRE(backend.AddSubgroup(TestGuid(1), TestGuid(2), L"First"));
+    P_REQUIRE(backend.AddSubgroup(TestGuid(1), TestGuid(3), L"Second"));
+    P_REQUIRE(backend.AddSetting(TestGuid(1), TestGuid(2), TestGuid(9), L"Shared", L"", 1, 1));
+    P_REQUIRE(backend.AddSetting(TestGuid(1), TestGuid(3), TestGuid(9), L"Shared", L"", 2, 2));
+    PInformation info(backend);
+    PSystemSnapshot before = PSystemSnapshot::Capture(info, FlatTopology(1));
+    P_CHECK(DiffSnapshots(before, PSystemSnapshot::Capture(info, FlatTopology(1))).empty());
+
+    P_REQUIRE(backend.WriteValueIndex(TestGuid(1), TestGuid(3), TestGuid(9), false, 7) == ERROR_SUCCESS);
+    std::vector<PDiffRecord> records = DiffSnapshots(before, PSystemSnapshot::Capture(info, FlatTopology(1)));
+    P_REQUIRE(records.size() == 1);
+    P_CHECK(records[0].subgroup == TestGuid(3));
+    P_CHECK_EQ(records[0].field, std::wstring(L"dc"));
+    P_CHECK_EQ(records[0].oldValue, std::wstring(L"2"));
+    P_CHECK_EQ(records[0].newValue, std::wstring(L"7"));
+}
+
+P_TEST(SnapshotDiff, TopologyChanges)
+{
+    PFakePowerBackend backend;
+    backend.Populate(1, 1, 1);
+    PInformation info(backend);
+    PCpuTopology grown = FlatTopology(4);
+    grown.coreType[1] = PCoreType::Efficiency;
+    PSystemSnapshot before = PSystemSnapshot::Capture(info, FlatTopology(2));
+    PSystemSnapshot after = PSystemSnapshot::Capture(info, grown);
+
+    std::vector<std::wstring> expected = {
+        L"topology cpuCount 2 4 ",
+        L"cpu-added cpu2  online=1,type=U,core=2,package=0,die=-1,node=-1,capacity=0,siblings=2 ",
+        L"cpu-added cpu3  online=1,type=U,core=3,package=0,die=-1,node=-1,capacity=0,siblings=3 ",
+        L"topology cpu1.type U E ",
+    };
+    P_CHECK(Lines(DiffSnapshots(before, after)) == expected);
+
+    expected = {
+        L"topology cpuCount 4 2 ",
+        L"cpu-removed cpu2 online=1,type=U,core=2,package=0,die=-1,node=-1,capacity=0,siblings=2  ",
+        L"cpu-removed cpu3 online=1,type=U,core=3,package=0,die=-1,node=-1,capacity=0,siblings=3  ",
+        L"topology cpu1.type E U ",
+    };
+    P_CHECK(Lines(DiffSnapshots(after, before)) == expected);
+}
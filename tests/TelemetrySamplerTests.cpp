@@ -0,0 +1,132 @@
+// TelemetrySamplerTests.cpp - PTelemetrySampler over fixture cpufreq, powercap and /proc/cpuinfo trees.
+//
+#include "pch.h"
+#include "PTest.h"
+
+#ifndef _WIN32
+#include "PTelemetrySampler.h"
+#include <thread>
+
+namespace {
+
+const char* RaplZone = "sys/class/powercap/intel-rapl:0/";
+
+// Two CPUs at 1.2 and 2.4 GHz, one RAPL package zone that wraps at 1000000 uJ
+void WriteFixture(const PTempDir& dir)
+{
+    dir.Write("sys/devices/system/cpu/present", "0-1\n");
+    dir.Write("sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq", "1200000\n");
+    dir.Write("sys/devices/system/cpu/cpu1/cpufreq/scaling_cur_freq", "2400000\n");
+    dir.Write(std::string(RaplZone) + "name", "package-0\n");
+    dir.Write(std::string(RaplZone) + "energy_uj", "1000\n");
+    dir.Write(std::string(RaplZone) + "max_energy_range_uj", "1000000\n");
+}
+
+} // namespace
+
+P_TEST(TelemetrySampler, ReadsFrequencyAndEnergy)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    PTelemetrySampler sampler(dir.Path());
+    P_CHECK_EQ(sampler.CpuCount(), size_t(2));
+    P_REQUIRE(sampler.EnergyDomains().size() == 1);
+    P_CHECK_EQ(sampler.EnergyDomains()[0].id, std::string("intel-rapl:0"));
+    P_CHECK_EQ(sampler.EnergyDomains()[0].name, std::string("package-0"));
+    P_CHECK_EQ(sampler.EnergyDomains()[0].maxRangeUj, uint64_t(1000000));
+
+    PTelemetrySample sample;
+    P_REQUIRE(sampler.SampleOnce(sample));
+    P_CHECK_EQ(sample.sequence, uint64_t(0));
+    P_CHECK(sample.frequencyKHz == std::vector<uint32_t>({ 1200000, 2400000 }));
+    P_CHECK(sample.energyUj == std::vector<uint64_t>({ 0 }));
+
+    dir.Write(std::string(RaplZone) + "energy_uj", "1500\n");
+    dir.Write("sys/devices/system/cpu/cpu1/cpufreq/scaling_cur_freq", "800000\n");
+    P_REQUIRE(sampler.SampleOnce(sample));
+    P_CHECK_EQ(sample.sequence, uint64_t(1));
+    P_CHECK(sample.frequencyKHz == std::vector<uint32_t>({ 1200000, 800000 }));
+    P_CHECK(sample.energyUj == std::vector<uint64_t>({ 500 }));
+}
+
+P_TEST(TelemetrySampler, EnergyFoldsCounterWraparound)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    PTelemetrySampler sampler(dir.Path());
+    PTelemetrySample sample;
+    P_REQUIRE(sampler.SampleOnce(sample));
+
+    dir.Write(std::string(RaplZone) + "energy_uj", "999000\n");
+    P_REQUIRE(sampler.SampleOnce(sample));
+    P_CHECK(sample.energyUj == std::vector<uint64_t>({ 998000 }));
+    // Wrapped: 1000 uJ up to the range end, then 500 from zero
+    dir.Write(std::string(RaplZone) + "energy_uj", "500\n");
+    P_REQUIRE(sampler.SampleOnce(sample));
+    P_CHECK(sample.energyUj == std::vector<uint64_t>({ 999500 }));
+}
+
+P_TEST(TelemetrySampler, FallsBackToCpuInfoWithoutCpufreq)
+{
+    PTempDir dir;
+    dir.Write("sys/devices/system/cpu/present", "0-1\n");
+    dir.Write("proc/cpuinfo", "processor\t: 0\ncpu MHz\t\t: 2100.000\n\nprocessor\t: 1\ncpu MHz\t\t: 3000.500\n\n");
+    PTelemetrySampler sampler(dir.Path());
+    P_CHECK(sampler.EnergyDomains().empty());
+
+    PTelemetrySample sample;
+    P_REQUIRE(sampler.SampleOnce(sample));
+    P_CHECK(sample.frequencyKHz == std::vector<uint32_t>({ 2100000, 3000500 }));
+    // The same open file is re-read on every sample
+    dir.Write("proc/cpuinfo", "processor\t: 0\ncpu MHz\t\t: 800.000\n\nprocessor\t: 1\ncpu MHz\t\t: 900.000\n\n");
+    P_REQUIRE(sampler.SampleOnce(sample));
+    P_CHECK(sample.frequencyKHz == std::vector<uint32_t>({ 800000, 900000 }));
+}
+
+P_TEST(TelemetrySampler, ThreadPublishesSamplesInOrder)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    PTelemetrySampler sampler(dir.Path(), 1024);
+    P_REQUIRE(sampler.Start(std::chrono::milliseconds(1)));
+    P_CHECK(sampler.IsRunning());
+    PTelemetrySample ignored;
+    P_CHECK(!sampler.SampleOnce(ignored));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    sampler.Stop();
+    P_CHECK(!sampler.IsRunning());
+
+    uint64_t expected = 0, lastTimestamp = 0;
+    size_t count = sampler.Drain([&](const PTelemetrySample& sample) {
+        P_CHECK_EQ(sample.sequence, expected);
+        P_CHECK(sample.timestampNs >= lastTimestamp);
+        P_CHECK(sample.frequencyKHz == std::vector<uint32_t>({ 1200000, 2400000 }));
+        expected++;
+        lastTimestamp = sample.timestampNs;
+    });
+    P_CHECK(count > 0);
+    P_CHECK_EQ(sampler.Dropped(), uint64_t(0));
+}
+
+P_TEST(TelemetrySampler, FullRingCountsDroppedSamples)
+{
+    PTempDir dir;
+    WriteFixture(dir);
+    PTelemetrySampler sampler(dir.Path(), 2);
+    P_REQUIRE(sampler.Start(std::chrono::microseconds(100)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    sampler.Stop();
+    P_CHECK(sampler.Drain([](const PTelemetrySample&) {}) <= 2);
+    P_CHECK(sampler.Dropped() > 0);
+}
+
+P_TEST(TelemetrySampler, NothingToSampleDoesNotStart)
+{
+    PTempDir dir;
+    PTelemetrySampler sampler(dir.Path());
+    P_CHECK_EQ(sampler.CpuCount(), size_t(0));
+    P_CHECK(sampler.EnergyDomains().empty());
+    P_CHECK(!sampler.Start(std::chrono::milliseconds(1)));
+}
+
+#endif
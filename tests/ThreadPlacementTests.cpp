@@ -0,0 +1,102 @@
+// ThreadPlacementTests.cpp - PlacementMask on synthetic hybrid and SMT topologies, refusing empty
+// placements, saving and restoring the calling thread's affinity, and the placement names.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PThreadPlacement.h"
+
+namespace {
+
+// Two P-cores with two threads each (0-3) and four single-thread E-cores (4-7); CPU 7 is offline
+PCpuTopology HybridTopology()
+{
+    PCpuTopology topology;
+    topology.Reset(8);
+    for (size_t cpu = 0; cpu < 8; cpu++) {
+        if (cpu != 7)
+            topology.online.Set(cpu);
+        topology.coreType[cpu] = cpu < 4 ? PCoreType::Performance : PCoreType::Efficiency;
+        if (cpu < 4)
+            topology.smtSiblings[cpu].SetRange(cpu & ~size_t(1), cpu | 1);
+    }
+    topology.BuildMasks();
+    return topology;
+}
+
+// Four CPUs on two SMT cores with no core-type information
+PCpuTopology SmtTopology()
+{
+    PCpuTopology topology;
+    topology.Reset(4);
+    for (size_t cpu = 0; cpu < 4; cpu++) {
+        topology.online.Set(cpu);
+        topology.smtSiblings[cpu].SetRange(cpu & ~size_t(1), cpu | 1);
+    }
+    topology.BuildMasks();
+    return topology;
+}
+
+} // namespace
+
+P_TEST(ThreadPlacement, HybridPlacementMasks)
+{
+    PCpuTopology topology = HybridTopology();
+    P_CHECK_EQ(PlacementMask(topology, PCorePlacement::Any).ToList(), std::string("0-6"));
+    P_CHECK_EQ(PlacementMask(topology, PCorePlacement::Performance).ToList(), std::string("0-3"));
+    P_CHECK_EQ(PlacementMask(topology, PCorePlacement::Efficiency).ToList(), std::string("4-6"));
+    P_CHECK_EQ(PlacementMask(topology, PCorePlacement::NoSmtSiblings).ToList(), std::string("0,2,4-6"));
+}
+
+P_TEST(ThreadPlacement, NonHybridHasNoCoreTypeMasks)
+{
+    PCpuTopology topology = SmtTopology();
+    P_CHECK_EQ(PlacementMask(topology, PCorePlacement::Any).ToList(), std::string("0-3"));
+    P_CHECK(PlacementMask(topology, PCorePlacement::Performance).Empty());
+    P_CHECK(PlacementMask(topology, PCorePlacement::Efficiency).Empty());
+    P_CHECK_EQ(PlacementMask(topology, PCorePlacement::NoSmtSiblings).ToList(), std::string("0,2"));
+}
+
+P_TEST(ThreadPlacement, EmptyPlacementIsRefused)
+{
+    PCpuTopology topology = SmtTopology();
+    P_CHECK(!PinThread(CurrentThreadId(), PCpuMask()));
+    P_CHECK(!PinThread(CurrentThreadId(), PCpuMask(64)));
+    P_CHECK(!PinCurrentThread(topology, PCorePlacement::Efficiency));
+    P_CHECK(!PinThread(CurrentThreadId(), topology, PCorePlacement::Performance));
+}
+
+P_TEST(ThreadPlacement, PinAndRestoreTheCallingThread)
+{
+    PSavedAffinity saved;
+    P_REQUIRE(SaveCurrentThreadAffinity(saved));
+#ifndef _WIN32
+    P_REQUIRE(!saved.cpus.Empty());
+    PCpuMask first;
+    first.Set(saved.cpus.First());
+    P_REQUIRE(PinThread(CurrentThreadId(), first));
+    PSavedAffinity pinned;
+    P_REQUIRE(SaveCurrentThreadAffinity(pinned));
+    P_CHECK(pinned.cpus == first);
+#endif
+    P_REQUIRE(RestoreCurrentThreadAffinity(saved));
+    PSavedAffinity restored;
+    P_REQUIRE(SaveCurrentThreadAffinity(restored));
+#ifdef _WIN32
+    P_CHECK(restored.cpuSets == saved.cpuSets);
+#else
+    P_CHECK(restored.cpus == saved.cpus);
+#endif
+}
+
+P_TEST(ThreadPlacement, NamesRoundTrip)
+{
+    for (PCorePlacement placement : { PCorePlacement::Any, PCorePlacement::Performance, PCorePlacement::Efficiency,
+                                      PCorePlacement::NoSmtSiblings }) {
+        PCorePlacement parsed = PCorePlacement::Any;
+        P_CHECK(ParsePlacement(PlacementName(placement), parsed));
+        P_CHECK(parsed == placement);
+    }
+    PCorePlacement parsed = PCorePlacement::Any;
+    P_CHECK(ParsePlacement(L"e", parsed) && parsed == PCorePlacement::Efficiency);
+    P_CHECK(!ParsePlacement(L"fast", parsed));
+}
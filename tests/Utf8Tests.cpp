@@ -0,0 +1,143 @@
+// Utf8Tests.cpp - PUtf8 conversions: block boundaries of the vector paths, U+FFFD replacement of malformed
+// input, strict conversions with error positions, and round trips of random input.
+//
+#include "pch.h"
+#include "PTest.h"
+#include "PUtf8.h"
+#include <random>
+
+namespace {
+
+constexpr wchar_t Replacement = 0xFFFD;
+
+std::wstring Wide(std::initializer_list<uint32_t> codePoints)
+{
+    std::wstring out;
+    for (uint32_t cp : codePoints) {
+        if (sizeof(wchar_t) == 2 && cp >= 0x10000) {
+            out += static_cast<wchar_t>(0xD800 | ((cp - 0x10000) >> 10));
+            out += static_cast<wchar_t>(0xDC00 | ((cp - 0x10000) & 0x3FF));
+        } else {
+            out += static_cast<wchar_t>(cp);
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+P_TEST(Utf8, AsciiAndMultibyteRoundTrip)
+{
+    std::string utf8 = "Balanced \xc3\xa9 \xe2\x82\xac \xf0\x9f\x94\x8b end";
+    std::wstring wide = Wide({ 'B', 'a', 'l', 'a', 'n', 'c', 'e', 'd', ' ', 0xE9, ' ', 0x20AC, ' ', 0x1F50B, ' ', 'e', 'n', 'd' });
+    P_CHECK(Utf8ToWide(utf8) == wide);
+    P_CHECK_EQ(WideToUtf8(wide), utf8);
+    P_CHECK(Utf8ToWide("").empty());
+    P_CHECK(WideToUtf8(L"").empty());
+
+    std::string appended = "prefix:";
+    WideToUtf8(wide, appended);
+    P_CHECK_EQ(appended, "prefix:" + utf8);
+}
+
+P_TEST(Utf8, NonAsciiAtEveryBlockOffset)
+{
+    // Put one two-byte character at each position of strings spanning several 16/32-byte blocks
+    for (size_t length = 1; length <= 80; length++) {
+        for (size_t at = 0; at < length; at++) {
+            std::string utf8;
+            std::wstring wide;
+            for (size_t i = 0; i < length; i++) {
+                if (i == at) {
+                    utf8 += "\xc3\xa9";
+                    wide += static_cast<wchar_t>(0xE9);
+                } else {
+                    utf8 += static_cast<char>('a' + i % 26);
+                    wide += static_cast<wchar_t>('a' + i % 26);
+                }
+            }
+            if (Utf8ToWide(utf8) != wide || WideToUtf8(wide) != utf8 || !ValidateUtf8(utf8)) {
+                P_CHECK(false && "mismatch");
+                return;
+            }
+        }
+    }
+}
+
+P_TEST(Utf8, MalformedInputBecomesReplacementCharacters)
+{
+    // One U+FFFD per maximal invalid subpart
+    P_CHECK(Utf8ToWide("a\xe2\x82" "b") == Wide({ 'a', Replacement, 'b' }));        // truncated 3-byte sequence
+    P_CHECK(Utf8ToWide("\xc0\xaf") == Wide({ Replacement, Replacement }));           // overlong '/'
+    P_CHECK(Utf8ToWide("\xed\xa0\x80") == Wide({ Replacement, Replacement, Replacement })); // encoded surrogate
+    P_CHECK(Utf8ToWide("\xf4\x90\x80\x80") == Wide({ Replacement, Replacement, Replacement, Replacement })); // above U+10FFFF
+    P_CHECK(Utf8ToWide("\xf0\x9f\x94" "A") == Wide({ Replacement, 'A' }));             // truncated 4-byte sequence
+    P_CHECK(Utf8ToWide("\x80\xff") == Wide({ Replacement, Replacement }));             // stray continuation, invalid byte
+
+    // Unpaired surrogates and out-of-range values in wide input
+    std::wstring lone(1, static_cast<wchar_t>(0xD800));
+    P_CHECK_EQ(WideToUtf8(L"x" + lone + L"y"), std::string("x\xef\xbf\xbdy"));
+}
+
+P_TEST(Utf8, StrictConversionsReportTheFirstError)
+{
+    size_t position = 0;
+    P_CHECK(ValidateUtf8("plain ascii", &position));
+    P_CHECK(!ValidateUtf8("ab\xe2\x82", &position));
+    P_CHECK_EQ(position, size_t(2));
+
+    std::u16string utf16 = u"keep";
+    P_CHECK(Utf8ToUtf16("\xc3\xa9\xf0\x9f\x94\x8b", utf16, &position));
+    P_CHECK(utf16 == u"keepé\U0001F50B");
+
+    std::u32string utf32;
+    P_CHECK(!Utf8ToUtf32("ok\xc3\xa9\xed\xa0\x80tail", utf32, &position));
+    P_CHECK_EQ(position, size_t(4));
+    P_CHECK(utf32 == U"oké");
+
+    std::string out;
+    std::u16string badUtf16 = u"ab";
+    badUtf16 += static_cast<char16_t>(0xDC00);
+    P_CHECK(!Utf16ToUtf8(badUtf16, out, &position));
+    P_CHECK_EQ(position, size_t(2));
+    P_CHECK_EQ(out, std::string("ab"));
+
+    out.clear();
+    std::u32string badUtf32 = U"xyz";
+    badUtf32 += static_cast<char32_t>(0x110000);
+    P_CHECK(!Utf32ToUtf8(badUtf32, out, &position));
+    P_CHECK_EQ(position, size_t(3));
+    P_CHECK_EQ(out, std::string("xyz"));
+}
+
+P_TEST(Utf8, RandomInputKeepsInvariants)
+{
+    std::mt19937 rng(19);
+    const char* pieces[] = { "a", "Z", " ", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x94\x8b", "\x80", "\xc3", "\xed\xa0\x80", "\xff" };
+    for (int round = 0; round < 2000; round++) {
+        std::string input;
+        size_t count = rng() % 60;
+        for (size_t i = 0; i < count; i++)
+            input += pieces[rng() % (round % 2 ? 6 : 10)];
+
+        size_t position = SIZE_MAX;
+        bool valid = ValidateUtf8(input, &position);
+        std::wstring wide = Utf8ToWide(input);
+        std::string back = WideToUtf8(wide);
+        std::u32string utf32;
+        size_t position32 = SIZE_MAX;
+        bool valid32 = Utf8ToUtf32(input, utf32, &position32);
+
+        // Lenient output is always well formed; valid input round-trips exactly
+        bool ok = ValidateUtf8(back) && valid == valid32 && (valid ? back == input : position == position32);
+        if (ok && !valid) {
+            // The strict prefix converts to the same text as the lenient conversion of that prefix
+            std::string prefix;
+            ok = Utf32ToUtf8(utf32, prefix) && prefix == input.substr(0, position);
+        }
+        if (!ok) {
+            P_CHECK(false && "invariant broken");
+            return;
+        }
+    }
+}